@@ -0,0 +1,136 @@
+/* Author: Alexander G. Lopez
+   --------------------------
+   This is the Bucket Queue interface. A bucket queue is a double ended
+   priority queue for small integer priorities in the range [0, N) where N
+   is the number of buckets the user provides. Each bucket is a FIFO list of
+   the elements with that priority so there are no comparisons at all. Push
+   and erase are O(1). The min and max are found by scanning from cached
+   bounds on the lowest and highest occupied bucket, which only move
+   inward as buckets empty, so the scan is O(1) amortized for a stream of
+   pops from one end and O(N) in the worst case.
+
+   Elements of equal priority leave in round robin order, oldest first,
+   whether popped from the min or the max end. This matches the duplicate
+   promise of the DEPQ in depqueue.h. An element whose priority is updated
+   is considered new and goes to the back of its new bucket.
+
+   The buckets are an array of element pointers owned by the user so that
+   no allocation occurs. The array must start zeroed. For example:
+
+     struct bpq_elem *buckets[101] = {0};
+     struct bucket_pqueue bq = BPQ_INIT(buckets, 101); */
+#ifndef BUCKET_PQUEUE
+#define BUCKET_PQUEUE
+
+#include <stdbool.h>
+#include <stddef.h>
+/* NOLINTNEXTLINE */
+#include <stdint.h>
+
+/* The embedded struct type for operation of the bucket queue. Do not access
+   the fields of the struct directly. */
+struct bpq_elem
+{
+    struct bpq_elem *next;
+    struct bpq_elem *prev;
+    size_t priority;
+};
+
+/* Acts on each element as the bucket queue is cleared. The element has
+   already been removed so it is safe to free its wrapping struct. */
+typedef void bpq_destructor_fn(struct bpq_elem *);
+
+/* Operation counts for profiling builds that define CONTAINER_PROFILE.
+   Skips count the empty buckets passed over while finding the min or max
+   and are the only cost of a pop beyond the O(1) unlink. */
+struct bpq_counters
+{
+    size_t skips;
+};
+
+/* The bucket queue. Every occupied bucket lies in [lo, hi] and each bucket
+   holds the oldest element of a circular list, the next to leave. Consider
+   the fields private and initialize it with the macro below. */
+struct bucket_pqueue
+{
+    struct bpq_elem **buckets;
+    size_t num_buckets;
+    size_t sz;
+    size_t lo;
+    size_t hi;
+#ifdef CONTAINER_PROFILE
+    struct bpq_counters counters;
+#endif
+};
+
+/* Obtains the wrapping struct from the address of the embedded element, the
+   name of the wrapping struct, and the name of the field of the element. */
+#define BPQ_ENTRY(BPQ_ELEM, STRUCT, MEMBER)                                    \
+    ((STRUCT *)((uint8_t *)&(BPQ_ELEM)->next                                   \
+                - offsetof(STRUCT, MEMBER.next))) /* NOLINT */
+
+/* Initializes an empty bucket queue on the right hand side of its
+   declaration given a zeroed array of NUM_BUCKETS element pointers. The
+   valid priorities are then [0, NUM_BUCKETS). */
+#define BPQ_INIT(BUCKETS, NUM_BUCKETS)                                         \
+    {                                                                          \
+        .buckets = (BUCKETS), .num_buckets = (NUM_BUCKETS), .sz = 0,           \
+        .lo = (NUM_BUCKETS), .hi = 0                                           \
+    }
+
+/* Adds the element to the back of the bucket for the priority. Returns
+   false and does not push if the priority is not less than the number of
+   buckets. O(1). */
+bool bpq_push(struct bucket_pqueue *, struct bpq_elem *, size_t priority);
+
+/* Removes the oldest element of the highest priority. Returns NULL if
+   empty. O(1) amortized over pops from the same end. */
+struct bpq_elem *bpq_pop_max(struct bucket_pqueue *);
+/* Same promises as pop_max except for the lowest priority. */
+struct bpq_elem *bpq_pop_min(struct bucket_pqueue *);
+
+/* Reports the element pop_max would remove. The cached bound is moved to
+   the highest occupied bucket so it is not a const operation but a
+   following pop_max does not scan. Returns NULL if empty. */
+struct bpq_elem *bpq_max(struct bucket_pqueue *);
+/* Same promises as max except for the lowest priority. */
+struct bpq_elem *bpq_min(struct bucket_pqueue *);
+
+/* Removes the element from wherever it is. Returns NULL if the element is
+   not in a bucket queue. O(1). */
+struct bpq_elem *bpq_erase(struct bucket_pqueue *, struct bpq_elem *);
+
+/* Moves the element to the back of the bucket for the new priority even if
+   the priority is unchanged. Returns false and changes nothing if the
+   element is not in a bucket queue or the priority is out of range. O(1) */
+bool bpq_update(struct bucket_pqueue *, struct bpq_elem *, size_t priority);
+
+/* The priority stored in the element. */
+size_t bpq_priority(struct bpq_elem const *);
+
+/* Returns true if the bucket queue is empty. */
+bool bpq_empty(struct bucket_pqueue const *);
+
+/* Returns the number of elements. O(1). */
+size_t bpq_size(struct bucket_pqueue const *);
+
+/* The number of buckets, one more than the largest valid priority. */
+size_t bpq_num_buckets(struct bucket_pqueue const *);
+
+/* A snapshot of the operation counters, all 0 unless built with
+   CONTAINER_PROFILE defined. See pq_profile. */
+struct bpq_counters bpq_profile(struct bucket_pqueue const *);
+
+/* Zeroes the operation counters. No effect without CONTAINER_PROFILE. */
+void bpq_profile_reset(struct bucket_pqueue *);
+
+/* Removes every element and calls the destructor on it. O(N + B) for N
+   elements and B buckets. */
+void bpq_clear(struct bucket_pqueue *, bpq_destructor_fn *);
+
+/* Checks that every element is in the bucket for its priority, that the
+   lists are linked both ways, that the cached bounds cover every occupied
+   bucket, and the size. Intended for tests and debugging. */
+bool bpq_validate(struct bucket_pqueue const *);
+
+#endif /* BUCKET_PQUEUE */
@@ -85,6 +85,12 @@ typedef void depq_print_fn(struct depq_elem const *);
    even if it is updated to the same value it previously stored O(lgN). */
 typedef void depq_update_fn(struct depq_elem *, void *aux);
 
+/* A visitor for the depq_for_each family. The aux argument is passed
+   through untouched so it can carry an accumulator for a sum, histogram,
+   export, or any other fold over the elements. The visitor may read the
+   element but must not modify its priority or the DEPQ. */
+typedef void depq_for_each_fn(struct depq_elem *, void *aux);
+
 /* Performs user specified destructor actions on a single depq_elem. This
    depq_elem is assumed to be embedded in user defined structs and therefore
    allows the user to perform any updates to their program before deleting
@@ -165,6 +171,27 @@ bool depq_empty(struct depqueue const *);
 /* O(1) */
 size_t depq_size(struct depqueue *);
 
+/* Rebuilds the DEPQ into a perfectly balanced shape in O(N) time and O(1)
+   space with the Day-Stout-Warren algorithm. Duplicates stay in their
+   rings behind their tree node so round robin order is unchanged. No
+   elements move in memory and iterators remain valid. */
+void depq_rebalance(struct depqueue *);
+
+/* Reports the height, average depth, node count, and duplicate ring
+   counts of the DEPQ in O(N) time and O(1) space without modifying the
+   tree. See tree.h for the fields. */
+struct tree_stats depq_stats(struct depqueue const *);
+
+/* A snapshot of the operation counters of the DEPQ. The counters only
+   exist when the library is built with CONTAINER_PROFILE defined, see the
+   CMake option of the same name. Otherwise every count is 0 and no
+   operation pays for counting. See tree.h for the fields. */
+struct tree_counters depq_profile(struct depqueue const *);
+
+/* Zeroes the operation counters of the DEPQ. No effect without
+   CONTAINER_PROFILE. */
+void depq_profile_reset(struct depqueue *);
+
 /* Inserts the given struct depq_elem into an initialized struct depqueue
    any data in the struct depq_elem member will be overwritten
    The struct depq_elem must not already be in the DEPQ or the
@@ -188,6 +215,28 @@ struct depq_elem *depq_pop_max(struct depqueue *);
 /* Same promises as pop_max except for the minimum values. */
 struct depq_elem *depq_pop_min(struct depqueue *);
 
+/* Pops the max and pushes the new element in one operation. The max is
+   splayed to the root once and detached without the second splay a pop
+   normally performs. If the new element is not less than the old max it
+   takes the root in O(1), the common case when merging sorted streams.
+   Otherwise it is inserted with a normal splay. Round robin fairness among
+   duplicates is preserved. Returns the old max or the end element if the
+   DEPQ was empty, in which case the new element is simply pushed. */
+struct depq_elem *depq_replace_max(struct depqueue *, struct depq_elem *);
+/* Same promises as replace_max except for the minimum values. */
+struct depq_elem *depq_replace_min(struct depqueue *, struct depq_elem *);
+
+/* Pops up to n of the max elements into the caller provided array in
+   descending order with duplicates in round robin order, exactly as n
+   calls to pop_max would. The max is splayed to the root once and every
+   following element is unlinked in O(1) as it is found so the batch
+   costs O(lgN + n) rather than n splays. Returns the number of elements
+   written to out which is less than n only if the DEPQ ran out. */
+size_t depq_pop_max_n(struct depqueue *, struct depq_elem **out, size_t n);
+/* Same promises as pop_max_n except for the minimum values in ascending
+   order. */
+size_t depq_pop_min_n(struct depqueue *, struct depq_elem **out, size_t n);
+
 /* Reports the maximum priority element in the DEPQ, drawing
    it to the root via splay operations. This, is a good
    function to use if the user wishes to bring frequently
@@ -286,6 +335,39 @@ struct depq_elem *depq_rnext(struct depqueue *, struct depq_elem *);
    is reached. The end is same for any iteration order. */
 struct depq_elem *depq_end(struct depqueue *);
 
+/* A cursor for fast read only scans of the whole DEPQ. Each step of the
+   iterators above must work out where a duplicate ring began and double
+   check the root. The cursor tracks the ring it is in so each step is a
+   plain pointer walk, never writes to the tree, and prefetches the next
+   node. The visiting order, duplicates included, is the same as the
+   iterators. For example:
+
+      struct depq_cursor c;
+      for (struct depq_elem *e = depq_cursor_begin(&pq, &c);
+           e != depq_end(&pq); e = depq_cursor_next(&c))
+      {
+          ...Read only logic...
+      }
+
+   The DEPQ must not be modified while a cursor is in use. Any push, pop,
+   erase, or search that splays the tree invalidates the cursor. */
+struct depq_cursor
+{
+    struct cursor c ATTRIB_PRIVATE;
+};
+
+/* Starts a descending scan at the maximum. Returns end if empty. */
+struct depq_elem *depq_cursor_begin(struct depqueue const *,
+                                    struct depq_cursor *);
+
+/* Starts an ascending scan at the minimum. Returns end if empty. */
+struct depq_elem *depq_cursor_rbegin(struct depqueue const *,
+                                     struct depq_cursor *);
+
+/* Advances the cursor in the direction it was started. Returns end once
+   every element has been visited and continues to return end after. */
+struct depq_elem *depq_cursor_next(struct depq_cursor *);
+
 /* Returns the range with pointers to the first element NOT GREATER
    than the requested begin and last element LESS than the
    provided end element. If either portion of the range cannot
@@ -325,6 +407,27 @@ struct depq_elem *depq_begin_rrange(struct depq_rrange const *);
    access fields of rranges directly. */
 struct depq_elem *depq_end_rrange(struct depq_rrange const *);
 
+/* Visits every element in descending order, duplicates in round robin
+   order, and passes each to the visitor with aux. This is the fastest way
+   to visit every element. There is no per element iterator call and the
+   walk uses the parent links so it needs no stack and never writes to the
+   tree, not even to splay. O(N) time and O(1) space. */
+void depq_for_each(struct depqueue const *, depq_for_each_fn *, void *aux);
+
+/* Visits every element in ascending order. See depq_for_each. */
+void depq_rfor_each(struct depqueue const *, depq_for_each_fn *, void *aux);
+
+/* Visits the elements of a range obtained from depq_equal_range in the
+   same order depq_next would. Obtaining the range splays but visiting
+   it does not. */
+void depq_for_each_range(struct depqueue const *, struct depq_range const *,
+                         depq_for_each_fn *, void *aux);
+
+/* Visits the elements of a rrange obtained from depq_equal_rrange in the
+   same order depq_rnext would. */
+void depq_for_each_rrange(struct depqueue const *, struct depq_rrange const *,
+                          depq_for_each_fn *, void *aux);
+
 /* To view the underlying tree like structure of the DEPQ
    for debugging or other purposes, provide the root of the struct depqueue
    to the depq_print function as the starting struct depq_elem. */
@@ -1,6 +1,7 @@
 #ifndef PQUEUE
 #define PQUEUE
 
+#include <limits.h>
 #include <stdbool.h>
 #include <stddef.h>
 /* NOLINTNEXTLINE */
@@ -53,6 +54,58 @@ typedef void pq_destructor_fn(struct pq_elem *);
    the type being used for comparisons in the priority queue. */
 typedef void pq_update_fn(struct pq_elem *, void *);
 
+/* A visitor for pq_for_each. The aux argument is passed through untouched
+   so it can carry an accumulator. The visitor may read the element but must
+   not change its priority or modify the priority queue. */
+typedef void pq_for_each_fn(struct pq_elem *, void *);
+
+/* A predicate for pq_find_if. Return true to stop the scan and receive the
+   element. The same rules as the visitor apply. */
+typedef bool pq_pred_fn(struct pq_elem const *, void *);
+
+/* Operation counts for profiling builds that define CONTAINER_PROFILE.
+   Merges count the fair merges that link two heaps, each costing one
+   comparison. Cuts count subtrees cut from their parent for an update or
+   erase and delete_mins count the pairing passes over a child list. */
+struct pq_counters
+{
+    size_t cmps;
+    size_t merges;
+    size_t cuts;
+    size_t delete_mins;
+};
+
+/* The pairing strategy used to combine the children of the front when it is
+   popped. Each is a different order of the same fair merges and they trade
+   constant factors depending on the workload.
+
+      PQ_FRONT_TO_BACK       Pair the children oldest first and fold each
+                             pair into the result as it forms. The default.
+      PQ_TWO_PASS            Pair the children oldest first, then fold the
+                             pairs together from the last pair back to the
+                             first. The classic pairing heap.
+      PQ_MULTIPASS           Treat the children as a queue. Merge the front
+                             two and append the result to the back until one
+                             tree remains.
+      PQ_AUXILIARY_TWO_PASS  Pushes and the subtrees cut by an update that
+                             do not beat the front wait in an auxiliary list
+                             of roots. A pop combines that list multipass and
+                             the children of the front two pass. Suits many
+                             decrease key operations between pops. */
+enum pq_pairing
+{
+    PQ_FRONT_TO_BACK = 0,
+    PQ_TWO_PASS,
+    PQ_MULTIPASS,
+    PQ_AUXILIARY_TWO_PASS,
+};
+
+/* One slot per bit of the element count. A bounded priority queue keeps
+   pushed elements that lose to the front in a forest of trees sized like a
+   binary counter, at most one tree of each power of two. The slots are an
+   array the user provides so that other priority queues do not carry it. */
+#define PQ_PENDING_SLOTS (sizeof(size_t) * CHAR_BIT)
+
 /* The structure used to manage the data in a priority queue. Stack allocation
    is recommended for easy cleanup and speed. However, this structure may be
    placed anywhere that is convenient for the user. Consider the fields
@@ -65,6 +118,13 @@ struct pqueue
     pq_cmp_fn *cmp;
     enum pq_threeway_cmp order;
     void *aux;
+    enum pq_pairing pairing;
+    struct pq_elem *aux_roots;
+    struct pq_elem **pending;
+    size_t pending_count;
+#ifdef CONTAINER_PROFILE
+    struct pq_counters counters;
+#endif
 };
 
 /* Given the address of the pq_elem the user has access to, the name of the
@@ -87,16 +147,60 @@ struct pqueue
         .root = NULL, .sz = 0, .cmp = (CMP_FN), .order = (ORDER), .aux = (AUX) \
     }
 
+/* Initializes the priority queue with a pairing strategy other than the
+   default. Otherwise the same as PQ_INIT. For example:
+
+     struct pqueue my_pq
+         = PQ_INIT_PAIRING(PQLES, my_cmp_fn, NULL, PQ_TWO_PASS); */
+#define PQ_INIT_PAIRING(ORDER, CMP_FN, AUX, PAIRING)                           \
+    {                                                                          \
+        .root = NULL, .sz = 0, .cmp = (CMP_FN), .order = (ORDER),              \
+        .aux = (AUX), .pairing = (PAIRING)                                     \
+    }
+
+/* Initializes a priority queue that bounds the work of each pop. A burst of
+   pushes to a plain pairing heap leaves every element in the child list of
+   the front and the next pop pairs all of them at once. Here a pushed
+   element that does not become the front is instead merged with equally
+   sized pending trees, one comparison per carry just like incrementing a
+   binary counter. A pop then pairs the children of the front with at most
+   one pending tree per power of two, roughly lgN trees rather than N. Push
+   is still amortized O(1) and pop amortized O(lgN). Every other operation
+   first hangs the pending trees under the front in O(lgN) and then proceeds
+   as usual. The pending trees live in a zeroed array of PQ_PENDING_SLOTS
+   element pointers owned by the user for the life of the priority queue.
+   For example:
+
+     struct pq_elem *pending[PQ_PENDING_SLOTS] = {0};
+     struct pqueue my_pq = PQ_INIT_BOUNDED(PQLES, my_cmp_fn, NULL, pending); */
+#define PQ_INIT_BOUNDED(ORDER, CMP_FN, AUX, PENDING)                           \
+    {                                                                          \
+        .root = NULL, .sz = 0, .cmp = (CMP_FN), .order = (ORDER),              \
+        .aux = (AUX), .pending = (PENDING)                                     \
+    }
+
 /* Obtain a reference to the front of the priority queue. This will be a min
    or max depending on the initialization of the priority queue. O(1). */
 struct pq_elem const *pq_front(struct pqueue const *);
 
-/* Adds an element to the priority queue in correct total order. O(1). */
+/* Adds an element to the priority queue in correct total order. O(1).
+   Amortized O(1) and worst case O(lgN) if initialized as bounded. */
 void pq_push(struct pqueue *, struct pq_elem *);
 
 /* Pops the front element from the priority queue. O(lgN). */
 struct pq_elem *pq_pop(struct pqueue *);
 
+/* Pops the front element and pushes the new element in one pairing pass.
+   The new element joins the children of the old front before they are
+   paired so no separate merge is needed. Returns NULL if the priority queue
+   was empty in which case the new element is simply pushed. O(lgN). */
+struct pq_elem *pq_replace_front(struct pqueue *, struct pq_elem *);
+
+/* Pushes the new element and pops the front in one step. If the new element
+   would be the front it is returned right away without entering the priority
+   queue. Otherwise this is a replace front operation. O(1) or O(lgN). */
+struct pq_elem *pq_pushpop(struct pqueue *, struct pq_elem *);
+
 /* Erase the specified element from the priority queue. This need not be
    the front element. O(lgN). */
 struct pq_elem *pq_erase(struct pqueue *, struct pq_elem *);
@@ -127,6 +231,32 @@ bool pq_decrease(struct pqueue *, struct pq_elem *, pq_update_fn *, void *);
 /* Return the order used to initialize the heap. */
 enum pq_threeway_cmp pq_order(struct pqueue const *);
 
+/* Return the pairing strategy used to initialize the heap. */
+enum pq_pairing pq_pairing(struct pqueue const *);
+
+/* Visits every element exactly once in no particular order other than that
+   a parent is visited before its children. The walk follows the child and
+   sibling links in place with the parent pointers to climb back up, so it
+   needs no stack, does not restructure the heap, and performs no
+   comparisons. O(N). */
+void pq_for_each(struct pqueue const *, pq_for_each_fn *, void *);
+
+/* Scans the elements in the same order as pq_for_each and returns the first
+   for which the predicate returns true, or NULL if none does. The scan stops
+   as soon as the predicate is satisfied so a question such as "is any job
+   older than X" costs only as much as it takes to find a witness. O(N) worst
+   case. */
+struct pq_elem *pq_find_if(struct pqueue const *, pq_pred_fn *, void *);
+
+/* A snapshot of the operation counters of the priority queue. The counters
+   only exist when built with CONTAINER_PROFILE defined, see the CMake option
+   of the same name. Otherwise every count is 0 and no operation pays for
+   counting. */
+struct pq_counters pq_profile(struct pqueue const *);
+
+/* Zeroes the operation counters. No effect without CONTAINER_PROFILE. */
+void pq_profile_reset(struct pqueue *);
+
 /* Calls the user provided destructor on each element in the priority queue.
    It is safe to free the struct if it has been heap allocated as elements
    are popped from the priority queue before the function is called. O(NlgN). */
@@ -0,0 +1,135 @@
+/* Author: Alexander G. Lopez
+   --------------------------
+   This is the Radix Heap interface. A radix heap is a min priority queue
+   for unsigned integer keys with one extra promise from the user: keys are
+   monotone. Every key pushed or decreased to must be no smaller than the
+   key of the last element popped. Dijkstra's algorithm with non negative
+   edge costs and many event simulations keep this promise.
+
+   In exchange there is no comparison function. The elements live in one
+   bucket per bit of the key. Bucket 0 holds the keys equal to the last
+   popped key and bucket i holds the keys whose highest bit that differs
+   from the last popped key is bit i - 1. Push and decrease key only find a
+   bucket with a bit scan and splice the element into a list. A pop that
+   finds bucket 0 empty takes the smallest key of the first non empty
+   bucket as the new last key and moves that bucket into lower buckets.
+   An element can only move down so it moves at most once per bit of the
+   key and pops are O(lgC) amortized where C is the largest key.
+
+   Like the other containers no allocation occurs and the user embeds the
+   element in their own struct. The key is stored in the element. */
+#ifndef RADIX_PQUEUE
+#define RADIX_PQUEUE
+
+#include <stdbool.h>
+#include <stddef.h>
+/* NOLINTNEXTLINE */
+#include <stdint.h>
+
+/* One bucket for keys equal to the last popped key and one per bit. */
+#define RDPQ_BUCKETS 65
+
+/* The embedded struct type for operation of the radix heap. The key may be
+   read with rdpq_key but only changed through the interface. Do not access
+   the fields of the struct directly. */
+struct rdpq_elem
+{
+    struct rdpq_elem *next;
+    struct rdpq_elem *prev;
+    uint64_t key;
+};
+
+/* Acts on each element as the radix heap is cleared. The element has
+   already been removed so it is safe to free its wrapping struct. */
+typedef void rdpq_destructor_fn(struct rdpq_elem *);
+
+/* Operation counts for profiling builds that define CONTAINER_PROFILE.
+   Redistributions count the pops that had to empty a bucket into lower
+   buckets and moves count the elements that were moved when they did. */
+struct rdpq_counters
+{
+    size_t redistributions;
+    size_t moves;
+};
+
+/* The radix heap. Each bucket is a circular doubly linked list of the
+   elements in it. Consider the fields private and initialize it with the
+   macro below. */
+struct rdpqueue
+{
+    struct rdpq_elem *buckets[RDPQ_BUCKETS];
+    uint64_t last;
+    size_t sz;
+#ifdef CONTAINER_PROFILE
+    struct rdpq_counters counters;
+#endif
+};
+
+/* Obtains the wrapping struct from the address of the embedded element, the
+   name of the wrapping struct, and the name of the field of the element. */
+#define RDPQ_ENTRY(RDPQ_ELEM, STRUCT, MEMBER)                                  \
+    ((STRUCT *)((uint8_t *)&(RDPQ_ELEM)->next                                  \
+                - offsetof(STRUCT, MEMBER.next))) /* NOLINT */
+
+/* Initializes an empty radix heap on the right hand side of its
+   declaration. The last popped key starts at 0 so any key may be pushed.
+
+     struct rdpqueue q = RDPQ_INIT(); */
+#define RDPQ_INIT()                                                            \
+    {                                                                          \
+        .last = 0, .sz = 0                                                     \
+    }
+
+/* The element with the smallest key. Returns NULL if empty. If the bucket
+   of keys equal to the last key is empty this does the work of the next
+   pop early, moving the first non empty bucket down, so it is not a const
+   operation. O(1) if called again before the next pop. */
+struct rdpq_elem const *rdpq_front(struct rdpqueue *);
+
+/* Adds the element with the given key. Returns false and does not push if
+   the key is smaller than the last popped key. O(1). */
+bool rdpq_push(struct rdpqueue *, struct rdpq_elem *, uint64_t key);
+
+/* Removes the element with the smallest key. Ties are popped in no
+   particular order. Returns NULL if empty. O(lgC) amortized. */
+struct rdpq_elem *rdpq_pop(struct rdpqueue *);
+
+/* Removes the element wherever it is. Returns NULL if the element is not
+   in a radix heap. O(1). */
+struct rdpq_elem *rdpq_erase(struct rdpqueue *, struct rdpq_elem *);
+
+/* Lowers the key of the element. Returns false and changes nothing if the
+   element is not in a radix heap, the new key is greater than the old, or
+   the new key is smaller than the last popped key. O(1). */
+bool rdpq_decrease(struct rdpqueue *, struct rdpq_elem *, uint64_t key);
+
+/* The key stored in the element. */
+uint64_t rdpq_key(struct rdpq_elem const *);
+
+/* The key of the last popped element, the smallest key that may be pushed.
+   Starts at 0. */
+uint64_t rdpq_last(struct rdpqueue const *);
+
+/* Returns true if the radix heap is empty. */
+bool rdpq_empty(struct rdpqueue const *);
+
+/* Returns the number of elements. O(1). */
+size_t rdpq_size(struct rdpqueue const *);
+
+/* A snapshot of the operation counters, all 0 unless built with
+   CONTAINER_PROFILE defined. See pq_profile. */
+struct rdpq_counters rdpq_profile(struct rdpqueue const *);
+
+/* Zeroes the operation counters. No effect without CONTAINER_PROFILE. */
+void rdpq_profile_reset(struct rdpqueue *);
+
+/* Removes every element and calls the destructor on it. The last popped
+   key returns to 0. O(N). */
+void rdpq_clear(struct rdpqueue *, rdpq_destructor_fn *);
+
+/* Checks that every element is in the bucket its key belongs to, that no
+   key is smaller than the last popped key, that the lists are linked both
+   ways, and the size. Intended for tests and debugging. */
+bool rdpq_validate(struct rdpqueue const *);
+
+#endif /* RADIX_PQUEUE */
@@ -0,0 +1,153 @@
+/* Author: Alexander G. Lopez
+   --------------------------
+   This is the Rank Pairing Heap interface. It offers the same operations as
+   the pairing heap priority queue in pqueue.h so one can be swapped for the
+   other. The difference is in the guarantees. The pairing heap decrease key
+   is O(1) in practice but its amortized bound is unresolved in theory and
+   under many decrease keys its pops can grow expensive. A rank pairing heap
+   keeps a rank in every node and only ever links trees of equal rank, which
+   gives the same bounds as a Fibonacci heap: O(1) push and decrease key and
+   O(lgN) amortized pop and erase.
+
+   The heap is a circular list of half trees. A half tree is a binary tree
+   whose root has only a left child and in which every node is no worse
+   than every node in its left subtree. The front of the list is always the
+   front of the priority queue. Like the other containers no allocation
+   occurs and the user embeds the element in their own struct. */
+#ifndef RANK_PQUEUE
+#define RANK_PQUEUE
+
+#include <stdbool.h>
+#include <stddef.h>
+/* NOLINTNEXTLINE */
+#include <stdint.h>
+
+/* Standard C-style three way comparison for rank pairing heap elements. */
+enum rkpq_threeway_cmp
+{
+    RKPQLES = -1,
+    RKPQEQL,
+    RKPQGRT,
+};
+
+/* The embedded struct type for operation of the rank pairing heap. The
+   right field of a half tree root links it to the next root in the list.
+   Do not access the fields of the struct directly. */
+struct rkpq_elem
+{
+    struct rkpq_elem *left;
+    struct rkpq_elem *right;
+    struct rkpq_elem *parent;
+    int rank;
+};
+
+/* Given two valid elements and any auxilliary data, return the three way
+   comparison of the user structs that wrap them. */
+typedef enum rkpq_threeway_cmp rkpq_cmp_fn(struct rkpq_elem const *,
+                                           struct rkpq_elem const *, void *);
+
+/* Acts on each element as the rank pairing heap is cleared. The element has
+   already been removed so it is safe to free its wrapping struct. */
+typedef void rkpq_destructor_fn(struct rkpq_elem *);
+
+/* Writes the new value found in the void * argument into the user struct
+   wrapping the element. See pq_update_fn for the same idea. */
+typedef void rkpq_update_fn(struct rkpq_elem *, void *);
+
+/* Operation counts for profiling builds that define CONTAINER_PROFILE.
+   Links count the joins of two half trees of equal rank and cuts count the
+   subtrees detached by decrease key and erase. */
+struct rkpq_counters
+{
+    size_t cmps;
+    size_t links;
+    size_t cuts;
+};
+
+/* The rank pairing heap. Consider the fields private and initialize it with
+   the macro below. */
+struct rkpqueue
+{
+    struct rkpq_elem *front;
+    size_t sz;
+    rkpq_cmp_fn *cmp;
+    enum rkpq_threeway_cmp order;
+    void *aux;
+#ifdef CONTAINER_PROFILE
+    struct rkpq_counters counters;
+#endif
+};
+
+/* Obtains the wrapping struct from the address of the embedded element, the
+   name of the wrapping struct, and the name of the field of the element. */
+#define RKPQ_ENTRY(RKPQ_ELEM, STRUCT, MEMBER)                                  \
+    ((STRUCT *)((uint8_t *)&(RKPQ_ELEM)->parent                                \
+                - offsetof(STRUCT, MEMBER.parent))) /* NOLINT */
+
+/* Initializes an empty rank pairing heap on the right hand side of its
+   declaration with the desired order, comparison, and auxilliary data.
+   For example:
+
+     struct rkpqueue my_pq = RKPQ_INIT(RKPQLES, my_cmp_fn, NULL); */
+#define RKPQ_INIT(ORDER, CMP_FN, AUX)                                          \
+    {                                                                          \
+        .front = NULL, .sz = 0, .cmp = (CMP_FN), .order = (ORDER),             \
+        .aux = (AUX)                                                           \
+    }
+
+/* The min or max element depending on the order. NULL if empty. O(1). */
+struct rkpq_elem const *rkpq_front(struct rkpqueue const *);
+
+/* Adds the element as a new half tree of rank 0. O(1). */
+void rkpq_push(struct rkpqueue *, struct rkpq_elem *);
+
+/* Removes the front. The half trees hanging off the right spine of the
+   left child of the front join the list and one pass links every pair of
+   roots with equal rank before the new front is found. O(lgN) amortized.
+   Returns NULL if empty. */
+struct rkpq_elem *rkpq_pop(struct rkpqueue *);
+
+/* Removes the element wherever it is. The element is first cut to become a
+   root and then removed like the front. O(lgN) amortized. Returns NULL if
+   the element is not in a rank pairing heap. */
+struct rkpq_elem *rkpq_erase(struct rkpqueue *, struct rkpq_elem *);
+
+/* Returns true if the rank pairing heap is empty. */
+bool rkpq_empty(struct rkpqueue const *);
+
+/* Returns the number of elements. O(1). */
+size_t rkpq_size(struct rkpqueue const *);
+
+/* Updates the value when the direction of the change is not known. This is
+   an erase and a push. O(lgN) amortized. */
+bool rkpq_update(struct rkpqueue *, struct rkpq_elem *, rkpq_update_fn *,
+                 void *);
+
+/* Optimal if the rank pairing heap is a max heap and the new value is known
+   to be greater than the old. Then O(1) amortized, otherwise O(lgN). */
+bool rkpq_increase(struct rkpqueue *, struct rkpq_elem *, rkpq_update_fn *,
+                   void *);
+
+/* Optimal if the rank pairing heap is a min heap and the new value is known
+   to be less than the old. Then O(1) amortized, otherwise O(lgN). */
+bool rkpq_decrease(struct rkpqueue *, struct rkpq_elem *, rkpq_update_fn *,
+                   void *);
+
+/* Returns the order used to initialize the heap. */
+enum rkpq_threeway_cmp rkpq_order(struct rkpqueue const *);
+
+/* A snapshot of the operation counters, all 0 unless built with
+   CONTAINER_PROFILE defined. See pq_profile. */
+struct rkpq_counters rkpq_profile(struct rkpqueue const *);
+
+/* Zeroes the operation counters. No effect without CONTAINER_PROFILE. */
+void rkpq_profile_reset(struct rkpqueue *);
+
+/* Pops every element and calls the destructor on it. O(NlgN). */
+void rkpq_clear(struct rkpqueue *, rkpq_destructor_fn *);
+
+/* Checks the half tree order, the parent links, the rank rule, and the
+   size. Intended for tests and debugging. */
+bool rkpq_validate(struct rkpqueue const *);
+
+#endif /* RANK_PQUEUE */
@@ -236,6 +236,12 @@ typedef set_threeway_cmp set_cmp_fn(struct set_elem const *a,
    updates may be specified by this function. */
 typedef void set_destructor_fn(struct set_elem *);
 
+/* A visitor for the set_for_each family. The aux argument is passed
+   through untouched so it can carry an accumulator for a fold over the
+   set. The visitor may read the element but must not modify its key or
+   the set. */
+typedef void set_for_each_fn(struct set_elem *, void *aux);
+
 /* A container for a simple begin and end pointer to a set_elem.
 
       set_range
@@ -312,6 +318,28 @@ void set_clear(struct set *, set_destructor_fn *destructor);
 
 /* O(1) */
 bool set_empty(struct set *);
+
+/* Rebuilds the set into a perfectly balanced shape in O(N) time and O(1)
+   space with the Day-Stout-Warren algorithm. Useful after the sequential
+   insertion anti-pattern described above which leaves a long spine that
+   the first lookups would otherwise pay for. No elements move in memory
+   and iterators remain valid. */
+void set_rebalance(struct set *);
+
+/* Reports the height, average depth, and node count of the set in O(N)
+   time and O(1) space without modifying the tree. See tree.h for the
+   fields. Cheap enough to sample from monitoring and trigger a rebalance
+   when the height strays far from lgN. */
+struct tree_stats set_stats(struct set const *);
+
+/* A snapshot of the operation counters of the set, all 0 unless the library
+   is built with CONTAINER_PROFILE defined. See depq_profile. */
+struct tree_counters set_profile(struct set const *);
+
+/* Zeroes the operation counters of the set. No effect without
+   CONTAINER_PROFILE. */
+void set_profile_reset(struct set *);
+
 /* O(1) */
 size_t set_size(struct set *);
 
@@ -464,6 +492,36 @@ struct set_elem *set_next(struct set *, struct set_elem *);
    the set or the end if done. */
 struct set_elem *set_rnext(struct set *, struct set_elem *);
 
+/* A cursor for fast read only scans of the whole set. The iterators above
+   are robust to any state of the tree but pay for it on every step. A
+   cursor is set up once by begin or rbegin and then each step is a plain
+   pointer walk that never writes to the tree. The next node is prefetched
+   while the caller works on the current one. For example:
+
+      struct set_cursor c;
+      for (struct set_elem *i = set_cursor_begin(&s, &c); i != set_end(&s);
+           i = set_cursor_next(&c))
+      {
+          ...Read only logic...
+      }
+
+   The set must not be modified while a cursor is in use. Any insertion,
+   erase, or search that splays the tree invalidates the cursor. */
+struct set_cursor
+{
+    struct cursor c ATTRIB_PRIVATE;
+};
+
+/* Starts an ascending scan at the minimum. Returns end if empty. */
+struct set_elem *set_cursor_begin(struct set const *, struct set_cursor *);
+
+/* Starts a descending scan at the maximum. Returns end if empty. */
+struct set_elem *set_cursor_rbegin(struct set const *, struct set_cursor *);
+
+/* Advances the cursor in the direction it was started. Returns end once
+   every element has been visited and continues to return end after. */
+struct set_elem *set_cursor_next(struct set_cursor *);
+
 /* Returns the range with pointers to the first element NOT LESS
    than the requested begin and last element GREATER than the
    provided end element. If either portion of the range cannot
@@ -520,6 +578,25 @@ struct set_elem *set_begin_rrange(struct set_rrange const *);
 
 struct set_elem *set_end_rrange(struct set_rrange const *);
 
+/* Visits every element in ascending order and passes each to the visitor
+   with aux. The walk follows parent links so it needs no stack and never
+   writes to the tree. This is the fastest way to visit the whole set.
+   O(N) time and O(1) space. */
+void set_for_each(struct set const *, set_for_each_fn *, void *aux);
+
+/* Visits every element in descending order. See set_for_each. */
+void set_rfor_each(struct set const *, set_for_each_fn *, void *aux);
+
+/* Visits the elements of a range obtained from set_equal_range in
+   ascending order. Obtaining the range splays but visiting it does not. */
+void set_for_each_range(struct set const *, struct set_range const *,
+                        set_for_each_fn *, void *aux);
+
+/* Visits the elements of a rrange obtained from set_equal_rrange in
+   descending order. */
+void set_for_each_rrange(struct set const *, struct set_rrange const *,
+                         set_for_each_fn *, void *aux);
+
 /* Internal testing. Mostly useless. User at your own risk
    unless you wish to do some traversal of your own liking.
    However, you should of course not modify keys or nodes.
@@ -0,0 +1,97 @@
+/* Author: Alexander G. Lopez
+   --------------------------
+   This is the bounded Top K interface implemented via the same Splay Tree
+   that runs the DEPQ. A Top K container keeps the K largest elements seen
+   from a stream of arbitrary length. The smallest kept element acts as the
+   threshold for the stream. Any new element that does not beat the
+   threshold is rejected with one comparison and the tree is not touched.
+   Otherwise the threshold is unlinked in O(1) with its parent pointer and
+   the new element is inserted with a single splay. The evicted element is
+   handed back so the caller may reuse its memory and no allocation ever
+   occurs. Because the elements are stored in a DEPQ, the kept elements can
+   be exported in sorted order with the usual iterators. */
+#ifndef TOPK
+#define TOPK
+
+#include "depqueue.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/* A Top K container is a DEPQ with a fixed capacity. The current minimum
+   is cached so rejecting an element never walks or splays the tree. */
+struct topk
+{
+    struct depqueue dq;
+    struct depq_elem *min;
+    size_t cap;
+};
+
+/* Initialize the topk on the left hand side with this right hand side
+   initializer. Pass the left hand side topk by name to this macro along
+   with the capacity, comparison function, and any necessary auxilliary
+   data. The elements are struct depq_elem and the comparison is the same
+   depq_cmp_fn used by a DEPQ. This may be used at compile time or runtime.
+   It is undefined to use the topk if this has not been called. */
+#define TOPK_INIT(TOPK_NAME, CAPACITY, CMP, AUX)                               \
+    {                                                                          \
+        .dq = DEPQ_INIT((TOPK_NAME).dq, CMP, AUX), .min = NULL,                \
+        .cap = (CAPACITY)                                                      \
+    }
+
+/* Offers an element from the stream to the Top K. There are three
+   possible outcomes.
+
+      1. The topk is not full. The element is inserted and NULL is returned.
+      2. The topk is full and the element is not greater than the current
+         minimum. The element is rejected and returned to the caller. The
+         tree is not modified. Ties with the minimum are rejected so the
+         elements that arrived first are kept.
+      3. The topk is full and the element is greater than the current
+         minimum. The minimum is evicted and returned to the caller. If
+         multiple elements are tied for the minimum the one that arrived
+         first is evicted according to the round robin duplicate order.
+
+   In all cases the caller owns the returned element again and may reuse
+   it for the next element of the stream. A rejection is O(1) and an
+   eviction is one amortized O(lgN) splay for the insertion. A topk with a
+   capacity of zero rejects everything. */
+struct depq_elem *topk_push(struct topk *, struct depq_elem *);
+
+/* The current threshold of the Top K, the smallest element kept. This is
+   a read only O(1) query. Returns NULL if the topk is empty. */
+struct depq_elem const *topk_min(struct topk const *);
+
+/* O(1) */
+size_t topk_size(struct topk const *);
+
+/* The capacity with which the topk was initialized. O(1) */
+size_t topk_capacity(struct topk const *);
+
+/* Checks if the topk is empty. */
+bool topk_empty(struct topk const *);
+
+/* Checks if the topk holds capacity elements. Every push after this point
+   returns either the rejected element or the evicted element. */
+bool topk_full(struct topk const *);
+
+/* Calls the destructor for each element while emptying the topk. The topk
+   may be reused afterward with the same capacity. */
+void topk_clear(struct topk *, depq_destructor_fn *destructor);
+
+/* Sorted export of the kept elements. The begin and next functions visit
+   the elements in descending order, largest first, while rbegin and rnext
+   visit the elements in ascending order starting at the threshold. These
+   are the DEPQ iterators and carry the same promises. Do not push to the
+   topk while iterating. */
+struct depq_elem *topk_begin(struct topk *);
+struct depq_elem *topk_rbegin(struct topk *);
+struct depq_elem *topk_next(struct topk *, struct depq_elem *);
+struct depq_elem *topk_rnext(struct topk *, struct depq_elem *);
+struct depq_elem *topk_end(struct topk *);
+
+/* Returns true if the underlying tree is valid and the cached threshold
+   is the minimum of the topk. Useful for debugging and tests. */
+bool topk_validate(struct topk *);
+
+#endif /* TOPK */
@@ -18,6 +18,23 @@
 #    define ATTRIB_PRIVATE /**/
 #endif                     /* __GNUC__ || __clang__ || __INTEL_LLVM_COMPILER */
 
+/* Profiling builds define CONTAINER_PROFILE to count the internal operations
+   of the containers. Otherwise the counters do not exist and this expands to
+   nothing so there is no overhead. */
+#ifdef CONTAINER_PROFILE
+#    define PROFILE_INC(COUNTER) (++(COUNTER))
+#else
+#    define PROFILE_INC(COUNTER) ((void)0)
+#endif
+
+/* A read prefetch hint for pointer walks. It is only a hint so compilers
+   without the builtin simply do nothing. */
+#if defined(__GNUC__) || defined(__clang__)
+#    define PREFETCH(ADDR) __builtin_prefetch((ADDR), 0, 3)
+#else
+#    define PREFETCH(ADDR) ((void)(ADDR))
+#endif
+
 #define UNIMPLEMENTED()                                                        \
     do                                                                         \
     {                                                                          \
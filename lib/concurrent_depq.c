@@ -0,0 +1,353 @@
+#include "concurrent_depq.h"
+#include "depqueue.h"
+#include "random.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+
+/* The number of random pairs a relaxed pop tries without blocking before
+   it waits on the locks of the last pair. */
+static int const trylock_rounds = 4;
+
+static struct depq_elem *pop_relaxed(struct concurrent_depq *, bool);
+static struct depq_elem *pop_exact(struct concurrent_depq *, bool);
+static struct depq_elem *sweep(struct concurrent_depq *, bool);
+static struct cdepq_shard *better_shard(struct concurrent_depq *,
+                                        struct cdepq_shard *,
+                                        struct cdepq_shard *, bool);
+static struct depq_elem *pop_front(struct cdepq_shard *, bool);
+static bool lock_pair(struct concurrent_depq *, size_t, size_t, bool);
+static void lock_shard(struct concurrent_depq *, struct cdepq_shard *);
+static size_t shard_size(struct cdepq_shard const *);
+static size_t rand_shard(struct concurrent_depq const *);
+
+bool
+cdepq_init(struct concurrent_depq *const q, size_t const num_shards,
+           enum cdepq_mode const mode, depq_cmp_fn *const cmp, void *const aux)
+{
+    *q = (struct concurrent_depq){
+        .num_shards = num_shards,
+        .mode = mode,
+        .cmp = cmp,
+        .aux = aux,
+    };
+    if (!num_shards)
+    {
+        return false;
+    }
+    q->shards
+        = aligned_alloc(CDEPQ_CACHE_LINE, num_shards * sizeof(*q->shards));
+    if (!q->shards)
+    {
+        return false;
+    }
+    for (size_t i = 0; i < num_shards; ++i)
+    {
+        struct cdepq_shard *const s = &q->shards[i];
+        if (pthread_mutex_init(&s->lock, NULL))
+        {
+            while (i--)
+            {
+                (void)pthread_mutex_destroy(&q->shards[i].lock);
+            }
+            free(q->shards);
+            q->shards = NULL;
+            return false;
+        }
+        s->depq = (struct depqueue)DEPQ_INIT(s->depq, cmp, aux);
+        atomic_init(&s->size, 0);
+    }
+#ifdef CONTAINER_PROFILE
+    atomic_init(&q->contended, 0);
+    atomic_init(&q->sweeps, 0);
+#endif
+    return true;
+}
+
+void
+cdepq_push(struct concurrent_depq *const q, struct depq_elem *const e)
+{
+    struct cdepq_shard *const s = &q->shards[rand_shard(q)];
+    lock_shard(q, s);
+    depq_push(&s->depq, e);
+    atomic_store_explicit(&s->size, shard_size(s) + 1, memory_order_relaxed);
+    (void)pthread_mutex_unlock(&s->lock);
+}
+
+struct depq_elem *
+cdepq_pop_max(struct concurrent_depq *const q)
+{
+    return q->mode == CDEPQ_EXACT ? pop_exact(q, true) : pop_relaxed(q, true);
+}
+
+struct depq_elem *
+cdepq_pop_min(struct concurrent_depq *const q)
+{
+    return q->mode == CDEPQ_EXACT ? pop_exact(q, false)
+                                  : pop_relaxed(q, false);
+}
+
+size_t
+cdepq_size(struct concurrent_depq const *const q)
+{
+    size_t sz = 0;
+    for (size_t i = 0; i < q->num_shards; ++i)
+    {
+        sz += shard_size(&q->shards[i]);
+    }
+    return sz;
+}
+
+bool
+cdepq_empty(struct concurrent_depq const *const q)
+{
+    return !cdepq_size(q);
+}
+
+size_t
+cdepq_num_shards(struct concurrent_depq const *const q)
+{
+    return q->num_shards;
+}
+
+void
+cdepq_clear(struct concurrent_depq *const q,
+            depq_destructor_fn *const destructor)
+{
+    for (size_t i = 0; i < q->num_shards; ++i)
+    {
+        if (destructor)
+        {
+            depq_clear(&q->shards[i].depq, destructor);
+        }
+        (void)pthread_mutex_destroy(&q->shards[i].lock);
+    }
+    free(q->shards);
+    *q = (struct concurrent_depq){0};
+}
+
+bool
+cdepq_validate(struct concurrent_depq *const q)
+{
+    for (size_t i = 0; i < q->num_shards; ++i)
+    {
+        struct cdepq_shard *const s = &q->shards[i];
+        if (!validate_tree(&s->depq.t)
+            || depq_size(&s->depq) != shard_size(s))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+struct cdepq_counters
+cdepq_profile(struct concurrent_depq const *const q)
+{
+#ifdef CONTAINER_PROFILE
+    return (struct cdepq_counters){
+        .contended = atomic_load(&q->contended),
+        .sweeps = atomic_load(&q->sweeps),
+    };
+#else
+    (void)q;
+    return (struct cdepq_counters){0};
+#endif
+}
+
+void
+cdepq_profile_reset(struct concurrent_depq *const q)
+{
+#ifdef CONTAINER_PROFILE
+    atomic_store(&q->contended, 0);
+    atomic_store(&q->sweeps, 0);
+#else
+    (void)q;
+#endif
+}
+
+/*===============================  Static Helpers  =========================*/
+
+/* Samples two distinct shards and pops the better front of the two. Empty
+   shards are skipped by their sizes without taking their locks. Busy pairs
+   are passed over for a few rounds before waiting on one. */
+static struct depq_elem *
+pop_relaxed(struct concurrent_depq *const q, bool const max)
+{
+    if (q->num_shards == 1)
+    {
+        return sweep(q, max);
+    }
+    for (int round = 0;; ++round)
+    {
+        size_t const i = rand_shard(q);
+        size_t j = rand_shard(q);
+        if (j == i)
+        {
+            j = (j + 1) % q->num_shards;
+        }
+        if (!shard_size(&q->shards[i]) && !shard_size(&q->shards[j]))
+        {
+            PROFILE_INC(q->sweeps);
+            return sweep(q, max);
+        }
+        if (!lock_pair(q, i, j, round >= trylock_rounds))
+        {
+            continue;
+        }
+        struct depq_elem *const e = pop_front(
+            better_shard(q, &q->shards[i], &q->shards[j], max), max);
+        (void)pthread_mutex_unlock(&q->shards[i].lock);
+        (void)pthread_mutex_unlock(&q->shards[j].lock);
+        if (e)
+        {
+            return e;
+        }
+    }
+}
+
+/* Holding every lock makes the pop linearizable. Locks are always taken in
+   shard order so pops cannot deadlock with each other or with pushes. */
+static struct depq_elem *
+pop_exact(struct concurrent_depq *const q, bool const max)
+{
+    for (size_t i = 0; i < q->num_shards; ++i)
+    {
+        lock_shard(q, &q->shards[i]);
+    }
+    struct cdepq_shard *best = &q->shards[0];
+    for (size_t i = 1; i < q->num_shards; ++i)
+    {
+        best = better_shard(q, best, &q->shards[i], max);
+    }
+    struct depq_elem *const e = pop_front(best, max);
+    for (size_t i = q->num_shards; i--;)
+    {
+        (void)pthread_mutex_unlock(&q->shards[i].lock);
+    }
+    return e;
+}
+
+/* Visits every shard once from a random start and pops the front of the
+   first that is not empty. */
+static struct depq_elem *
+sweep(struct concurrent_depq *const q, bool const max)
+{
+    size_t const start = rand_shard(q);
+    for (size_t k = 0; k < q->num_shards; ++k)
+    {
+        struct cdepq_shard *const s
+            = &q->shards[(start + k) % q->num_shards];
+        if (!shard_size(s))
+        {
+            continue;
+        }
+        lock_shard(q, s);
+        struct depq_elem *const e = pop_front(s, max);
+        (void)pthread_mutex_unlock(&s->lock);
+        if (e)
+        {
+            return e;
+        }
+    }
+    return NULL;
+}
+
+/* Both shards must be locked. Peeking walks the spine of each tree without
+   splaying so only the shard that is popped is reshaped. An empty shard
+   loses and ties go to a. */
+static struct cdepq_shard *
+better_shard(struct concurrent_depq *const q, struct cdepq_shard *const a,
+             struct cdepq_shard *const b, bool const max)
+{
+    if (depq_empty(&a->depq))
+    {
+        return b;
+    }
+    if (depq_empty(&b->depq))
+    {
+        return a;
+    }
+    struct depq_elem const *const x
+        = max ? depq_const_max(&a->depq) : depq_const_min(&a->depq);
+    struct depq_elem const *const y
+        = max ? depq_const_max(&b->depq) : depq_const_min(&b->depq);
+    dpq_threeway_cmp const c = q->cmp(x, y, q->aux);
+    return c == (max ? DPQLES : DPQGRT) ? b : a;
+}
+
+static struct depq_elem *
+pop_front(struct cdepq_shard *const s, bool const max)
+{
+    if (depq_empty(&s->depq))
+    {
+        return NULL;
+    }
+    struct depq_elem *const e
+        = max ? depq_pop_max(&s->depq) : depq_pop_min(&s->depq);
+    atomic_store_explicit(&s->size, shard_size(s) - 1, memory_order_relaxed);
+    return e;
+}
+
+/* Locks shards i and j in index order. Without wait it gives up and
+   returns false if either is busy. */
+static bool
+lock_pair(struct concurrent_depq *const q, size_t i, size_t j,
+          bool const wait)
+{
+    if (j < i)
+    {
+        size_t const swap = i;
+        i = j;
+        j = swap;
+    }
+    struct cdepq_shard *const first = &q->shards[i];
+    struct cdepq_shard *const second = &q->shards[j];
+    if (wait)
+    {
+        lock_shard(q, first);
+        lock_shard(q, second);
+        return true;
+    }
+    if (pthread_mutex_trylock(&first->lock))
+    {
+        PROFILE_INC(q->contended);
+        return false;
+    }
+    if (pthread_mutex_trylock(&second->lock))
+    {
+        PROFILE_INC(q->contended);
+        (void)pthread_mutex_unlock(&first->lock);
+        return false;
+    }
+    return true;
+}
+
+static void
+lock_shard(struct concurrent_depq *const q, struct cdepq_shard *const s)
+{
+    (void)q;
+    if (pthread_mutex_trylock(&s->lock))
+    {
+        PROFILE_INC(q->contended);
+        (void)pthread_mutex_lock(&s->lock);
+    }
+}
+
+static inline size_t
+shard_size(struct cdepq_shard const *const s)
+{
+    return atomic_load_explicit(&s->size, memory_order_relaxed);
+}
+
+static inline size_t
+rand_shard(struct concurrent_depq const *const q)
+{
+    return (size_t)(rand_thread_u64() % q->num_shards);
+}
@@ -0,0 +1,89 @@
+/* A double ended priority queue for many threads made of shards, each a
+   splay tree depqueue behind its own mutex. A splay tree reshapes itself on
+   every access so even a peek needs the lock of its shard, and one lock
+   around one depqueue serializes every thread. Here a push locks one shard
+   chosen at random.
+
+   Pops come in two modes. Relaxed pops sample two shards, lock both, and
+   pop the better of their fronts. A relaxed pop may return an element that
+   is not the max or min of the whole queue but it is usually near it and
+   touches only two locks. Exact pops lock every shard in order and pop the
+   true max or min, which is linearizable but serializes pops again and
+   costs a lock and a peek per shard.
+
+   The elements are the depq_elem of depqueue.h and are compared with a
+   depq_cmp_fn. Erase, update, and iteration are not offered because an
+   element does not know its shard. */
+#ifndef CONCURRENT_DEPQ
+#define CONCURRENT_DEPQ
+
+#include "attrib.h"
+#include "depqueue.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Shards are aligned to this so two shards never share a cache line. */
+#define CDEPQ_CACHE_LINE 64
+
+enum cdepq_mode
+{
+    CDEPQ_RELAXED = 0,
+    CDEPQ_EXACT,
+};
+
+struct cdepq_counters
+{
+    /* Shards that were busy when a pop or push first tried them. */
+    size_t contended;
+    /* Relaxed pops that found both sampled shards empty and swept the
+       others instead. */
+    size_t sweeps;
+};
+
+struct cdepq_shard
+{
+    _Alignas(CDEPQ_CACHE_LINE) pthread_mutex_t lock ATTRIB_PRIVATE;
+    struct depqueue depq ATTRIB_PRIVATE;
+    /* Written under the lock and read without it to skip empty shards. */
+    atomic_size_t size ATTRIB_PRIVATE;
+};
+
+struct concurrent_depq
+{
+    struct cdepq_shard *shards ATTRIB_PRIVATE;
+    size_t num_shards ATTRIB_PRIVATE;
+    enum cdepq_mode mode ATTRIB_PRIVATE;
+    depq_cmp_fn *cmp ATTRIB_PRIVATE;
+    void *aux ATTRIB_PRIVATE;
+#ifdef CONTAINER_PROFILE
+    atomic_size_t contended ATTRIB_PRIVATE;
+    atomic_size_t sweeps ATTRIB_PRIVATE;
+#endif
+};
+
+/* Initialization and clearing are not thread safe. Every other function
+   may be called from any number of threads at once. A few shards per
+   thread keep two relaxed pops from often sampling the same shard. Returns
+   false if num_shards is 0 or memory could not be allocated. */
+bool cdepq_init(struct concurrent_depq *, size_t num_shards, enum cdepq_mode,
+                depq_cmp_fn *, void *);
+void cdepq_push(struct concurrent_depq *, struct depq_elem *);
+/* NULL only if every shard was empty when it was looked at. */
+struct depq_elem *cdepq_pop_max(struct concurrent_depq *);
+struct depq_elem *cdepq_pop_min(struct concurrent_depq *);
+/* Exact when no other thread is pushing or popping. */
+size_t cdepq_size(struct concurrent_depq const *);
+bool cdepq_empty(struct concurrent_depq const *);
+size_t cdepq_num_shards(struct concurrent_depq const *);
+/* Calls the destructor, if not NULL, on every element and frees the
+   shards. */
+void cdepq_clear(struct concurrent_depq *, depq_destructor_fn *);
+/* Not thread safe. Validates every shard and its recorded size. */
+bool cdepq_validate(struct concurrent_depq *);
+struct cdepq_counters cdepq_profile(struct concurrent_depq const *);
+void cdepq_profile_reset(struct concurrent_depq *);
+
+#endif
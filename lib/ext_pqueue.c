@@ -0,0 +1,571 @@
+/* mkstemp, fdopen, and unlink for spill files in a chosen directory. */
+#define _POSIX_C_SOURCE 200809L
+
+#include "ext_pqueue.h"
+#include "heap_pqueue.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+
+/* A slot in the arena is an hpq_elem followed by the record bytes. */
+static size_t const record_offset = sizeof(struct hpq_elem);
+
+static enum heap_pq_threeway_cmp mem_cmp(struct hpq_elem const *,
+                                         struct hpq_elem const *, void *);
+static enum heap_pq_threeway_cmp run_cmp(struct hpq_elem const *,
+                                         struct hpq_elem const *, void *);
+static void no_destroy(struct hpq_elem *);
+static void const *slot_record(struct hpq_elem const *);
+static void const *run_record(struct ext_pqueue const *,
+                              struct hpq_elem const *);
+static bool spill(struct ext_pqueue *);
+static bool merge_all_runs(struct ext_pqueue *);
+static bool start_run(struct ext_pqueue *, struct epq_run *, FILE *, size_t);
+static void rewind_runs(struct ext_pqueue *);
+static void advance_front_run(struct ext_pqueue *);
+static bool fill_buffer(struct ext_pqueue *, struct epq_run *);
+static void close_run(struct ext_pqueue *, struct epq_run *);
+static FILE *open_spill_file(struct ext_pqueue const *);
+
+bool
+epq_init(struct ext_pqueue *const epq, struct epq_config const *const config,
+         enum ext_pq_threeway_cmp const order, epq_cmp_fn *const cmp,
+         void *const aux)
+{
+    if (!config->record_size || config->block_size < config->record_size)
+    {
+        return false;
+    }
+    size_t const half = config->memory_budget / 2;
+    size_t const slot_size
+        = ((record_offset + config->record_size + sizeof(size_t) - 1)
+           / sizeof(size_t))
+          * sizeof(size_t);
+    /* Each slot also costs a free list entry and a heap pointer. */
+    size_t const num_slots
+        = half / (slot_size + sizeof(size_t) + sizeof(struct hpq_elem *));
+    size_t const max_runs = half / config->block_size;
+    if (!num_slots || max_runs < 2)
+    {
+        return false;
+    }
+    *epq = (struct ext_pqueue){
+        .num_slots = num_slots,
+        .slot_size = slot_size,
+        .max_runs = max_runs,
+        .config = *config,
+        .cmp = cmp,
+        .order = order,
+        .aux = aux,
+    };
+    epq->arena = malloc(num_slots * slot_size);
+    epq->free_slots = malloc(num_slots * sizeof(size_t));
+    epq->runs = calloc(max_runs, sizeof(struct epq_run));
+    unsigned char *const bufs = malloc(max_runs * config->block_size);
+    if (!epq->arena || !epq->free_slots || !epq->runs || !bufs)
+    {
+        free(epq->arena);
+        free(epq->free_slots);
+        free(epq->runs);
+        free(bufs);
+        return false;
+    }
+    for (size_t i = 0; i < max_runs; ++i)
+    {
+        epq->runs[i].buf = bufs + (i * config->block_size);
+    }
+    /* Hand out low slots first so a small queue touches little memory. */
+    for (size_t i = 0; i < num_slots; ++i)
+    {
+        epq->free_slots[i] = num_slots - 1 - i;
+    }
+    epq->num_free = num_slots;
+    enum heap_pq_threeway_cmp const hpq_order
+        = order == EPQLES ? HPQLES : HPQGRT;
+    hpq_init(&epq->mem, hpq_order, mem_cmp, epq);
+    hpq_init(&epq->merge, hpq_order, run_cmp, epq);
+    return true;
+}
+
+bool
+epq_push(struct ext_pqueue *const epq, void const *const record)
+{
+    if (!epq->num_free && !spill(epq))
+    {
+        return false;
+    }
+    unsigned char *const slot
+        = epq->arena + (epq->free_slots[--epq->num_free] * epq->slot_size);
+    memcpy(slot + record_offset, record, epq->config.record_size);
+    hpq_push(&epq->mem, (struct hpq_elem *)slot);
+    ++epq->sz;
+    return true;
+}
+
+void const *
+epq_front(struct ext_pqueue const *const epq)
+{
+    struct hpq_elem const *const m = hpq_front(&epq->mem);
+    struct hpq_elem const *const r = hpq_front(&epq->merge);
+    if (!r)
+    {
+        return m ? slot_record(m) : NULL;
+    }
+    if (!m)
+    {
+        return run_record(epq, r);
+    }
+    void const *const mem_front = slot_record(m);
+    void const *const run_front = run_record(epq, r);
+    return epq->cmp(run_front, mem_front, epq->aux) == epq->order
+               ? run_front
+               : mem_front;
+}
+
+bool
+epq_pop(struct ext_pqueue *const epq, void *const out)
+{
+    void const *const front = epq_front(epq);
+    if (!front)
+    {
+        return false;
+    }
+    if (out)
+    {
+        memcpy(out, front, epq->config.record_size);
+    }
+    struct hpq_elem const *const m = hpq_front(&epq->mem);
+    if (m && front == slot_record(m))
+    {
+        unsigned char const *const slot
+            = (unsigned char const *)hpq_pop(&epq->mem);
+        epq->free_slots[epq->num_free++]
+            = (size_t)(slot - epq->arena) / epq->slot_size;
+    }
+    else
+    {
+        advance_front_run(epq);
+    }
+    --epq->sz;
+    return true;
+}
+
+bool
+epq_empty(struct ext_pqueue const *const epq)
+{
+    return !epq->sz;
+}
+
+size_t
+epq_size(struct ext_pqueue const *const epq)
+{
+    return epq->sz;
+}
+
+size_t
+epq_num_runs(struct ext_pqueue const *const epq)
+{
+    return epq->num_runs;
+}
+
+size_t
+epq_lost(struct ext_pqueue const *const epq)
+{
+    return epq->lost;
+}
+
+void
+epq_free(struct ext_pqueue *const epq)
+{
+    for (size_t i = 0; i < epq->max_runs; ++i)
+    {
+        if (epq->runs[i].file)
+        {
+            (void)fclose(epq->runs[i].file);
+        }
+    }
+    hpq_clear(&epq->mem, no_destroy);
+    hpq_clear(&epq->merge, no_destroy);
+    if (epq->runs)
+    {
+        free(epq->runs[0].buf);
+    }
+    free(epq->runs);
+    free(epq->free_slots);
+    free(epq->arena);
+    *epq = (struct ext_pqueue){0};
+}
+
+/* Both heaps must be valid, every slot either free or in the memory heap,
+   every buffered block sorted, and the runs and size accounted for. */
+bool
+epq_validate(struct ext_pqueue const *const epq)
+{
+    if (!hpq_validate(&epq->mem) || !hpq_validate(&epq->merge)
+        || epq->num_free + hpq_size(&epq->mem) != epq->num_slots
+        || hpq_size(&epq->merge) != epq->num_runs)
+    {
+        return false;
+    }
+    size_t const rs = epq->config.record_size;
+    size_t sz = hpq_size(&epq->mem);
+    size_t active = 0;
+    for (size_t i = 0; i < epq->max_runs; ++i)
+    {
+        struct epq_run const *const run = &epq->runs[i];
+        if (!run->file)
+        {
+            continue;
+        }
+        ++active;
+        if (run->buf_pos >= run->buf_len)
+        {
+            return false;
+        }
+        for (size_t r = run->buf_pos + 1; r < run->buf_len; ++r)
+        {
+            if (epq->cmp(run->buf + (r * rs), run->buf + ((r - 1) * rs),
+                         epq->aux)
+                == epq->order)
+            {
+                return false;
+            }
+        }
+        sz += (run->buf_len - run->buf_pos) + run->on_disk;
+    }
+    return active == epq->num_runs && sz == epq->sz;
+}
+
+struct epq_counters
+epq_profile(struct ext_pqueue const *const epq)
+{
+#ifdef CONTAINER_PROFILE
+    return epq->counters;
+#else
+    (void)epq;
+    return (struct epq_counters){0};
+#endif
+}
+
+void
+epq_profile_reset(struct ext_pqueue *const epq)
+{
+#ifdef CONTAINER_PROFILE
+    epq->counters = (struct epq_counters){0};
+#else
+    (void)epq;
+#endif
+}
+
+/*===============================  Static Helpers  =========================*/
+
+static enum heap_pq_threeway_cmp
+mem_cmp(struct hpq_elem const *const a, struct hpq_elem const *const b,
+        void *const aux)
+{
+    struct ext_pqueue const *const epq = aux;
+    return (enum heap_pq_threeway_cmp)epq->cmp(slot_record(a), slot_record(b),
+                                               epq->aux);
+}
+
+static enum heap_pq_threeway_cmp
+run_cmp(struct hpq_elem const *const a, struct hpq_elem const *const b,
+        void *const aux)
+{
+    struct ext_pqueue const *const epq = aux;
+    return (enum heap_pq_threeway_cmp)epq->cmp(
+        run_record(epq, a), run_record(epq, b), epq->aux);
+}
+
+static void
+no_destroy(struct hpq_elem *const e)
+{
+    (void)e;
+}
+
+static inline void const *
+slot_record(struct hpq_elem const *const slot)
+{
+    return (unsigned char const *)slot + record_offset;
+}
+
+static inline void const *
+run_record(struct ext_pqueue const *const epq, struct hpq_elem const *const e)
+{
+    struct epq_run const *const run = HPQ_ENTRY(e, struct epq_run, elem);
+    return run->buf + (run->buf_pos * epq->config.record_size);
+}
+
+/* Writes every record in memory to a new run in order. Runs are merged
+   first if every read buffer is taken. If a write fails the records go
+   back into memory and the queue is unchanged. */
+static bool
+spill(struct ext_pqueue *const epq)
+{
+    if (epq->num_runs == epq->max_runs && !merge_all_runs(epq))
+    {
+        return false;
+    }
+    FILE *const f = open_spill_file(epq);
+    if (!f)
+    {
+        return false;
+    }
+    struct epq_run *run = epq->runs;
+    while (run->file)
+    {
+        ++run;
+    }
+    (void)setvbuf(f, NULL, _IOFBF, epq->config.block_size);
+    size_t const rs = epq->config.record_size;
+    size_t const first_freed = epq->num_free;
+    size_t written = 0;
+    bool ok = true;
+    while (!hpq_empty(&epq->mem))
+    {
+        unsigned char const *const slot
+            = (unsigned char const *)hpq_front(&epq->mem);
+        if (fwrite(slot + record_offset, rs, 1, f) != 1)
+        {
+            ok = false;
+            break;
+        }
+        (void)hpq_pop(&epq->mem);
+        epq->free_slots[epq->num_free++]
+            = (size_t)(slot - epq->arena) / epq->slot_size;
+        ++written;
+    }
+    if (!ok || fflush(f) || !start_run(epq, run, f, written))
+    {
+        (void)fclose(f);
+        while (epq->num_free > first_freed)
+        {
+            hpq_push(&epq->mem,
+                     (struct hpq_elem *)(epq->arena
+                                         + (epq->free_slots[--epq->num_free]
+                                            * epq->slot_size)));
+        }
+        return false;
+    }
+    PROFILE_INC(epq->counters.spills);
+#ifdef CONTAINER_PROFILE
+    epq->counters.bytes_written += written * rs;
+#endif
+    return true;
+}
+
+/* Streams every run through the merge heap into one new run. The source
+   runs stay open until the merged run holds its first block, so if a write
+   or read fails they are wound back and the queue is unchanged. */
+static bool
+merge_all_runs(struct ext_pqueue *const epq)
+{
+    FILE *const out = open_spill_file(epq);
+    if (!out)
+    {
+        return false;
+    }
+    (void)setvbuf(out, NULL, _IOFBF, epq->config.block_size);
+    size_t const rs = epq->config.record_size;
+    for (size_t i = 0; i < epq->max_runs; ++i)
+    {
+        struct epq_run *const run = &epq->runs[i];
+        run->at_merge = run->on_disk + (run->buf_len - run->buf_pos);
+    }
+    size_t written = 0;
+    bool ok = true;
+    while (ok && !hpq_empty(&epq->merge))
+    {
+        struct epq_run *const run
+            = HPQ_ENTRY(hpq_front(&epq->merge), struct epq_run, elem);
+        if (fwrite(run_record(epq, &run->elem), rs, 1, out) != 1)
+        {
+            ok = false;
+            break;
+        }
+        ++written;
+        /* An exhausted source leaves the heap but keeps its file. */
+        if (++run->buf_pos == run->buf_len && !run->on_disk)
+        {
+            (void)hpq_pop(&epq->merge);
+        }
+        else if (run->buf_pos < run->buf_len || fill_buffer(epq, run))
+        {
+            (void)hpq_replace_front(&epq->merge, &run->elem);
+        }
+        else
+        {
+            ok = false;
+        }
+    }
+    /* After a full merge every source is exhausted, so the first one lends
+       its slot to the merged run and the sources close once it starts. */
+    struct epq_run *first = epq->runs;
+    while (!first->file)
+    {
+        ++first;
+    }
+    FILE *const src = first->file;
+    first->file = NULL;
+    if (!ok || fflush(out) || !start_run(epq, first, out, written))
+    {
+        first->file = src;
+        (void)fclose(out);
+        rewind_runs(epq);
+        return false;
+    }
+    (void)fclose(src);
+    --epq->num_runs;
+    for (size_t i = 0; i < epq->max_runs; ++i)
+    {
+        if (epq->runs[i].file && &epq->runs[i] != first)
+        {
+            close_run(epq, &epq->runs[i]);
+        }
+    }
+    PROFILE_INC(epq->counters.run_merges);
+#ifdef CONTAINER_PROFILE
+    epq->counters.bytes_written += written * rs;
+#endif
+    return true;
+}
+
+/* Rewinds a written run file into the given free slot, buffers its first
+   block, and adds it to the merge heap. The run takes ownership of the
+   file on success. */
+static bool
+start_run(struct ext_pqueue *const epq, struct epq_run *const run,
+          FILE *const f, size_t const records)
+{
+    rewind(f);
+    run->file = f;
+    run->on_disk = records;
+    if (!fill_buffer(epq, run))
+    {
+        run->file = NULL;
+        return false;
+    }
+    hpq_push(&epq->merge, &run->elem);
+    ++epq->num_runs;
+    return true;
+}
+
+/* Winds every run back to the records it held when the failed merge began
+   and rebuilds the merge heap. Those records are the tail of each run file.
+   A run that cannot be read again is closed and its records are lost. */
+static void
+rewind_runs(struct ext_pqueue *const epq)
+{
+    while (!hpq_empty(&epq->merge))
+    {
+        (void)hpq_pop(&epq->merge);
+    }
+    size_t const rs = epq->config.record_size;
+    for (size_t i = 0; i < epq->max_runs; ++i)
+    {
+        struct epq_run *const run = &epq->runs[i];
+        if (!run->file)
+        {
+            continue;
+        }
+        run->buf_len = run->buf_pos = 0;
+        run->on_disk = run->at_merge;
+        if (fseek(run->file, -(long)(run->on_disk * rs), SEEK_END)
+            || !fill_buffer(epq, run))
+        {
+            close_run(epq, run);
+            continue;
+        }
+        hpq_push(&epq->merge, &run->elem);
+    }
+}
+
+/* Moves the front run past its front record and sifts it down by its new
+   front record. A run leaves the merge heap when it is exhausted or when
+   its next block cannot be read, in which case its records are lost. */
+static void
+advance_front_run(struct ext_pqueue *const epq)
+{
+    struct epq_run *const run
+        = HPQ_ENTRY(hpq_front(&epq->merge), struct epq_run, elem);
+    if (++run->buf_pos == run->buf_len
+        && (!run->on_disk || !fill_buffer(epq, run)))
+    {
+        (void)hpq_pop(&epq->merge);
+        close_run(epq, run);
+        return;
+    }
+    (void)hpq_replace_front(&epq->merge, &run->elem);
+}
+
+static bool
+fill_buffer(struct ext_pqueue *const epq, struct epq_run *const run)
+{
+    size_t const rs = epq->config.record_size;
+    size_t const per_block = epq->config.block_size / rs;
+    size_t const n = run->on_disk < per_block ? run->on_disk : per_block;
+    if (fread(run->buf, rs, n, run->file) != n)
+    {
+        return false;
+    }
+    run->on_disk -= n;
+    run->buf_len = n;
+    run->buf_pos = 0;
+#ifdef CONTAINER_PROFILE
+    epq->counters.bytes_read += n * rs;
+#endif
+    return true;
+}
+
+/* Any records the run still holds leave the queue as lost. */
+static void
+close_run(struct ext_pqueue *const epq, struct epq_run *const run)
+{
+    size_t const left = run->on_disk + (run->buf_len - run->buf_pos);
+    epq->lost += left;
+    epq->sz -= left;
+    (void)fclose(run->file);
+    run->file = NULL;
+    run->buf_len = run->buf_pos = run->on_disk = 0;
+    --epq->num_runs;
+}
+
+/* The file is unlinked right away so it disappears when closed, even if
+   the program exits without freeing the queue. */
+static FILE *
+open_spill_file(struct ext_pqueue const *const epq)
+{
+    if (!epq->config.dir)
+    {
+        return tmpfile();
+    }
+    static char const name[] = "/epq_XXXXXX";
+    size_t const dir_len = strlen(epq->config.dir);
+    char *const path = malloc(dir_len + sizeof(name));
+    if (!path)
+    {
+        return NULL;
+    }
+    memcpy(path, epq->config.dir, dir_len);
+    memcpy(path + dir_len, name, sizeof(name));
+    int const fd = mkstemp(path);
+    if (fd < 0)
+    {
+        free(path);
+        return NULL;
+    }
+    (void)unlink(path);
+    free(path);
+    FILE *const f = fdopen(fd, "w+b");
+    if (!f)
+    {
+        (void)close(fd);
+    }
+    return f;
+}
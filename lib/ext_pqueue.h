@@ -0,0 +1,117 @@
+/* An external memory priority queue for more elements than fit in memory.
+   Elements are fixed size records copied in and out by value because a
+   spilled element cannot hold pointers. Records are kept in a heap_pqueue
+   over a fixed arena until the arena is full. Then the whole heap is
+   written in order as a sorted run to a temporary file with sequential
+   buffered writes. Pops take the better of the in memory front and the
+   front of a second heap_pqueue that merges the runs, each read back one
+   block at a time. When there are as many runs as there are read buffers
+   the runs are merged into one on disk so memory never exceeds the budget
+   given at initialization, apart from the heap pointer arrays. The queue
+   refers to itself once initialized so it must not be moved. */
+#ifndef EXT_PQUEUE
+#define EXT_PQUEUE
+
+#include "attrib.h"
+#include "heap_pqueue.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+enum ext_pq_threeway_cmp
+{
+    EPQLES = -1,
+    EPQEQL,
+    EPQGRT,
+};
+
+/* Compares two records. The pointers are to record_size bytes that may
+   not be suitably aligned for the record type so copy them out or use
+   memcpy when the type needs alignment. */
+typedef enum ext_pq_threeway_cmp epq_cmp_fn(void const *, void const *,
+                                            void *);
+
+/* The memory budget is split in half. One half holds records in memory and
+   the other half is the read buffers of the runs, one block each. A block
+   must hold at least one record and the budget must allow at least two
+   read buffers. The spill files are created in dir, or with tmpfile() if
+   dir is NULL, and are unlinked as soon as they are open. */
+struct epq_config
+{
+    size_t record_size;
+    size_t memory_budget;
+    size_t block_size;
+    char const *dir;
+};
+
+struct epq_counters
+{
+    size_t spills;
+    size_t run_merges;
+    size_t bytes_written;
+    size_t bytes_read;
+};
+
+/* A sorted run on disk with a block of it buffered in memory. */
+struct epq_run
+{
+    struct hpq_elem elem ATTRIB_PRIVATE;
+    FILE *file ATTRIB_PRIVATE;
+    unsigned char *buf ATTRIB_PRIVATE;
+    size_t buf_len ATTRIB_PRIVATE;
+    size_t buf_pos ATTRIB_PRIVATE;
+    size_t on_disk ATTRIB_PRIVATE;
+    /* The records left when a merge began, to wind back to if it fails. */
+    size_t at_merge ATTRIB_PRIVATE;
+};
+
+struct ext_pqueue
+{
+    struct heap_pqueue mem ATTRIB_PRIVATE;
+    struct heap_pqueue merge ATTRIB_PRIVATE;
+    unsigned char *arena ATTRIB_PRIVATE;
+    size_t *free_slots ATTRIB_PRIVATE;
+    size_t num_free ATTRIB_PRIVATE;
+    size_t num_slots ATTRIB_PRIVATE;
+    size_t slot_size ATTRIB_PRIVATE;
+    struct epq_run *runs ATTRIB_PRIVATE;
+    size_t max_runs ATTRIB_PRIVATE;
+    size_t num_runs ATTRIB_PRIVATE;
+    size_t sz ATTRIB_PRIVATE;
+    size_t lost ATTRIB_PRIVATE;
+    struct epq_config config ATTRIB_PRIVATE;
+    epq_cmp_fn *cmp ATTRIB_PRIVATE;
+    enum ext_pq_threeway_cmp order ATTRIB_PRIVATE;
+    void *aux ATTRIB_PRIVATE;
+#ifdef CONTAINER_PROFILE
+    struct epq_counters counters ATTRIB_PRIVATE;
+#endif
+};
+
+/* Returns false if the configuration is unusable or memory could not be
+   allocated, in which case nothing needs to be freed. */
+bool epq_init(struct ext_pqueue *, struct epq_config const *,
+              enum ext_pq_threeway_cmp, epq_cmp_fn *, void *);
+/* Copies the record in. Returns false on a failed spill, in which case the
+   record is not pushed and the queue is unchanged. */
+bool epq_push(struct ext_pqueue *, void const *);
+/* The front record, valid until the next push or pop. NULL if empty. */
+void const *epq_front(struct ext_pqueue const *);
+/* Copies the front record to out, if out is not NULL, and removes it.
+   Returns false if empty. If the next block of a run cannot be read the
+   rest of that run is dropped from the queue and counted by epq_lost. */
+bool epq_pop(struct ext_pqueue *, void *);
+bool epq_empty(struct ext_pqueue const *);
+size_t epq_size(struct ext_pqueue const *);
+/* The number of sorted runs on disk that still hold records. */
+size_t epq_num_runs(struct ext_pqueue const *);
+/* The records dropped because a run could not be read back. */
+size_t epq_lost(struct ext_pqueue const *);
+/* Closes the spill files and frees all memory. */
+void epq_free(struct ext_pqueue *);
+bool epq_validate(struct ext_pqueue const *);
+struct epq_counters epq_profile(struct ext_pqueue const *);
+void epq_profile_reset(struct ext_pqueue *);
+
+#endif
@@ -0,0 +1,603 @@
+/* mkstemp, fdopen, and unlink for runs in a chosen directory. */
+#define _POSIX_C_SOURCE 200809L
+
+#include "ext_sort.h"
+#include "kway_merge.h"
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+
+/* Every I/O buffer starts on a page and is a whole number of pages. */
+static size_t const page_size = 4096;
+/* Chunks are sorted by insertion sort in slices of this many records and
+   then by merging the slices. */
+static size_t const insertion_slice = 16;
+
+struct sorter
+{
+    struct esort_config config;
+    esort_cmp_fn *cmp;
+    enum ext_sort_threeway_cmp order;
+    void *aux;
+    /* The bytes of whole records that fit in a block and the page rounded
+       size of a buffer that holds them. */
+    size_t io_bytes;
+    size_t buf_bytes;
+    FILE **runs;
+    size_t num_runs;
+    size_t runs_cap;
+    bool io_error;
+    struct esort_stats stats;
+};
+
+/* A chunk of input read by the calling thread or the reader thread. */
+struct chunk_read
+{
+    FILE *in;
+    unsigned char *buf;
+    size_t cap;
+    size_t got;
+    bool failed;
+};
+
+/* Output is gathered a block at a time before it is written. */
+struct writer
+{
+    struct sorter *s;
+    FILE *f;
+    unsigned char *buf;
+    size_t len;
+};
+
+/* A run being merged. The two buffers alternate so the last record of a
+   block stays valid while the merge reads the next block of the run. */
+struct run_cursor
+{
+    struct sorter *s;
+    FILE *f;
+    unsigned char *buf[2];
+    size_t which;
+    size_t len;
+    size_t pos;
+};
+
+static bool make_runs(struct sorter *, FILE *, FILE *);
+static bool merge_runs(struct sorter *, FILE *);
+static bool merge_group(struct sorter *, FILE *const *, size_t, FILE *,
+                        struct run_cursor *, struct kwm_input *,
+                        struct writer *);
+static unsigned char const **sort_chunk(struct sorter *, unsigned char *,
+                                        size_t, unsigned char const **,
+                                        unsigned char const **);
+static unsigned char *sort_records(struct sorter *, unsigned char *,
+                                   unsigned char *, size_t);
+static bool before(struct sorter *, void const *, void const *);
+static void read_chunk(struct chunk_read *);
+static void *read_chunk_thread(void *);
+static void const *run_next(void *);
+static enum kway_threeway_cmp merge_cmp(void const *, void const *, void *);
+static bool writer_put(struct writer *, void const *);
+static bool writer_flush(struct writer *);
+static bool add_run(struct sorter *, FILE *);
+static void close_runs(struct sorter *);
+static FILE *open_run(struct sorter const *);
+static void *alloc_buf(size_t);
+
+bool
+esort_file(FILE *const in, FILE *const out,
+           struct esort_config const *const config,
+           enum ext_sort_threeway_cmp const order, esort_cmp_fn *const cmp,
+           void *const aux, struct esort_stats *const stats)
+{
+    struct sorter s = {
+        .config = *config,
+        .cmp = cmp,
+        .order = order,
+        .aux = aux,
+    };
+    bool ok = config->record_size && cmp && order != ESORTEQL
+              && config->block_size >= config->record_size;
+    if (ok)
+    {
+        s.io_bytes = config->block_size / config->record_size
+                     * config->record_size;
+        s.buf_bytes = (s.io_bytes + page_size - 1) / page_size * page_size;
+        ok = config->memory_budget / 5 >= s.buf_bytes;
+    }
+    ok = ok && make_runs(&s, in, out) && merge_runs(&s, out);
+    close_runs(&s);
+    free(s.runs);
+    if (stats)
+    {
+        *stats = s.stats;
+    }
+    return ok;
+}
+
+/*===============================  Static Helpers  =========================*/
+
+/* Reads, sorts, and writes chunks until the input is exhausted. A single
+   chunk that holds all of the input is written to out and anything larger
+   becomes runs. With the reader thread the chunk after the current one is
+   read into the other buffer while the current one is sorted and written. */
+static bool
+make_runs(struct sorter *const s, FILE *const in, FILE *const out)
+{
+    size_t const rs = s->config.record_size;
+    bool const threaded = s->config.reader_thread;
+    size_t const per_record
+        = (threaded ? 2 * rs : rs) + (2 * sizeof(unsigned char *));
+    size_t const n_cap = (s->config.memory_budget - s->buf_bytes) / per_record;
+    size_t const cap = n_cap * rs;
+    unsigned char *chunk[2] = {
+        alloc_buf(cap),
+        threaded ? alloc_buf(cap) : NULL,
+    };
+    /* One array for both halves of the pointer sort so records small
+       enough to be sorted by value can use it as their scratch space. */
+    unsigned char const **const ptrs = malloc(2 * n_cap * sizeof(*ptrs));
+    bool const by_value = rs <= 2 * sizeof(*ptrs);
+    struct writer w = {.s = s, .buf = alloc_buf(s->buf_bytes)};
+    bool ok = chunk[0] && (!threaded || chunk[1]) && ptrs && w.buf;
+    struct chunk_read reads[2] = {
+        {.in = in, .buf = chunk[0], .cap = cap},
+        {.in = in, .buf = chunk[1], .cap = cap},
+    };
+    size_t cur = 0;
+    if (ok)
+    {
+        read_chunk(&reads[cur]);
+    }
+    for (bool first = true; ok; first = false)
+    {
+        struct chunk_read *const r = &reads[cur];
+        if (r->failed || r->got % rs)
+        {
+            ok = false;
+            break;
+        }
+        if (!r->got)
+        {
+            break;
+        }
+        s->stats.bytes_read += r->got;
+        bool const more = r->got == cap;
+        size_t const next = threaded ? !cur : cur;
+        pthread_t reader;
+        bool const ahead
+            = more && next != cur
+              && !pthread_create(&reader, NULL, read_chunk_thread,
+                                 &reads[next]);
+        size_t const n = r->got / rs;
+        s->stats.records += n;
+        unsigned char const **sorted = NULL;
+        unsigned char const *sorted_records = NULL;
+        if (by_value)
+        {
+            sorted_records = sort_records(s, r->buf, (unsigned char *)ptrs, n);
+        }
+        else
+        {
+            sorted = sort_chunk(s, r->buf, n, ptrs, ptrs + n_cap);
+        }
+        w.f = first && !more ? out : open_run(s);
+        w.len = 0;
+        ok = w.f != NULL;
+        for (size_t i = 0; ok && i < n; ++i)
+        {
+            ok = writer_put(&w, by_value ? sorted_records + (i * rs)
+                                         : sorted[i]);
+        }
+        ok = ok && writer_flush(&w);
+        if (w.f && w.f != out && !(ok && add_run(s, w.f)))
+        {
+            (void)fclose(w.f);
+            ok = false;
+        }
+        if (ahead)
+        {
+            (void)pthread_join(reader, NULL);
+        }
+        else if (ok && more)
+        {
+            read_chunk(&reads[next]);
+        }
+        cur = next;
+        if (!more)
+        {
+            break;
+        }
+    }
+    s->stats.runs = s->num_runs;
+    free(w.buf);
+    free(ptrs);
+    free(chunk[1]);
+    free(chunk[0]);
+    return ok;
+}
+
+/* Merges as many runs at a time as there are read buffers for. Each pass
+   merges consecutive groups so runs stay in input order and the sort stays
+   stable. The last pass writes to out. */
+static bool
+merge_runs(struct sorter *const s, FILE *const out)
+{
+    if (!s->num_runs)
+    {
+        return true;
+    }
+    size_t const fan_in
+        = (s->config.memory_budget - s->buf_bytes) / (2 * s->buf_bytes);
+    size_t const ways = s->num_runs < fan_in ? s->num_runs : fan_in;
+    struct run_cursor *const cursors = calloc(ways, sizeof(*cursors));
+    struct kwm_input *const inputs = malloc(ways * sizeof(*inputs));
+    struct writer w = {.s = s, .buf = alloc_buf(s->buf_bytes)};
+    bool ok = cursors && inputs && w.buf;
+    for (size_t i = 0; ok && i < ways; ++i)
+    {
+        cursors[i].buf[0] = alloc_buf(s->buf_bytes);
+        cursors[i].buf[1] = alloc_buf(s->buf_bytes);
+        ok = cursors[i].buf[0] && cursors[i].buf[1];
+    }
+    while (ok && s->num_runs > fan_in)
+    {
+        size_t kept = 0;
+        for (size_t i = 0; ok && i < s->num_runs; i += fan_in)
+        {
+            size_t const k
+                = s->num_runs - i < fan_in ? s->num_runs - i : fan_in;
+            FILE *merged = s->runs[i];
+            if (k > 1)
+            {
+                merged = open_run(s);
+                ok = merged
+                     && merge_group(s, s->runs + i, k, merged, cursors,
+                                    inputs, &w);
+                if (!ok)
+                {
+                    if (merged)
+                    {
+                        (void)fclose(merged);
+                    }
+                    break;
+                }
+                for (size_t j = i; j < i + k; ++j)
+                {
+                    (void)fclose(s->runs[j]);
+                    s->runs[j] = NULL;
+                }
+            }
+            s->runs[kept++] = merged;
+        }
+        if (ok)
+        {
+            s->num_runs = kept;
+            ++s->stats.merge_passes;
+        }
+    }
+    if (ok)
+    {
+        ok = merge_group(s, s->runs, s->num_runs, out, cursors, inputs, &w);
+        ++s->stats.merge_passes;
+    }
+    for (size_t i = 0; cursors && i < ways; ++i)
+    {
+        free(cursors[i].buf[0]);
+        free(cursors[i].buf[1]);
+    }
+    free(w.buf);
+    free(inputs);
+    free(cursors);
+    return ok;
+}
+
+/* Streams k runs from their starts through a kway_merge into dst. */
+static bool
+merge_group(struct sorter *const s, FILE *const *const runs, size_t const k,
+            FILE *const dst, struct run_cursor *const cursors,
+            struct kwm_input *const inputs, struct writer *const w)
+{
+    for (size_t i = 0; i < k; ++i)
+    {
+        rewind(runs[i]);
+        cursors[i].s = s;
+        cursors[i].f = runs[i];
+        cursors[i].which = 0;
+        cursors[i].len = cursors[i].pos = 0;
+        inputs[i] = (struct kwm_input){.next = run_next, .ctx = &cursors[i]};
+    }
+    struct kway_merge km;
+    if (!kwm_init(&km, inputs, k, (enum kway_threeway_cmp)s->order,
+                  merge_cmp, s, s->config.engine))
+    {
+        return false;
+    }
+    w->f = dst;
+    w->len = 0;
+    bool ok = true;
+    for (void const *e = NULL; ok && (e = kwm_next(&km));)
+    {
+        ok = writer_put(w, e);
+    }
+    kwm_free(&km);
+    return ok && !s->io_error && writer_flush(w);
+}
+
+/* Sorts pointers to the n records of the chunk and returns whichever of
+   the two pointer arrays holds the result. Slices are insertion sorted and
+   then merged bottom up between the arrays, which keeps equal records in
+   input order. */
+static unsigned char const **
+sort_chunk(struct sorter *const s, unsigned char *const chunk, size_t const n,
+           unsigned char const **src, unsigned char const **dst)
+{
+    size_t const rs = s->config.record_size;
+    for (size_t i = 0; i < n; ++i)
+    {
+        src[i] = chunk + (i * rs);
+    }
+    for (size_t lo = 0; lo < n; lo += insertion_slice)
+    {
+        size_t const hi = lo + insertion_slice < n ? lo + insertion_slice : n;
+        for (size_t i = lo + 1; i < hi; ++i)
+        {
+            unsigned char const *const key = src[i];
+            size_t j = i;
+            for (; j > lo && before(s, key, src[j - 1]); --j)
+            {
+                src[j] = src[j - 1];
+            }
+            src[j] = key;
+        }
+    }
+    for (size_t width = insertion_slice; width < n; width *= 2)
+    {
+        for (size_t lo = 0; lo < n; lo += 2 * width)
+        {
+            size_t const mid = lo + width < n ? lo + width : n;
+            size_t const hi = mid + width < n ? mid + width : n;
+            size_t a = lo;
+            size_t b = mid;
+            size_t out = lo;
+            while (a < mid && b < hi)
+            {
+                dst[out++] = before(s, src[b], src[a]) ? src[b++] : src[a++];
+            }
+            while (a < mid)
+            {
+                dst[out++] = src[a++];
+            }
+            while (b < hi)
+            {
+                dst[out++] = src[b++];
+            }
+        }
+        unsigned char const **const swap = src;
+        src = dst;
+        dst = swap;
+    }
+    return src;
+}
+
+/* Records no larger than the two pointers the pointer sort would use are
+   sorted by value in the same space, the same way as sort_chunk. Reading
+   and moving the records in order costs less than comparing through
+   pointers that jump around the chunk. Returns the buffer that holds the
+   result. */
+static unsigned char *
+sort_records(struct sorter *const s, unsigned char *src, unsigned char *dst,
+             size_t const n)
+{
+    size_t const rs = s->config.record_size;
+    unsigned char key[2 * sizeof(void *)];
+    for (size_t lo = 0; lo < n; lo += insertion_slice)
+    {
+        size_t const hi = lo + insertion_slice < n ? lo + insertion_slice : n;
+        for (size_t i = lo + 1; i < hi; ++i)
+        {
+            memcpy(key, src + (i * rs), rs);
+            size_t j = i;
+            for (; j > lo && before(s, key, src + ((j - 1) * rs)); --j)
+            {
+                memcpy(src + (j * rs), src + ((j - 1) * rs), rs);
+            }
+            memcpy(src + (j * rs), key, rs);
+        }
+    }
+    for (size_t width = insertion_slice; width < n; width *= 2)
+    {
+        for (size_t lo = 0; lo < n; lo += 2 * width)
+        {
+            size_t const mid = lo + width < n ? lo + width : n;
+            size_t const hi = mid + width < n ? mid + width : n;
+            unsigned char const *a = src + (lo * rs);
+            unsigned char const *b = src + (mid * rs);
+            unsigned char const *const a_end = b;
+            unsigned char const *const b_end = src + (hi * rs);
+            unsigned char *out = dst + (lo * rs);
+            while (a < a_end && b < b_end)
+            {
+                if (before(s, b, a))
+                {
+                    memcpy(out, b, rs);
+                    b += rs;
+                }
+                else
+                {
+                    memcpy(out, a, rs);
+                    a += rs;
+                }
+                out += rs;
+            }
+            memcpy(out, a, (size_t)(a_end - a));
+            out += a_end - a;
+            memcpy(out, b, (size_t)(b_end - b));
+        }
+        unsigned char *const swap = src;
+        src = dst;
+        dst = swap;
+    }
+    return src;
+}
+
+static inline bool
+before(struct sorter *const s, void const *const a, void const *const b)
+{
+    return s->cmp(a, b, s->aux) == s->order;
+}
+
+/* Fills the chunk unless the input ends first. */
+static void
+read_chunk(struct chunk_read *const r)
+{
+    r->got = fread(r->buf, 1, r->cap, r->in);
+    r->failed = r->got < r->cap && ferror(r->in);
+}
+
+static void *
+read_chunk_thread(void *const arg)
+{
+    read_chunk(arg);
+    return NULL;
+}
+
+/* The kwm_next_fn of a run. A read error ends the run early and is
+   reported once the merge finishes. */
+static void const *
+run_next(void *const ctx)
+{
+    struct run_cursor *const c = ctx;
+    size_t const rs = c->s->config.record_size;
+    if (c->pos == c->len)
+    {
+        c->which = !c->which;
+        size_t const got = fread(c->buf[c->which], 1, c->s->io_bytes, c->f);
+        c->s->stats.bytes_read += got;
+        c->len = got / rs;
+        c->pos = 0;
+        if (got % rs || (got < c->s->io_bytes && ferror(c->f)))
+        {
+            c->s->io_error = true;
+            c->len = 0;
+        }
+        if (!c->len)
+        {
+            return NULL;
+        }
+    }
+    return c->buf[c->which] + (c->pos++ * rs);
+}
+
+static enum kway_threeway_cmp
+merge_cmp(void const *const a, void const *const b, void *const aux)
+{
+    struct sorter const *const s = aux;
+    return (enum kway_threeway_cmp)s->cmp(a, b, s->aux);
+}
+
+static inline bool
+writer_put(struct writer *const w, void const *const record)
+{
+    size_t const rs = w->s->config.record_size;
+    memcpy(w->buf + w->len, record, rs);
+    w->len += rs;
+    return w->len < w->s->io_bytes || writer_flush(w);
+}
+
+static bool
+writer_flush(struct writer *const w)
+{
+    if (w->len && fwrite(w->buf, 1, w->len, w->f) != w->len)
+    {
+        return false;
+    }
+    w->s->stats.bytes_written += w->len;
+    w->len = 0;
+    return !fflush(w->f);
+}
+
+static bool
+add_run(struct sorter *const s, FILE *const f)
+{
+    if (s->num_runs == s->runs_cap)
+    {
+        size_t const cap = s->runs_cap ? s->runs_cap * 2 : 8;
+        FILE **const runs = realloc(s->runs, cap * sizeof(FILE *));
+        if (!runs)
+        {
+            return false;
+        }
+        s->runs = runs;
+        s->runs_cap = cap;
+    }
+    s->runs[s->num_runs++] = f;
+    return true;
+}
+
+static void
+close_runs(struct sorter *const s)
+{
+    for (size_t i = 0; i < s->num_runs; ++i)
+    {
+        if (s->runs[i])
+        {
+            (void)fclose(s->runs[i]);
+        }
+    }
+    s->num_runs = 0;
+}
+
+/* The file is unlinked right away so it disappears when closed, even if
+   the program exits during the sort. Runs are read and written in whole
+   blocks from aligned buffers so they are left unbuffered by stdio. */
+static FILE *
+open_run(struct sorter const *const s)
+{
+    FILE *f = NULL;
+    if (!s->config.dir)
+    {
+        f = tmpfile();
+    }
+    else
+    {
+        static char const name[] = "/esort_XXXXXX";
+        size_t const dir_len = strlen(s->config.dir);
+        char *const path = malloc(dir_len + sizeof(name));
+        if (!path)
+        {
+            return NULL;
+        }
+        memcpy(path, s->config.dir, dir_len);
+        memcpy(path + dir_len, name, sizeof(name));
+        int const fd = mkstemp(path);
+        if (fd >= 0)
+        {
+            (void)unlink(path);
+            f = fdopen(fd, "w+b");
+            if (!f)
+            {
+                (void)close(fd);
+            }
+        }
+        free(path);
+    }
+    if (f)
+    {
+        (void)setvbuf(f, NULL, _IONBF, 0);
+    }
+    return f;
+}
+
+static void *
+alloc_buf(size_t const bytes)
+{
+    size_t const rounded = (bytes + page_size - 1) / page_size * page_size;
+    return aligned_alloc(page_size, rounded ? rounded : page_size);
+}
@@ -0,0 +1,70 @@
+/* An external sort of fixed size records for files larger than memory. The
+   input is read in chunks that fill the memory budget. Each chunk is sorted
+   in memory and written as a sorted run to a temporary file, or straight to
+   the output if the whole input fits in one chunk. The runs are then merged
+   with a kway_merge, as many at a time as the budget has read buffers for,
+   in passes until the last pass writes the output. All file I/O is whole
+   blocks to and from page aligned buffers so stdio does not copy through
+   its own buffers. With a reader thread the next chunk is read while the
+   current one is sorted and written, at the cost of half the chunk size.
+
+   The sort is stable. Records that compare equal leave in input order. */
+#ifndef EXT_SORT
+#define EXT_SORT
+
+#include "kway_merge.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+enum ext_sort_threeway_cmp
+{
+    ESORTLES = -1,
+    ESORTEQL,
+    ESORTGRT,
+};
+
+/* Compares two records. The pointers are to record_size bytes that may
+   not be suitably aligned for the record type so copy them out or use
+   memcpy when the type needs alignment. */
+typedef enum ext_sort_threeway_cmp esort_cmp_fn(void const *, void const *,
+                                                void *);
+
+/* The memory budget covers the chunk, two record pointers per record of
+   the chunk, and one block of output. In the merge it covers two read
+   blocks per run merged and one block of output so the budget must hold at
+   least five blocks. A block must hold at least one record. Runs are
+   created in dir, or with tmpfile() if dir is NULL, and are unlinked as
+   soon as they are open. */
+struct esort_config
+{
+    size_t record_size;
+    size_t memory_budget;
+    size_t block_size;
+    char const *dir;
+    enum kwm_engine engine;
+    bool reader_thread;
+};
+
+struct esort_stats
+{
+    size_t records;
+    size_t runs;
+    size_t merge_passes;
+    size_t bytes_read;
+    size_t bytes_written;
+};
+
+/* Sorts the records from the current position of in to the end of the file
+   and writes them at the current position of out. in and out must be
+   different files. The input must be a whole number of records. Returns
+   false if the configuration is unusable, memory could not be allocated,
+   the input is malformed, or a read or write failed, in which case the
+   contents of out are unspecified. If stats is not NULL it is filled in
+   either way. */
+bool esort_file(FILE *in, FILE *out, struct esort_config const *,
+                enum ext_sort_threeway_cmp, esort_cmp_fn *, void *,
+                struct esort_stats *stats);
+
+#endif
@@ -0,0 +1,393 @@
+#include "heap_depqueue.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+
+static size_t const starting_capacity = 8;
+
+static enum heap_depq_threeway_cmp cmp_elems(struct heap_depqueue *,
+                                             struct hdepq_elem const *,
+                                             struct hdepq_elem const *);
+static void grow(struct heap_depqueue *);
+static void swap(struct hdepq_elem **, struct hdepq_elem **);
+static bool is_min_level(size_t);
+static size_t floor_log2(size_t);
+static size_t max_index(struct heap_depqueue const *);
+static struct hdepq_elem *remove_at(struct heap_depqueue *, size_t);
+static void fix(struct heap_depqueue *, size_t);
+static void push_up(struct heap_depqueue *, size_t);
+static void push_up_level(struct heap_depqueue *, size_t,
+                          enum heap_depq_threeway_cmp);
+static void push_down(struct heap_depqueue *, size_t,
+                      enum heap_depq_threeway_cmp);
+
+void
+hdepq_init(struct heap_depqueue *const hdq, hdepq_cmp_fn *const cmp,
+           void *const aux)
+{
+    hdq->sz = 0;
+    hdq->capacity = starting_capacity;
+    hdq->heap = calloc(starting_capacity, sizeof(struct hdepq_elem *));
+    if (!hdq->heap)
+    {
+        (void)fprintf(stderr, "heap backing store exhausted.\n");
+    }
+    hdq->cmp = cmp;
+    hdq->aux = aux;
+#ifdef CONTAINER_PROFILE
+    hdq->counters = (struct hdepq_counters){0};
+#endif
+}
+
+void
+hdepq_push(struct heap_depqueue *const hdq, struct hdepq_elem *const e)
+{
+    if (hdq->sz == hdq->capacity)
+    {
+        grow(hdq);
+    }
+    hdq->heap[hdq->sz] = e;
+    e->handle = hdq->sz;
+    ++hdq->sz;
+    push_up(hdq, hdq->sz - 1);
+}
+
+struct hdepq_elem *
+hdepq_pop_max(struct heap_depqueue *const hdq)
+{
+    if (!hdq->sz)
+    {
+        return NULL;
+    }
+    return remove_at(hdq, max_index(hdq));
+}
+
+struct hdepq_elem *
+hdepq_pop_min(struct heap_depqueue *const hdq)
+{
+    if (!hdq->sz)
+    {
+        return NULL;
+    }
+    return remove_at(hdq, 0);
+}
+
+struct hdepq_elem const *
+hdepq_max(struct heap_depqueue const *const hdq)
+{
+    if (!hdq->sz)
+    {
+        return NULL;
+    }
+    return hdq->heap[max_index(hdq)];
+}
+
+struct hdepq_elem const *
+hdepq_min(struct heap_depqueue const *const hdq)
+{
+    if (!hdq->sz)
+    {
+        return NULL;
+    }
+    return hdq->heap[0];
+}
+
+struct hdepq_elem *
+hdepq_erase(struct heap_depqueue *const hdq, struct hdepq_elem *const e)
+{
+    if (!hdq->sz || e->handle >= hdq->sz || hdq->heap[e->handle] != e)
+    {
+        return NULL;
+    }
+    return remove_at(hdq, e->handle);
+}
+
+bool
+hdepq_update(struct heap_depqueue *const hdq, struct hdepq_elem *const e,
+             hdepq_update_fn *const fn, void *const aux)
+{
+    if (!e || !hdq->sz || e->handle >= hdq->sz || hdq->heap[e->handle] != e)
+    {
+        return false;
+    }
+    fn(e, aux);
+    fix(hdq, e->handle);
+    return true;
+}
+
+void
+hdepq_clear(struct heap_depqueue *const hdq, hdepq_destructor_fn *const fn)
+{
+    for (size_t i = 0; i < hdq->sz; ++i)
+    {
+        fn(hdq->heap[i]);
+    }
+    free(hdq->heap);
+    hdq->sz = hdq->capacity = 0;
+    hdq->cmp = NULL;
+    hdq->heap = NULL;
+}
+
+bool
+hdepq_empty(struct heap_depqueue const *const hdq)
+{
+    if (!hdq)
+    {
+        return true;
+    }
+    return !hdq->sz;
+}
+
+size_t
+hdepq_size(struct heap_depqueue const *const hdq)
+{
+    if (!hdq)
+    {
+        return 0ULL;
+    }
+    return hdq->sz;
+}
+
+/* Every element on a min level must not be greater than any element below
+   it and every element on a max level must not be less. It is enough to
+   check each element against its children and grandchildren. */
+bool
+hdepq_validate(struct heap_depqueue const *const hdq)
+{
+    for (size_t i = 0; i < hdq->sz; ++i)
+    {
+        if (hdq->heap[i]->handle != i)
+        {
+            return false;
+        }
+        enum heap_depq_threeway_cmp const wrong
+            = is_min_level(i) ? HDEPQLES : HDEPQGRT;
+        size_t const first_child = (i * 2) + 1;
+        size_t const first_grandchild = (first_child * 2) + 1;
+        for (size_t c = first_child; c < first_child + 2 && c < hdq->sz; ++c)
+        {
+            if (hdq->cmp(hdq->heap[c], hdq->heap[i], hdq->aux) == wrong)
+            {
+                return false;
+            }
+        }
+        for (size_t g = first_grandchild;
+             g < first_grandchild + 4 && g < hdq->sz; ++g)
+        {
+            if (hdq->cmp(hdq->heap[g], hdq->heap[i], hdq->aux) == wrong)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+struct hdepq_counters
+hdepq_profile(struct heap_depqueue const *const hdq)
+{
+#ifdef CONTAINER_PROFILE
+    return hdq->counters;
+#else
+    (void)hdq;
+    return (struct hdepq_counters){0};
+#endif
+}
+
+void
+hdepq_profile_reset(struct heap_depqueue *const hdq)
+{
+#ifdef CONTAINER_PROFILE
+    hdq->counters = (struct hdepq_counters){0};
+#else
+    (void)hdq;
+#endif
+}
+
+/*===============================  Static Helpers  =========================*/
+
+/* All comparisons outside of validation go through here so profiling builds
+   can count them. */
+static inline enum heap_depq_threeway_cmp
+cmp_elems(struct heap_depqueue *const hdq, struct hdepq_elem const *const a,
+          struct hdepq_elem const *const b)
+{
+    PROFILE_INC(hdq->counters.cmps);
+    return hdq->cmp(a, b, hdq->aux);
+}
+
+/* The root is level 0, a min level, and levels alternate from there. */
+static inline bool
+is_min_level(size_t const i)
+{
+    return !(floor_log2(i + 1) & 1);
+}
+
+static inline size_t
+floor_log2(size_t n)
+{
+    size_t lg = 0;
+    for (; n >>= 1; ++lg)
+    {}
+    return lg;
+}
+
+/* The max is the root alone or the greater of its children. */
+static size_t
+max_index(struct heap_depqueue const *const hdq)
+{
+    if (hdq->sz == 1)
+    {
+        return 0;
+    }
+    if (hdq->sz == 2
+        || hdq->cmp(hdq->heap[1], hdq->heap[2], hdq->aux) != HDEPQLES)
+    {
+        return 1;
+    }
+    return 2;
+}
+
+/* The last element fills the hole and is then placed relative to both its
+   new descendants and ancestors. */
+static struct hdepq_elem *
+remove_at(struct heap_depqueue *const hdq, size_t const i)
+{
+    --hdq->sz;
+    struct hdepq_elem *const removed = hdq->heap[i];
+    if (i != hdq->sz)
+    {
+        swap(&hdq->heap[i], &hdq->heap[hdq->sz]);
+        fix(hdq, i);
+    }
+    return removed;
+}
+
+/* Pushing down settles the element against everything below it and the
+   handle tracks where it ended up, possibly on the other kind of level.
+   From there it may still belong above an ancestor of either kind. */
+static void
+fix(struct heap_depqueue *const hdq, size_t const i)
+{
+    struct hdepq_elem const *const e = hdq->heap[i];
+    push_down(hdq, i, is_min_level(i) ? HDEPQLES : HDEPQGRT);
+    push_up(hdq, e->handle);
+}
+
+/* An element on a min level that is greater than its max level parent
+   belongs on the max levels and the opposite for an element on a max
+   level. After at most one swap with the parent the element climbs only
+   through grandparents of the same kind of level. */
+static void
+push_up(struct heap_depqueue *const hdq, size_t i)
+{
+    enum heap_depq_threeway_cmp const order
+        = is_min_level(i) ? HDEPQLES : HDEPQGRT;
+    if (i)
+    {
+        size_t const parent = (i - 1) / 2;
+        if (cmp_elems(hdq, hdq->heap[parent], hdq->heap[i]) == order)
+        {
+            PROFILE_INC(hdq->counters.sift_steps);
+            swap(&hdq->heap[parent], &hdq->heap[i]);
+            push_up_level(hdq, parent,
+                          order == HDEPQLES ? HDEPQGRT : HDEPQLES);
+            return;
+        }
+    }
+    push_up_level(hdq, i, order);
+}
+
+static void
+push_up_level(struct heap_depqueue *const hdq, size_t i,
+              enum heap_depq_threeway_cmp const order)
+{
+    while (i > 2)
+    {
+        size_t const grandparent = (((i - 1) / 2) - 1) / 2;
+        if (cmp_elems(hdq, hdq->heap[i], hdq->heap[grandparent]) != order)
+        {
+            break;
+        }
+        PROFILE_INC(hdq->counters.sift_steps);
+        swap(&hdq->heap[grandparent], &hdq->heap[i]);
+        i = grandparent;
+    }
+}
+
+/* Moves the element down two levels at a time toward the most extreme of
+   its children and grandchildren for the order of its level. A grandchild
+   swap may leave the element out of order with its new parent, a level of
+   the opposite kind, in which case they trade places and the displaced
+   parent continues down in its place. */
+static void
+push_down(struct heap_depqueue *const hdq, size_t i,
+          enum heap_depq_threeway_cmp const order)
+{
+    for (;;)
+    {
+        size_t const first_child = (i * 2) + 1;
+        if (first_child >= hdq->sz)
+        {
+            return;
+        }
+        size_t best = first_child;
+        size_t const first_grandchild = (first_child * 2) + 1;
+        size_t const candidates[5] = {
+            first_child + 1,      first_grandchild,     first_grandchild + 1,
+            first_grandchild + 2, first_grandchild + 3,
+        };
+        for (size_t c = 0; c < 5 && candidates[c] < hdq->sz; ++c)
+        {
+            if (cmp_elems(hdq, hdq->heap[candidates[c]], hdq->heap[best])
+                == order)
+            {
+                best = candidates[c];
+            }
+        }
+        if (cmp_elems(hdq, hdq->heap[best], hdq->heap[i]) != order)
+        {
+            return;
+        }
+        PROFILE_INC(hdq->counters.sift_steps);
+        swap(&hdq->heap[best], &hdq->heap[i]);
+        if (best <= first_child + 1)
+        {
+            return;
+        }
+        size_t const parent = (best - 1) / 2;
+        if (cmp_elems(hdq, hdq->heap[parent], hdq->heap[best]) == order)
+        {
+            swap(&hdq->heap[parent], &hdq->heap[best]);
+        }
+        i = best;
+    }
+}
+
+static void
+grow(struct heap_depqueue *const hdq)
+{
+    struct hdepq_elem **new
+        = realloc(hdq->heap, sizeof(struct hdepq_elem *) * hdq->capacity * 2);
+    if (!new)
+    {
+        (void)fprintf(stderr, "reallocation of min-max heap failed.\n");
+    }
+    hdq->heap = new;
+    hdq->capacity *= 2;
+}
+
+static inline void
+swap(struct hdepq_elem **a, struct hdepq_elem **b)
+{
+    size_t const temp_handle = (*a)->handle;
+    (*a)->handle = (*b)->handle;
+    (*b)->handle = temp_handle;
+    struct hdepq_elem *temp = *a;
+    *a = *b;
+    *b = temp;
+}
@@ -0,0 +1,76 @@
+/* An array based double ended priority queue implemented as a min-max heap.
+   Even levels of the implicit tree are min levels and odd levels are max
+   levels so the min is the root and the max is one of its two children.
+   It offers the core operations of the splay tree DEPQ in depqueue.h with
+   O(1) min and max peeks and O(lgN) push, pop, erase, and update, but it
+   does not promise round robin order among duplicates. The elements store
+   their index in the array as a handle for erase and update. */
+#ifndef HEAP_DEPQUEUE
+#define HEAP_DEPQUEUE
+
+#include "attrib.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+/* NOLINTNEXTLINE */
+#include <stdint.h>
+
+enum heap_depq_threeway_cmp
+{
+    HDEPQLES = -1,
+    HDEPQEQL,
+    HDEPQGRT,
+};
+
+struct hdepq_elem
+{
+    size_t handle;
+};
+
+typedef enum heap_depq_threeway_cmp hdepq_cmp_fn(struct hdepq_elem const *,
+                                                 struct hdepq_elem const *,
+                                                 void *);
+
+typedef void hdepq_destructor_fn(struct hdepq_elem *);
+
+typedef void hdepq_update_fn(struct hdepq_elem *, void *);
+
+struct hdepq_counters
+{
+    size_t cmps;
+    size_t sift_steps;
+};
+
+struct heap_depqueue
+{
+    struct hdepq_elem **heap ATTRIB_PRIVATE;
+    size_t sz ATTRIB_PRIVATE;
+    size_t capacity ATTRIB_PRIVATE;
+    hdepq_cmp_fn *cmp ATTRIB_PRIVATE;
+    void *aux ATTRIB_PRIVATE;
+#ifdef CONTAINER_PROFILE
+    struct hdepq_counters counters ATTRIB_PRIVATE;
+#endif
+};
+
+#define HDEPQ_ENTRY(HDEPQ_ELEM, STRUCT, MEMBER)                                \
+    ((STRUCT *)((uint8_t *)&(HDEPQ_ELEM)->handle                               \
+                - offsetof(STRUCT, MEMBER.handle))) /* NOLINT */
+
+void hdepq_init(struct heap_depqueue *, hdepq_cmp_fn *, void *);
+void hdepq_push(struct heap_depqueue *, struct hdepq_elem *);
+struct hdepq_elem *hdepq_pop_max(struct heap_depqueue *);
+struct hdepq_elem *hdepq_pop_min(struct heap_depqueue *);
+struct hdepq_elem const *hdepq_max(struct heap_depqueue const *);
+struct hdepq_elem const *hdepq_min(struct heap_depqueue const *);
+struct hdepq_elem *hdepq_erase(struct heap_depqueue *, struct hdepq_elem *);
+bool hdepq_update(struct heap_depqueue *, struct hdepq_elem *,
+                  hdepq_update_fn *, void *);
+void hdepq_clear(struct heap_depqueue *, hdepq_destructor_fn *);
+bool hdepq_empty(struct heap_depqueue const *);
+size_t hdepq_size(struct heap_depqueue const *);
+bool hdepq_validate(struct heap_depqueue const *);
+struct hdepq_counters hdepq_profile(struct heap_depqueue const *);
+void hdepq_profile_reset(struct heap_depqueue *);
+
+#endif
@@ -31,10 +31,16 @@ enum hpq_direction
 
 static size_t const starting_capacity = 8;
 
+static enum heap_pq_threeway_cmp cmp_elems(struct heap_pqueue *,
+                                           struct hpq_elem const *,
+                                           struct hpq_elem const *);
+static bool in_heap(struct heap_pqueue const *, struct hpq_elem const *);
 static void grow(struct heap_pqueue *);
 static void swap(struct hpq_elem **, struct hpq_elem **);
 static void bubble_down(struct heap_pqueue *, size_t);
 static void bubble_up(struct heap_pqueue *, size_t);
+static void heapify(struct heap_pqueue *);
+static size_t floor_log2(size_t);
 static void print_node(struct heap_pqueue const *, size_t, hpq_print_fn *);
 static void print_inner_heap(struct heap_pqueue const *, size_t, char const *,
                              enum print_link, hpq_print_fn *);
@@ -59,6 +65,9 @@ hpq_init(struct heap_pqueue *const hpq, enum heap_pq_threeway_cmp hpq_ordering,
     }
     hpq->cmp = cmp;
     hpq->aux = aux;
+#ifdef CONTAINER_PROFILE
+    hpq->counters = (struct hpq_counters){0};
+#endif
 }
 
 void
@@ -88,6 +97,36 @@ hpq_pop(struct heap_pqueue *hpq)
     return ret;
 }
 
+/* A pop followed by a push would sift the last element down and the new
+   element up. Dropping the new element into the front slot only needs the
+   one sift down. Returns NULL if the heap was empty before the push. */
+struct hpq_elem *
+hpq_replace_front(struct heap_pqueue *const hpq, struct hpq_elem *const e)
+{
+    if (!hpq->sz)
+    {
+        hpq_push(hpq, e);
+        return NULL;
+    }
+    struct hpq_elem *const ret = hpq->heap[0];
+    hpq->heap[0] = e;
+    e->handle = 0;
+    bubble_down(hpq, 0);
+    return ret;
+}
+
+/* Push then pop in one step. If the new element would be popped right
+   away it never enters the heap. Otherwise the front is replaced. */
+struct hpq_elem *
+hpq_pushpop(struct heap_pqueue *const hpq, struct hpq_elem *const e)
+{
+    if (!hpq->sz || cmp_elems(hpq, hpq->heap[0], e) != hpq->order)
+    {
+        return e;
+    }
+    return hpq_replace_front(hpq, e);
+}
+
 struct hpq_elem *
 hpq_erase(struct heap_pqueue *const hpq, struct hpq_elem *e)
 {
@@ -110,7 +149,7 @@ hpq_erase(struct heap_pqueue *const hpq, struct hpq_elem *e)
     swap(&hpq->heap[swap_location], &hpq->heap[hpq->sz]);
     struct hpq_elem *erased = hpq->heap[hpq->sz];
     enum heap_pq_threeway_cmp const erased_cmp
-        = hpq->cmp(hpq->heap[swap_location], erased, hpq->aux);
+        = cmp_elems(hpq, hpq->heap[swap_location], erased);
     if (erased_cmp == hpq->order)
     {
         bubble_up(hpq, swap_location);
@@ -127,7 +166,7 @@ bool
 hpq_update(struct heap_pqueue *hpq, struct hpq_elem *e, hpq_update_fn *fn,
            void *aux)
 {
-    if (!e || !hpq->sz)
+    if (!in_heap(hpq, e))
     {
         return false;
     }
@@ -137,8 +176,9 @@ hpq_update(struct heap_pqueue *hpq, struct hpq_elem *e, hpq_update_fn *fn,
         bubble_down(hpq, 0);
         return true;
     }
-    enum heap_pq_threeway_cmp const parent_cmp = hpq->cmp(
-        hpq->heap[e->handle], hpq->heap[(e->handle - 1) / 2], hpq->aux);
+    enum heap_pq_threeway_cmp const parent_cmp
+        = cmp_elems(hpq, hpq->heap[e->handle],
+                    hpq->heap[(e->handle - 1) / 2]);
     if (parent_cmp == hpq->order)
     {
         bubble_up(hpq, e->handle);
@@ -153,6 +193,46 @@ hpq_update(struct heap_pqueue *hpq, struct hpq_elem *e, hpq_update_fn *fn,
     return true;
 }
 
+/* Updating K elements one at a time costs O(KlgN) while applying every
+   update and rebuilding costs O(N). However, a random update sifts up only a
+   constant number of levels on average and heapify touches every element with
+   poor locality, so the rebuild only wins once K is a large fraction of N.
+   The constant below puts the crossover near half to two thirds of the heap
+   for the sizes measured in the perf update-batch test. With no repeated
+   elements K is at most N, so the rebuild only starts at 2048 elements. Every
+   element is checked before any is changed so a bad batch changes nothing. */
+bool
+hpq_update_batch(struct heap_pqueue *const hpq, struct hpq_elem **const elems,
+                 size_t const n, hpq_update_fn *const fn, void *const aux)
+{
+    if (!elems || !hpq->sz)
+    {
+        return false;
+    }
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (!in_heap(hpq, elems[i]))
+        {
+            return false;
+        }
+    }
+    if (n * (floor_log2(hpq->sz) + 1) < hpq->sz * 12)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            (void)hpq_update(hpq, elems[i], fn, aux);
+        }
+        return true;
+    }
+    for (size_t i = 0; i < n; ++i)
+    {
+        fn(elems[i], aux);
+    }
+    PROFILE_INC(hpq->counters.rebuilds);
+    heapify(hpq);
+    return true;
+}
+
 struct hpq_elem const *
 hpq_front(struct heap_pqueue const *const hpq)
 {
@@ -238,6 +318,27 @@ hpq_validate(struct heap_pqueue const *const hpq)
     return true;
 }
 
+struct hpq_counters
+hpq_profile(struct heap_pqueue const *const hpq)
+{
+#ifdef CONTAINER_PROFILE
+    return hpq->counters;
+#else
+    (void)hpq;
+    return (struct hpq_counters){0};
+#endif
+}
+
+void
+hpq_profile_reset(struct heap_pqueue *const hpq)
+{
+#ifdef CONTAINER_PROFILE
+    hpq->counters = (struct hpq_counters){0};
+#else
+    (void)hpq;
+#endif
+}
+
 void
 hpq_print(struct heap_pqueue const *hpq, size_t const i, hpq_print_fn *const fn)
 {
@@ -246,13 +347,24 @@ hpq_print(struct heap_pqueue const *hpq, size_t const i, hpq_print_fn *const fn)
 
 /*===============================  Static Helpers  =========================*/
 
+/* All comparisons outside of validation go through here so profiling builds
+   can count them. */
+static inline enum heap_pq_threeway_cmp
+cmp_elems(struct heap_pqueue *const hpq, struct hpq_elem const *const a,
+          struct hpq_elem const *const b)
+{
+    PROFILE_INC(hpq->counters.cmps);
+    return hpq->cmp(a, b, hpq->aux);
+}
+
 static void
 bubble_up(struct heap_pqueue *const hpq, size_t i)
 {
     for (size_t parent = (i - 1) / 2;
-         i && hpq->cmp(hpq->heap[i], hpq->heap[parent], hpq->aux) == hpq->order;
+         i && cmp_elems(hpq, hpq->heap[i], hpq->heap[parent]) == hpq->order;
          i = parent, parent = (parent - 1) / 2)
     {
+        PROFILE_INC(hpq->counters.sift_steps);
         swap(&hpq->heap[parent], &hpq->heap[i]);
     }
     hpq->heap[i]->handle = i;
@@ -271,18 +383,51 @@ bubble_down(struct heap_pqueue *hpq, size_t i)
            Avoid one call if there is no right child. */
         next = (right < hpq->sz
                 && (hpq->order
-                    == hpq->cmp(hpq->heap[right], hpq->heap[left], hpq->aux)))
+                    == cmp_elems(hpq, hpq->heap[right], hpq->heap[left])))
                    ? right
                    : left;
-        if (hpq->cmp(hpq->heap[i], hpq->heap[next], NULL) != wrong_order)
+        if (cmp_elems(hpq, hpq->heap[i], hpq->heap[next]) != wrong_order)
         {
             break;
         }
+        PROFILE_INC(hpq->counters.sift_steps);
         swap(&hpq->heap[next], &hpq->heap[i]);
     }
     hpq->heap[i]->handle = i;
 }
 
+/* Floyd's bottom up construction. Every element below the last internal node
+   is already a valid heap of one so start there and work back to the root. */
+static void
+heapify(struct heap_pqueue *const hpq)
+{
+    if (hpq->sz <= 1)
+    {
+        return;
+    }
+    for (size_t i = ((hpq->sz - 2) / 2) + 1; i--;)
+    {
+        bubble_down(hpq, i);
+    }
+}
+
+static inline size_t
+floor_log2(size_t n)
+{
+    size_t lg = 0;
+    for (; n >>= 1; ++lg)
+    {}
+    return lg;
+}
+
+/* The handle of an element is its index, so an element outside this heap
+   has a handle past the end or finds another element at its index. */
+static inline bool
+in_heap(struct heap_pqueue const *const hpq, struct hpq_elem const *const e)
+{
+    return e && e->handle < hpq->sz && hpq->heap[e->handle] == e;
+}
+
 static void
 grow(struct heap_pqueue *hpq)
 {
@@ -29,6 +29,13 @@ typedef void hpq_update_fn(struct hpq_elem *, void *);
 
 typedef void hpq_print_fn(struct hpq_elem const *);
 
+struct hpq_counters
+{
+    size_t cmps;
+    size_t sift_steps;
+    size_t rebuilds;
+};
+
 struct heap_pqueue
 {
     struct hpq_elem **heap ATTRIB_PRIVATE;
@@ -37,6 +44,9 @@ struct heap_pqueue
     hpq_cmp_fn *cmp ATTRIB_PRIVATE;
     enum heap_pq_threeway_cmp order ATTRIB_PRIVATE;
     void *aux ATTRIB_PRIVATE;
+#ifdef CONTAINER_PROFILE
+    struct hpq_counters counters ATTRIB_PRIVATE;
+#endif
 };
 
 #define HPQ_ENTRY(HPQ_ELEM, STRUCT, MEMBER)                                    \
@@ -48,14 +58,20 @@ void hpq_init(struct heap_pqueue *, enum heap_pq_threeway_cmp hpq_ordering,
 struct hpq_elem const *hpq_front(struct heap_pqueue const *);
 void hpq_push(struct heap_pqueue *, struct hpq_elem *);
 struct hpq_elem *hpq_pop(struct heap_pqueue *);
+struct hpq_elem *hpq_replace_front(struct heap_pqueue *, struct hpq_elem *);
+struct hpq_elem *hpq_pushpop(struct heap_pqueue *, struct hpq_elem *);
 struct hpq_elem *hpq_erase(struct heap_pqueue *, struct hpq_elem *);
 void hpq_clear(struct heap_pqueue *, hpq_destructor_fn *);
 bool hpq_empty(struct heap_pqueue const *);
 size_t hpq_size(struct heap_pqueue const *);
 bool hpq_update(struct heap_pqueue *, struct hpq_elem *, hpq_update_fn *,
                 void *);
+bool hpq_update_batch(struct heap_pqueue *, struct hpq_elem **, size_t,
+                      hpq_update_fn *, void *);
 bool hpq_validate(struct heap_pqueue const *);
 enum heap_pq_threeway_cmp hpq_order(struct heap_pqueue const *);
+struct hpq_counters hpq_profile(struct heap_pqueue const *);
+void hpq_profile_reset(struct heap_pqueue *);
 
 void hpq_print(struct heap_pqueue const *, size_t, hpq_print_fn *);
 
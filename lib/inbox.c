@@ -0,0 +1,226 @@
+#include "inbox.h"
+#include "depqueue.h"
+#include "pqueue.h"
+
+#include <stdatomic.h>
+#include <stddef.h>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+
+/* The link of an element whose producer has published it but not yet
+   written its link. Only the addresses are used. */
+static struct pq_elem pq_unlinked;
+static struct node depq_unlinked;
+
+static size_t push_pq_chain(struct pq_inbox *, struct pq_elem *);
+static size_t push_depq_chain(struct depq_inbox *, struct depq_elem *);
+
+void
+pq_inbox_init(struct pq_inbox *const in, struct pqueue *const pq)
+{
+    *in = (struct pq_inbox){.pq = pq};
+    atomic_init(&in->head, NULL);
+}
+
+/* The link is a plain field of the element so it is written with the GCC
+   atomic builtins. The exchange publishes the marker and the element and
+   the release store publishes the link. */
+void
+pq_inbox_push(struct pq_inbox *const in, struct pq_elem *const e)
+{
+    __atomic_store_n(&e->next_sibling, &pq_unlinked, __ATOMIC_RELAXED);
+    struct pq_elem *const next
+        = atomic_exchange_explicit(&in->head, e, memory_order_acq_rel);
+    __atomic_store_n(&e->next_sibling, next, __ATOMIC_RELEASE);
+}
+
+/* Elements left at an unfinished link are resumed first. Each is chained
+   to the next through its parent field, which its producer never writes. */
+size_t
+pq_inbox_drain(struct pq_inbox *const in)
+{
+    size_t moved = 0;
+    struct pq_elem *stalled = in->stalled;
+    in->stalled = NULL;
+    while (stalled)
+    {
+        struct pq_elem *const resume = stalled;
+        stalled = stalled->parent;
+        moved += push_pq_chain(in, resume);
+    }
+    /* A load first spares the cache line of producers when there is
+       nothing to take. */
+    if (atomic_load_explicit(&in->head, memory_order_relaxed))
+    {
+        moved += push_pq_chain(
+            in, atomic_exchange_explicit(&in->head, NULL,
+                                         memory_order_acquire));
+    }
+#ifdef CONTAINER_PROFILE
+    if (moved)
+    {
+        ++in->stats.drains;
+        in->stats.batched += moved;
+    }
+#endif
+    return moved;
+}
+
+struct pq_elem *
+pq_inbox_pop(struct pq_inbox *const in)
+{
+    (void)pq_inbox_drain(in);
+    return pq_empty(in->pq) ? NULL : pq_pop(in->pq);
+}
+
+struct inbox_counters
+pq_inbox_profile(struct pq_inbox const *const in)
+{
+#ifdef CONTAINER_PROFILE
+    return in->stats;
+#else
+    (void)in;
+    return (struct inbox_counters){0};
+#endif
+}
+
+void
+pq_inbox_profile_reset(struct pq_inbox *const in)
+{
+#ifdef CONTAINER_PROFILE
+    in->stats = (struct inbox_counters){0};
+#else
+    (void)in;
+#endif
+}
+
+void
+depq_inbox_init(struct depq_inbox *const in, struct depqueue *const depq)
+{
+    *in = (struct depq_inbox){.depq = depq};
+    atomic_init(&in->head, NULL);
+}
+
+void
+depq_inbox_push(struct depq_inbox *const in, struct depq_elem *const e)
+{
+    __atomic_store_n(&e->n.link[0], &depq_unlinked, __ATOMIC_RELAXED);
+    struct depq_elem *const next
+        = atomic_exchange_explicit(&in->head, e, memory_order_acq_rel);
+    __atomic_store_n(&e->n.link[0], (struct node *)next, __ATOMIC_RELEASE);
+}
+
+/* Stalled elements are chained through the second link of their node. */
+size_t
+depq_inbox_drain(struct depq_inbox *const in)
+{
+    size_t moved = 0;
+    struct depq_elem *stalled = in->stalled;
+    in->stalled = NULL;
+    while (stalled)
+    {
+        struct depq_elem *const resume = stalled;
+        stalled = (struct depq_elem *)stalled->n.link[1];
+        moved += push_depq_chain(in, resume);
+    }
+    if (atomic_load_explicit(&in->head, memory_order_relaxed))
+    {
+        moved += push_depq_chain(
+            in, atomic_exchange_explicit(&in->head, NULL,
+                                         memory_order_acquire));
+    }
+#ifdef CONTAINER_PROFILE
+    if (moved)
+    {
+        ++in->stats.drains;
+        in->stats.batched += moved;
+    }
+#endif
+    return moved;
+}
+
+struct depq_elem *
+depq_inbox_pop_max(struct depq_inbox *const in)
+{
+    (void)depq_inbox_drain(in);
+    return depq_empty(in->depq) ? NULL : depq_pop_max(in->depq);
+}
+
+struct depq_elem *
+depq_inbox_pop_min(struct depq_inbox *const in)
+{
+    (void)depq_inbox_drain(in);
+    return depq_empty(in->depq) ? NULL : depq_pop_min(in->depq);
+}
+
+struct inbox_counters
+depq_inbox_profile(struct depq_inbox const *const in)
+{
+#ifdef CONTAINER_PROFILE
+    return in->stats;
+#else
+    (void)in;
+    return (struct inbox_counters){0};
+#endif
+}
+
+void
+depq_inbox_profile_reset(struct depq_inbox *const in)
+{
+#ifdef CONTAINER_PROFILE
+    in->stats = (struct inbox_counters){0};
+#else
+    (void)in;
+#endif
+}
+
+/*===============================  Static Helpers  =========================*/
+
+/* Pushes the chain from e into the pqueue up to its end or to the first
+   element whose link is not yet written, which is set aside with the rest
+   of the chain behind it. The link must be read before the push because
+   the pqueue reuses the field. */
+static size_t
+push_pq_chain(struct pq_inbox *const in, struct pq_elem *e)
+{
+    size_t moved = 0;
+    while (e)
+    {
+        struct pq_elem *const next
+            = __atomic_load_n(&e->next_sibling, __ATOMIC_ACQUIRE);
+        if (next == &pq_unlinked)
+        {
+            e->parent = in->stalled;
+            in->stalled = e;
+            PROFILE_INC(in->stats.stalls);
+            break;
+        }
+        pq_push(in->pq, e);
+        e = next;
+        ++moved;
+    }
+    return moved;
+}
+
+static size_t
+push_depq_chain(struct depq_inbox *const in, struct depq_elem *e)
+{
+    size_t moved = 0;
+    while (e)
+    {
+        struct node *const next
+            = __atomic_load_n(&e->n.link[0], __ATOMIC_ACQUIRE);
+        if (next == &depq_unlinked)
+        {
+            e->n.link[1] = (struct node *)in->stalled;
+            in->stalled = e;
+            PROFILE_INC(in->stats.stalls);
+            break;
+        }
+        depq_push(in->depq, e);
+        e = (struct depq_elem *)next;
+        ++moved;
+    }
+    return moved;
+}
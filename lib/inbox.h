@@ -0,0 +1,85 @@
+/* Inboxes that let many threads push into a pqueue or a depqueue owned by
+   one consumer thread without a lock around the container. A producer
+   pushes an element onto an intrusive stack with one atomic exchange and
+   one store, so a push never loops or waits on another thread. Before each
+   pop the consumer takes the whole stack with one exchange and pushes the
+   batch into its container, so producers never touch the container and
+   the consumer pays for one atomic per batch rather than a lock per push.
+
+   While an element waits in an inbox its own intrusive fields hold the
+   stack link: next_sibling of a pq_elem or the first link of the node of
+   a depq_elem. No other memory is needed. Order within a batch is lost,
+   which a priority queue does not need.
+
+   A producer links its element in two steps. If a producer is stopped
+   between them the consumer leaves that element and every element pushed
+   before it in the inbox and picks them up at a later drain, once the
+   producer has finished. The consumer never waits on a producer but an
+   element may be seen later than a push that returned before it. */
+#ifndef INBOX
+#define INBOX
+
+#include "attrib.h"
+#include "depqueue.h"
+#include "pqueue.h"
+
+#include <stdatomic.h>
+#include <stddef.h>
+
+/* The producer and consumer sides of an inbox are aligned to this so
+   pushes do not evict the fields the consumer reads. */
+#define INBOX_CACHE_LINE 64
+
+struct inbox_counters
+{
+    /* Drains that found at least one element. */
+    size_t drains;
+    /* Elements moved from the inbox into the container. */
+    size_t batched;
+    /* Times a drain found a link a producer had not yet written, again
+       for each drain that finds the same link still unwritten. */
+    size_t stalls;
+};
+
+struct pq_inbox
+{
+    _Alignas(INBOX_CACHE_LINE) _Atomic(struct pq_elem *) head ATTRIB_PRIVATE;
+    _Alignas(INBOX_CACHE_LINE) struct pqueue *pq ATTRIB_PRIVATE;
+    struct pq_elem *stalled ATTRIB_PRIVATE;
+#ifdef CONTAINER_PROFILE
+    struct inbox_counters stats ATTRIB_PRIVATE;
+#endif
+};
+
+struct depq_inbox
+{
+    _Alignas(INBOX_CACHE_LINE) _Atomic(struct depq_elem *) head ATTRIB_PRIVATE;
+    _Alignas(INBOX_CACHE_LINE) struct depqueue *depq ATTRIB_PRIVATE;
+    struct depq_elem *stalled ATTRIB_PRIVATE;
+#ifdef CONTAINER_PROFILE
+    struct inbox_counters stats ATTRIB_PRIVATE;
+#endif
+};
+
+/* Push may be called from any number of threads at once. Every other
+   function belongs to the one consumer thread, which may also use the
+   container directly between drains. */
+void pq_inbox_init(struct pq_inbox *, struct pqueue *);
+void pq_inbox_push(struct pq_inbox *, struct pq_elem *);
+/* Moves every finished element from the inbox into the pqueue and returns
+   how many were moved. */
+size_t pq_inbox_drain(struct pq_inbox *);
+/* Drains and pops the front of the pqueue. NULL if both are empty. */
+struct pq_elem *pq_inbox_pop(struct pq_inbox *);
+struct inbox_counters pq_inbox_profile(struct pq_inbox const *);
+void pq_inbox_profile_reset(struct pq_inbox *);
+
+void depq_inbox_init(struct depq_inbox *, struct depqueue *);
+void depq_inbox_push(struct depq_inbox *, struct depq_elem *);
+size_t depq_inbox_drain(struct depq_inbox *);
+struct depq_elem *depq_inbox_pop_max(struct depq_inbox *);
+struct depq_elem *depq_inbox_pop_min(struct depq_inbox *);
+struct inbox_counters depq_inbox_profile(struct depq_inbox const *);
+void depq_inbox_profile_reset(struct depq_inbox *);
+
+#endif
@@ -0,0 +1,272 @@
+#include "kway_merge.h"
+#include "heap_pqueue.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+
+static enum kway_threeway_cmp cmp_elems(struct kway_merge *, void const *,
+                                        void const *);
+static void const *pull(struct kwm_input *);
+static bool beats(struct kway_merge *, size_t, size_t);
+static size_t build(struct kway_merge *, size_t);
+static void replay(struct kway_merge *, size_t);
+static enum heap_pq_threeway_cmp node_cmp(struct hpq_elem const *,
+                                          struct hpq_elem const *, void *);
+static void no_destroy(struct hpq_elem *);
+
+bool
+kwm_init(struct kway_merge *const km, struct kwm_input *const inputs,
+         size_t const k, enum kway_threeway_cmp const order,
+         kwm_cmp_fn *const cmp, void *const aux, enum kwm_engine const engine)
+{
+    *km = (struct kway_merge){
+        .inputs = inputs,
+        .k = k,
+        .engine = engine,
+        .cmp = cmp,
+        .order = order,
+        .aux = aux,
+    };
+    if (!k)
+    {
+        return true;
+    }
+    km->heads = malloc(k * sizeof(void const *));
+    if (!km->heads)
+    {
+        return false;
+    }
+    for (size_t i = 0; i < k; ++i)
+    {
+        inputs[i].pos = 0;
+        km->heads[i] = pull(&inputs[i]);
+    }
+    if (engine == KWM_LOSER_TREE)
+    {
+        km->tree = malloc(k * sizeof(size_t));
+        if (!km->tree)
+        {
+            free(km->heads);
+            return false;
+        }
+        km->tree[0] = build(km, 1);
+        return true;
+    }
+    km->nodes = malloc(k * sizeof(struct kwm_node));
+    if (!km->nodes)
+    {
+        free(km->heads);
+        return false;
+    }
+    hpq_init(&km->heap, order == KWMLES ? HPQLES : HPQGRT, node_cmp, km);
+    for (size_t i = 0; i < k; ++i)
+    {
+        km->nodes[i].input = i;
+        if (km->heads[i])
+        {
+            hpq_push(&km->heap, &km->nodes[i].elem);
+        }
+    }
+    return true;
+}
+
+void const *
+kwm_next(struct kway_merge *const km)
+{
+    if (kwm_done(km))
+    {
+        return NULL;
+    }
+    if (km->engine == KWM_LOSER_TREE)
+    {
+        size_t const winner = km->tree[0];
+        void const *const e = km->heads[winner];
+        km->heads[winner] = pull(&km->inputs[winner]);
+        replay(km, winner);
+        return e;
+    }
+    struct kwm_node *const node
+        = HPQ_ENTRY(hpq_front(&km->heap), struct kwm_node, elem);
+    void const *const e = km->heads[node->input];
+    km->heads[node->input] = pull(&km->inputs[node->input]);
+    if (km->heads[node->input])
+    {
+        (void)hpq_replace_front(&km->heap, &node->elem);
+    }
+    else
+    {
+        (void)hpq_pop(&km->heap);
+    }
+    return e;
+}
+
+size_t
+kwm_next_batch(struct kway_merge *const km, void const **const out,
+               size_t const max)
+{
+    size_t n = 0;
+    for (void const *e = NULL; n < max && (e = kwm_next(km)); ++n)
+    {
+        out[n] = e;
+    }
+    return n;
+}
+
+bool
+kwm_done(struct kway_merge const *const km)
+{
+    if (!km->k)
+    {
+        return true;
+    }
+    if (km->engine == KWM_LOSER_TREE)
+    {
+        return !km->heads[km->tree[0]];
+    }
+    return hpq_empty(&km->heap);
+}
+
+void
+kwm_free(struct kway_merge *const km)
+{
+    if (km->nodes)
+    {
+        hpq_clear(&km->heap, no_destroy);
+    }
+    free(km->nodes);
+    free(km->tree);
+    free(km->heads);
+    *km = (struct kway_merge){0};
+}
+
+struct kwm_counters
+kwm_profile(struct kway_merge const *const km)
+{
+#ifdef CONTAINER_PROFILE
+    return km->counters;
+#else
+    (void)km;
+    return (struct kwm_counters){0};
+#endif
+}
+
+void
+kwm_profile_reset(struct kway_merge *const km)
+{
+#ifdef CONTAINER_PROFILE
+    km->counters = (struct kwm_counters){0};
+#else
+    (void)km;
+#endif
+}
+
+/*===============================  Static Helpers  =========================*/
+
+/* All comparisons go through here so profiling builds can count them. */
+static inline enum kway_threeway_cmp
+cmp_elems(struct kway_merge *const km, void const *const a,
+          void const *const b)
+{
+    PROFILE_INC(km->counters.cmps);
+    return km->cmp(a, b, km->aux);
+}
+
+static inline void const *
+pull(struct kwm_input *const in)
+{
+    if (in->next)
+    {
+        return in->next(in->ctx);
+    }
+    return in->pos < in->len ? in->items[in->pos++] : NULL;
+}
+
+/* An exhausted input loses to everything so it sinks out of the way
+   without a call to the comparison function. Ties go to the earlier input
+   which keeps the merge stable. */
+static inline bool
+beats(struct kway_merge *const km, size_t const a, size_t const b)
+{
+    void const *const x = km->heads[a];
+    void const *const y = km->heads[b];
+    if (!x)
+    {
+        return false;
+    }
+    if (!y)
+    {
+        return true;
+    }
+    enum kway_threeway_cmp const c = cmp_elems(km, x, y);
+    return c == km->order || (c == KWMEQL && a < b);
+}
+
+/* NOLINTBEGIN(*misc-no-recursion) */
+
+/* The tree is implicit with internal nodes [1, k) and input i as the leaf
+   at node k + i so the shape is complete for any k. Returns the winner of
+   the subtree and stores the loser of each match in its node. */
+static size_t
+build(struct kway_merge *const km, size_t const node)
+{
+    if (node >= km->k)
+    {
+        return node - km->k;
+    }
+    size_t const a = build(km, node * 2);
+    size_t const b = build(km, (node * 2) + 1);
+    if (beats(km, a, b))
+    {
+        km->tree[node] = b;
+        return a;
+    }
+    km->tree[node] = a;
+    return b;
+}
+
+/* NOLINTEND(*misc-no-recursion) */
+
+/* The previous winner has a new head so it replays every match on its path
+   to the root against the losers stored there, one comparison a level. */
+static void
+replay(struct kway_merge *const km, size_t winner)
+{
+    for (size_t node = (winner + km->k) / 2; node; node /= 2)
+    {
+        if (beats(km, km->tree[node], winner))
+        {
+            size_t const loser = winner;
+            winner = km->tree[node];
+            km->tree[node] = loser;
+        }
+    }
+    km->tree[0] = winner;
+}
+
+/* Only inputs with a head are in the heap. Equal heads are ordered by
+   input so the heap engine is stable as well. */
+static enum heap_pq_threeway_cmp
+node_cmp(struct hpq_elem const *const a, struct hpq_elem const *const b,
+         void *const aux)
+{
+    struct kway_merge *const km = aux;
+    size_t const x = HPQ_ENTRY(a, struct kwm_node, elem)->input;
+    size_t const y = HPQ_ENTRY(b, struct kwm_node, elem)->input;
+    enum kway_threeway_cmp const c
+        = cmp_elems(km, km->heads[x], km->heads[y]);
+    if (c != KWMEQL)
+    {
+        return (enum heap_pq_threeway_cmp)c;
+    }
+    return (enum heap_pq_threeway_cmp)(x < y ? km->order : -km->order);
+}
+
+static void
+no_destroy(struct hpq_elem *const e)
+{
+    (void)e;
+}
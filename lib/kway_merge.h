@@ -0,0 +1,100 @@
+/* A k-way merge of sorted input streams. The default engine is a loser
+   tree: a tournament over the K inputs where each internal node keeps the
+   loser of the match played there and the overall winner sits above the
+   root. Taking the winner and replaying its path from leaf to root costs
+   exactly ceil(lgK) comparisons and touches the same lgK nodes each time,
+   against up to 2lgK for the sift down of a binary heap. The heap_pqueue
+   engine is kept as a fallback and for comparison.
+
+   Inputs are either arrays of element pointers or callbacks that produce
+   the next element pointer. Elements from different inputs that compare
+   equal leave in input order so the merge is stable for either engine. */
+#ifndef KWAY_MERGE
+#define KWAY_MERGE
+
+#include "attrib.h"
+#include "heap_pqueue.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+enum kway_threeway_cmp
+{
+    KWMLES = -1,
+    KWMEQL,
+    KWMGRT,
+};
+
+enum kwm_engine
+{
+    KWM_LOSER_TREE = 0,
+    KWM_HEAP,
+};
+
+typedef enum kway_threeway_cmp kwm_cmp_fn(void const *, void const *, void *);
+
+/* Produces the next element of a stream or NULL when it is exhausted. The
+   merge reads ahead one element per input and returns the pointers as they
+   are so an element must stay valid after later calls for its stream until
+   the caller of the merge is done with it. */
+typedef void const *kwm_next_fn(void *);
+
+/* One sorted input. With next set the callback is called with ctx for each
+   element. Otherwise the len pointers in items are the input. */
+struct kwm_input
+{
+    kwm_next_fn *next;
+    void *ctx;
+    void const *const *items;
+    size_t len;
+    size_t pos ATTRIB_PRIVATE;
+};
+
+struct kwm_counters
+{
+    size_t cmps;
+};
+
+/* A node of the heap engine, one per input. */
+struct kwm_node
+{
+    struct hpq_elem elem ATTRIB_PRIVATE;
+    size_t input ATTRIB_PRIVATE;
+};
+
+struct kway_merge
+{
+    struct kwm_input *inputs ATTRIB_PRIVATE;
+    size_t k ATTRIB_PRIVATE;
+    void const **heads ATTRIB_PRIVATE;
+    size_t *tree ATTRIB_PRIVATE;
+    struct kwm_node *nodes ATTRIB_PRIVATE;
+    struct heap_pqueue heap ATTRIB_PRIVATE;
+    enum kwm_engine engine ATTRIB_PRIVATE;
+    kwm_cmp_fn *cmp ATTRIB_PRIVATE;
+    enum kway_threeway_cmp order ATTRIB_PRIVATE;
+    void *aux ATTRIB_PRIVATE;
+#ifdef CONTAINER_PROFILE
+    struct kwm_counters counters ATTRIB_PRIVATE;
+#endif
+};
+
+/* Pulls the first element of every input and plays the first tournament.
+   The inputs array is borrowed and advanced in place. KWMLES merges inputs
+   sorted in ascending order and KWMGRT descending. Returns false if memory
+   could not be allocated. The merge refers to itself once initialized so
+   it must not be moved. */
+bool kwm_init(struct kway_merge *, struct kwm_input *, size_t k,
+              enum kway_threeway_cmp, kwm_cmp_fn *, void *, enum kwm_engine);
+/* The next element of the merged output or NULL when every input is
+   exhausted. */
+void const *kwm_next(struct kway_merge *);
+/* Writes up to max merged elements to out and returns how many were
+   written, 0 only once every input is exhausted. */
+size_t kwm_next_batch(struct kway_merge *, void const **out, size_t max);
+bool kwm_done(struct kway_merge const *);
+void kwm_free(struct kway_merge *);
+struct kwm_counters kwm_profile(struct kway_merge const *);
+void kwm_profile_reset(struct kway_merge *);
+
+#endif
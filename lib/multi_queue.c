@@ -0,0 +1,282 @@
+/* sched_yield when every sampled heap is busy. */
+#define _POSIX_C_SOURCE 200809L
+
+#include "multi_queue.h"
+#include "pqueue.h"
+#include "random.h"
+
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+
+/* Failed samples in a row before a thread yields the processor. The holder
+   of a busy lock may have been preempted, in which case spinning on would
+   only delay it. */
+static unsigned const busy_rounds = 8;
+
+static struct pq_elem *sweep(struct multi_queue *);
+static struct pq_elem *pop_front(struct mq_heap *);
+static bool try_lock(struct multi_queue *, struct mq_heap *);
+static void unlock(struct mq_heap *);
+static void back_off(unsigned *);
+static size_t heap_size(struct mq_heap const *);
+static size_t rand_heap(struct multi_queue const *);
+
+bool
+mq_init(struct multi_queue *const mq, size_t const num_heaps,
+        enum pq_threeway_cmp const order, pq_cmp_fn *const cmp,
+        void *const aux)
+{
+    *mq = (struct multi_queue){
+        .num_heaps = num_heaps,
+        .cmp = cmp,
+        .order = order,
+        .aux = aux,
+    };
+    if (num_heaps < 2)
+    {
+        return false;
+    }
+    mq->heaps = aligned_alloc(MQ_CACHE_LINE, num_heaps * sizeof(*mq->heaps));
+    if (!mq->heaps)
+    {
+        return false;
+    }
+    for (size_t i = 0; i < num_heaps; ++i)
+    {
+        struct mq_heap *const h = &mq->heaps[i];
+        atomic_flag_clear(&h->lock);
+        h->pq = (struct pqueue)PQ_INIT(order, cmp, aux);
+        atomic_init(&h->size, 0);
+    }
+#ifdef CONTAINER_PROFILE
+    atomic_init(&mq->busy, 0);
+    atomic_init(&mq->sweeps, 0);
+#endif
+    return true;
+}
+
+void
+mq_push(struct multi_queue *const mq, struct pq_elem *const e)
+{
+    for (unsigned fails = 0;; back_off(&fails))
+    {
+        struct mq_heap *const h = &mq->heaps[rand_heap(mq)];
+        if (try_lock(mq, h))
+        {
+            pq_push(&h->pq, e);
+            atomic_store_explicit(&h->size, heap_size(h) + 1,
+                                  memory_order_relaxed);
+            unlock(h);
+            return;
+        }
+    }
+}
+
+/* Both locks are only tried so two pops that sample the same heaps in the
+   opposite order cannot deadlock and no lock order is needed. */
+struct pq_elem *
+mq_pop(struct multi_queue *const mq)
+{
+    for (unsigned fails = 0;; back_off(&fails))
+    {
+        size_t const i = rand_heap(mq);
+        size_t j = rand_heap(mq);
+        if (j == i)
+        {
+            j = (j + 1) % mq->num_heaps;
+        }
+        struct mq_heap *const a = &mq->heaps[i];
+        struct mq_heap *const b = &mq->heaps[j];
+        if (!heap_size(a) && !heap_size(b))
+        {
+            PROFILE_INC(mq->sweeps);
+            return sweep(mq);
+        }
+        if (!try_lock(mq, a))
+        {
+            continue;
+        }
+        if (!try_lock(mq, b))
+        {
+            unlock(a);
+            continue;
+        }
+        struct mq_heap *better = a;
+        if (pq_empty(&a->pq))
+        {
+            better = b;
+        }
+        else if (!pq_empty(&b->pq)
+                 && mq->cmp(pq_front(&b->pq), pq_front(&a->pq), mq->aux)
+                        == mq->order)
+        {
+            better = b;
+        }
+        struct pq_elem *const e = pop_front(better);
+        unlock(b);
+        unlock(a);
+        if (e)
+        {
+            return e;
+        }
+    }
+}
+
+size_t
+mq_size(struct multi_queue const *const mq)
+{
+    size_t sz = 0;
+    for (size_t i = 0; i < mq->num_heaps; ++i)
+    {
+        sz += heap_size(&mq->heaps[i]);
+    }
+    return sz;
+}
+
+bool
+mq_empty(struct multi_queue const *const mq)
+{
+    return !mq_size(mq);
+}
+
+size_t
+mq_num_heaps(struct multi_queue const *const mq)
+{
+    return mq->num_heaps;
+}
+
+void
+mq_clear(struct multi_queue *const mq, pq_destructor_fn *const destructor)
+{
+    for (size_t i = 0; destructor && i < mq->num_heaps; ++i)
+    {
+        pq_clear(&mq->heaps[i].pq, destructor);
+    }
+    free(mq->heaps);
+    *mq = (struct multi_queue){0};
+}
+
+bool
+mq_validate(struct multi_queue const *const mq)
+{
+    for (size_t i = 0; i < mq->num_heaps; ++i)
+    {
+        struct mq_heap const *const h = &mq->heaps[i];
+        if (!pq_validate(&h->pq) || pq_size(&h->pq) != heap_size(h))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+struct mq_counters
+mq_profile(struct multi_queue const *const mq)
+{
+#ifdef CONTAINER_PROFILE
+    return (struct mq_counters){
+        .busy = atomic_load(&mq->busy),
+        .sweeps = atomic_load(&mq->sweeps),
+    };
+#else
+    (void)mq;
+    return (struct mq_counters){0};
+#endif
+}
+
+void
+mq_profile_reset(struct multi_queue *const mq)
+{
+#ifdef CONTAINER_PROFILE
+    atomic_store(&mq->busy, 0);
+    atomic_store(&mq->sweeps, 0);
+#else
+    (void)mq;
+#endif
+}
+
+/*===============================  Static Helpers  =========================*/
+
+/* Goes around every heap from a random start and pops the front of the
+   first that is not empty, skipping busy heaps until a round finds every
+   heap empty. */
+static struct pq_elem *
+sweep(struct multi_queue *const mq)
+{
+    for (unsigned fails = 0; !mq_empty(mq); back_off(&fails))
+    {
+        size_t const start = rand_heap(mq);
+        for (size_t k = 0; k < mq->num_heaps; ++k)
+        {
+            struct mq_heap *const h = &mq->heaps[(start + k) % mq->num_heaps];
+            if (!heap_size(h) || !try_lock(mq, h))
+            {
+                continue;
+            }
+            struct pq_elem *const e = pop_front(h);
+            unlock(h);
+            if (e)
+            {
+                return e;
+            }
+        }
+    }
+    return NULL;
+}
+
+static struct pq_elem *
+pop_front(struct mq_heap *const h)
+{
+    if (pq_empty(&h->pq))
+    {
+        return NULL;
+    }
+    struct pq_elem *const e = pq_pop(&h->pq);
+    atomic_store_explicit(&h->size, heap_size(h) - 1, memory_order_relaxed);
+    return e;
+}
+
+static inline bool
+try_lock(struct multi_queue *const mq, struct mq_heap *const h)
+{
+    (void)mq;
+    if (atomic_flag_test_and_set_explicit(&h->lock, memory_order_acquire))
+    {
+        PROFILE_INC(mq->busy);
+        return false;
+    }
+    return true;
+}
+
+static inline void
+unlock(struct mq_heap *const h)
+{
+    atomic_flag_clear_explicit(&h->lock, memory_order_release);
+}
+
+static void
+back_off(unsigned *const fails)
+{
+    if (++*fails % busy_rounds == 0)
+    {
+        (void)sched_yield();
+    }
+}
+
+static inline size_t
+heap_size(struct mq_heap const *const h)
+{
+    return atomic_load_explicit(&h->size, memory_order_relaxed);
+}
+
+static inline size_t
+rand_heap(struct multi_queue const *const mq)
+{
+    return (size_t)(rand_thread_u64() % mq->num_heaps);
+}
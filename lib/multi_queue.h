@@ -0,0 +1,78 @@
+/* A relaxed concurrent priority queue in the style of the MultiQueue. For
+   T threads and a small c it holds cT pairing heaps, each behind a spin
+   lock that is only ever tried, never waited on. A push goes to a random
+   heap whose lock it gets. A pop samples two random heaps, takes both
+   locks, and pops the better of their fronts, sampling again if either
+   lock is busy. No thread waits for another so throughput grows with the
+   number of threads while the popped element stays close to the true
+   front. With cT heaps the expected rank of a popped element among all
+   elements is O(cT).
+
+   The elements are the pq_elem of pqueue.h compared with a pq_cmp_fn. Use
+   a queue for a scheduler or a search where any element near the front
+   will do. For exact order see concurrent_depq.h. */
+#ifndef MULTI_QUEUE
+#define MULTI_QUEUE
+
+#include "attrib.h"
+#include "pqueue.h"
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Heaps are aligned to this so two heaps never share a cache line. */
+#define MQ_CACHE_LINE 64
+
+struct mq_counters
+{
+    /* Lock attempts that found a heap busy. */
+    size_t busy;
+    /* Pops that found both sampled heaps empty and swept the others. */
+    size_t sweeps;
+};
+
+struct mq_heap
+{
+    _Alignas(MQ_CACHE_LINE) atomic_flag lock ATTRIB_PRIVATE;
+    struct pqueue pq ATTRIB_PRIVATE;
+    /* Written under the lock and read without it to skip empty heaps. */
+    atomic_size_t size ATTRIB_PRIVATE;
+};
+
+struct multi_queue
+{
+    struct mq_heap *heaps ATTRIB_PRIVATE;
+    size_t num_heaps ATTRIB_PRIVATE;
+    pq_cmp_fn *cmp ATTRIB_PRIVATE;
+    enum pq_threeway_cmp order ATTRIB_PRIVATE;
+    void *aux ATTRIB_PRIVATE;
+#ifdef CONTAINER_PROFILE
+    atomic_size_t busy ATTRIB_PRIVATE;
+    atomic_size_t sweeps ATTRIB_PRIVATE;
+#endif
+};
+
+/* Initialization and clearing are not thread safe. Every other function
+   may be called from any number of threads at once. Two to four heaps per
+   thread is the usual choice. Returns false if num_heaps is less than 2 or
+   memory could not be allocated. */
+bool mq_init(struct multi_queue *, size_t num_heaps, enum pq_threeway_cmp,
+             pq_cmp_fn *, void *);
+void mq_push(struct multi_queue *, struct pq_elem *);
+/* An element near the front. NULL only if every heap was empty when it was
+   looked at. */
+struct pq_elem *mq_pop(struct multi_queue *);
+/* Exact when no other thread is pushing or popping. */
+size_t mq_size(struct multi_queue const *);
+bool mq_empty(struct multi_queue const *);
+size_t mq_num_heaps(struct multi_queue const *);
+/* Calls the destructor, if not NULL, on every element and frees the
+   heaps. */
+void mq_clear(struct multi_queue *, pq_destructor_fn *);
+/* Not thread safe. Validates every heap and its recorded size. */
+bool mq_validate(struct multi_queue const *);
+struct mq_counters mq_profile(struct multi_queue const *);
+void mq_profile_reset(struct multi_queue *);
+
+#endif
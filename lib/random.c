@@ -1,5 +1,6 @@
 #include "random.h"
 
+#include <stdatomic.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
@@ -31,3 +32,22 @@ rand_shuffle(size_t const elem_size, void *const elems, size_t const n)
         memcpy(elem_view + (i * step), tmp, elem_size);
     }
 }
+
+uint64_t
+rand_thread_u64(void)
+{
+    static atomic_uint_fast64_t seeds = 0;
+    static _Thread_local uint64_t state = 0;
+    if (!state)
+    {
+        uint64_t z = (atomic_fetch_add(&seeds, 1) + 1)
+                     * UINT64_C(0x9E3779B97F4A7C15);
+        z = (z ^ (z >> 30)) * UINT64_C(0xBF58476D1CE4E5B9);
+        z = (z ^ (z >> 27)) * UINT64_C(0x94D049BB133111EB);
+        state = (z ^ (z >> 31)) | 1;
+    }
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
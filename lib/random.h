@@ -2,9 +2,14 @@
 #define RANDOM_H
 
 #include <stddef.h>
+#include <stdint.h>
 
 void rand_seed(unsigned int);
 int rand_range(int, int);
 void rand_shuffle(size_t, void *, size_t);
+/* A xorshift generator per thread so threads that pick at random share no
+   state. Each thread seeds its own from a shared counter. Does not touch
+   the rand() sequence. */
+uint64_t rand_thread_u64(void);
 
 #endif
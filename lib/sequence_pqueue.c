@@ -0,0 +1,523 @@
+#include "sequence_pqueue.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+
+static size_t const prefetch_distance = 2;
+
+static enum sequence_pq_threeway_cmp cmp_elems(struct sequence_pqueue *,
+                                               struct spq_elem const *,
+                                               struct spq_elem const *);
+static void swap(struct spq_elem **, struct spq_elem **);
+static void bubble_up(struct sequence_pqueue *, size_t);
+static void bubble_down(struct sequence_pqueue *, size_t, size_t);
+static bool front_in_del(struct sequence_pqueue *);
+static bool flush(struct sequence_pqueue *);
+static bool make_room(struct sequence_pqueue *);
+static bool merge_level(struct sequence_pqueue *, size_t, struct spq_run *);
+static size_t merge_runs(struct sequence_pqueue *, struct spq_run **, size_t,
+                         struct spq_elem **, size_t);
+static void run_heap_down(struct sequence_pqueue *, struct spq_run **, size_t,
+                          size_t);
+static void refill(struct sequence_pqueue *);
+static void drop_empty_runs(struct sequence_pqueue *);
+static bool is_sorted(struct sequence_pqueue const *,
+                      struct spq_elem *const *, size_t, size_t);
+
+void
+spq_init(struct sequence_pqueue *const spq,
+         enum sequence_pq_threeway_cmp const order, spq_cmp_fn *const cmp,
+         void *const aux)
+{
+    *spq = (struct sequence_pqueue){
+        .cmp = cmp,
+        .order = order,
+        .aux = aux,
+    };
+    spq->ins = malloc(SPQ_INSERT_CAP * sizeof(struct spq_elem *));
+    spq->del = malloc(SPQ_DELETE_CAP * sizeof(struct spq_elem *));
+    if (!spq->ins || !spq->del)
+    {
+        (void)fprintf(stderr, "sequence heap buffers exhausted.\n");
+    }
+}
+
+struct spq_elem const *
+spq_front(struct sequence_pqueue *const spq)
+{
+    if (!spq->sz)
+    {
+        return NULL;
+    }
+    return front_in_del(spq) ? spq->del[spq->del_begin] : spq->ins[0];
+}
+
+bool
+spq_push(struct sequence_pqueue *const spq, struct spq_elem *const e)
+{
+    if (spq->ins_sz == SPQ_INSERT_CAP && !flush(spq))
+    {
+        return false;
+    }
+    spq->ins[spq->ins_sz] = e;
+    bubble_up(spq, spq->ins_sz);
+    ++spq->ins_sz;
+    ++spq->sz;
+    return true;
+}
+
+struct spq_elem *
+spq_pop(struct sequence_pqueue *const spq)
+{
+    if (!spq->sz)
+    {
+        return NULL;
+    }
+    --spq->sz;
+    if (front_in_del(spq))
+    {
+        return spq->del[spq->del_begin++];
+    }
+    struct spq_elem *const ret = spq->ins[0];
+    --spq->ins_sz;
+    spq->ins[0] = spq->ins[spq->ins_sz];
+    bubble_down(spq, 0, spq->ins_sz);
+    return ret;
+}
+
+void
+spq_clear(struct sequence_pqueue *const spq, spq_destructor_fn *const fn)
+{
+    for (size_t l = 0; l < SPQ_LEVELS; ++l)
+    {
+        for (size_t r = 0; r < spq->num_runs[l]; ++r)
+        {
+            struct spq_run const *const run = &spq->runs[l][r];
+            for (size_t i = run->begin; fn && i < run->end; ++i)
+            {
+                fn(run->elems[i]);
+            }
+            free(run->elems);
+        }
+        spq->num_runs[l] = 0;
+    }
+    for (size_t i = spq->del_begin; fn && i < spq->del_end; ++i)
+    {
+        fn(spq->del[i]);
+    }
+    for (size_t i = 0; fn && i < spq->ins_sz; ++i)
+    {
+        fn(spq->ins[i]);
+    }
+    free(spq->ins);
+    free(spq->del);
+    spq->ins = spq->del = NULL;
+    spq->ins_sz = spq->del_begin = spq->del_end = spq->sz = 0;
+    spq->cmp = NULL;
+}
+
+bool
+spq_empty(struct sequence_pqueue const *const spq)
+{
+    if (!spq)
+    {
+        return true;
+    }
+    return !spq->sz;
+}
+
+size_t
+spq_size(struct sequence_pqueue const *const spq)
+{
+    if (!spq)
+    {
+        return 0ULL;
+    }
+    return spq->sz;
+}
+
+/* The insertion buffer must be a heap, the deletion buffer and every run
+   sorted, and no run may hold an element that belongs before the last
+   element of the deletion buffer. Runs are never left empty. */
+bool
+spq_validate(struct sequence_pqueue const *const spq)
+{
+    for (size_t i = 1; i < spq->ins_sz; ++i)
+    {
+        if (spq->cmp(spq->ins[i], spq->ins[(i - 1) / 2], spq->aux)
+            == spq->order)
+        {
+            return false;
+        }
+    }
+    if (!is_sorted(spq, spq->del, spq->del_begin, spq->del_end))
+    {
+        return false;
+    }
+    struct spq_elem const *const last_del
+        = spq->del_begin < spq->del_end ? spq->del[spq->del_end - 1] : NULL;
+    size_t sz = spq->ins_sz + (spq->del_end - spq->del_begin);
+    for (size_t l = 0; l < SPQ_LEVELS; ++l)
+    {
+        for (size_t r = 0; r < spq->num_runs[l]; ++r)
+        {
+            struct spq_run const *const run = &spq->runs[l][r];
+            if (run->begin >= run->end
+                || !is_sorted(spq, run->elems, run->begin, run->end))
+            {
+                return false;
+            }
+            if (last_del
+                && spq->cmp(run->elems[run->begin], last_del, spq->aux)
+                       == spq->order)
+            {
+                return false;
+            }
+            sz += run->end - run->begin;
+        }
+    }
+    return sz == spq->sz;
+}
+
+enum sequence_pq_threeway_cmp
+spq_order(struct sequence_pqueue const *const spq)
+{
+    return spq->order;
+}
+
+struct spq_counters
+spq_profile(struct sequence_pqueue const *const spq)
+{
+#ifdef CONTAINER_PROFILE
+    return spq->counters;
+#else
+    (void)spq;
+    return (struct spq_counters){0};
+#endif
+}
+
+void
+spq_profile_reset(struct sequence_pqueue *const spq)
+{
+#ifdef CONTAINER_PROFILE
+    spq->counters = (struct spq_counters){0};
+#else
+    (void)spq;
+#endif
+}
+
+/*===============================  Static Helpers  =========================*/
+
+/* All comparisons outside of validation go through here so profiling builds
+   can count them. */
+static inline enum sequence_pq_threeway_cmp
+cmp_elems(struct sequence_pqueue *const spq, struct spq_elem const *const a,
+          struct spq_elem const *const b)
+{
+    PROFILE_INC(spq->counters.cmps);
+    return spq->cmp(a, b, spq->aux);
+}
+
+/* Every run element is at or behind the deletion buffer so the front is
+   either the deletion buffer front or the insertion heap front. An empty
+   deletion buffer is refilled first. Assumes the queue is not empty. */
+static bool
+front_in_del(struct sequence_pqueue *const spq)
+{
+    if (spq->del_begin == spq->del_end)
+    {
+        refill(spq);
+        if (spq->del_begin == spq->del_end)
+        {
+            return false;
+        }
+    }
+    return !spq->ins_sz
+           || cmp_elems(spq, spq->ins[0], spq->del[spq->del_begin])
+                  != spq->order;
+}
+
+/* Sorts the full insertion heap into a new run on level 0. The deletion
+   buffer is merged into the run as well because the new elements may
+   belong before it. Nothing changes if an allocation fails. */
+static bool
+flush(struct sequence_pqueue *const spq)
+{
+    if (!make_room(spq))
+    {
+        return false;
+    }
+    size_t const n = spq->ins_sz + (spq->del_end - spq->del_begin);
+    struct spq_elem **const run = malloc(n * sizeof(struct spq_elem *));
+    if (!run)
+    {
+        (void)fprintf(stderr, "sequence heap run allocation failed.\n");
+        return false;
+    }
+    PROFILE_INC(spq->counters.flushes);
+    /* Heap sort in place leaves the front of the heap in the last slot. */
+    for (size_t last = spq->ins_sz - 1; last; --last)
+    {
+        swap(&spq->ins[0], &spq->ins[last]);
+        bubble_down(spq, 0, last);
+    }
+    size_t i = spq->ins_sz;
+    size_t d = spq->del_begin;
+    size_t out = 0;
+    while (i && d < spq->del_end)
+    {
+        if (cmp_elems(spq, spq->del[d], spq->ins[i - 1]) == spq->order)
+        {
+            run[out++] = spq->del[d++];
+        }
+        else
+        {
+            run[out++] = spq->ins[--i];
+        }
+    }
+    while (i)
+    {
+        run[out++] = spq->ins[--i];
+    }
+    while (d < spq->del_end)
+    {
+        run[out++] = spq->del[d++];
+    }
+    spq->ins_sz = spq->del_begin = spq->del_end = 0;
+    spq->runs[0][spq->num_runs[0]++]
+        = (struct spq_run){.elems = run, .begin = 0, .end = n};
+    return true;
+}
+
+/* Frees a slot on level 0 by merging each full level into one run on the
+   level above, starting from the highest full level in the unbroken
+   sequence of full levels so every merge has somewhere to go. A full top
+   level is merged into a single run in place. */
+static bool
+make_room(struct sequence_pqueue *const spq)
+{
+    size_t top = 0;
+    while (top < SPQ_LEVELS && spq->num_runs[top] == SPQ_WAYS)
+    {
+        ++top;
+    }
+    struct spq_run merged;
+    if (top == SPQ_LEVELS)
+    {
+        top = SPQ_LEVELS - 1;
+        if (!merge_level(spq, top, &merged))
+        {
+            return false;
+        }
+        spq->runs[top][spq->num_runs[top]++] = merged;
+    }
+    while (top--)
+    {
+        if (!merge_level(spq, top, &merged))
+        {
+            return false;
+        }
+        spq->runs[top + 1][spq->num_runs[top + 1]++] = merged;
+    }
+    return true;
+}
+
+/* Merges every run on the level into one new run and empties the level. */
+static bool
+merge_level(struct sequence_pqueue *const spq, size_t const level,
+            struct spq_run *const merged)
+{
+    struct spq_run *srcs[SPQ_WAYS];
+    size_t total = 0;
+    for (size_t r = 0; r < spq->num_runs[level]; ++r)
+    {
+        srcs[r] = &spq->runs[level][r];
+        total += srcs[r]->end - srcs[r]->begin;
+    }
+    struct spq_elem **const elems = malloc(total * sizeof(struct spq_elem *));
+    if (!elems)
+    {
+        (void)fprintf(stderr, "sequence heap run allocation failed.\n");
+        return false;
+    }
+    (void)merge_runs(spq, srcs, spq->num_runs[level], elems, total);
+    for (size_t r = 0; r < spq->num_runs[level]; ++r)
+    {
+        free(spq->runs[level][r].elems);
+    }
+    spq->num_runs[level] = 0;
+    *merged = (struct spq_run){.elems = elems, .begin = 0, .end = total};
+    return true;
+}
+
+/* Writes up to limit elements in order from the fronts of the runs to out
+   and advances the runs past them. The runs are kept in a binary heap
+   ordered by their front elements. Returns the number written. */
+static size_t
+merge_runs(struct sequence_pqueue *const spq, struct spq_run **const srcs,
+           size_t const n, struct spq_elem **const out, size_t const limit)
+{
+    struct spq_run *heap[SPQ_LEVELS * SPQ_WAYS];
+    size_t heap_sz = 0;
+    for (size_t r = 0; r < n; ++r)
+    {
+        if (srcs[r]->begin < srcs[r]->end)
+        {
+            heap[heap_sz++] = srcs[r];
+        }
+    }
+    for (size_t i = heap_sz / 2; i--;)
+    {
+        run_heap_down(spq, heap, heap_sz, i);
+    }
+    size_t written = 0;
+    while (written < limit && heap_sz)
+    {
+        struct spq_run *const run = heap[0];
+        out[written++] = run->elems[run->begin++];
+        PROFILE_INC(spq->counters.merge_moves);
+#if defined(__GNUC__) || defined(__clang__)
+        /* The runs are pointer arrays so the elements they point to are
+           scattered. Fetching one ahead hides most of the miss on the
+           comparison that will need it. */
+        if (run->begin + prefetch_distance < run->end)
+        {
+            __builtin_prefetch(run->elems[run->begin + prefetch_distance]);
+        }
+#endif
+        if (run->begin == run->end)
+        {
+            heap[0] = heap[--heap_sz];
+        }
+        run_heap_down(spq, heap, heap_sz, 0);
+    }
+    return written;
+}
+
+static void
+run_heap_down(struct sequence_pqueue *const spq, struct spq_run **const heap,
+              size_t const heap_sz, size_t i)
+{
+    for (size_t left = (i * 2) + 1; left < heap_sz; left = (i * 2) + 1)
+    {
+        size_t const right = left + 1;
+        size_t next = left;
+        if (right < heap_sz
+            && cmp_elems(spq, heap[right]->elems[heap[right]->begin],
+                         heap[left]->elems[heap[left]->begin])
+                   == spq->order)
+        {
+            next = right;
+        }
+        if (cmp_elems(spq, heap[next]->elems[heap[next]->begin],
+                      heap[i]->elems[heap[i]->begin])
+            != spq->order)
+        {
+            return;
+        }
+        struct spq_run *const tmp = heap[i];
+        heap[i] = heap[next];
+        heap[next] = tmp;
+        i = next;
+    }
+}
+
+/* Takes the next elements in order across every run into the empty
+   deletion buffer and frees the runs this exhausts. */
+static void
+refill(struct sequence_pqueue *const spq)
+{
+    struct spq_run *srcs[SPQ_LEVELS * SPQ_WAYS];
+    size_t n = 0;
+    for (size_t l = 0; l < SPQ_LEVELS; ++l)
+    {
+        for (size_t r = 0; r < spq->num_runs[l]; ++r)
+        {
+            srcs[n++] = &spq->runs[l][r];
+        }
+    }
+    spq->del_begin = 0;
+    spq->del_end = merge_runs(spq, srcs, n, spq->del, SPQ_DELETE_CAP);
+    drop_empty_runs(spq);
+}
+
+static void
+drop_empty_runs(struct sequence_pqueue *const spq)
+{
+    for (size_t l = 0; l < SPQ_LEVELS; ++l)
+    {
+        size_t kept = 0;
+        for (size_t r = 0; r < spq->num_runs[l]; ++r)
+        {
+            struct spq_run const run = spq->runs[l][r];
+            if (run.begin == run.end)
+            {
+                free(run.elems);
+            }
+            else
+            {
+                spq->runs[l][kept++] = run;
+            }
+        }
+        spq->num_runs[l] = kept;
+    }
+}
+
+static void
+bubble_up(struct sequence_pqueue *const spq, size_t i)
+{
+    for (size_t parent = (i - 1) / 2;
+         i && cmp_elems(spq, spq->ins[i], spq->ins[parent]) == spq->order;
+         i = parent, parent = (i - 1) / 2)
+    {
+        swap(&spq->ins[parent], &spq->ins[i]);
+    }
+}
+
+static void
+bubble_down(struct sequence_pqueue *const spq, size_t i, size_t const sz)
+{
+    for (size_t left = (i * 2) + 1; left < sz; left = (i * 2) + 1)
+    {
+        size_t const right = left + 1;
+        size_t const next
+            = (right < sz
+               && cmp_elems(spq, spq->ins[right], spq->ins[left])
+                      == spq->order)
+                  ? right
+                  : left;
+        if (cmp_elems(spq, spq->ins[next], spq->ins[i]) != spq->order)
+        {
+            return;
+        }
+        swap(&spq->ins[next], &spq->ins[i]);
+        i = next;
+    }
+}
+
+static inline void
+swap(struct spq_elem **const a, struct spq_elem **const b)
+{
+    struct spq_elem *const tmp = *a;
+    *a = *b;
+    *b = tmp;
+}
+
+static bool
+is_sorted(struct sequence_pqueue const *const spq,
+          struct spq_elem *const *const elems, size_t const begin,
+          size_t const end)
+{
+    for (size_t i = begin + 1; i < end; ++i)
+    {
+        if (spq->cmp(elems[i], elems[i - 1], spq->aux) == spq->order)
+        {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,98 @@
+/* A sequence heap priority queue for queues much larger than the cache.
+   New elements go to a small binary heap. When it fills it is sorted into
+   a run and runs are kept in levels of at most SPQ_WAYS sorted arrays,
+   each level holding runs SPQ_WAYS times longer than the one below. A full
+   level is merged into one run on the next level. The front of the queue
+   is the better of the insertion heap front and a small sorted deletion
+   buffer refilled by a k-way merge of every run. All work on large data is
+   sequential passes over pointer arrays rather than the scattered sifts of
+   a binary heap over N elements. There is no arbitrary erase or update
+   because an element in a run has no handle to find it by. */
+#ifndef SEQUENCE_PQUEUE
+#define SEQUENCE_PQUEUE
+
+#include "attrib.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+/* NOLINTNEXTLINE */
+#include <stdint.h>
+
+#define SPQ_INSERT_CAP (size_t)1024
+#define SPQ_DELETE_CAP (size_t)256
+#define SPQ_WAYS (size_t)16
+#define SPQ_LEVELS (size_t)8
+
+enum sequence_pq_threeway_cmp
+{
+    SPQLES = -1,
+    SPQEQL,
+    SPQGRT,
+};
+
+/* The sequence heap only stores pointers to elements and never links them
+   so the embedded struct only anchors SPQ_ENTRY. */
+struct spq_elem
+{
+    uint8_t unused;
+};
+
+typedef enum sequence_pq_threeway_cmp spq_cmp_fn(struct spq_elem const *,
+                                                 struct spq_elem const *,
+                                                 void *);
+
+typedef void spq_destructor_fn(struct spq_elem *);
+
+struct spq_counters
+{
+    size_t cmps;
+    size_t flushes;
+    size_t merge_moves;
+};
+
+/* A sorted run with the elements in [begin, end) still in the queue. */
+struct spq_run
+{
+    struct spq_elem **elems ATTRIB_PRIVATE;
+    size_t begin ATTRIB_PRIVATE;
+    size_t end ATTRIB_PRIVATE;
+};
+
+struct sequence_pqueue
+{
+    struct spq_elem **ins ATTRIB_PRIVATE;
+    size_t ins_sz ATTRIB_PRIVATE;
+    struct spq_elem **del ATTRIB_PRIVATE;
+    size_t del_begin ATTRIB_PRIVATE;
+    size_t del_end ATTRIB_PRIVATE;
+    struct spq_run runs[SPQ_LEVELS][SPQ_WAYS] ATTRIB_PRIVATE;
+    size_t num_runs[SPQ_LEVELS] ATTRIB_PRIVATE;
+    size_t sz ATTRIB_PRIVATE;
+    spq_cmp_fn *cmp ATTRIB_PRIVATE;
+    enum sequence_pq_threeway_cmp order ATTRIB_PRIVATE;
+    void *aux ATTRIB_PRIVATE;
+#ifdef CONTAINER_PROFILE
+    struct spq_counters counters ATTRIB_PRIVATE;
+#endif
+};
+
+#define SPQ_ENTRY(SPQ_ELEM, STRUCT, MEMBER)                                    \
+    ((STRUCT *)((uint8_t *)&(SPQ_ELEM)->unused                                 \
+                - offsetof(STRUCT, MEMBER.unused))) /* NOLINT */
+
+void spq_init(struct sequence_pqueue *, enum sequence_pq_threeway_cmp,
+              spq_cmp_fn *, void *);
+/* Not const because an empty deletion buffer is refilled from the runs. */
+struct spq_elem const *spq_front(struct sequence_pqueue *);
+/* Returns false and does not push if a run could not be allocated. */
+bool spq_push(struct sequence_pqueue *, struct spq_elem *);
+struct spq_elem *spq_pop(struct sequence_pqueue *);
+void spq_clear(struct sequence_pqueue *, spq_destructor_fn *);
+bool spq_empty(struct sequence_pqueue const *);
+size_t spq_size(struct sequence_pqueue const *);
+bool spq_validate(struct sequence_pqueue const *);
+enum sequence_pq_threeway_cmp spq_order(struct sequence_pqueue const *);
+struct spq_counters spq_profile(struct sequence_pqueue const *);
+void spq_profile_reset(struct sequence_pqueue *);
+
+#endif
@@ -0,0 +1,247 @@
+#include "spsc_queue.h"
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+
+static size_t room(struct spsc_queue *, size_t, size_t);
+static size_t ready(struct spsc_queue *, size_t, size_t);
+static void copy_in(struct spsc_queue *, size_t, void const *, size_t);
+static void copy_out(struct spsc_queue const *, size_t, void *, size_t);
+static void *slot(struct spsc_queue const *, size_t);
+static size_t round_up_pow2(size_t);
+
+bool
+spscq_init(struct spsc_queue *const q, size_t const elem_sz,
+           size_t const capacity)
+{
+    *q = (struct spsc_queue){.elem_sz = elem_sz};
+    atomic_init(&q->back, 0);
+    atomic_init(&q->front, 0);
+    size_t const cap = round_up_pow2(capacity);
+    if (!elem_sz || !cap || cap > SIZE_MAX / elem_sz)
+    {
+        return false;
+    }
+    size_t const bytes = cap * elem_sz;
+    /* aligned_alloc requires a size that is a multiple of the alignment. */
+    q->mem = aligned_alloc(SPSCQ_CACHE_LINE,
+                           (bytes + SPSCQ_CACHE_LINE - 1)
+                               & ~(size_t)(SPSCQ_CACHE_LINE - 1));
+    if (!q->mem)
+    {
+        return false;
+    }
+    q->mask = cap - 1;
+    return true;
+}
+
+void
+spscq_free(struct spsc_queue *const q)
+{
+    free(q->mem);
+    *q = (struct spsc_queue){0};
+}
+
+bool
+spscq_push(struct spsc_queue *const q, void const *const elem)
+{
+    size_t const back = atomic_load_explicit(&q->back, memory_order_relaxed);
+    if (!room(q, back, 1))
+    {
+        return false;
+    }
+    memcpy(slot(q, back), elem, q->elem_sz);
+    atomic_store_explicit(&q->back, back + 1, memory_order_release);
+    return true;
+}
+
+size_t
+spscq_push_n(struct spsc_queue *const q, void const *const elems,
+             size_t const n)
+{
+    size_t const back = atomic_load_explicit(&q->back, memory_order_relaxed);
+    size_t const fit = room(q, back, n);
+    if (fit)
+    {
+        copy_in(q, back, elems, fit);
+        atomic_store_explicit(&q->back, back + fit, memory_order_release);
+    }
+    return fit;
+}
+
+bool
+spscq_pop(struct spsc_queue *const q, void *const out)
+{
+    size_t const front
+        = atomic_load_explicit(&q->front, memory_order_relaxed);
+    if (!ready(q, front, 1))
+    {
+        return false;
+    }
+    memcpy(out, slot(q, front), q->elem_sz);
+    atomic_store_explicit(&q->front, front + 1, memory_order_release);
+    return true;
+}
+
+size_t
+spscq_pop_n(struct spsc_queue *const q, void *const out, size_t const n)
+{
+    size_t const front
+        = atomic_load_explicit(&q->front, memory_order_relaxed);
+    size_t const got = ready(q, front, n);
+    if (got)
+    {
+        copy_out(q, front, out, got);
+        atomic_store_explicit(&q->front, front + got, memory_order_release);
+    }
+    return got;
+}
+
+void *
+spscq_front(struct spsc_queue *const q)
+{
+    size_t const front
+        = atomic_load_explicit(&q->front, memory_order_relaxed);
+    return ready(q, front, 1) ? slot(q, front) : NULL;
+}
+
+size_t
+spscq_size(struct spsc_queue const *const q)
+{
+    size_t const front
+        = atomic_load_explicit(&q->front, memory_order_acquire);
+    size_t const back = atomic_load_explicit(&q->back, memory_order_acquire);
+    /* Front is loaded first so back is never behind it, but the producer
+       may have filled freed slots between the two loads. */
+    size_t const sz = back - front;
+    return sz > q->mask + 1 ? q->mask + 1 : sz;
+}
+
+bool
+spscq_empty(struct spsc_queue const *const q)
+{
+    return !spscq_size(q);
+}
+
+size_t
+spscq_capacity(struct spsc_queue const *const q)
+{
+    return q->mem ? q->mask + 1 : 0;
+}
+
+struct spscq_counters
+spscq_profile(struct spsc_queue const *const q)
+{
+#ifdef CONTAINER_PROFILE
+    return (struct spscq_counters){
+        .producer_reloads = q->producer_reloads,
+        .consumer_reloads = q->consumer_reloads,
+    };
+#else
+    (void)q;
+    return (struct spscq_counters){0};
+#endif
+}
+
+void
+spscq_profile_reset(struct spsc_queue *const q)
+{
+#ifdef CONTAINER_PROFILE
+    q->producer_reloads = 0;
+    q->consumer_reloads = 0;
+#else
+    (void)q;
+#endif
+}
+
+/*===============================  Static Helpers  =========================*/
+
+/* The free slots for the producer at back, up to want. The shared front is
+   loaded only when the copy shows too little room. The acquire pairs with
+   the release of a pop so the slots it freed are no longer being read. */
+static inline size_t
+room(struct spsc_queue *const q, size_t const back, size_t const want)
+{
+    size_t const cap = q->mask + 1;
+    size_t free_slots = cap - (back - q->front_copy);
+    if (free_slots < want)
+    {
+        PROFILE_INC(q->producer_reloads);
+        q->front_copy = atomic_load_explicit(&q->front, memory_order_acquire);
+        free_slots = cap - (back - q->front_copy);
+    }
+    return free_slots < want ? free_slots : want;
+}
+
+/* The elements ready for the consumer at front, up to want. The acquire
+   pairs with the release of a push so the copied elements are visible. */
+static inline size_t
+ready(struct spsc_queue *const q, size_t const front, size_t const want)
+{
+    size_t avail = q->back_copy - front;
+    if (avail < want)
+    {
+        PROFILE_INC(q->consumer_reloads);
+        q->back_copy = atomic_load_explicit(&q->back, memory_order_acquire);
+        avail = q->back_copy - front;
+    }
+    return avail < want ? avail : want;
+}
+
+/* A run of n elements wraps at most once so it is at most two copies. */
+static void
+copy_in(struct spsc_queue *const q, size_t const back, void const *const src,
+        size_t const n)
+{
+    size_t const first = q->mask + 1 - (back & q->mask);
+    size_t const head = n < first ? n : first;
+    memcpy(slot(q, back), src, head * q->elem_sz);
+    if (head < n)
+    {
+        memcpy(q->mem, (uint8_t const *)src + (head * q->elem_sz),
+               (n - head) * q->elem_sz);
+    }
+}
+
+static void
+copy_out(struct spsc_queue const *const q, size_t const front,
+         void *const dst, size_t const n)
+{
+    size_t const first = q->mask + 1 - (front & q->mask);
+    size_t const head = n < first ? n : first;
+    memcpy(dst, slot(q, front), head * q->elem_sz);
+    if (head < n)
+    {
+        memcpy((uint8_t *)dst + (head * q->elem_sz), q->mem,
+               (n - head) * q->elem_sz);
+    }
+}
+
+static inline void *
+slot(struct spsc_queue const *const q, size_t const i)
+{
+    return (uint8_t *)q->mem + ((i & q->mask) * q->elem_sz);
+}
+
+/* 0 for 0 or a capacity too large to round. */
+static size_t
+round_up_pow2(size_t const n)
+{
+    if (!n || n > (SIZE_MAX >> 1) + 1)
+    {
+        return 0;
+    }
+    size_t cap = 1;
+    while (cap < n)
+    {
+        cap <<= 1;
+    }
+    return cap;
+}
@@ -0,0 +1,87 @@
+/* A fixed capacity ring for passing elements from exactly one producer
+   thread to exactly one consumer thread without a lock. It is the two
+   thread counterpart of queue.h. The capacity is a power of two so a
+   position in the ring is a mask of a counter that only grows, and the
+   producer and consumer each publish their counter with a release store
+   that the other side reads with an acquire load.
+
+   Each side keeps a copy of the other side's counter and reads the shared
+   one only when the copy says the ring is full or empty. Each side's
+   fields sit on their own cache line, so the line holding a counter moves
+   between the two cores only when the copy runs out, not on every
+   element. The batch calls move many elements with one or two memcpy
+   calls and one release store. */
+#ifndef SPSC_QUEUE
+#define SPSC_QUEUE
+
+#include "attrib.h"
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* The producer and consumer fields are aligned to this so the two sides
+   never share a cache line. */
+#define SPSCQ_CACHE_LINE 64
+
+struct spscq_counters
+{
+    /* Pushes that found the ring full by their copy of the consumer
+       counter and loaded the shared one. */
+    size_t producer_reloads;
+    /* Pops that found the ring empty by their copy of the producer counter
+       and loaded the shared one. */
+    size_t consumer_reloads;
+};
+
+struct spsc_queue
+{
+    /* Written once at initialization. */
+    _Alignas(SPSCQ_CACHE_LINE) void *mem ATTRIB_PRIVATE;
+    size_t elem_sz ATTRIB_PRIVATE;
+    size_t mask ATTRIB_PRIVATE;
+    /* The producer side. */
+    _Alignas(SPSCQ_CACHE_LINE) atomic_size_t back ATTRIB_PRIVATE;
+    size_t front_copy ATTRIB_PRIVATE;
+#ifdef CONTAINER_PROFILE
+    size_t producer_reloads ATTRIB_PRIVATE;
+#endif
+    /* The consumer side. */
+    _Alignas(SPSCQ_CACHE_LINE) atomic_size_t front ATTRIB_PRIVATE;
+    size_t back_copy ATTRIB_PRIVATE;
+#ifdef CONTAINER_PROFILE
+    size_t consumer_reloads ATTRIB_PRIVATE;
+#endif
+};
+
+/* The capacity is rounded up to a power of two. Returns false if the
+   element size or capacity is 0 or memory could not be allocated.
+   Initialization and freeing are not thread safe. */
+bool spscq_init(struct spsc_queue *, size_t elem_sz, size_t capacity);
+void spscq_free(struct spsc_queue *);
+
+/* Producer only. Copies the element in and returns false if the ring is
+   full. */
+bool spscq_push(struct spsc_queue *, void const *elem);
+/* Producer only. Copies up to n elements from the array and returns how
+   many fit. */
+size_t spscq_push_n(struct spsc_queue *, void const *elems, size_t n);
+
+/* Consumer only. Copies the front element out and returns false if the
+   ring is empty. */
+bool spscq_pop(struct spsc_queue *, void *out);
+/* Consumer only. Copies up to n elements into the array and returns how
+   many were there. */
+size_t spscq_pop_n(struct spsc_queue *, void *out, size_t n);
+/* Consumer only. The front element in place or NULL if the ring is empty.
+   It stays valid until the next pop. */
+void *spscq_front(struct spsc_queue *);
+
+/* Exact only when neither side is running, otherwise a recent value. */
+size_t spscq_size(struct spsc_queue const *);
+bool spscq_empty(struct spsc_queue const *);
+size_t spscq_capacity(struct spsc_queue const *);
+struct spscq_counters spscq_profile(struct spsc_queue const *);
+void spscq_profile_reset(struct spsc_queue *);
+
+#endif
@@ -0,0 +1,233 @@
+/* A queue generated for one element type so every push and pop is a typed
+   assignment the compiler can inline rather than a memcpy of a size known
+   only at runtime. The capacity is a power of two so a position is a mask
+   of a counter that only grows, and the ring doubles when it is full.
+
+   A producer that knows how many elements it may write can reserve the
+   slots and write them in place, then commit how many it wrote. Reserved
+   slots and batches of popped elements come as at most two spans because
+   a run of slots wraps around the end of the ring at most once.
+
+   The macro declares the queue struct, a spans struct, and static inline
+   functions prefixed by the name. For example:
+
+     TYPED_QUEUE(point_queue, struct point)
+
+     struct point_queue q;
+     point_queue_init(&q, 64);
+     point_queue_push(&q, (struct point){1, 2});
+     struct point p;
+     while (point_queue_pop(&q, &p)) { ... }
+     point_queue_free(&q);
+
+   The queue is not thread safe. For two threads see spsc_queue.h. */
+#ifndef TYPED_QUEUE_H
+#define TYPED_QUEUE_H
+
+#include "attrib.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Declares the queue of TYPE called NAME and its functions. Use it once per
+   element type at file scope. */
+#define TYPED_QUEUE(NAME, TYPE)                                                \
+struct NAME                                                                    \
+{                                                                              \
+    TYPE *buf ATTRIB_PRIVATE;                                                  \
+    size_t mask ATTRIB_PRIVATE;                                                \
+    size_t front ATTRIB_PRIVATE;                                               \
+    size_t back ATTRIB_PRIVATE;                                                \
+    size_t reserved ATTRIB_PRIVATE;                                            \
+};                                                                             \
+                                                                               \
+/* Up to two runs of slots in ring order. The second is empty unless the       \
+   run wraps around the end of the ring. */                                    \
+struct NAME##_spans                                                            \
+{                                                                              \
+    TYPE *first;                                                               \
+    size_t first_len;                                                          \
+    TYPE *second;                                                              \
+    size_t second_len;                                                         \
+};                                                                             \
+                                                                               \
+/* The functions are the implementation so the warning on private fields is    \
+   silenced for them alone. */                                                 \
+_Pragma("GCC diagnostic push")                                                 \
+_Pragma("GCC diagnostic ignored \"-Wdeprecated-declarations\"")                \
+                                                                               \
+/* Rounds the capacity up to a power of two, at least 1. Returns false if      \
+   memory could not be allocated. */                                           \
+static inline bool                                                             \
+NAME##_init(struct NAME *const q, size_t const capacity)                       \
+{                                                                              \
+    size_t cap = 1;                                                            \
+    while (cap < capacity && cap <= SIZE_MAX / (2 * sizeof(TYPE)))             \
+    {                                                                          \
+        cap <<= 1;                                                             \
+    }                                                                          \
+    *q = (struct NAME){.buf = malloc(cap * sizeof(TYPE)), .mask = cap - 1};    \
+    return q->buf != NULL;                                                     \
+}                                                                              \
+                                                                               \
+static inline void                                                             \
+NAME##_free(struct NAME *const q)                                              \
+{                                                                              \
+    free(q->buf);                                                              \
+    *q = (struct NAME){0};                                                     \
+}                                                                              \
+                                                                               \
+static inline size_t                                                           \
+NAME##_size(struct NAME const *const q)                                        \
+{                                                                              \
+    return q->back - q->front;                                                 \
+}                                                                              \
+                                                                               \
+static inline bool                                                             \
+NAME##_empty(struct NAME const *const q)                                       \
+{                                                                              \
+    return q->back == q->front;                                                \
+}                                                                              \
+                                                                               \
+static inline size_t                                                           \
+NAME##_capacity(struct NAME const *const q)                                    \
+{                                                                              \
+    return q->buf ? q->mask + 1 : 0;                                           \
+}                                                                              \
+                                                                               \
+/* The spans of n slots from position i. */                                    \
+static inline struct NAME##_spans                                              \
+NAME##_spans_from(struct NAME const *const q, size_t const i,                  \
+                  size_t const n)                                              \
+{                                                                              \
+    size_t const to_end = q->mask + 1 - (i & q->mask);                         \
+    size_t const first_len = n < to_end ? n : to_end;                          \
+    return (struct NAME##_spans){                                              \
+        .first = q->buf + (i & q->mask),                                       \
+        .first_len = first_len,                                                \
+        .second = q->buf,                                                      \
+        .second_len = n - first_len,                                           \
+    };                                                                         \
+}                                                                              \
+                                                                               \
+/* Grows to the smallest doubling with room for n more elements and copies     \
+   the elements to the start of the new ring. Returns false if memory could    \
+   not be allocated and leaves the queue as it was. */                         \
+static inline bool                                                             \
+NAME##_reserve_room(struct NAME *const q, size_t const n)                      \
+{                                                                              \
+    size_t const sz = NAME##_size(q);                                          \
+    size_t cap = q->mask + 1;                                                  \
+    if (cap - sz >= n)                                                         \
+    {                                                                          \
+        return true;                                                           \
+    }                                                                          \
+    while (cap - sz < n)                                                       \
+    {                                                                          \
+        if (cap > SIZE_MAX / (2 * sizeof(TYPE)))                               \
+        {                                                                      \
+            return false;                                                      \
+        }                                                                      \
+        cap <<= 1;                                                             \
+    }                                                                          \
+    TYPE *const buf = malloc(cap * sizeof(TYPE));                              \
+    if (!buf)                                                                  \
+    {                                                                          \
+        return false;                                                          \
+    }                                                                          \
+    struct NAME##_spans const s = NAME##_spans_from(q, q->front, sz);          \
+    memcpy(buf, s.first, s.first_len * sizeof(TYPE));                          \
+    memcpy(buf + s.first_len, s.second, s.second_len * sizeof(TYPE));          \
+    free(q->buf);                                                              \
+    *q = (struct NAME){.buf = buf, .mask = cap - 1, .front = 0, .back = sz};   \
+    return true;                                                               \
+}                                                                              \
+                                                                               \
+/* Returns false only if the ring was full and could not grow. */              \
+static inline bool                                                             \
+NAME##_push(struct NAME *const q, TYPE const elem)                             \
+{                                                                              \
+    if (q->back - q->front > q->mask && !NAME##_reserve_room(q, 1))            \
+    {                                                                          \
+        return false;                                                          \
+    }                                                                          \
+    q->buf[q->back & q->mask] = elem;                                          \
+    ++q->back;                                                                 \
+    q->reserved = 0;                                                           \
+    return true;                                                               \
+}                                                                              \
+                                                                               \
+/* NULL if the queue is empty. Valid until the next push or reserve. */        \
+static inline TYPE *                                                           \
+NAME##_front(struct NAME const *const q)                                       \
+{                                                                              \
+    return NAME##_empty(q) ? NULL : &q->buf[q->front & q->mask];               \
+}                                                                              \
+                                                                               \
+/* Copies the front out and removes it. Returns false if the queue is          \
+   empty. */                                                                   \
+static inline bool                                                             \
+NAME##_pop(struct NAME *const q, TYPE *const out)                              \
+{                                                                              \
+    if (NAME##_empty(q))                                                       \
+    {                                                                          \
+        return false;                                                          \
+    }                                                                          \
+    *out = q->buf[q->front & q->mask];                                         \
+    ++q->front;                                                                \
+    return true;                                                               \
+}                                                                              \
+                                                                               \
+/* Removes up to n elements from the front and returns them in place. They     \
+   stay valid until the next push or reserve, which may reuse the slots. */    \
+static inline struct NAME##_spans                                              \
+NAME##_pop_n(struct NAME *const q, size_t const n)                             \
+{                                                                              \
+    size_t const sz = NAME##_size(q);                                          \
+    struct NAME##_spans const s                                                \
+        = NAME##_spans_from(q, q->front, n < sz ? n : sz);                     \
+    q->front += s.first_len + s.second_len;                                    \
+    return s;                                                                  \
+}                                                                              \
+                                                                               \
+/* Grows the ring if needed and returns n free slots after the back to         \
+   write in place. Both spans are empty if the ring could not grow. The        \
+   slots join the queue only once committed and a push or another reserve      \
+   gives them up. */                                                           \
+static inline struct NAME##_spans                                              \
+NAME##_reserve(struct NAME *const q, size_t const n)                           \
+{                                                                              \
+    if (!NAME##_reserve_room(q, n))                                            \
+    {                                                                          \
+        q->reserved = 0;                                                       \
+        return (struct NAME##_spans){0};                                       \
+    }                                                                          \
+    q->reserved = n;                                                           \
+    return NAME##_spans_from(q, q->back, n);                                   \
+}                                                                              \
+                                                                               \
+/* Adds the first n slots of the last reserve to the back of the queue and     \
+   ends the reserve. Returns how many were added, fewer than n only if         \
+   fewer slots were reserved. */                                               \
+static inline size_t                                                           \
+NAME##_commit(struct NAME *const q, size_t const n)                            \
+{                                                                              \
+    size_t const added = n < q->reserved ? n : q->reserved;                    \
+    q->back += added;                                                          \
+    q->reserved = 0;                                                           \
+    return added;                                                              \
+}                                                                              \
+                                                                               \
+/* The slot i of spans in ring order. */                                       \
+static inline TYPE *                                                           \
+NAME##_span_at(struct NAME##_spans const *const s, size_t const i)             \
+{                                                                              \
+    return i < s->first_len ? s->first + i : s->second + (i - s->first_len);   \
+}                                                                              \
+                                                                               \
+_Pragma("GCC diagnostic pop")
+
+#endif
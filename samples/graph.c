@@ -1,9 +1,9 @@
 #include "cli.h"
 #include "pqueue.h"
-#include "queue.h"
 #include "random.h"
 #include "set.h"
 #include "str_view/str_view.h"
+#include "typed_queue.h"
 
 #include <alloca.h>
 #include <assert.h>
@@ -23,6 +23,9 @@ struct point
     int c;
 };
 
+/* The breadth first search frontier of points. */
+TYPED_QUEUE(point_queue, struct point)
+
 struct parent_cell
 {
     struct point key;
@@ -428,19 +431,20 @@ has_built_edge(struct graph *const graph, struct vertex *const src,
 {
     Cell const edge_id = sort_vertices(src->name, dst->name) << edge_id_shift;
     struct set parent_map = SET_INIT(parent_map, cmp_parent_cells, NULL);
-    struct queue bfs;
-    q_init(sizeof(struct point), &bfs, 4);
+    struct point_queue bfs;
+    if (!point_queue_init(&bfs, 4))
+    {
+        quit("Heap exhausted.\n", 1);
+    }
     (void)insert_parent_cell(&parent_map, (struct parent_cell){
                                               .key = src->pos,
                                               .parent = (struct point){-1, -1},
                                           });
-    q_push(&bfs, &src->pos);
+    (void)point_queue_push(&bfs, src->pos);
     bool success = false;
     struct point cur = {0};
-    while (!q_empty(&bfs))
+    while (point_queue_pop(&bfs, &cur))
     {
-        cur = *((struct point *)q_front(&bfs));
-        q_pop(&bfs);
         Cell const cur_cell = grid_at(graph, cur);
         if (is_dst(cur_cell, dst->name))
         {
@@ -460,7 +464,10 @@ has_built_edge(struct graph *const graph, struct vertex *const src,
                     && !set_contains(&parent_map, &push.elem)))
             {
                 (void)insert_parent_cell(&parent_map, push);
-                q_push(&bfs, &next);
+                if (!point_queue_push(&bfs, next))
+                {
+                    quit("Heap exhausted.\n", 1);
+                }
             }
         }
     }
@@ -494,7 +501,7 @@ has_built_edge(struct graph *const graph, struct vertex *const src,
         add_edge_cost_label(graph, dst, &edge);
     }
     set_clear(&parent_map, set_parent_point_destructor);
-    q_free(&bfs);
+    point_queue_free(&bfs);
     return success;
 }
 
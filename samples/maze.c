@@ -4,7 +4,10 @@
    This file provides a simple maze builder that implements Prim's algorithm
    to randomly generate a maze. I chose this algorithm because it can use
    both a set and a priority queue to acheive its purpose. Such data structures
-   are provided by the library offering a perfect sample program opportunity. */
+   are provided by the library offering a perfect sample program opportunity.
+   The costs are small integers so the bucket queue may replace the DEPQ
+   with the -b flag. */
+#include "bucket_pqueue.h"
 #include "cli.h"
 #include "depqueue.h"
 #include "random.h"
@@ -45,6 +48,7 @@ struct maze
     int rows;
     int cols;
     enum speed speed;
+    bool bucket_queue;
     uint16_t *maze;
 };
 
@@ -55,6 +59,16 @@ struct priority_cell
     struct point cell;
     int priority;
     struct depq_elem elem;
+    struct bpq_elem bucket_elem;
+};
+
+/* The frontier of cells for Prim's algorithm held in whichever priority
+   queue the user picked. Both pop the max cost with round robin ties. */
+struct frontier
+{
+    bool bucket_queue;
+    struct depqueue dq;
+    struct bucket_pqueue bq;
 };
 
 struct point_cost
@@ -66,6 +80,10 @@ struct point_cost
 
 /*======================   Maze Constants   =================================*/
 
+/* Cell costs are drawn from [0, MAX_COST] and the bucket queue needs one
+   bucket for each. */
+#define MAX_COST 100
+
 char const *walls[] = {
     "■", "╵", "╶", "└", "╷", "│", "┌", "├",
     "╴", "┘", "─", "┴", "┐", "┤", "┬", "┼",
@@ -82,6 +100,7 @@ str_view const rows = SV("-r=");
 str_view const cols = SV("-c=");
 str_view const speed = SV("-s=");
 str_view const help_flag = SV("-h");
+str_view const bucket_flag = SV("-b");
 str_view const escape = SV("\033[");
 str_view const semi_colon = SV(";");
 str_view const cursor_pos_specifier = SV("f");
@@ -119,6 +138,10 @@ static void help(void);
 static struct point pick_rand_point(struct maze const *);
 static dpq_threeway_cmp cmp_priority_cells(struct depq_elem const *,
                                            struct depq_elem const *, void *);
+static void frontier_push(struct frontier *, struct priority_cell *);
+static struct priority_cell *frontier_max(struct frontier *);
+static struct priority_cell *frontier_pop_max(struct frontier *);
+static bool frontier_empty(struct frontier const *);
 static set_threeway_cmp cmp_points(struct set_elem const *,
                                    struct set_elem const *, void *);
 static void set_destructor(struct set_elem *);
@@ -137,6 +160,7 @@ main(int argc, char **argv)
         .rows = default_rows,
         .cols = default_cols,
         .speed = default_speed,
+        .bucket_queue = false,
         .maze = NULL,
     };
     for (int i = 1; i < argc; ++i)
@@ -174,10 +198,14 @@ main(int argc, char **argv)
         {
             help();
         }
+        else if (sv_cmp(arg, bucket_flag) == SV_EQL)
+        {
+            maze.bucket_queue = true;
+        }
         else
         {
-            quit("can only specify rows, columns, or speed "
-                 "for now (-r=N, -c=N, -s=N)\n",
+            quit("can only specify rows, columns, speed, or the bucket "
+                 "queue for now (-r=N, -c=N, -s=N, -b)\n",
                  1);
         }
     }
@@ -204,12 +232,17 @@ animate_maze(struct maze *maze)
        A set could be replaced by a 2D vector copy of the maze with costs
        mapped but the purpose of this program is to test both the set
        and priority queue data structures. Also a 2D vector wastes space. */
-    struct depqueue cells = DEPQ_INIT(cells, cmp_priority_cells, NULL);
+    struct bpq_elem *cost_buckets[MAX_COST + 1] = {0};
+    struct frontier cells = {
+        .bucket_queue = maze->bucket_queue,
+        .dq = DEPQ_INIT(cells.dq, cmp_priority_cells, NULL),
+        .bq = BPQ_INIT(cost_buckets, MAX_COST + 1),
+    };
     struct set cell_costs = SET_INIT(cell_costs, cmp_points, NULL);
     struct point_cost *odd_point = valid_malloc(sizeof(struct point_cost));
     *odd_point = (struct point_cost){
         .p = pick_rand_point(maze),
-        .cost = rand_range(0, 100),
+        .cost = rand_range(0, MAX_COST),
     };
     (void)set_insert(&cell_costs, &odd_point->elem);
     struct priority_cell *start = valid_malloc(sizeof(struct priority_cell));
@@ -217,15 +250,14 @@ animate_maze(struct maze *maze)
         .cell = odd_point->p,
         .priority = odd_point->cost,
     };
-    (void)depq_push(&cells, &start->elem);
+    frontier_push(&cells, start);
 
     int const animation_speed = speeds[maze->speed];
     fill_maze_with_walls(maze);
     clear_and_flush_maze(maze);
-    while (!depq_empty(&cells))
+    while (!frontier_empty(&cells))
     {
-        struct priority_cell const *const cur
-            = DEPQ_ENTRY(depq_max(&cells), struct priority_cell, elem);
+        struct priority_cell const *const cur = frontier_max(&cells);
         *maze_at_mut(maze, cur->cell) |= cached_bit;
         struct point min_neighbor = {0};
         int min_weight = INT_MAX;
@@ -249,7 +281,7 @@ animate_maze(struct maze *maze)
                     = valid_malloc(sizeof(struct point_cost));
                 *new_cost = (struct point_cost){
                     .p = next,
-                    .cost = rand_range(0, 100),
+                    .cost = rand_range(0, MAX_COST),
                 };
                 cur_weight = new_cost->cost;
                 assert(set_insert(&cell_costs, &new_cost->elem));
@@ -274,13 +306,11 @@ animate_maze(struct maze *maze)
                 .cell = min_neighbor,
                 .priority = min_weight,
             };
-            depq_push(&cells, &new_cell->elem);
+            frontier_push(&cells, new_cell);
         }
         else
         {
-            struct priority_cell *pc
-                = DEPQ_ENTRY(depq_pop_max(&cells), struct priority_cell, elem);
-            free(pc);
+            free(frontier_pop_max(&cells));
         }
     }
     /* The priority queue does not need to be cleared because it's emptiness
@@ -471,6 +501,46 @@ can_build_new_square(struct maze const *const maze, struct point const next)
            && next.c < maze->cols - 1 && !(maze_at(maze, next) & cached_bit);
 }
 
+/*=====================   Frontier Priority Queue   =========================*/
+
+static void
+frontier_push(struct frontier *const f, struct priority_cell *const pc)
+{
+    if (f->bucket_queue)
+    {
+        (void)bpq_push(&f->bq, &pc->bucket_elem, (size_t)pc->priority);
+        return;
+    }
+    depq_push(&f->dq, &pc->elem);
+}
+
+static struct priority_cell *
+frontier_max(struct frontier *const f)
+{
+    if (f->bucket_queue)
+    {
+        return BPQ_ENTRY(bpq_max(&f->bq), struct priority_cell, bucket_elem);
+    }
+    return DEPQ_ENTRY(depq_max(&f->dq), struct priority_cell, elem);
+}
+
+static struct priority_cell *
+frontier_pop_max(struct frontier *const f)
+{
+    if (f->bucket_queue)
+    {
+        return BPQ_ENTRY(bpq_pop_max(&f->bq), struct priority_cell,
+                         bucket_elem);
+    }
+    return DEPQ_ENTRY(depq_pop_max(&f->dq), struct priority_cell, elem);
+}
+
+static bool
+frontier_empty(struct frontier const *const f)
+{
+    return f->bucket_queue ? bpq_empty(&f->bq) : depq_empty(&f->dq);
+}
+
 /*===================   Data Structure Comparators   ========================*/
 
 static dpq_threeway_cmp
@@ -552,5 +622,7 @@ help(void)
                   "row flag lets you specify maze rows > 7.\n-c=N The col flag "
                   "lets you specify maze cols > 7.\n-s=N The speed flag lets "
                   "you specify the speed of the animation "
-                  "0-7.\nExample:\n./build/rel/maze -c=111 -r=33 -s=4\n");
+                  "0-7.\n-b The bucket flag builds the maze with the bucket "
+                  "queue instead of the DEPQ.\nExample:\n./build/rel/maze "
+                  "-c=111 -r=33 -s=4\n");
 }
@@ -0,0 +1,262 @@
+#include "bucket_pqueue.h"
+#include "attrib.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/*=========================  Function Prototypes   ==========================*/
+
+static void splice(struct bucket_pqueue *, struct bpq_elem *);
+static void unlink_elem(struct bucket_pqueue *, struct bpq_elem *);
+static struct bpq_elem *find_max(struct bucket_pqueue *);
+static struct bpq_elem *find_min(struct bucket_pqueue *);
+
+/*=========================  Interface Functions   ==========================*/
+
+bool
+bpq_push(struct bucket_pqueue *const bq, struct bpq_elem *const e,
+         size_t const priority)
+{
+    if (!e || !bq || priority >= bq->num_buckets)
+    {
+        return false;
+    }
+    e->priority = priority;
+    splice(bq, e);
+    ++bq->sz;
+    return true;
+}
+
+struct bpq_elem *
+bpq_pop_max(struct bucket_pqueue *const bq)
+{
+    struct bpq_elem *const e = find_max(bq);
+    if (e)
+    {
+        unlink_elem(bq, e);
+        --bq->sz;
+    }
+    return e;
+}
+
+struct bpq_elem *
+bpq_pop_min(struct bucket_pqueue *const bq)
+{
+    struct bpq_elem *const e = find_min(bq);
+    if (e)
+    {
+        unlink_elem(bq, e);
+        --bq->sz;
+    }
+    return e;
+}
+
+struct bpq_elem *
+bpq_max(struct bucket_pqueue *const bq)
+{
+    return find_max(bq);
+}
+
+struct bpq_elem *
+bpq_min(struct bucket_pqueue *const bq)
+{
+    return find_min(bq);
+}
+
+struct bpq_elem *
+bpq_erase(struct bucket_pqueue *const bq, struct bpq_elem *const e)
+{
+    if (!e->next)
+    {
+        return NULL;
+    }
+    unlink_elem(bq, e);
+    --bq->sz;
+    return e;
+}
+
+bool
+bpq_update(struct bucket_pqueue *const bq, struct bpq_elem *const e,
+           size_t const priority)
+{
+    if (!e->next || priority >= bq->num_buckets)
+    {
+        return false;
+    }
+    unlink_elem(bq, e);
+    e->priority = priority;
+    splice(bq, e);
+    return true;
+}
+
+size_t
+bpq_priority(struct bpq_elem const *const e)
+{
+    return e->priority;
+}
+
+bool
+bpq_empty(struct bucket_pqueue const *const bq)
+{
+    return !bq->sz;
+}
+
+size_t
+bpq_size(struct bucket_pqueue const *const bq)
+{
+    return bq->sz;
+}
+
+size_t
+bpq_num_buckets(struct bucket_pqueue const *const bq)
+{
+    return bq->num_buckets;
+}
+
+struct bpq_counters
+bpq_profile(struct bucket_pqueue const *const bq)
+{
+#ifdef CONTAINER_PROFILE
+    return bq->counters;
+#else
+    (void)bq;
+    return (struct bpq_counters){0};
+#endif
+}
+
+void
+bpq_profile_reset(struct bucket_pqueue *const bq)
+{
+#ifdef CONTAINER_PROFILE
+    bq->counters = (struct bpq_counters){0};
+#else
+    (void)bq;
+#endif
+}
+
+void
+bpq_clear(struct bucket_pqueue *const bq, bpq_destructor_fn *const fn)
+{
+    while (!bpq_empty(bq))
+    {
+        fn(bpq_pop_min(bq));
+    }
+    bq->lo = bq->num_buckets;
+    bq->hi = 0;
+}
+
+bool
+bpq_validate(struct bucket_pqueue const *const bq)
+{
+    size_t sz = 0;
+    for (size_t b = 0; b < bq->num_buckets; ++b)
+    {
+        struct bpq_elem const *const head = bq->buckets[b];
+        if (!head)
+        {
+            continue;
+        }
+        if (b < bq->lo || b > bq->hi)
+        {
+            return false;
+        }
+        struct bpq_elem const *e = head;
+        do
+        {
+            if (!e->next || e->next->prev != e || e->priority != b)
+            {
+                return false;
+            }
+            if (++sz > bq->sz)
+            {
+                return false;
+            }
+            e = e->next;
+        } while (e != head);
+    }
+    return sz == bq->sz;
+}
+
+/*=========================   Static Helpers   ==============================*/
+
+/* Adds the element at the back of its bucket, just before the oldest, and
+   widens the cached bounds if needed. */
+static void
+splice(struct bucket_pqueue *const bq, struct bpq_elem *const e)
+{
+    size_t const b = e->priority;
+    struct bpq_elem *const head = bq->buckets[b];
+    if (!head)
+    {
+        e->next = e->prev = e;
+        bq->buckets[b] = e;
+    }
+    else
+    {
+        e->next = head;
+        e->prev = head->prev;
+        head->prev->next = e;
+        head->prev = e;
+    }
+    if (b < bq->lo)
+    {
+        bq->lo = b;
+    }
+    if (b > bq->hi)
+    {
+        bq->hi = b;
+    }
+}
+
+/* Removes the element from its bucket. A removed element has no links
+   which is how the interface tells it is not in a bucket queue. The
+   cached bounds are left for the next scan to tighten. */
+static void
+unlink_elem(struct bucket_pqueue *const bq, struct bpq_elem *const e)
+{
+    size_t const b = e->priority;
+    if (e->next == e)
+    {
+        bq->buckets[b] = NULL;
+    }
+    else
+    {
+        e->prev->next = e->next;
+        e->next->prev = e->prev;
+        if (bq->buckets[b] == e)
+        {
+            bq->buckets[b] = e->next;
+        }
+    }
+    e->next = e->prev = NULL;
+}
+
+static struct bpq_elem *
+find_max(struct bucket_pqueue *const bq)
+{
+    if (!bq->sz)
+    {
+        return NULL;
+    }
+    while (!bq->buckets[bq->hi])
+    {
+        PROFILE_INC(bq->counters.skips);
+        --bq->hi;
+    }
+    return bq->buckets[bq->hi];
+}
+
+static struct bpq_elem *
+find_min(struct bucket_pqueue *const bq)
+{
+    if (!bq->sz)
+    {
+        return NULL;
+    }
+    while (!bq->buckets[bq->lo])
+    {
+        PROFILE_INC(bq->counters.skips);
+        ++bq->lo;
+    }
+    return bq->buckets[bq->lo];
+}
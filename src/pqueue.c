@@ -1,4 +1,5 @@
 #include "pqueue.h"
+#include "attrib.h"
 
 #include <stdbool.h>
 #include <stddef.h>
@@ -14,8 +15,16 @@ static bool has_valid_links(struct pqueue const *, struct pq_elem const *parent,
                             struct pq_elem const *child);
 static struct pq_elem *delete(struct pqueue *, struct pq_elem *);
 static struct pq_elem *delete_min(struct pqueue *, struct pq_elem *);
+static struct pq_elem *front_to_back(struct pqueue *, struct pq_elem *);
+static struct pq_elem *two_pass(struct pqueue *, struct pq_elem *);
+static struct pq_elem *multipass(struct pqueue *, struct pq_elem *);
+static struct pq_elem *meld(struct pqueue *, struct pq_elem *);
 static void clear_node(struct pq_elem *);
+static void cut(struct pqueue *, struct pq_elem *);
 static void cut_child(struct pq_elem *);
+static struct pq_elem *next_preorder(struct pq_elem const *);
+static void push_pending(struct pqueue *, struct pq_elem *);
+static void flush_pending(struct pqueue *);
 
 /*=========================  Interface Functions   ==========================*/
 
@@ -33,8 +42,20 @@ pq_push(struct pqueue *const ppq, struct pq_elem *const e)
         return;
     }
     init_node(e);
-    ppq->root = fair_merge(ppq, ppq->root, e);
     ++ppq->sz;
+    if (ppq->pending && ppq->root)
+    {
+        PROFILE_INC(ppq->counters.cmps);
+        if (ppq->cmp(e, ppq->root, ppq->aux) != ppq->order)
+        {
+            push_pending(ppq, e);
+            return;
+        }
+        link_child(e, ppq->root);
+        ppq->root = e;
+        return;
+    }
+    ppq->root = meld(ppq, e);
 }
 
 struct pq_elem *
@@ -44,6 +65,7 @@ pq_pop(struct pqueue *const ppq)
     {
         return NULL;
     }
+    flush_pending(ppq);
     struct pq_elem *const popped = ppq->root;
     ppq->root = delete_min(ppq, ppq->root);
     ppq->sz--;
@@ -51,6 +73,46 @@ pq_pop(struct pqueue *const ppq)
     return popped;
 }
 
+struct pq_elem *
+pq_replace_front(struct pqueue *const ppq, struct pq_elem *const e)
+{
+    if (!e || !ppq)
+    {
+        return NULL;
+    }
+    if (!ppq->root)
+    {
+        pq_push(ppq, e);
+        return NULL;
+    }
+    flush_pending(ppq);
+    struct pq_elem *const popped = ppq->root;
+    init_node(e);
+    link_child(popped, e);
+    ppq->root = delete_min(ppq, popped);
+    clear_node(popped);
+    return popped;
+}
+
+struct pq_elem *
+pq_pushpop(struct pqueue *const ppq, struct pq_elem *const e)
+{
+    if (!e || !ppq)
+    {
+        return NULL;
+    }
+    if (!ppq->root)
+    {
+        return e;
+    }
+    PROFILE_INC(ppq->counters.cmps);
+    if (ppq->cmp(ppq->root, e, ppq->aux) != ppq->order)
+    {
+        return e;
+    }
+    return pq_replace_front(ppq, e);
+}
+
 struct pq_elem *
 pq_erase(struct pqueue *const ppq, struct pq_elem *const e)
 {
@@ -58,6 +120,7 @@ pq_erase(struct pqueue *const ppq, struct pq_elem *const e)
     {
         return NULL;
     }
+    flush_pending(ppq);
     ppq->root = delete (ppq, e);
     ppq->sz--;
     clear_node(e);
@@ -99,16 +162,19 @@ pq_update(struct pqueue *const ppq, struct pq_elem *const e,
     {
         return false;
     }
+    flush_pending(ppq);
     fn(e, aux);
+    PROFILE_INC(ppq->counters.cmps);
     if (e->parent && ppq->cmp(e, e->parent, ppq->aux) == ppq->order)
     {
-        cut_child(e);
-        ppq->root = fair_merge(ppq, ppq->root, e);
+        PROFILE_INC(ppq->counters.cuts);
+        cut(ppq, e);
+        ppq->root = meld(ppq, e);
         return true;
     }
     ppq->root = delete (ppq, e);
     init_node(e);
-    ppq->root = fair_merge(ppq, ppq->root, e);
+    ppq->root = meld(ppq, e);
     return true;
 }
 
@@ -122,10 +188,12 @@ pq_increase(struct pqueue *const ppq, struct pq_elem *const e, pq_update_fn *fn,
     {
         return false;
     }
+    flush_pending(ppq);
     if (ppq->order == PQGRT)
     {
         fn(e, aux);
-        cut_child(e);
+        PROFILE_INC(ppq->counters.cuts);
+        cut(ppq, e);
     }
     else
     {
@@ -133,7 +201,7 @@ pq_increase(struct pqueue *const ppq, struct pq_elem *const e, pq_update_fn *fn,
         fn(e, aux);
         init_node(e);
     }
-    ppq->root = fair_merge(ppq, ppq->root, e);
+    ppq->root = meld(ppq, e);
     return true;
 }
 
@@ -147,10 +215,12 @@ pq_decrease(struct pqueue *const ppq, struct pq_elem *const e, pq_update_fn *fn,
     {
         return false;
     }
+    flush_pending(ppq);
     if (ppq->order == PQLES)
     {
         fn(e, aux);
-        cut_child(e);
+        PROFILE_INC(ppq->counters.cuts);
+        cut(ppq, e);
     }
     else
     {
@@ -158,7 +228,7 @@ pq_decrease(struct pqueue *const ppq, struct pq_elem *const e, pq_update_fn *fn,
         fn(e, aux);
         init_node(e);
     }
-    ppq->root = fair_merge(ppq, ppq->root, e);
+    ppq->root = meld(ppq, e);
     return true;
 }
 
@@ -173,19 +243,162 @@ pq_validate(struct pqueue const *const ppq)
     {
         return false;
     }
-    if (traversal_size(ppq->root) != ppq->sz)
+    size_t sz = traversal_size(ppq->root);
+    if (ppq->aux_roots)
+    {
+        if (!ppq->root || !has_valid_links(ppq, NULL, ppq->aux_roots))
+        {
+            return false;
+        }
+        struct pq_elem const *aux_root = ppq->aux_roots;
+        do
+        {
+            /* Auxiliary roots hang nowhere and never beat the front. */
+            if (aux_root->parent
+                || ppq->cmp(aux_root, ppq->root, ppq->aux) == ppq->order)
+            {
+                return false;
+            }
+            aux_root = aux_root->next_sibling;
+        } while (aux_root != ppq->aux_roots);
+        sz += traversal_size(ppq->aux_roots);
+    }
+    size_t pending = 0;
+    for (size_t r = 0; ppq->pending && r < PQ_PENDING_SLOTS; ++r)
+    {
+        struct pq_elem const *const tree = ppq->pending[r];
+        bool const occupied = (ppq->pending_count >> r) & 1U;
+        if (occupied != (tree != NULL))
+        {
+            return false;
+        }
+        if (!tree)
+        {
+            continue;
+        }
+        /* A pending tree hangs nowhere and never beats the front. */
+        if (!ppq->root || tree->parent || tree->next_sibling != tree
+            || !has_valid_links(ppq, NULL, tree)
+            || ppq->cmp(tree, ppq->root, ppq->aux) == ppq->order)
+        {
+            return false;
+        }
+        size_t const tree_sz = traversal_size(tree);
+        if (tree_sz != ((size_t)1 << r))
+        {
+            return false;
+        }
+        pending += tree_sz;
+        sz += tree_sz;
+    }
+    if (pending != ppq->pending_count || sz != ppq->sz)
     {
         return false;
     }
     return true;
 }
 
+struct pq_counters
+pq_profile(struct pqueue const *const ppq)
+{
+#ifdef CONTAINER_PROFILE
+    return ppq->counters;
+#else
+    (void)ppq;
+    return (struct pq_counters){0};
+#endif
+}
+
+void
+pq_profile_reset(struct pqueue *const ppq)
+{
+#ifdef CONTAINER_PROFILE
+    ppq->counters = (struct pq_counters){0};
+#else
+    (void)ppq;
+#endif
+}
+
 enum pq_threeway_cmp
 pq_order(struct pqueue const *const ppq)
 {
     return ppq->order;
 }
 
+enum pq_pairing
+pq_pairing(struct pqueue const *const ppq)
+{
+    return ppq->pairing;
+}
+
+void
+pq_for_each(struct pqueue const *const ppq, pq_for_each_fn *const fn,
+            void *const aux)
+{
+    for (struct pq_elem *e = ppq->root; e; e = next_preorder(e))
+    {
+        fn(e, aux);
+    }
+    if (ppq->aux_roots)
+    {
+        struct pq_elem *aux_root = ppq->aux_roots;
+        do
+        {
+            for (struct pq_elem *e = aux_root; e; e = next_preorder(e))
+            {
+                fn(e, aux);
+            }
+            aux_root = aux_root->next_sibling;
+        } while (aux_root != ppq->aux_roots);
+    }
+    for (size_t r = 0, bits = ppq->pending_count; bits; ++r, bits >>= 1)
+    {
+        for (struct pq_elem *e = ppq->pending[r]; e; e = next_preorder(e))
+        {
+            fn(e, aux);
+        }
+    }
+}
+
+struct pq_elem *
+pq_find_if(struct pqueue const *const ppq, pq_pred_fn *const pred,
+           void *const aux)
+{
+    for (struct pq_elem *e = ppq->root; e; e = next_preorder(e))
+    {
+        if (pred(e, aux))
+        {
+            return e;
+        }
+    }
+    if (ppq->aux_roots)
+    {
+        struct pq_elem *aux_root = ppq->aux_roots;
+        do
+        {
+            for (struct pq_elem *e = aux_root; e; e = next_preorder(e))
+            {
+                if (pred(e, aux))
+                {
+                    return e;
+                }
+            }
+            aux_root = aux_root->next_sibling;
+        } while (aux_root != ppq->aux_roots);
+    }
+    for (size_t r = 0, bits = ppq->pending_count; bits; ++r, bits >>= 1)
+    {
+        for (struct pq_elem *e = ppq->pending[r]; e; e = next_preorder(e))
+        {
+            if (pred(e, aux))
+            {
+                return e;
+            }
+        }
+    }
+    return NULL;
+}
+
 /*========================   Static Helpers   ================================*/
 
 static void
@@ -201,6 +414,18 @@ clear_node(struct pq_elem *e)
     e->left_child = e->next_sibling = e->prev_sibling = e->parent = NULL;
 }
 
+/* An auxiliary root has no parent but is not the front. If it is the
+   newest auxiliary root the list must be handed to the next newest. */
+static void
+cut(struct pqueue *const ppq, struct pq_elem *const e)
+{
+    if (!e->parent && e != ppq->root && e == ppq->aux_roots)
+    {
+        ppq->aux_roots = e->prev_sibling == e ? NULL : e->prev_sibling;
+    }
+    cut_child(e);
+}
+
 static void
 cut_child(struct pq_elem *child)
 {
@@ -217,29 +442,122 @@ cut_child(struct pq_elem *child)
             child->parent->left_child = child->next_sibling;
         }
     }
+    /* A cut subtree may win its next merge and become the root so it must
+       be alone in its circular list. */
+    child->next_sibling = child->prev_sibling = child;
     child->parent = NULL;
 }
 
+/* A child ring has been lapped when the next sibling is the left child of
+   the parent again. Then we climb and try the next sibling of the parent.
+   The root is alone in its ring and has no parent so the walk ends there. */
+static struct pq_elem *
+next_preorder(struct pq_elem const *e)
+{
+    if (e->left_child)
+    {
+        return e->left_child;
+    }
+    for (; e->parent; e = e->parent)
+    {
+        if (e->next_sibling != e->parent->left_child)
+        {
+            return e->next_sibling;
+        }
+    }
+    return NULL;
+}
+
+/* Carries the new singleton tree up the counter, merging with the tree of
+   equal size at each occupied slot. The merged trees stay binomial so the
+   root of the tree in slot r has exactly r children. */
+static void
+push_pending(struct pqueue *const ppq, struct pq_elem *e)
+{
+    size_t r = 0;
+    for (; ppq->pending[r]; ++r)
+    {
+        e = fair_merge(ppq, ppq->pending[r], e);
+        ppq->pending[r] = NULL;
+    }
+    ppq->pending[r] = e;
+    ++ppq->pending_count;
+}
+
+/* Every pending tree is known to lose to the front so they join the child
+   list of the front without any comparisons. */
+static void
+flush_pending(struct pqueue *const ppq)
+{
+    for (size_t r = 0; ppq->pending_count; ++r, ppq->pending_count >>= 1)
+    {
+        if (ppq->pending[r])
+        {
+            link_child(ppq->root, ppq->pending[r]);
+            ppq->pending[r] = NULL;
+        }
+    }
+}
+
 static struct pq_elem *delete(struct pqueue *ppq, struct pq_elem *root)
 {
     if (ppq->root == root)
     {
         return delete_min(ppq, root);
     }
-    cut_child(root);
+    PROFILE_INC(ppq->counters.cuts);
+    cut(ppq, root);
     return fair_merge(ppq, ppq->root, delete_min(ppq, root));
 }
 
+/* Pairs the children of the root with the chosen strategy. Popping the
+   front under the auxiliary strategy must also consume the auxiliary roots
+   because they were only ever known to lose to the old front. */
 static struct pq_elem *
 delete_min(struct pqueue *ppq, struct pq_elem *root)
 {
-    if (!root->left_child)
+    PROFILE_INC(ppq->counters.delete_mins);
+    struct pq_elem *paired = NULL;
+    if (root->left_child)
     {
-        return NULL;
+        switch (ppq->pairing)
+        {
+        case PQ_TWO_PASS:
+        case PQ_AUXILIARY_TWO_PASS:
+            paired = two_pass(ppq, root->left_child);
+            break;
+        case PQ_MULTIPASS:
+            paired = multipass(ppq, root->left_child);
+            break;
+        case PQ_FRONT_TO_BACK:
+        default:
+            paired = front_to_back(ppq, root->left_child);
+            break;
+        }
+        /* The root is always alone in its circular list after merges. */
+        paired->next_sibling = paired->prev_sibling = paired;
+        paired->parent = NULL;
+    }
+    if (root == ppq->root && ppq->aux_roots)
+    {
+        struct pq_elem *const aux_tree = multipass(ppq, ppq->aux_roots);
+        ppq->aux_roots = NULL;
+        aux_tree->next_sibling = aux_tree->prev_sibling = aux_tree;
+        aux_tree->parent = NULL;
+        paired = fair_merge(ppq, paired, aux_tree);
     }
-    struct pq_elem *const eldest = root->left_child->next_sibling;
-    struct pq_elem *accumulator = root->left_child->next_sibling;
-    struct pq_elem *cur = root->left_child->next_sibling->next_sibling;
+    return paired;
+}
+
+/* Every strategy receives the newest tree of a circular list whose next is
+   the eldest. The list is consumed and the winner is returned with stale
+   sibling and parent links for the caller to reset. */
+static struct pq_elem *
+front_to_back(struct pqueue *const ppq, struct pq_elem *const newest)
+{
+    struct pq_elem *const eldest = newest->next_sibling;
+    struct pq_elem *accumulator = eldest;
+    struct pq_elem *cur = eldest->next_sibling;
     while (cur != eldest && cur->next_sibling != eldest)
     {
         struct pq_elem *next = cur->next_sibling;
@@ -250,11 +568,103 @@ delete_min(struct pqueue *ppq, struct pq_elem *root)
         cur = next_cur;
     }
     /* This covers the odd or even case for number of pairings. */
-    root = cur != eldest ? fair_merge(ppq, accumulator, cur) : accumulator;
-    /* The root is always alone in its circular list at the end of merges. */
-    root->next_sibling = root->prev_sibling = root;
-    root->parent = NULL;
-    return root;
+    return cur != eldest ? fair_merge(ppq, accumulator, cur) : accumulator;
+}
+
+/* The first pass pushes each pair onto a stack threaded through the unused
+   next sibling field so the second pass pops them last pair first. */
+static struct pq_elem *
+two_pass(struct pqueue *const ppq, struct pq_elem *const newest)
+{
+    struct pq_elem *const eldest = newest->next_sibling;
+    struct pq_elem *stack = NULL;
+    struct pq_elem *cur = eldest;
+    do
+    {
+        struct pq_elem *partner = cur->next_sibling;
+        struct pq_elem *next_cur = eldest;
+        if (partner == eldest)
+        {
+            partner = NULL;
+        }
+        else
+        {
+            next_cur = partner->next_sibling;
+        }
+        struct pq_elem *const pair = fair_merge(ppq, cur, partner);
+        pair->next_sibling = stack;
+        stack = pair;
+        cur = next_cur;
+    } while (cur != eldest);
+    struct pq_elem *acc = stack;
+    for (stack = stack->next_sibling; stack;)
+    {
+        struct pq_elem *const next_pair = stack->next_sibling;
+        acc = fair_merge(ppq, acc, stack);
+        stack = next_pair;
+    }
+    return acc;
+}
+
+/* The circular list is broken into a queue threaded through the next
+   sibling field. Merged trees rejoin at the back so every round pairs
+   trees of similar size. */
+static struct pq_elem *
+multipass(struct pqueue *const ppq, struct pq_elem *const newest)
+{
+    struct pq_elem *head = newest->next_sibling;
+    struct pq_elem *tail = newest;
+    tail->next_sibling = NULL;
+    while (head != tail)
+    {
+        struct pq_elem *const a = head;
+        struct pq_elem *const b = head->next_sibling;
+        head = b->next_sibling;
+        struct pq_elem *const winner = fair_merge(ppq, a, b);
+        winner->next_sibling = NULL;
+        if (!head)
+        {
+            head = winner;
+        }
+        else
+        {
+            tail->next_sibling = winner;
+        }
+        tail = winner;
+    }
+    return head;
+}
+
+/* Joins a lone tree with the heap. Under the auxiliary strategy a tree that
+   does not beat the front waits in the auxiliary list in arrival order. */
+static struct pq_elem *
+meld(struct pqueue *const ppq, struct pq_elem *const e)
+{
+    if (ppq->pairing != PQ_AUXILIARY_TWO_PASS || !ppq->root
+        || e == ppq->root)
+    {
+        return fair_merge(ppq, ppq->root, e);
+    }
+    PROFILE_INC(ppq->counters.cmps);
+    if (ppq->cmp(e, ppq->root, ppq->aux) == ppq->order)
+    {
+        link_child(e, ppq->root);
+        return e;
+    }
+    e->parent = NULL;
+    if (ppq->aux_roots)
+    {
+        e->next_sibling = ppq->aux_roots->next_sibling;
+        e->prev_sibling = ppq->aux_roots;
+        ppq->aux_roots->next_sibling->prev_sibling = e;
+        ppq->aux_roots->next_sibling = e;
+    }
+    else
+    {
+        e->next_sibling = e->prev_sibling = e;
+    }
+    ppq->aux_roots = e;
+    return ppq->root;
 }
 
 static inline struct pq_elem *
@@ -265,6 +675,8 @@ fair_merge(struct pqueue *const ppq, struct pq_elem *const old,
     {
         return old ? old : new;
     }
+    PROFILE_INC(ppq->counters.merges);
+    PROFILE_INC(ppq->counters.cmps);
     if (ppq->cmp(new, old, ppq->aux) == ppq->order)
     {
         link_child(new, old);
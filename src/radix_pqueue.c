@@ -0,0 +1,277 @@
+#include "radix_pqueue.h"
+#include "attrib.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*=========================  Function Prototypes   ==========================*/
+
+static size_t bucket_of(uint64_t last, uint64_t key);
+static void splice(struct rdpqueue *, size_t bucket, struct rdpq_elem *);
+static void unlink_elem(struct rdpqueue *, size_t bucket,
+                        struct rdpq_elem *);
+static bool redistribute(struct rdpqueue *);
+
+/*=========================  Interface Functions   ==========================*/
+
+struct rdpq_elem const *
+rdpq_front(struct rdpqueue *const rdq)
+{
+    if (!rdq->buckets[0] && !redistribute(rdq))
+    {
+        return NULL;
+    }
+    return rdq->buckets[0];
+}
+
+bool
+rdpq_push(struct rdpqueue *const rdq, struct rdpq_elem *const e,
+          uint64_t const key)
+{
+    if (!e || !rdq || key < rdq->last)
+    {
+        return false;
+    }
+    e->key = key;
+    splice(rdq, bucket_of(rdq->last, key), e);
+    ++rdq->sz;
+    return true;
+}
+
+struct rdpq_elem *
+rdpq_pop(struct rdpqueue *const rdq)
+{
+    if (!rdq->buckets[0] && !redistribute(rdq))
+    {
+        return NULL;
+    }
+    struct rdpq_elem *const popped = rdq->buckets[0];
+    unlink_elem(rdq, 0, popped);
+    --rdq->sz;
+    return popped;
+}
+
+struct rdpq_elem *
+rdpq_erase(struct rdpqueue *const rdq, struct rdpq_elem *const e)
+{
+    if (!e->next)
+    {
+        return NULL;
+    }
+    unlink_elem(rdq, bucket_of(rdq->last, e->key), e);
+    --rdq->sz;
+    return e;
+}
+
+bool
+rdpq_decrease(struct rdpqueue *const rdq, struct rdpq_elem *const e,
+              uint64_t const key)
+{
+    if (!e->next || key > e->key || key < rdq->last)
+    {
+        return false;
+    }
+    size_t const old_bucket = bucket_of(rdq->last, e->key);
+    size_t const new_bucket = bucket_of(rdq->last, key);
+    e->key = key;
+    if (new_bucket != old_bucket)
+    {
+        unlink_elem(rdq, old_bucket, e);
+        splice(rdq, new_bucket, e);
+    }
+    return true;
+}
+
+uint64_t
+rdpq_key(struct rdpq_elem const *const e)
+{
+    return e->key;
+}
+
+uint64_t
+rdpq_last(struct rdpqueue const *const rdq)
+{
+    return rdq->last;
+}
+
+bool
+rdpq_empty(struct rdpqueue const *const rdq)
+{
+    return !rdq->sz;
+}
+
+size_t
+rdpq_size(struct rdpqueue const *const rdq)
+{
+    return rdq->sz;
+}
+
+struct rdpq_counters
+rdpq_profile(struct rdpqueue const *const rdq)
+{
+#ifdef CONTAINER_PROFILE
+    return rdq->counters;
+#else
+    (void)rdq;
+    return (struct rdpq_counters){0};
+#endif
+}
+
+void
+rdpq_profile_reset(struct rdpqueue *const rdq)
+{
+#ifdef CONTAINER_PROFILE
+    rdq->counters = (struct rdpq_counters){0};
+#else
+    (void)rdq;
+#endif
+}
+
+void
+rdpq_clear(struct rdpqueue *const rdq, rdpq_destructor_fn *const fn)
+{
+    for (size_t b = 0; b < RDPQ_BUCKETS; ++b)
+    {
+        while (rdq->buckets[b])
+        {
+            struct rdpq_elem *const e = rdq->buckets[b];
+            unlink_elem(rdq, b, e);
+            fn(e);
+        }
+    }
+    rdq->sz = 0;
+    rdq->last = 0;
+}
+
+bool
+rdpq_validate(struct rdpqueue const *const rdq)
+{
+    size_t sz = 0;
+    for (size_t b = 0; b < RDPQ_BUCKETS; ++b)
+    {
+        struct rdpq_elem const *const head = rdq->buckets[b];
+        if (!head)
+        {
+            continue;
+        }
+        struct rdpq_elem const *e = head;
+        do
+        {
+            if (!e->next || e->next->prev != e || e->key < rdq->last
+                || bucket_of(rdq->last, e->key) != b)
+            {
+                return false;
+            }
+            if (++sz > rdq->sz)
+            {
+                return false;
+            }
+            e = e->next;
+        } while (e != head);
+    }
+    return sz == rdq->sz;
+}
+
+/*=========================   Static Helpers   ==============================*/
+
+/* The bucket is the position of the highest bit in which the key differs
+   from the last popped key, counting from 1, or 0 if they are equal. */
+static size_t
+bucket_of(uint64_t const last, uint64_t const key)
+{
+    uint64_t const diff = last ^ key;
+    if (!diff)
+    {
+        return 0;
+    }
+#if defined(__GNUC__) || defined(__clang__)
+    return (size_t)(64 - __builtin_clzll((unsigned long long)diff));
+#else
+    size_t width = 0;
+    for (uint64_t d = diff; d; d >>= 1)
+    {
+        ++width;
+    }
+    return width;
+#endif
+}
+
+/* Adds the element at the back of the circular list of the bucket. */
+static void
+splice(struct rdpqueue *const rdq, size_t const bucket,
+       struct rdpq_elem *const e)
+{
+    struct rdpq_elem *const head = rdq->buckets[bucket];
+    if (!head)
+    {
+        e->next = e->prev = e;
+        rdq->buckets[bucket] = e;
+        return;
+    }
+    e->next = head;
+    e->prev = head->prev;
+    head->prev->next = e;
+    head->prev = e;
+}
+
+/* Removes the element from the bucket list. A removed element has no
+   links which is how the interface tells it is not in a heap. */
+static void
+unlink_elem(struct rdpqueue *const rdq, size_t const bucket,
+            struct rdpq_elem *const e)
+{
+    if (e->next == e)
+    {
+        rdq->buckets[bucket] = NULL;
+    }
+    else
+    {
+        e->prev->next = e->next;
+        e->next->prev = e->prev;
+        if (rdq->buckets[bucket] == e)
+        {
+            rdq->buckets[bucket] = e->next;
+        }
+    }
+    e->next = e->prev = NULL;
+}
+
+/* Called when bucket 0 is empty. The smallest key of the first non empty
+   bucket becomes the last key and every element of that bucket moves to
+   a strictly lower bucket, the minimum and its ties to bucket 0. No other
+   bucket changes because their keys differ from the old and new last key
+   in the same highest bit. Returns false if the heap is empty. */
+static bool
+redistribute(struct rdpqueue *const rdq)
+{
+    size_t b = 1;
+    while (b < RDPQ_BUCKETS && !rdq->buckets[b])
+    {
+        ++b;
+    }
+    if (b == RDPQ_BUCKETS)
+    {
+        return false;
+    }
+    PROFILE_INC(rdq->counters.redistributions);
+    struct rdpq_elem *const head = rdq->buckets[b];
+    uint64_t min = head->key;
+    for (struct rdpq_elem const *e = head->next; e != head; e = e->next)
+    {
+        if (e->key < min)
+        {
+            min = e->key;
+        }
+    }
+    rdq->last = min;
+    rdq->buckets[b] = NULL;
+    head->prev->next = NULL;
+    for (struct rdpq_elem *e = head, *next = NULL; e; e = next)
+    {
+        PROFILE_INC(rdq->counters.moves);
+        next = e->next;
+        splice(rdq, bucket_of(min, e->key), e);
+    }
+    return true;
+}
@@ -0,0 +1,463 @@
+#include "rank_pqueue.h"
+#include "attrib.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/* The rank of a half tree is at most log base phi of the size with the type
+   one rank rule, which is under 93 for any element count a size_t can hold.
+   The buckets used while linking roots after a pop are indexed by rank. */
+#define RANK_SLOTS 128
+
+/*=========================  Function Prototypes   ==========================*/
+
+static void init_node(struct rkpq_elem *);
+static bool in_heap(struct rkpq_elem const *);
+static int rank_of(struct rkpq_elem const *);
+static int rule_rank(struct rkpq_elem const *);
+static void add_root(struct rkpqueue *, struct rkpq_elem *);
+static struct rkpq_elem *link_trees(struct rkpqueue *, struct rkpq_elem *,
+                                    struct rkpq_elem *);
+static void cut(struct rkpqueue *, struct rkpq_elem *);
+static void repair_ranks(struct rkpq_elem *);
+static void delete_root(struct rkpqueue *, struct rkpq_elem *);
+static void bucket_root(struct rkpqueue *, struct rkpq_elem **bucket,
+                        int *max_rank, struct rkpq_elem **out,
+                        struct rkpq_elem *);
+static void improve(struct rkpqueue *, struct rkpq_elem *);
+static struct rkpq_elem *erase(struct rkpqueue *, struct rkpq_elem *);
+static bool has_valid_tree(struct rkpqueue const *,
+                           struct rkpq_elem const *parent,
+                           struct rkpq_elem const *bound,
+                           struct rkpq_elem const *, size_t *);
+
+/*=========================  Interface Functions   ==========================*/
+
+struct rkpq_elem const *
+rkpq_front(struct rkpqueue const *const rpq)
+{
+    return rpq->front;
+}
+
+void
+rkpq_push(struct rkpqueue *const rpq, struct rkpq_elem *const e)
+{
+    if (!e || !rpq)
+    {
+        return;
+    }
+    init_node(e);
+    add_root(rpq, e);
+    ++rpq->sz;
+}
+
+struct rkpq_elem *
+rkpq_pop(struct rkpqueue *const rpq)
+{
+    if (!rpq->front)
+    {
+        return NULL;
+    }
+    struct rkpq_elem *const popped = rpq->front;
+    delete_root(rpq, popped);
+    return popped;
+}
+
+struct rkpq_elem *
+rkpq_erase(struct rkpqueue *const rpq, struct rkpq_elem *const e)
+{
+    if (!rpq->front || !in_heap(e))
+    {
+        return NULL;
+    }
+    return erase(rpq, e);
+}
+
+bool
+rkpq_empty(struct rkpqueue const *const rpq)
+{
+    return !rpq->sz;
+}
+
+size_t
+rkpq_size(struct rkpqueue const *const rpq)
+{
+    return rpq->sz;
+}
+
+/* A node without a left subtree orders nothing below it so it may be cut
+   into a root of rank 0 no matter which way its value moved. Otherwise the
+   direction is unknown and the element is removed and pushed again. A root
+   is never cut because it may have been the front and grown worse. */
+bool
+rkpq_update(struct rkpqueue *const rpq, struct rkpq_elem *const e,
+            rkpq_update_fn *const fn, void *const aux)
+{
+    if (!in_heap(e))
+    {
+        return false;
+    }
+    if (e->parent && !e->left)
+    {
+        fn(e, aux);
+        cut(rpq, e);
+        return true;
+    }
+    (void)erase(rpq, e);
+    fn(e, aux);
+    rkpq_push(rpq, e);
+    return true;
+}
+
+bool
+rkpq_increase(struct rkpqueue *const rpq, struct rkpq_elem *const e,
+              rkpq_update_fn *const fn, void *const aux)
+{
+    if (rpq->order != RKPQGRT)
+    {
+        return rkpq_update(rpq, e, fn, aux);
+    }
+    if (!in_heap(e))
+    {
+        return false;
+    }
+    fn(e, aux);
+    improve(rpq, e);
+    return true;
+}
+
+bool
+rkpq_decrease(struct rkpqueue *const rpq, struct rkpq_elem *const e,
+              rkpq_update_fn *const fn, void *const aux)
+{
+    if (rpq->order != RKPQLES)
+    {
+        return rkpq_update(rpq, e, fn, aux);
+    }
+    if (!in_heap(e))
+    {
+        return false;
+    }
+    fn(e, aux);
+    improve(rpq, e);
+    return true;
+}
+
+enum rkpq_threeway_cmp
+rkpq_order(struct rkpqueue const *const rpq)
+{
+    return rpq->order;
+}
+
+struct rkpq_counters
+rkpq_profile(struct rkpqueue const *const rpq)
+{
+#ifdef CONTAINER_PROFILE
+    return rpq->counters;
+#else
+    (void)rpq;
+    return (struct rkpq_counters){0};
+#endif
+}
+
+void
+rkpq_profile_reset(struct rkpqueue *const rpq)
+{
+#ifdef CONTAINER_PROFILE
+    rpq->counters = (struct rkpq_counters){0};
+#else
+    (void)rpq;
+#endif
+}
+
+void
+rkpq_clear(struct rkpqueue *const rpq, rkpq_destructor_fn *const fn)
+{
+    while (!rkpq_empty(rpq))
+    {
+        fn(rkpq_pop(rpq));
+    }
+}
+
+bool
+rkpq_validate(struct rkpqueue const *const rpq)
+{
+    if (!rpq->front)
+    {
+        return rpq->sz == 0;
+    }
+    size_t sz = 0;
+    struct rkpq_elem const *root = rpq->front;
+    do
+    {
+        /* Roots hang nowhere, never beat the front, and have no right
+           child of their own because right is the root list link. */
+        if (root->parent || !root->right
+            || rpq->cmp(root, rpq->front, rpq->aux) == rpq->order
+            || root->rank != rank_of(root->left) + 1)
+        {
+            return false;
+        }
+        ++sz;
+        if (!has_valid_tree(rpq, root, root, root->left, &sz))
+        {
+            return false;
+        }
+        if (sz > rpq->sz)
+        {
+            return false;
+        }
+        root = root->right;
+    } while (root != rpq->front);
+    return sz == rpq->sz;
+}
+
+/*=========================   Static Helpers   ==============================*/
+
+static void
+init_node(struct rkpq_elem *const e)
+{
+    e->left = e->right = e->parent = NULL;
+    e->rank = 0;
+}
+
+/* Every root has a right link, at least to itself, and every other node
+   has a parent. A node outside of a heap has neither. */
+static bool
+in_heap(struct rkpq_elem const *const e)
+{
+    return e->parent || e->right;
+}
+
+/* A missing child counts as rank -1 so a leaf has rank 0. */
+static int
+rank_of(struct rkpq_elem const *const e)
+{
+    return e ? e->rank : -1;
+}
+
+/* The type one rank rule for a node that is not a root. Equal children
+   ranks raise the rank by one and otherwise the larger rank is kept. */
+static int
+rule_rank(struct rkpq_elem const *const e)
+{
+    int const l = rank_of(e->left);
+    int const r = rank_of(e->right);
+    if (l == r)
+    {
+        return l + 1;
+    }
+    return l > r ? l : r;
+}
+
+/* Splices a half tree in after the front and takes the front if it wins. */
+static void
+add_root(struct rkpqueue *const rpq, struct rkpq_elem *const e)
+{
+    if (!rpq->front)
+    {
+        e->right = e;
+        rpq->front = e;
+        return;
+    }
+    e->right = rpq->front->right;
+    rpq->front->right = e;
+    PROFILE_INC(rpq->counters.cmps);
+    if (rpq->cmp(e, rpq->front, rpq->aux) == rpq->order)
+    {
+        rpq->front = e;
+    }
+}
+
+/* Links two half trees of equal rank. The loser becomes the left child of
+   the winner and takes the old left subtree of the winner as its right
+   subtree. The winner keeps its right link for the caller to overwrite.
+   Ties go to the first argument. */
+static struct rkpq_elem *
+link_trees(struct rkpqueue *const rpq, struct rkpq_elem *winner,
+           struct rkpq_elem *loser)
+{
+    PROFILE_INC(rpq->counters.cmps);
+    PROFILE_INC(rpq->counters.links);
+    if (rpq->cmp(loser, winner, rpq->aux) == rpq->order)
+    {
+        struct rkpq_elem *const tmp = winner;
+        winner = loser;
+        loser = tmp;
+    }
+    loser->right = winner->left;
+    if (loser->right)
+    {
+        loser->right->parent = loser;
+    }
+    loser->parent = winner;
+    winner->left = loser;
+    ++winner->rank;
+    return winner;
+}
+
+/* Cuts a node that is not a root, along with its left subtree, into a new
+   half tree in the root list. The right subtree of the node takes its
+   place below the old parent and the ranks above are repaired. */
+static void
+cut(struct rkpqueue *const rpq, struct rkpq_elem *const e)
+{
+    PROFILE_INC(rpq->counters.cuts);
+    struct rkpq_elem *const parent = e->parent;
+    struct rkpq_elem *const right = e->right;
+    if (parent->left == e)
+    {
+        parent->left = right;
+    }
+    else
+    {
+        parent->right = right;
+    }
+    if (right)
+    {
+        right->parent = parent;
+    }
+    e->parent = e->right = NULL;
+    e->rank = rank_of(e->left) + 1;
+    add_root(rpq, e);
+    repair_ranks(parent);
+}
+
+/* Walks up from a node whose subtree shrank and lowers ranks to match the
+   rule until a rank does not change. A root only depends on its left. */
+static void
+repair_ranks(struct rkpq_elem *e)
+{
+    for (;;)
+    {
+        if (!e->parent)
+        {
+            e->rank = rank_of(e->left) + 1;
+            return;
+        }
+        int const k = rule_rank(e);
+        if (k >= e->rank)
+        {
+            return;
+        }
+        e->rank = k;
+        e = e->parent;
+    }
+}
+
+/* The element moved toward the front. A root only needs to be compared to
+   the front while any other node is cut into its own half tree. */
+static void
+improve(struct rkpqueue *const rpq, struct rkpq_elem *const e)
+{
+    if (e->parent)
+    {
+        cut(rpq, e);
+        return;
+    }
+    PROFILE_INC(rpq->counters.cmps);
+    if (e != rpq->front && rpq->cmp(e, rpq->front, rpq->aux) == rpq->order)
+    {
+        rpq->front = e;
+    }
+}
+
+static struct rkpq_elem *
+erase(struct rkpqueue *const rpq, struct rkpq_elem *const e)
+{
+    if (e->parent)
+    {
+        cut(rpq, e);
+    }
+    delete_root(rpq, e);
+    return e;
+}
+
+/* Removes a root. Every other root and every half tree on the right spine
+   of the left child of the removed root is placed in a bucket by rank. A
+   root that finds its bucket taken is linked with the occupant and the
+   result leaves for the output list right away. This is the one pass
+   variant that links each pair of equal rank at most once per pop. */
+static void
+delete_root(struct rkpqueue *const rpq, struct rkpq_elem *const x)
+{
+    struct rkpq_elem *bucket[RANK_SLOTS] = {0};
+    int max_rank = -1;
+    struct rkpq_elem *out = NULL;
+    for (struct rkpq_elem *r = x->right, *next = NULL; r != x; r = next)
+    {
+        next = r->right;
+        bucket_root(rpq, bucket, &max_rank, &out, r);
+    }
+    for (struct rkpq_elem *c = x->left, *next = NULL; c; c = next)
+    {
+        next = c->right;
+        c->parent = c->right = NULL;
+        c->rank = rank_of(c->left) + 1;
+        bucket_root(rpq, bucket, &max_rank, &out, c);
+    }
+    for (int k = 0; k <= max_rank; ++k)
+    {
+        if (bucket[k])
+        {
+            bucket[k]->right = out;
+            out = bucket[k];
+        }
+    }
+    rpq->front = NULL;
+    for (struct rkpq_elem *r = out, *next = NULL; r; r = next)
+    {
+        next = r->right;
+        add_root(rpq, r);
+    }
+    --rpq->sz;
+    init_node(x);
+}
+
+static void
+bucket_root(struct rkpqueue *const rpq, struct rkpq_elem **const bucket,
+            int *const max_rank, struct rkpq_elem **const out,
+            struct rkpq_elem *const r)
+{
+    int const k = r->rank;
+    if (!bucket[k])
+    {
+        bucket[k] = r;
+        if (k > *max_rank)
+        {
+            *max_rank = k;
+        }
+        return;
+    }
+    struct rkpq_elem *const w = link_trees(rpq, bucket[k], r);
+    bucket[k] = NULL;
+    w->right = *out;
+    *out = w;
+}
+
+/* Checks one subtree below a half tree root. Every node must be no better
+   than the bound, the nearest ancestor whose left subtree holds it, its
+   parent link must be correct, and its rank must follow the rule. */
+static bool
+has_valid_tree(struct rkpqueue const *const rpq,
+               struct rkpq_elem const *const parent,
+               struct rkpq_elem const *const bound,
+               struct rkpq_elem const *const e, size_t *const sz)
+{
+    if (!e)
+    {
+        return true;
+    }
+    if (e->parent != parent || e->rank != rule_rank(e)
+        || rpq->cmp(e, bound, rpq->aux) == rpq->order)
+    {
+        return false;
+    }
+    ++*sz;
+    if (*sz > rpq->sz)
+    {
+        return false;
+    }
+    return has_valid_tree(rpq, e, e, e->left, sz)
+           && has_valid_tree(rpq, e, bound, e->right, sz);
+}
@@ -21,6 +21,7 @@
       https://www.link.cs.cmu.edu/link/ftp-site/splaying/top-down-splay.c */
 #include "depqueue.h"
 #include "set.h"
+#include "topk.h"
 #include "tree.h"
 
 #include <stdbool.h>
@@ -56,6 +57,8 @@ enum tree_link const reverse_inorder_traversal = R;
 /* =======================        Prototypes         ====================== */
 
 static void init_node(struct tree *, struct node *);
+static node_threeway_cmp tree_cmp(struct tree *, struct node const *,
+                                  struct node const *);
 static bool empty(struct tree const *);
 static void multiset_insert(struct tree *, struct node *);
 static struct node *find(struct tree *, struct node *);
@@ -65,6 +68,20 @@ static bool insert(struct tree *, struct node *);
 static struct node *multiset_erase_max_or_min(struct tree *, struct node *,
                                               tree_cmp_fn *);
 static struct node *multiset_erase_node(struct tree *, struct node *);
+static struct node *multiset_replace_max_or_min(struct tree *, struct node *,
+                                                tree_cmp_fn *, enum tree_link);
+static size_t multiset_pop_n(struct tree *, struct node **, size_t,
+                             tree_cmp_fn *, enum tree_link);
+static size_t detach_dup_ring(struct tree *, struct node *, struct node **,
+                              size_t);
+static struct node *unlink_extreme(struct tree *, struct node *,
+                                   enum tree_link);
+static void rebalance(struct tree *);
+static size_t tree_to_vine(struct tree *);
+static void vine_to_tree(struct tree *, size_t);
+static void compress(struct tree *, size_t);
+static struct tree_stats stats(struct tree const *);
+static size_t count_dups(struct tree const *, struct node const *);
 static struct node *pop_dup_node(struct tree *, struct node *, struct node *);
 static struct node *pop_front_dup(struct tree *, struct node *);
 static struct node *remove_from_tree(struct tree *, struct node *);
@@ -79,6 +96,13 @@ static struct node *const_seek(struct tree *, struct node *);
 static struct node *end(struct tree *);
 static struct node *next(struct tree *, struct node *, enum tree_link);
 static struct node *multiset_next(struct tree *, struct node *, enum tree_link);
+static struct node *cursor_begin(struct tree const *, struct cursor *,
+                                 enum tree_link, bool);
+static struct node *cursor_init(struct tree const *, struct cursor *,
+                                struct node *, enum tree_link, bool);
+static struct node *cursor_next(struct cursor *);
+static void for_each(struct tree const *, struct node *, struct node const *,
+                     enum tree_link, bool, node_visit_fn *, void *);
 static struct range equal_range(struct tree *, struct node *, struct node *,
                                 enum tree_link);
 static node_threeway_cmp force_find_grt(struct node const *,
@@ -199,6 +223,60 @@ depq_rnext(struct depqueue *pq, struct depq_elem *i)
     return (struct depq_elem *)multiset_next(&pq->t, &i->n, inorder_traversal);
 }
 
+struct depq_elem *
+depq_cursor_begin(struct depqueue const *const pq, struct depq_cursor *const c)
+{
+    return (struct depq_elem *)cursor_begin(&pq->t, &c->c,
+                                            reverse_inorder_traversal, true);
+}
+
+struct depq_elem *
+depq_cursor_rbegin(struct depqueue const *const pq, struct depq_cursor *const c)
+{
+    return (struct depq_elem *)cursor_begin(&pq->t, &c->c, inorder_traversal,
+                                            true);
+}
+
+struct depq_elem *
+depq_cursor_next(struct depq_cursor *const c)
+{
+    return (struct depq_elem *)cursor_next(&c->c);
+}
+
+void
+depq_for_each(struct depqueue const *const pq, depq_for_each_fn *const fn,
+              void *const aux)
+{
+    for_each(&pq->t, max(&pq->t), &pq->t.end, reverse_inorder_traversal, true,
+             (node_visit_fn *)fn, aux);
+}
+
+void
+depq_rfor_each(struct depqueue const *const pq, depq_for_each_fn *const fn,
+               void *const aux)
+{
+    for_each(&pq->t, min(&pq->t), &pq->t.end, inorder_traversal, true,
+             (node_visit_fn *)fn, aux);
+}
+
+void
+depq_for_each_range(struct depqueue const *const pq,
+                    struct depq_range const *const r,
+                    depq_for_each_fn *const fn, void *const aux)
+{
+    for_each(&pq->t, range_begin(&r->r), range_end(&r->r),
+             reverse_inorder_traversal, true, (node_visit_fn *)fn, aux);
+}
+
+void
+depq_for_each_rrange(struct depqueue const *const pq,
+                     struct depq_rrange const *const r,
+                     depq_for_each_fn *const fn, void *const aux)
+{
+    for_each(&pq->t, rrange_begin(&r->r), rrange_end(&r->r),
+             inorder_traversal, true, (node_visit_fn *)fn, aux);
+}
+
 struct depq_range
 depq_equal_range(struct depqueue *pq, struct depq_elem *begin,
                  struct depq_elem *end)
@@ -315,6 +393,65 @@ depq_pop_min(struct depqueue *pq)
     return (struct depq_elem *)pop_min(&pq->t);
 }
 
+struct depq_elem *
+depq_replace_max(struct depqueue *pq, struct depq_elem *elem)
+{
+    return (struct depq_elem *)multiset_replace_max_or_min(
+        &pq->t, &elem->n, force_find_grt, R);
+}
+
+struct depq_elem *
+depq_replace_min(struct depqueue *pq, struct depq_elem *elem)
+{
+    return (struct depq_elem *)multiset_replace_max_or_min(
+        &pq->t, &elem->n, force_find_les, L);
+}
+
+size_t
+depq_pop_max_n(struct depqueue *pq, struct depq_elem **out, size_t n)
+{
+    return multiset_pop_n(&pq->t, (struct node **)out, n, force_find_grt, R);
+}
+
+size_t
+depq_pop_min_n(struct depqueue *pq, struct depq_elem **out, size_t n)
+{
+    return multiset_pop_n(&pq->t, (struct node **)out, n, force_find_les, L);
+}
+
+void
+depq_rebalance(struct depqueue *const pq)
+{
+    rebalance(&pq->t);
+}
+
+struct tree_stats
+depq_stats(struct depqueue const *const pq)
+{
+    return stats(&pq->t);
+}
+
+struct tree_counters
+depq_profile(struct depqueue const *const pq)
+{
+#ifdef CONTAINER_PROFILE
+    return pq->t.counters;
+#else
+    (void)pq;
+    return (struct tree_counters){0};
+#endif
+}
+
+void
+depq_profile_reset(struct depqueue *const pq)
+{
+#ifdef CONTAINER_PROFILE
+    pq->t.counters = (struct tree_counters){0};
+#else
+    (void)pq;
+#endif
+}
+
 size_t
 depq_size(struct depqueue *const pq)
 {
@@ -350,6 +487,39 @@ set_clear(struct set *set, set_destructor_fn *destructor)
     }
 }
 
+void
+set_rebalance(struct set *const s)
+{
+    rebalance(&s->t);
+}
+
+struct tree_stats
+set_stats(struct set const *const s)
+{
+    return stats(&s->t);
+}
+
+struct tree_counters
+set_profile(struct set const *const s)
+{
+#ifdef CONTAINER_PROFILE
+    return s->t.counters;
+#else
+    (void)s;
+    return (struct tree_counters){0};
+#endif
+}
+
+void
+set_profile_reset(struct set *const s)
+{
+#ifdef CONTAINER_PROFILE
+    s->t.counters = (struct tree_counters){0};
+#else
+    (void)s;
+#endif
+}
+
 bool
 set_empty(struct set *s)
 {
@@ -404,6 +574,59 @@ set_rnext(struct set *s, struct set_elem *e)
     return (struct set_elem *)next(&s->t, &e->n, reverse_inorder_traversal);
 }
 
+struct set_elem *
+set_cursor_begin(struct set const *const s, struct set_cursor *const c)
+{
+    return (struct set_elem *)cursor_begin(&s->t, &c->c, inorder_traversal,
+                                           false);
+}
+
+struct set_elem *
+set_cursor_rbegin(struct set const *const s, struct set_cursor *const c)
+{
+    return (struct set_elem *)cursor_begin(&s->t, &c->c,
+                                           reverse_inorder_traversal, false);
+}
+
+struct set_elem *
+set_cursor_next(struct set_cursor *const c)
+{
+    return (struct set_elem *)cursor_next(&c->c);
+}
+
+void
+set_for_each(struct set const *const s, set_for_each_fn *const fn,
+             void *const aux)
+{
+    for_each(&s->t, min(&s->t), &s->t.end, inorder_traversal, false,
+             (node_visit_fn *)fn, aux);
+}
+
+void
+set_rfor_each(struct set const *const s, set_for_each_fn *const fn,
+              void *const aux)
+{
+    for_each(&s->t, max(&s->t), &s->t.end, reverse_inorder_traversal, false,
+             (node_visit_fn *)fn, aux);
+}
+
+void
+set_for_each_range(struct set const *const s, struct set_range const *const r,
+                   set_for_each_fn *const fn, void *const aux)
+{
+    for_each(&s->t, range_begin(&r->r), range_end(&r->r), inorder_traversal,
+             false, (node_visit_fn *)fn, aux);
+}
+
+void
+set_for_each_rrange(struct set const *const s,
+                    struct set_rrange const *const r,
+                    set_for_each_fn *const fn, void *const aux)
+{
+    for_each(&s->t, rrange_begin(&r->r), rrange_end(&r->r),
+             reverse_inorder_traversal, false, (node_visit_fn *)fn, aux);
+}
+
 struct set_range
 set_equal_range(struct set *s, struct set_elem *begin, struct set_elem *end)
 {
@@ -499,6 +722,121 @@ set_print(struct set const *const s, struct set_elem const *const root,
     print_tree(&s->t, &root->n, (node_print_fn *)fn);
 }
 
+/* ======================        Top K Interface     ====================== */
+
+struct depq_elem *
+topk_push(struct topk *const tk, struct depq_elem *const e)
+{
+    if (!tk || !e || !tk->cap)
+    {
+        return e;
+    }
+    struct tree *const t = &tk->dq.t;
+    if (t->size < tk->cap)
+    {
+        if (!tk->min || tree_cmp(t, &e->n, &tk->min->n) == NODE_LES)
+        {
+            tk->min = e;
+        }
+        multiset_insert(t, &e->n);
+        return NULL;
+    }
+    if (tree_cmp(t, &e->n, &tk->min->n) != NODE_GRT)
+    {
+        return e;
+    }
+    struct node *const evicted = &tk->min->n;
+    struct node *next_min = unlink_extreme(t, evicted, L);
+    if (next_min == &t->end || tree_cmp(t, &e->n, next_min) == NODE_LES)
+    {
+        next_min = &e->n;
+    }
+    multiset_insert(t, &e->n);
+    tk->min = (struct depq_elem *)next_min;
+    return (struct depq_elem *)evicted;
+}
+
+struct depq_elem const *
+topk_min(struct topk const *const tk)
+{
+    return tk->min;
+}
+
+size_t
+topk_size(struct topk const *const tk)
+{
+    return tk->dq.t.size;
+}
+
+size_t
+topk_capacity(struct topk const *const tk)
+{
+    return tk->cap;
+}
+
+bool
+topk_empty(struct topk const *const tk)
+{
+    return empty(&tk->dq.t);
+}
+
+bool
+topk_full(struct topk const *const tk)
+{
+    return tk->dq.t.size == tk->cap;
+}
+
+void
+topk_clear(struct topk *const tk, depq_destructor_fn *destructor)
+{
+    depq_clear(&tk->dq, destructor);
+    tk->min = NULL;
+}
+
+struct depq_elem *
+topk_begin(struct topk *const tk)
+{
+    return depq_begin(&tk->dq);
+}
+
+struct depq_elem *
+topk_rbegin(struct topk *const tk)
+{
+    return depq_rbegin(&tk->dq);
+}
+
+struct depq_elem *
+topk_next(struct topk *const tk, struct depq_elem *const i)
+{
+    return depq_next(&tk->dq, i);
+}
+
+struct depq_elem *
+topk_rnext(struct topk *const tk, struct depq_elem *const i)
+{
+    return depq_rnext(&tk->dq, i);
+}
+
+struct depq_elem *
+topk_end(struct topk *const tk)
+{
+    return depq_end(&tk->dq);
+}
+
+bool
+topk_validate(struct topk *const tk)
+{
+    if (!validate_tree(&tk->dq.t) || tk->dq.t.size > tk->cap)
+    {
+        return false;
+    }
+    if (empty(&tk->dq.t))
+    {
+        return tk->min == NULL;
+    }
+    return tk->min && &tk->min->n == min(&tk->dq.t);
+}
+
 /* ===========    Splay Tree Multiset and Set Implementations    ===========
 
       (40)0x7fffffffd5c8-0x7fffffffdac8(+1)
@@ -568,6 +906,16 @@ init_node(struct tree *t, struct node *n)
     n->parent_or_dups = &t->end;
 }
 
+/* All comparisons with the user function outside of debugging go through
+   here so profiling builds can count them. */
+static inline node_threeway_cmp
+tree_cmp(struct tree *const t, struct node const *const key,
+         struct node const *const n)
+{
+    PROFILE_INC(t->counters.cmps);
+    return t->cmp(key, n, t->aux);
+}
+
 static bool
 empty(struct tree const *const t)
 {
@@ -604,7 +952,7 @@ const_seek(struct tree *const t, struct node *const n)
     struct node *seek = n;
     while (seek != &t->end)
     {
-        node_threeway_cmp const cur_cmp = t->cmp(n, seek, t->aux);
+        node_threeway_cmp const cur_cmp = tree_cmp(t, n, seek);
         if (cur_cmp == NODE_EQL)
         {
             return seek;
@@ -655,6 +1003,7 @@ multiset_next(struct tree *t, struct node *i, enum tree_link const traversal)
         {
             return next_tree_node(t, i->link[N], traversal);
         }
+        PROFILE_INC(t->counters.dup_steps);
         return i->link[N];
     }
     /* The special head node of a doubly linked list of duplicates. */
@@ -665,10 +1014,12 @@ multiset_next(struct tree *t, struct node *i, enum tree_link const traversal)
         {
             return next_tree_node(t, i, traversal);
         }
+        PROFILE_INC(t->counters.dup_steps);
         return i->link[N];
     }
     if (has_dups(&t->end, i))
     {
+        PROFILE_INC(t->counters.dup_steps);
         return i->parent_or_dups;
     }
     return next(t, i, traversal);
@@ -729,6 +1080,107 @@ next(struct tree *t, struct node *n, enum tree_link const traversal)
     return p;
 }
 
+/* The cursor starts at the far end of the traversal just like begin. The
+   root is always a tree node so there is no ring to account for yet. */
+static struct node *
+cursor_begin(struct tree const *const t, struct cursor *const c,
+             enum tree_link const traversal, bool const dups)
+{
+    struct node *n = t->root;
+    for (; n->link[traversal] != &t->end; n = n->link[traversal])
+    {}
+    return cursor_init(t, c, n, traversal, dups);
+}
+
+/* Ranges and begin always hand us a tree node, never a ring member. */
+static struct node *
+cursor_init(struct tree const *const t, struct cursor *const c,
+            struct node *const n, enum tree_link const traversal,
+            bool const dups)
+{
+    *c = (struct cursor){
+        .end = &t->end,
+        .cur = n,
+        .ring_owner = NULL,
+        .traversal = traversal,
+        .dups = dups,
+    };
+    PREFETCH(n->link[!traversal]);
+    return n;
+}
+
+/* The visitor is handed each node before the cursor steps past it. This
+   is the cursor walk with the loop kept inside the library so the caller
+   pays one indirect call per element and nothing else. */
+static void
+for_each(struct tree const *const t, struct node *const begin,
+         struct node const *const stop, enum tree_link const traversal,
+         bool const dups, node_visit_fn *const fn, void *const aux)
+{
+    struct cursor c;
+    for (struct node *n = cursor_init(t, &c, begin, traversal, dups);
+         n != stop && n != &t->end; n = cursor_next(&c))
+    {
+        fn(n, aux);
+    }
+}
+
+static inline struct node *
+cursor_parent(struct cursor const *const c, struct node *const n)
+{
+    return c->dups && has_dups(c->end, n) ? n->parent_or_dups->parent_or_dups
+                                          : n->parent_or_dups;
+}
+
+/* Same visiting order as multiset_next but the ring owner is remembered
+   rather than rediscovered and the root parent is trusted to be the end,
+   as it always is when nothing has modified the tree since begin. */
+static struct node *
+cursor_next(struct cursor *const c)
+{
+    struct node *n = c->cur;
+    if (n == c->end)
+    {
+        return n;
+    }
+    enum tree_link const dir = c->traversal;
+    if (c->ring_owner)
+    {
+        struct node *const head = c->ring_owner->parent_or_dups;
+        if (n->link[N] != head)
+        {
+            c->cur = n->link[N];
+            PREFETCH(c->cur->link[N]);
+            return c->cur;
+        }
+        n = c->ring_owner;
+        c->ring_owner = NULL;
+    }
+    else if (c->dups && has_dups(c->end, n))
+    {
+        c->ring_owner = n;
+        c->cur = n->parent_or_dups;
+        PREFETCH(c->cur->link[N]);
+        return c->cur;
+    }
+    if (n->link[!dir] != c->end)
+    {
+        for (n = n->link[!dir]; n->link[dir] != c->end; n = n->link[dir])
+        {}
+    }
+    else
+    {
+        struct node *p = cursor_parent(c, n);
+        for (; p != c->end && p->link[!dir] == n;
+             n = p, p = cursor_parent(c, p))
+        {}
+        n = p;
+    }
+    c->cur = n;
+    PREFETCH(n->link[!dir]);
+    return n;
+}
+
 static struct range
 equal_range(struct tree *t, struct node *begin, struct node *end,
             enum tree_link const traversal)
@@ -740,12 +1192,12 @@ equal_range(struct tree *t, struct node *begin, struct node *end,
        lesser element depending on the direction we are traversing. */
     node_threeway_cmp const grt_or_les[2] = {NODE_GRT, NODE_LES};
     struct node *b = splay(t, t->root, begin, t->cmp);
-    if (t->cmp(begin, b, NULL) == grt_or_les[traversal])
+    if (tree_cmp(t, begin, b) == grt_or_les[traversal])
     {
         b = next(t, b, traversal);
     }
     struct node *e = splay(t, t->root, end, t->cmp);
-    if (t->cmp(end, e, NULL) == grt_or_les[traversal])
+    if (tree_cmp(t, end, e) == grt_or_les[traversal])
     {
         e = next(t, e, traversal);
     }
@@ -781,7 +1233,7 @@ find(struct tree *t, struct node *elem)
 {
     init_node(t, elem);
     t->root = splay(t, t->root, elem, t->cmp);
-    return t->cmp(elem, t->root, NULL) == NODE_EQL ? t->root : &t->end;
+    return tree_cmp(t, elem, t->root) == NODE_EQL ? t->root : &t->end;
 }
 
 static bool
@@ -789,7 +1241,7 @@ contains(struct tree *t, struct node *dummy_key)
 {
     init_node(t, dummy_key);
     t->root = splay(t, t->root, dummy_key, t->cmp);
-    return t->cmp(dummy_key, t->root, NULL) == NODE_EQL;
+    return tree_cmp(t, dummy_key, t->root) == NODE_EQL;
 }
 
 static bool
@@ -803,7 +1255,7 @@ insert(struct tree *t, struct node *elem)
         return true;
     }
     t->root = splay(t, t->root, elem, t->cmp);
-    node_threeway_cmp const root_cmp = t->cmp(elem, t->root, NULL);
+    node_threeway_cmp const root_cmp = tree_cmp(t, elem, t->root);
     if (NODE_EQL == root_cmp)
     {
         return false;
@@ -816,15 +1268,16 @@ static void
 multiset_insert(struct tree *t, struct node *elem)
 {
     init_node(t, elem);
-    t->size++;
     if (empty(t))
     {
         t->root = elem;
+        t->size++;
         return;
     }
+    t->size++;
     t->root = splay(t, t->root, elem, t->cmp);
 
-    node_threeway_cmp const root_cmp = t->cmp(elem, t->root, NULL);
+    node_threeway_cmp const root_cmp = tree_cmp(t, elem, t->root);
     if (NODE_EQL == root_cmp)
     {
         add_duplicate(t, t->root, elem, &t->end);
@@ -882,7 +1335,7 @@ erase(struct tree *t, struct node *elem)
         return &t->end;
     }
     struct node *ret = splay(t, t->root, elem, t->cmp);
-    node_threeway_cmp const found = t->cmp(elem, ret, NULL);
+    node_threeway_cmp const found = tree_cmp(t, elem, ret);
     if (found != NODE_EQL)
     {
         return &t->end;
@@ -926,6 +1379,279 @@ multiset_erase_max_or_min(struct tree *t, struct node *tnil,
     return ret;
 }
 
+/* A pop of the max or min splays twice: once to bring the extreme to the
+   root and again in remove_from_tree to find the new root among the
+   remaining subtree. However, the extreme has no child in its own direction
+   so the other subtree is already a valid tree with the root's parent
+   updated. The new node only needs a splay of its own if it does not
+   become the new extreme, otherwise it simply takes the root. */
+static struct node *
+multiset_replace_max_or_min(struct tree *t, struct node *new,
+                            tree_cmp_fn *force_max_or_min,
+                            enum tree_link const dir)
+{
+    if (empty(t))
+    {
+        multiset_insert(t, new);
+        return &t->end;
+    }
+    struct node *ret = splay(t, t->root, &t->end, force_max_or_min);
+    if (has_dups(&t->end, ret))
+    {
+        ret = pop_front_dup(t, ret);
+    }
+    else
+    {
+        node_threeway_cmp const new_cmp = tree_cmp(t, new, ret);
+        t->root = ret->link[!dir];
+        link_trees(t, &t->end, 0, t->root);
+        if (NODE_EQL == new_cmp || (NODE_GRT == new_cmp) == dir)
+        {
+            init_node(t, new);
+            link_trees(t, new, !dir, t->root);
+            t->root = new;
+            link_trees(t, &t->end, 0, t->root);
+            ret->link[L] = ret->link[R] = ret->parent_or_dups = NULL;
+            return ret;
+        }
+    }
+    ret->link[L] = ret->link[R] = ret->parent_or_dups = NULL;
+    t->size--;
+    multiset_insert(t, new);
+    return ret;
+}
+
+/* Pops up to n of the max or min elements into out with one splay. Once the
+   extreme is at the root it has no child in its own direction and so does
+   every extreme after it. Each is unlinked with its parent pointer and the
+   next is found by the same walk an iterator takes so the batch costs
+   O(lgN + n). A duplicate ring that fits in the remaining space leaves the
+   tree all at once, otherwise duplicates are popped in round robin order
+   one at a time. Returns the number of elements written to out. */
+static size_t
+multiset_pop_n(struct tree *t, struct node **out, size_t n,
+               tree_cmp_fn *force_max_or_min, enum tree_link const dir)
+{
+    if (!t || !out || empty(t))
+    {
+        return 0;
+    }
+    size_t i = 0;
+    struct node *x = splay(t, t->root, &t->end, force_max_or_min);
+    while (i < n && x != &t->end)
+    {
+        out[i++] = x;
+        if (has_dups(&t->end, x))
+        {
+            i += detach_dup_ring(t, x, out + i, n - i);
+        }
+        x = unlink_extreme(t, x, dir);
+    }
+    return i;
+}
+
+/* Writes the ring of duplicates behind tree node x to out in round robin
+   order if the whole ring fits in n. Then x is given back its parent so it
+   may leave the tree like any other node. Returns the number of duplicates
+   written which is 0 if they do not fit. */
+static size_t
+detach_dup_ring(struct tree *t, struct node *x, struct node **out, size_t n)
+{
+    struct node *const head = x->parent_or_dups;
+    size_t dups = 1;
+    for (struct node *d = head->link[N]; d != head && dups <= n;
+         d = d->link[N])
+    {
+        PROFILE_INC(t->counters.dup_steps);
+        ++dups;
+    }
+    if (dups > n)
+    {
+        return 0;
+    }
+    x->parent_or_dups = head->parent_or_dups;
+    size_t i = 0;
+    struct node *d = head;
+    do
+    {
+        PROFILE_INC(t->counters.dup_steps);
+        struct node *const next_dup = d->link[N];
+        out[i++] = d;
+        d->link[L] = d->link[R] = d->parent_or_dups = NULL;
+        d = next_dup;
+    } while (d != head);
+    t->size -= i;
+    return i;
+}
+
+/* The max or min of the tree has no child in its own direction so it may be
+   unlinked with its parent pointer in O(1) rather than splayed to the root.
+   A top k eviction then only pays for the splay of the element that takes
+   its place and a batch pop only pays for the first splay. The oldest
+   duplicate is unlinked first and its ring head takes its place in the
+   tree. Returns the new max or min, the end if the tree is now empty. */
+static struct node *
+unlink_extreme(struct tree *t, struct node *x, enum tree_link const dir)
+{
+    t->size--;
+    if (has_dups(&t->end, x))
+    {
+        struct node *const tree_replacement = x->parent_or_dups;
+        (void)pop_front_dup(t, x);
+        x->link[L] = x->link[R] = x->parent_or_dups = NULL;
+        return tree_replacement;
+    }
+    struct node *const parent = get_parent(t, x);
+    struct node *const child = x->link[!dir];
+    if (x == t->root)
+    {
+        t->root = child;
+        link_trees(t, &t->end, 0, t->root);
+    }
+    else
+    {
+        link_trees(t, parent, dir, child);
+    }
+    x->link[L] = x->link[R] = x->parent_or_dups = NULL;
+    if (child == &t->end)
+    {
+        return parent;
+    }
+    struct node *next_extreme = child;
+    for (; next_extreme->link[dir] != &t->end;
+         next_extreme = next_extreme->link[dir])
+    {}
+    return next_extreme;
+}
+
+/* The Day-Stout-Warren algorithm. The end node serves as the pseudo root
+   that holds the vine in its right link so the first rotations need no
+   special case. All relinking goes through link_trees so parents and the
+   duplicate rings that track them stay correct throughout. */
+static void
+rebalance(struct tree *t)
+{
+    if (empty(t))
+    {
+        return;
+    }
+    t->end.link[R] = t->root;
+    vine_to_tree(t, tree_to_vine(t));
+    t->root = t->end.link[R];
+    link_trees(t, &t->end, 0, t->root);
+}
+
+/* Rotates every left child up until the tree is a right leaning vine.
+   Returns the number of tree nodes, duplicates not included. */
+static size_t
+tree_to_vine(struct tree *t)
+{
+    size_t nodes = 0;
+    struct node *tail = &t->end;
+    struct node *rest = tail->link[R];
+    while (rest != &t->end)
+    {
+        if (rest->link[L] == &t->end)
+        {
+            tail = rest;
+            rest = rest->link[R];
+            ++nodes;
+            continue;
+        }
+        struct node *const pivot = rest->link[L];
+        link_trees(t, rest, L, pivot->link[R]);
+        link_trees(t, pivot, R, rest);
+        link_trees(t, tail, R, pivot);
+        rest = pivot;
+    }
+    return nodes;
+}
+
+/* Fills the bottom level first so that every level above it is complete,
+   then halves the vine with left rotations until it is a tree. */
+static void
+vine_to_tree(struct tree *t, size_t nodes)
+{
+    size_t full = 1;
+    while (full <= nodes + 1)
+    {
+        full <<= 1;
+    }
+    full >>= 1;
+    size_t const leaves = nodes + 1 - full;
+    compress(t, leaves);
+    nodes -= leaves;
+    while (nodes > 1)
+    {
+        compress(t, nodes / 2);
+        nodes /= 2;
+    }
+}
+
+static void
+compress(struct tree *t, size_t count)
+{
+    struct node *scanner = &t->end;
+    for (size_t i = 0; i < count; ++i)
+    {
+        struct node *const child = scanner->link[R];
+        struct node *const next_scanner = child->link[R];
+        link_trees(t, scanner, R, next_scanner);
+        link_trees(t, child, R, next_scanner->link[L]);
+        link_trees(t, next_scanner, L, child);
+        scanner = next_scanner;
+    }
+}
+
+/* A stackless walk with parent pointers. We arrive at a node from its
+   parent, its left child, or its right child and that alone tells us
+   where to go next, so no stack or writes to the tree are needed. */
+static struct tree_stats
+stats(struct tree const *const t)
+{
+    struct tree_stats st = {0};
+    size_t depth_sum = 0;
+    size_t depth = 1;
+    struct node const *prev = &t->end;
+    struct node const *cur = t->root;
+    while (cur != &t->end)
+    {
+        struct node const *const parent
+            = has_dups(&t->end, cur) ? cur->parent_or_dups->parent_or_dups
+                                     : cur->parent_or_dups;
+        struct node const *next_node = parent;
+        if (prev == parent)
+        {
+            ++st.nodes;
+            depth_sum += depth;
+            st.height = depth > st.height ? depth : st.height;
+            size_t const dups = count_dups(t, cur);
+            st.dups += dups;
+            st.dup_rings += dups != 0;
+            if (cur->link[L] != &t->end)
+            {
+                next_node = cur->link[L];
+            }
+            else if (cur->link[R] != &t->end)
+            {
+                next_node = cur->link[R];
+            }
+        }
+        else if (prev == cur->link[L] && cur->link[R] != &t->end)
+        {
+            next_node = cur->link[R];
+        }
+        depth = next_node == parent ? depth - 1 : depth + 1;
+        prev = cur;
+        cur = next_node;
+    }
+    if (st.nodes)
+    {
+        st.avg_depth = (double)depth_sum / (double)st.nodes;
+    }
+    return st;
+}
+
 /* We need to mindful of what the user is asking for. This is a request
    to erase the exact node provided in the argument. So extra care is
    taken to only delete that node, especially if a different node with
@@ -954,7 +1680,7 @@ multiset_erase_node(struct tree *t, struct node *node)
         return node;
     }
     struct node *ret = splay(t, t->root, node, t->cmp);
-    if (t->cmp(node, ret, NULL) != NODE_EQL)
+    if (tree_cmp(t, node, ret) != NODE_EQL)
     {
         return &t->end;
     }
@@ -1006,7 +1732,7 @@ pop_front_dup(struct tree *t, struct node *old)
     else
     {
         /* Comparing sizes with the root's parent is undefined. */
-        parent->link[NODE_GRT == t->cmp(old, parent, NULL)] = tree_replacement;
+        parent->link[NODE_GRT == tree_cmp(t, old, parent)] = tree_replacement;
     }
 
     struct node *new_list_head = old->parent_or_dups->link[N];
@@ -1054,20 +1780,24 @@ splay(struct tree *t, struct node *root, struct node const *elem,
        as our helper tree because we don't need its Left Right fields. */
     t->end.link[L] = t->end.link[R] = t->end.parent_or_dups = &t->end;
     struct node *l_r_subtrees[LR] = {&t->end, &t->end};
+    PROFILE_INC(t->counters.splays);
     for (;;)
     {
+        PROFILE_INC(t->counters.cmps);
         node_threeway_cmp const root_cmp = cmp(elem, root, t->aux);
         enum tree_link const dir = NODE_GRT == root_cmp;
         if (NODE_EQL == root_cmp || root->link[dir] == &t->end)
         {
             break;
         }
+        PROFILE_INC(t->counters.cmps);
         node_threeway_cmp const child_cmp = cmp(elem, root->link[dir], t->aux);
         enum tree_link const dir_from_child = NODE_GRT == child_cmp;
         /* A straight line has formed from root->child->elem. An opportunity
            to splay and heal the tree arises. */
         if (NODE_EQL != child_cmp && dir == dir_from_child)
         {
+            PROFILE_INC(t->counters.rotations);
             struct node *const pivot = root->link[dir];
             link_trees(t, root, dir, pivot->link[!dir]);
             link_trees(t, pivot, !dir, root);
@@ -1101,6 +1831,7 @@ static inline void
 link_trees(struct tree *t, struct node *parent, enum tree_link dir,
            struct node *subtree)
 {
+    PROFILE_INC(t->counters.links);
     parent->link[dir] = subtree;
     if (has_dups(&t->end, subtree))
     {
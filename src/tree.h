@@ -65,6 +65,19 @@ typedef enum
 typedef node_threeway_cmp tree_cmp_fn(struct node const *key,
                                       struct node const *n, void *aux);
 
+/* Operation counts for profiling builds, see CONTAINER_PROFILE in attrib.h.
+   Comparisons include the forced comparisons used to find the max and min.
+   Links count every child and parent pointer pair written and dup_steps
+   count the steps taken through duplicate rings. */
+struct tree_counters
+{
+    size_t cmps;
+    size_t splays;
+    size_t rotations;
+    size_t links;
+    size_t dup_steps;
+};
+
 /* The size field is not strictly necessary but seems to be standard
    practice for these types of containers for O(1) access. The end is
    critical for this implementation, especially iterators. */
@@ -75,6 +88,9 @@ struct tree
     tree_cmp_fn *cmp;
     void *aux;
     size_t size;
+#ifdef CONTAINER_PROFILE
+    struct tree_counters counters;
+#endif
 };
 
 /* The underlying tree range can serve as both an inorder and reverse
@@ -93,8 +109,37 @@ struct rrange
     struct node *const end ATTRIB_PRIVATE;
 };
 
+/* A read only cursor for full traversals. The cursor remembers the tree
+   node that owns the duplicate ring it is walking, if any, so each step is
+   a plain pointer walk. The tree is never written during iteration. Sets
+   never have duplicates and skip the ring checks entirely. */
+struct cursor
+{
+    struct node const *end;
+    struct node *cur;
+    struct node *ring_owner;
+    enum tree_link traversal;
+    bool dups;
+};
+
+/* A snapshot of the shape of a tree. Depth counts the nodes on the path
+   from the root so a lone root has depth 1 and a lookup of a node visits
+   depth nodes. Duplicates wait in a ring behind a tree node and do not
+   count toward the shape, so nodes + dups is the size of the tree. */
+struct tree_stats
+{
+    size_t nodes;
+    size_t height;
+    double avg_depth;
+    size_t dup_rings;
+    size_t dups;
+};
+
 typedef void node_print_fn(struct node const *);
 
+/* The visitor the interfaces cast their typed callbacks to for for_each. */
+typedef void node_visit_fn(struct node *, void *aux);
+
 #define TREE_INIT(TREE_NAME, CMP, AUX)                                         \
     {                                                                          \
         .root = &(TREE_NAME).t.end,                                            \
@@ -0,0 +1,92 @@
+#include "bucket_pqueue.h"
+#include "test.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+struct val
+{
+    int id;
+    struct bpq_elem elem;
+};
+
+static enum test_result bpq_test_empty(void);
+static enum test_result bpq_test_out_of_range(void);
+static enum test_result bpq_test_profile(void);
+
+#define NUM_TESTS (size_t)3
+test_fn const all_tests[NUM_TESTS] = {
+    bpq_test_empty,
+    bpq_test_out_of_range,
+    bpq_test_profile,
+};
+
+int
+main()
+{
+    enum test_result res = PASS;
+    for (size_t i = 0; i < NUM_TESTS; ++i)
+    {
+        bool const fail = all_tests[i]() == FAIL;
+        if (fail)
+        {
+            res = FAIL;
+        }
+    }
+    return res;
+}
+
+static enum test_result
+bpq_test_empty(void)
+{
+    struct bpq_elem *buckets[8] = {0};
+    struct bucket_pqueue bq = BPQ_INIT(buckets, 8);
+    CHECK(bpq_empty(&bq), true, bool, "%d");
+    CHECK(bpq_num_buckets(&bq), 8, size_t, "%zu");
+    CHECK(bpq_max(&bq) == NULL, true, bool, "%d");
+    CHECK(bpq_pop_min(&bq) == NULL, true, bool, "%d");
+    CHECK(bpq_validate(&bq), true, bool, "%d");
+    return PASS;
+}
+
+static enum test_result
+bpq_test_out_of_range(void)
+{
+    struct bpq_elem *buckets[8] = {0};
+    struct bucket_pqueue bq = BPQ_INIT(buckets, 8);
+    struct val v = {0};
+    CHECK(bpq_push(&bq, &v.elem, 8), false, bool, "%d");
+    CHECK(bpq_empty(&bq), true, bool, "%d");
+    CHECK(bpq_update(&bq, &v.elem, 3), false, bool, "%d");
+    CHECK(bpq_erase(&bq, &v.elem) == NULL, true, bool, "%d");
+    CHECK(bpq_push(&bq, &v.elem, 7), true, bool, "%d");
+    CHECK(bpq_update(&bq, &v.elem, 8), false, bool, "%d");
+    CHECK(bpq_priority(&v.elem), 7, size_t, "%zu");
+    CHECK(bpq_validate(&bq), true, bool, "%d");
+    return PASS;
+}
+
+static enum test_result
+bpq_test_profile(void)
+{
+    struct bpq_elem *buckets[64] = {0};
+    struct bucket_pqueue bq = BPQ_INIT(buckets, 64);
+    struct val vals[4];
+    for (size_t i = 0; i < 4; ++i)
+    {
+        (void)bpq_push(&bq, &vals[i].elem, i * 20);
+    }
+    for (size_t i = 0; i < 4; ++i)
+    {
+        (void)bpq_pop_min(&bq);
+    }
+    struct bpq_counters const c = bpq_profile(&bq);
+#ifdef CONTAINER_PROFILE
+    CHECK(c.skips, 60, size_t, "%zu");
+    bpq_profile_reset(&bq);
+    CHECK(bpq_profile(&bq).skips, 0, size_t, "%zu");
+#else
+    CHECK(c.skips, 0, size_t, "%zu");
+#endif
+    return PASS;
+}
@@ -0,0 +1,172 @@
+#include "bucket_pqueue.h"
+#include "test.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+struct val
+{
+    int id;
+    struct bpq_elem elem;
+};
+
+static enum test_result bpq_test_round_robin_max(void);
+static enum test_result bpq_test_round_robin_min(void);
+static enum test_result bpq_test_pop_both_ends(void);
+static enum test_result bpq_test_erase_update_shuffled(void);
+
+#define NUM_TESTS (size_t)4
+test_fn const all_tests[NUM_TESTS] = {
+    bpq_test_round_robin_max,
+    bpq_test_round_robin_min,
+    bpq_test_pop_both_ends,
+    bpq_test_erase_update_shuffled,
+};
+
+int
+main()
+{
+    enum test_result res = PASS;
+    for (size_t i = 0; i < NUM_TESTS; ++i)
+    {
+        bool const fail = all_tests[i]() == FAIL;
+        if (fail)
+        {
+            res = FAIL;
+        }
+    }
+    return res;
+}
+
+static enum test_result
+bpq_test_round_robin_max(void)
+{
+    struct bpq_elem *buckets[4] = {0};
+    struct bucket_pqueue bq = BPQ_INIT(buckets, 4);
+    struct val vals[6];
+    for (int i = 0; i < 6; ++i)
+    {
+        vals[i].id = i;
+        CHECK(bpq_push(&bq, &vals[i].elem, i % 2 ? 3 : 1), true, bool, "%d");
+    }
+    /* Ties leave oldest first: 1, 3, 5 then 0, 2, 4. */
+    int const order[6] = {1, 3, 5, 0, 2, 4};
+    for (size_t i = 0; i < 6; ++i)
+    {
+        struct val const *const v
+            = BPQ_ENTRY(bpq_pop_max(&bq), struct val, elem);
+        CHECK(v->id, order[i], int, "%d");
+        CHECK(bpq_validate(&bq), true, bool, "%d");
+    }
+    CHECK(bpq_empty(&bq), true, bool, "%d");
+    return PASS;
+}
+
+static enum test_result
+bpq_test_round_robin_min(void)
+{
+    struct bpq_elem *buckets[4] = {0};
+    struct bucket_pqueue bq = BPQ_INIT(buckets, 4);
+    struct val vals[6];
+    for (int i = 0; i < 6; ++i)
+    {
+        vals[i].id = i;
+        CHECK(bpq_push(&bq, &vals[i].elem, 2), true, bool, "%d");
+    }
+    /* Updating to the same priority is a new arrival at the back. */
+    CHECK(bpq_update(&bq, &vals[0].elem, 2), true, bool, "%d");
+    int const order[6] = {1, 2, 3, 4, 5, 0};
+    for (size_t i = 0; i < 6; ++i)
+    {
+        struct val const *const v = BPQ_ENTRY(bpq_min(&bq), struct val, elem);
+        CHECK(v->id, order[i], int, "%d");
+        CHECK(bpq_pop_min(&bq) == &v->elem, true, bool, "%d");
+        CHECK(bpq_validate(&bq), true, bool, "%d");
+    }
+    return PASS;
+}
+
+static enum test_result
+bpq_test_pop_both_ends(void)
+{
+    struct bpq_elem *buckets[101] = {0};
+    struct bucket_pqueue bq = BPQ_INIT(buckets, 101);
+    /* Seed the test with any integer for reproducible random test sequence
+       currently this will change every test. NOLINTNEXTLINE */
+    srand(time(NULL));
+    size_t const num_nodes = 1000;
+    struct val vals[num_nodes];
+    for (size_t i = 0; i < num_nodes; ++i)
+    {
+        vals[i].id = (int)i;
+        CHECK(bpq_push(&bq, &vals[i].elem, (size_t)rand() % 101), // NOLINT
+              true, bool, "%d");
+        CHECK(bpq_validate(&bq), true, bool, "%d");
+    }
+    size_t lo = 0;
+    size_t hi = 100;
+    for (size_t i = 0; i < num_nodes; ++i)
+    {
+        if (i % 2)
+        {
+            struct bpq_elem const *const e = bpq_pop_max(&bq);
+            CHECK(bpq_priority(e) <= hi, true, bool, "%d");
+            hi = bpq_priority(e);
+        }
+        else
+        {
+            struct bpq_elem const *const e = bpq_pop_min(&bq);
+            CHECK(bpq_priority(e) >= lo, true, bool, "%d");
+            lo = bpq_priority(e);
+        }
+        CHECK(bpq_validate(&bq), true, bool, "%d");
+    }
+    CHECK(lo <= hi, true, bool, "%d");
+    CHECK(bpq_empty(&bq), true, bool, "%d");
+    return PASS;
+}
+
+static enum test_result
+bpq_test_erase_update_shuffled(void)
+{
+    struct bpq_elem *buckets[16] = {0};
+    struct bucket_pqueue bq = BPQ_INIT(buckets, 16);
+    size_t const size = 99;
+    size_t const prime = 101;
+    struct val vals[size];
+    size_t shuffled_index = prime % size;
+    for (size_t i = 0; i < size; ++i)
+    {
+        vals[shuffled_index].id = (int)shuffled_index;
+        CHECK(bpq_push(&bq, &vals[shuffled_index].elem, shuffled_index % 16),
+              true, bool, "%d");
+        shuffled_index = (shuffled_index + prime) % size;
+    }
+    for (size_t i = 0; i < size; i += 3)
+    {
+        CHECK(bpq_update(&bq, &vals[i].elem, 15 - (i % 16)), true, bool,
+              "%d");
+        CHECK(bpq_validate(&bq), true, bool, "%d");
+    }
+    size_t cur_size = size;
+    for (size_t i = 0; i < size; i += 2)
+    {
+        CHECK(bpq_erase(&bq, &vals[i].elem) == &vals[i].elem, true, bool,
+              "%d");
+        --cur_size;
+        CHECK(bpq_size(&bq), cur_size, size_t, "%zu");
+        CHECK(bpq_validate(&bq), true, bool, "%d");
+    }
+    CHECK(bpq_erase(&bq, &vals[0].elem) == NULL, true, bool, "%d");
+    size_t prev = 0;
+    while (!bpq_empty(&bq))
+    {
+        struct bpq_elem const *const e = bpq_pop_min(&bq);
+        CHECK(bpq_priority(e) >= prev, true, bool, "%d");
+        prev = bpq_priority(e);
+    }
+    return PASS;
+}
@@ -0,0 +1,173 @@
+#include "concurrent_depq.h"
+#include "depqueue.h"
+#include "test.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <time.h>
+
+struct val
+{
+    int id;
+    int val;
+    struct depq_elem elem;
+};
+
+static enum test_result cdepq_test_empty(void);
+static enum test_result cdepq_test_exact_order(void);
+static enum test_result cdepq_test_relaxed_all_out(void);
+static enum test_result cdepq_test_clear(void);
+static dpq_threeway_cmp val_cmp(struct depq_elem const *,
+                                struct depq_elem const *, void *);
+static void count_destruct(struct depq_elem *);
+
+static int destructed = 0;
+
+#define NUM_TESTS (size_t)4
+test_fn const all_tests[NUM_TESTS] = {
+    cdepq_test_empty,
+    cdepq_test_exact_order,
+    cdepq_test_relaxed_all_out,
+    cdepq_test_clear,
+};
+
+int
+main()
+{
+    /* Seed the test with any integer for reproducible randome test sequence
+       currently this will change every test. NOLINTNEXTLINE */
+    srand(time(NULL));
+    enum test_result res = PASS;
+    for (size_t i = 0; i < NUM_TESTS; ++i)
+    {
+        bool const fail = all_tests[i]() == FAIL;
+        if (fail)
+        {
+            res = FAIL;
+        }
+    }
+    return res;
+}
+
+static enum test_result
+cdepq_test_empty(void)
+{
+    struct concurrent_depq q;
+    CHECK(cdepq_init(&q, 0, CDEPQ_RELAXED, val_cmp, NULL), false, bool, "%d");
+    enum cdepq_mode const modes[2] = {CDEPQ_RELAXED, CDEPQ_EXACT};
+    for (size_t m = 0; m < 2; ++m)
+    {
+        CHECK(cdepq_init(&q, 4, modes[m], val_cmp, NULL), true, bool, "%d");
+        CHECK(cdepq_num_shards(&q), 4, size_t, "%zu");
+        CHECK(cdepq_empty(&q), true, bool, "%d");
+        CHECK(cdepq_pop_max(&q) == NULL, true, bool, "%d");
+        CHECK(cdepq_pop_min(&q) == NULL, true, bool, "%d");
+        CHECK(cdepq_validate(&q), true, bool, "%d");
+        cdepq_clear(&q, NULL);
+    }
+    return PASS;
+}
+
+/* Exact pops see every shard so a single thread gets a sorted sequence
+   from both ends. */
+static enum test_result
+cdepq_test_exact_order(void)
+{
+    struct concurrent_depq q;
+    CHECK(cdepq_init(&q, 7, CDEPQ_EXACT, val_cmp, NULL), true, bool, "%d");
+    struct val vals[1000];
+    for (int i = 0; i < 1000; ++i)
+    {
+        vals[i] = (struct val){.id = i, .val = rand() % 200}; // NOLINT
+        cdepq_push(&q, &vals[i].elem);
+    }
+    CHECK(cdepq_size(&q), 1000, size_t, "%zu");
+    CHECK(cdepq_validate(&q), true, bool, "%d");
+    int prev = 200;
+    for (int i = 0; i < 500; ++i)
+    {
+        struct val const *const v
+            = DEPQ_ENTRY(cdepq_pop_max(&q), struct val, elem);
+        CHECK(v->val <= prev, true, bool, "%d");
+        prev = v->val;
+    }
+    int const last_max = prev;
+    prev = -1;
+    for (int i = 0; i < 500; ++i)
+    {
+        struct val const *const v
+            = DEPQ_ENTRY(cdepq_pop_min(&q), struct val, elem);
+        CHECK(v->val >= prev && v->val <= last_max, true, bool, "%d");
+        prev = v->val;
+    }
+    CHECK(cdepq_empty(&q), true, bool, "%d");
+    CHECK(cdepq_validate(&q), true, bool, "%d");
+    cdepq_clear(&q, NULL);
+    return PASS;
+}
+
+/* Relaxed pops may come out of order but every element comes out once and
+   the first pop is the better of at least two shard fronts. */
+static enum test_result
+cdepq_test_relaxed_all_out(void)
+{
+    struct concurrent_depq q;
+    CHECK(cdepq_init(&q, 8, CDEPQ_RELAXED, val_cmp, NULL), true, bool, "%d");
+    struct val vals[1000];
+    bool seen[1000] = {0};
+    for (int i = 0; i < 1000; ++i)
+    {
+        vals[i] = (struct val){.id = i, .val = rand() % 5000}; // NOLINT
+        cdepq_push(&q, &vals[i].elem);
+    }
+    for (int i = 0; i < 1000; ++i)
+    {
+        struct depq_elem *const e
+            = i % 2 ? cdepq_pop_max(&q) : cdepq_pop_min(&q);
+        CHECK(e != NULL, true, bool, "%d");
+        struct val const *const v = DEPQ_ENTRY(e, struct val, elem);
+        CHECK(seen[v->id], false, bool, "%d");
+        seen[v->id] = true;
+        CHECK(cdepq_size(&q), (size_t)(999 - i), size_t, "%zu");
+    }
+    CHECK(cdepq_pop_max(&q) == NULL, true, bool, "%d");
+    CHECK(cdepq_validate(&q), true, bool, "%d");
+    cdepq_clear(&q, NULL);
+    return PASS;
+}
+
+static enum test_result
+cdepq_test_clear(void)
+{
+    struct concurrent_depq q;
+    CHECK(cdepq_init(&q, 3, CDEPQ_RELAXED, val_cmp, NULL), true, bool, "%d");
+    struct val vals[100];
+    for (int i = 0; i < 100; ++i)
+    {
+        vals[i] = (struct val){.id = i, .val = i};
+        cdepq_push(&q, &vals[i].elem);
+    }
+    destructed = 0;
+    cdepq_clear(&q, count_destruct);
+    CHECK(destructed, 100, int, "%d");
+    CHECK(cdepq_num_shards(&q), 0, size_t, "%zu");
+    return PASS;
+}
+
+static dpq_threeway_cmp
+val_cmp(struct depq_elem const *const a, struct depq_elem const *const b,
+        void *const aux)
+{
+    (void)aux;
+    int const x = DEPQ_ENTRY(a, struct val, elem)->val;
+    int const y = DEPQ_ENTRY(b, struct val, elem)->val;
+    return (x > y) - (x < y);
+}
+
+static void
+count_destruct(struct depq_elem *const e)
+{
+    (void)e;
+    ++destructed;
+}
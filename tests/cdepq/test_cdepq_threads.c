@@ -0,0 +1,225 @@
+#include "concurrent_depq.h"
+#include "depqueue.h"
+#include "test.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+struct val
+{
+    int id;
+    int val;
+    struct depq_elem elem;
+};
+
+/* The shared state of the producers and consumers of one run. */
+struct run
+{
+    struct concurrent_depq *q;
+    struct val *vals;
+    atomic_int *seen;
+    atomic_size_t popped;
+    size_t total;
+};
+
+/* A thread of a run with the slice of elements it pushes. */
+struct worker
+{
+    struct run *run;
+    size_t begin;
+    size_t end;
+    bool max;
+    bool ordered;
+};
+
+static enum test_result cdepq_test_producers_consumers(void);
+static enum test_result cdepq_test_exact_concurrent_pops(void);
+static enum test_result producers_consumers(enum cdepq_mode);
+static void *produce(void *);
+static void *consume(void *);
+static void *pop_in_order(void *);
+static dpq_threeway_cmp val_cmp(struct depq_elem const *,
+                                struct depq_elem const *, void *);
+
+#define THREADS (size_t)4
+#define PER_THREAD (size_t)5000
+
+#define NUM_TESTS (size_t)2
+test_fn const all_tests[NUM_TESTS] = {
+    cdepq_test_producers_consumers,
+    cdepq_test_exact_concurrent_pops,
+};
+
+int
+main()
+{
+    enum test_result res = PASS;
+    for (size_t i = 0; i < NUM_TESTS; ++i)
+    {
+        bool const fail = all_tests[i]() == FAIL;
+        if (fail)
+        {
+            res = FAIL;
+        }
+    }
+    return res;
+}
+
+static enum test_result
+cdepq_test_producers_consumers(void)
+{
+    CHECK(producers_consumers(CDEPQ_RELAXED), PASS, enum test_result, "%d");
+    CHECK(producers_consumers(CDEPQ_EXACT), PASS, enum test_result, "%d");
+    return PASS;
+}
+
+/* With no pushes running every exact pop takes the max of the whole queue
+   so each thread sees its own pops in non-increasing order. */
+static enum test_result
+cdepq_test_exact_concurrent_pops(void)
+{
+    struct concurrent_depq q;
+    CHECK(cdepq_init(&q, 8, CDEPQ_EXACT, val_cmp, NULL), true, bool, "%d");
+    size_t const total = THREADS * PER_THREAD;
+    struct val *const vals = malloc(total * sizeof(struct val));
+    CHECK(vals != NULL, true, bool, "%d");
+    for (size_t i = 0; i < total; ++i)
+    {
+        vals[i] = (struct val){.id = (int)i, .val = (int)((i * 7919) % 1000)};
+        cdepq_push(&q, &vals[i].elem);
+    }
+    struct run run = {.q = &q, .vals = vals, .total = total};
+    atomic_init(&run.popped, 0);
+    pthread_t threads[THREADS];
+    struct worker workers[THREADS];
+    for (size_t i = 0; i < THREADS; ++i)
+    {
+        workers[i] = (struct worker){.run = &run, .max = true};
+        CHECK(pthread_create(&threads[i], NULL, pop_in_order, &workers[i]), 0,
+              int, "%d");
+    }
+    for (size_t i = 0; i < THREADS; ++i)
+    {
+        CHECK(pthread_join(threads[i], NULL), 0, int, "%d");
+        CHECK(workers[i].ordered, true, bool, "%d");
+    }
+    CHECK(atomic_load(&run.popped), total, size_t, "%zu");
+    CHECK(cdepq_empty(&q), true, bool, "%d");
+    cdepq_clear(&q, NULL);
+    free(vals);
+    return PASS;
+}
+
+/* Producers push disjoint slices while as many consumers pop from both
+   ends until every element is out. Each element must come out once. */
+static enum test_result
+producers_consumers(enum cdepq_mode const mode)
+{
+    struct concurrent_depq q;
+    CHECK(cdepq_init(&q, 2 * THREADS, mode, val_cmp, NULL), true, bool, "%d");
+    size_t const total = THREADS * PER_THREAD;
+    struct val *const vals = malloc(total * sizeof(struct val));
+    atomic_int *const seen = malloc(total * sizeof(atomic_int));
+    CHECK(vals && seen, true, bool, "%d");
+    for (size_t i = 0; i < total; ++i)
+    {
+        vals[i] = (struct val){.id = (int)i, .val = (int)((i * 31) % 997)};
+        atomic_init(&seen[i], 0);
+    }
+    struct run run = {.q = &q, .vals = vals, .seen = seen, .total = total};
+    atomic_init(&run.popped, 0);
+    pthread_t threads[2 * THREADS];
+    struct worker workers[2 * THREADS];
+    for (size_t i = 0; i < THREADS; ++i)
+    {
+        workers[i] = (struct worker){
+            .run = &run,
+            .begin = i * PER_THREAD,
+            .end = (i + 1) * PER_THREAD,
+        };
+        workers[THREADS + i] = (struct worker){.run = &run, .max = i % 2};
+    }
+    for (size_t i = 0; i < 2 * THREADS; ++i)
+    {
+        CHECK(pthread_create(&threads[i], NULL,
+                             i < THREADS ? produce : consume, &workers[i]),
+              0, int, "%d");
+    }
+    for (size_t i = 0; i < 2 * THREADS; ++i)
+    {
+        CHECK(pthread_join(threads[i], NULL), 0, int, "%d");
+    }
+    CHECK(atomic_load(&run.popped), total, size_t, "%zu");
+    for (size_t i = 0; i < total; ++i)
+    {
+        CHECK(atomic_load(&seen[i]), 1, int, "%d");
+    }
+    CHECK(cdepq_empty(&q), true, bool, "%d");
+    CHECK(cdepq_validate(&q), true, bool, "%d");
+    cdepq_clear(&q, NULL);
+    free(seen);
+    free(vals);
+    return PASS;
+}
+
+static void *
+produce(void *const arg)
+{
+    struct worker *const w = arg;
+    for (size_t i = w->begin; i < w->end; ++i)
+    {
+        cdepq_push(w->run->q, &w->run->vals[i].elem);
+    }
+    return NULL;
+}
+
+static void *
+consume(void *const arg)
+{
+    struct worker *const w = arg;
+    struct run *const run = w->run;
+    while (atomic_load(&run->popped) < run->total)
+    {
+        struct depq_elem *const e
+            = w->max ? cdepq_pop_max(run->q) : cdepq_pop_min(run->q);
+        if (e)
+        {
+            (void)atomic_fetch_add(
+                &run->seen[DEPQ_ENTRY(e, struct val, elem)->id], 1);
+            (void)atomic_fetch_add(&run->popped, 1);
+        }
+    }
+    return NULL;
+}
+
+static void *
+pop_in_order(void *const arg)
+{
+    struct worker *const w = arg;
+    w->ordered = true;
+    int prev = 1000;
+    for (struct depq_elem *e = NULL; (e = cdepq_pop_max(w->run->q));)
+    {
+        int const cur = DEPQ_ENTRY(e, struct val, elem)->val;
+        if (cur > prev)
+        {
+            w->ordered = false;
+        }
+        prev = cur;
+        (void)atomic_fetch_add(&w->run->popped, 1);
+    }
+    return NULL;
+}
+
+static dpq_threeway_cmp
+val_cmp(struct depq_elem const *const a, struct depq_elem const *const b,
+        void *const aux)
+{
+    (void)aux;
+    int const x = DEPQ_ENTRY(a, struct val, elem)->val;
+    int const y = DEPQ_ENTRY(b, struct val, elem)->val;
+    return (x > y) - (x < y);
+}
@@ -12,11 +12,12 @@ struct val
 };
 
 static enum test_result depq_test_empty(void);
+static enum test_result depq_test_profile(void);
 static dpq_threeway_cmp val_cmp(struct depq_elem const *,
                                 struct depq_elem const *, void *);
 
-#define NUM_TESTS (size_t)1
-test_fn const all_tests[NUM_TESTS] = {depq_test_empty};
+#define NUM_TESTS (size_t)2
+test_fn const all_tests[NUM_TESTS] = {depq_test_empty, depq_test_profile};
 
 int
 main()
@@ -41,6 +42,35 @@ depq_test_empty(void)
     return PASS;
 }
 
+static enum test_result
+depq_test_profile(void)
+{
+    struct depqueue pq = DEPQ_INIT(pq, val_cmp, NULL);
+    struct val vals[10];
+    for (int i = 0; i < 10; ++i)
+    {
+        vals[i].val = i % 5;
+        depq_push(&pq, &vals[i].elem);
+    }
+    for (struct depq_elem *e = depq_begin(&pq); e != depq_end(&pq);
+         e = depq_next(&pq, e))
+    {}
+    struct tree_counters const c = depq_profile(&pq);
+#ifdef CONTAINER_PROFILE
+    CHECK(c.splays, 9, size_t, "%zu");
+    CHECK(c.cmps > 0, true, bool, "%d");
+    CHECK(c.links > 0, true, bool, "%d");
+    /* Five rings of one duplicate are each stepped into and out of. */
+    CHECK(c.dup_steps, 5, size_t, "%zu");
+    depq_profile_reset(&pq);
+    CHECK(depq_profile(&pq).links, 0, size_t, "%zu");
+#else
+    CHECK(c.cmps, 0, size_t, "%zu");
+    CHECK(c.splays, 0, size_t, "%zu");
+#endif
+    return PASS;
+}
+
 static dpq_threeway_cmp
 val_cmp(struct depq_elem const *a, struct depq_elem const *b, void *aux)
 {
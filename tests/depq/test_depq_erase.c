@@ -24,6 +24,9 @@ static enum test_result depq_test_min_round_robin(void);
 static enum test_result depq_test_delete_prime_shuffle_duplicates(void);
 static enum test_result depq_test_prime_shuffle(void);
 static enum test_result depq_test_weak_srand(void);
+static enum test_result depq_test_replace_max_min(void);
+static enum test_result depq_test_replace_round_robin(void);
+static enum test_result depq_test_pop_n_matches_pops(void);
 static enum test_result insert_shuffled(struct depqueue *, struct val[], size_t,
                                         int);
 static size_t inorder_fill(int[], size_t, struct depqueue *);
@@ -31,7 +34,7 @@ static dpq_threeway_cmp val_cmp(struct depq_elem const *,
                                 struct depq_elem const *, void *);
 static void depq_printer_fn(struct depq_elem const *);
 
-#define NUM_TESTS (size_t)9
+#define NUM_TESTS (size_t)12
 test_fn const all_tests[NUM_TESTS] = {
     depq_test_insert_remove_four_dups,
     depq_test_insert_erase_shuffled,
@@ -42,6 +45,9 @@ test_fn const all_tests[NUM_TESTS] = {
     depq_test_delete_prime_shuffle_duplicates,
     depq_test_prime_shuffle,
     depq_test_weak_srand,
+    depq_test_replace_max_min,
+    depq_test_replace_round_robin,
+    depq_test_pop_n_matches_pops,
 };
 
 int
@@ -341,6 +347,132 @@ depq_test_weak_srand(void)
     return PASS;
 }
 
+static enum test_result
+depq_test_replace_max_min(void)
+{
+    struct depqueue pq = DEPQ_INIT(pq, val_cmp, NULL);
+    size_t const size = 50;
+    int const prime = 53;
+    struct val vals[size];
+    CHECK(insert_shuffled(&pq, vals, size, prime), PASS, enum test_result,
+          "%d");
+    /* Streaming larger values through the min keeps the window sorted. */
+    struct val up[size];
+    for (size_t i = 0; i < size; ++i)
+    {
+        up[i].val = (int)(size + i);
+        struct val const *old
+            = DEPQ_ENTRY(depq_replace_min(&pq, &up[i].elem), struct val, elem);
+        CHECK(old->val, (int)i, int, "%d");
+        CHECK(validate_tree(&pq.t), true, bool, "%d");
+        CHECK(depq_size(&pq), size, size_t, "%zu");
+    }
+    /* Smaller replacements for the max must be inserted in sorted order. */
+    for (size_t i = 0; i < size; ++i)
+    {
+        vals[i].val = (int)i;
+        struct val const *old = DEPQ_ENTRY(
+            depq_replace_max(&pq, &vals[i].elem), struct val, elem);
+        CHECK(old->val, (int)((size * 2) - 1 - i), int, "%d");
+        CHECK(validate_tree(&pq.t), true, bool, "%d");
+        CHECK(depq_size(&pq), size, size_t, "%zu");
+    }
+    struct val const *min = DEPQ_ENTRY(depq_const_min(&pq), struct val, elem);
+    CHECK(min->val, 0, int, "%d");
+    return PASS;
+}
+
+static enum test_result
+depq_test_replace_round_robin(void)
+{
+    struct depqueue pq = DEPQ_INIT(pq, val_cmp, NULL);
+    struct val vals[4] = {
+        {.id = 0, .val = 9},
+        {.id = 1, .val = 9},
+        {.id = 2, .val = 9},
+        {.id = 3, .val = 1},
+    };
+    for (int i = 0; i < 4; ++i)
+    {
+        depq_push(&pq, &vals[i].elem);
+    }
+    /* Equal replacements go to the back of the round robin duplicates. */
+    struct val more[3] = {
+        {.id = 4, .val = 9},
+        {.id = 5, .val = 9},
+        {.id = 6, .val = 9},
+    };
+    int const expected_out[6] = {0, 1, 2, 4, 5, 6};
+    for (int i = 0; i < 3; ++i)
+    {
+        struct val const *old = DEPQ_ENTRY(
+            depq_replace_max(&pq, &more[i].elem), struct val, elem);
+        CHECK(old->id, expected_out[i], int, "%d");
+        CHECK(validate_tree(&pq.t), true, bool, "%d");
+    }
+    for (int i = 3; i < 6; ++i)
+    {
+        struct val const *old
+            = DEPQ_ENTRY(depq_pop_max(&pq), struct val, elem);
+        CHECK(old->id, expected_out[i], int, "%d");
+        CHECK(validate_tree(&pq.t), true, bool, "%d");
+    }
+    CHECK(depq_size(&pq), 1, size_t, "%zu");
+    struct depqueue empty = DEPQ_INIT(empty, val_cmp, NULL);
+    CHECK(depq_replace_min(&empty, &vals[0].elem) == depq_end(&empty), true,
+          bool, "%d");
+    CHECK(depq_size(&empty), 1, size_t, "%zu");
+    return PASS;
+}
+
+static enum test_result
+depq_test_pop_n_matches_pops(void)
+{
+    /* Two identical queues with many duplicates. Batches of every size,
+       including batches that split a duplicate ring, must come out in the
+       same round robin order as single pops. NOLINTNEXTLINE */
+    srand(time(NULL));
+    int const num_nodes = 300;
+    struct val batched[num_nodes];
+    struct val single[num_nodes];
+    for (int dir = 0; dir < 2; ++dir)
+    {
+        struct depqueue pq_batched = DEPQ_INIT(pq_batched, val_cmp, NULL);
+        struct depqueue pq_single = DEPQ_INIT(pq_single, val_cmp, NULL);
+        for (int i = 0; i < num_nodes; ++i)
+        {
+            batched[i].val = single[i].val = rand() % 25; // NOLINT
+            batched[i].id = single[i].id = i;
+            depq_push(&pq_batched, &batched[i].elem);
+            depq_push(&pq_single, &single[i].elem);
+        }
+        struct depq_elem *out[num_nodes];
+        size_t batch = 1;
+        while (!depq_empty(&pq_batched))
+        {
+            size_t const popped
+                = dir ? depq_pop_min_n(&pq_batched, out, batch)
+                      : depq_pop_max_n(&pq_batched, out, batch);
+            CHECK(validate_tree(&pq_batched.t), true, bool, "%d");
+            CHECK(popped <= batch, true, bool, "%d");
+            for (size_t i = 0; i < popped; ++i)
+            {
+                struct val const *expect = DEPQ_ENTRY(
+                    dir ? depq_pop_min(&pq_single) : depq_pop_max(&pq_single),
+                    struct val, elem);
+                struct val const *got = DEPQ_ENTRY(out[i], struct val, elem);
+                CHECK(got->id, expect->id, int, "%d");
+            }
+            CHECK(depq_size(&pq_batched), depq_size(&pq_single), size_t,
+                  "%zu");
+            batch = batch % 17 + 1;
+        }
+        CHECK(depq_empty(&pq_single), true, bool, "%d");
+        CHECK(depq_pop_max_n(&pq_batched, out, 4), 0, size_t, "%zu");
+    }
+    return PASS;
+}
+
 static enum test_result
 insert_shuffled(struct depqueue *pq, struct val vals[], size_t const size,
                 int const larger_prime)
@@ -19,17 +19,19 @@ static enum test_result depq_test_insert_shuffle(void);
 static enum test_result depq_test_struct_getter(void);
 static enum test_result depq_test_insert_three_dups(void);
 static enum test_result depq_test_read_max_min(void);
+static enum test_result depq_test_rebalance_dups(void);
 static enum test_result insert_shuffled(struct depqueue *, struct val[], size_t,
                                         int);
 static size_t inorder_fill(int[], size_t, struct depqueue *);
 static dpq_threeway_cmp val_cmp(struct depq_elem const *,
                                 struct depq_elem const *, void *);
 
-#define NUM_TESTS (size_t)6
+#define NUM_TESTS (size_t)7
 test_fn const all_tests[NUM_TESTS] = {
     depq_test_insert_one,     depq_test_insert_three,
     depq_test_struct_getter,  depq_test_insert_three_dups,
     depq_test_insert_shuffle, depq_test_read_max_min,
+    depq_test_rebalance_dups,
 };
 
 int
@@ -169,6 +171,40 @@ depq_test_read_max_min(void)
     return PASS;
 }
 
+static enum test_result
+depq_test_rebalance_dups(void)
+{
+    struct depqueue pq = DEPQ_INIT(pq, val_cmp, NULL);
+    int const num_nodes = 90;
+    struct val vals[num_nodes];
+    for (int i = 0; i < num_nodes; ++i)
+    {
+        vals[i].val = i % 30;
+        vals[i].id = i;
+        depq_push(&pq, &vals[i].elem);
+    }
+    struct tree_stats st = depq_stats(&pq);
+    CHECK(st.nodes, 30, size_t, "%zu");
+    CHECK(st.dup_rings, 30, size_t, "%zu");
+    CHECK(st.dups, 60, size_t, "%zu");
+    depq_rebalance(&pq);
+    CHECK(validate_tree(&pq.t), true, bool, "%d");
+    st = depq_stats(&pq);
+    CHECK(st.nodes, 30, size_t, "%zu");
+    CHECK(st.height, 5, size_t, "%zu");
+    CHECK(st.dups, 60, size_t, "%zu");
+    /* Rebalancing moves tree nodes, never the order of their rings. */
+    for (int i = 0; i < num_nodes; ++i)
+    {
+        struct val const *v = DEPQ_ENTRY(depq_pop_min(&pq), struct val, elem);
+        CHECK(v->val, i / 3, int, "%d");
+        CHECK(v->id, (i / 3) + (30 * (i % 3)), int, "%d");
+        CHECK(validate_tree(&pq.t), true, bool, "%d");
+    }
+    CHECK(depq_stats(&pq).height, 0, size_t, "%zu");
+    return PASS;
+}
+
 static enum test_result
 insert_shuffled(struct depqueue *pq, struct val vals[], size_t const size,
                 int const larger_prime)
@@ -15,6 +15,12 @@ struct val
     struct depq_elem elem;
 };
 
+struct visits
+{
+    struct depq_elem *elems[100];
+    size_t n;
+};
+
 static enum test_result depq_test_forward_iter_unique_vals(void);
 static enum test_result depq_test_forward_iter_all_vals(void);
 static enum test_result depq_test_insert_iterate_pop(void);
@@ -23,18 +29,22 @@ static enum test_result depq_test_priority_removal(void);
 static enum test_result depq_test_priority_valid_range(void);
 static enum test_result depq_test_priority_invalid_range(void);
 static enum test_result depq_test_priority_empty_range(void);
+static enum test_result depq_test_cursor_matches_iter(void);
+static enum test_result depq_test_for_each_matches_iter(void);
 static size_t inorder_fill(int[], size_t, struct depqueue *);
 static enum test_result iterator_check(struct depqueue *);
 static void val_update(struct depq_elem *, void *);
+static void record(struct depq_elem *, void *);
 static dpq_threeway_cmp val_cmp(struct depq_elem const *,
                                 struct depq_elem const *, void *);
 
-#define NUM_TESTS (size_t)8
+#define NUM_TESTS (size_t)10
 test_fn const all_tests[NUM_TESTS] = {
     depq_test_forward_iter_unique_vals, depq_test_forward_iter_all_vals,
     depq_test_insert_iterate_pop,       depq_test_priority_update,
     depq_test_priority_removal,         depq_test_priority_valid_range,
     depq_test_priority_invalid_range,   depq_test_priority_empty_range,
+    depq_test_cursor_matches_iter,      depq_test_for_each_matches_iter,
 };
 
 int
@@ -125,6 +135,109 @@ depq_test_forward_iter_all_vals(void)
     return PASS;
 }
 
+static enum test_result
+depq_test_cursor_matches_iter(void)
+{
+    struct depqueue pq = DEPQ_INIT(pq, val_cmp, NULL);
+    struct depq_cursor c;
+    CHECK(depq_cursor_begin(&pq, &c) == depq_end(&pq), true, bool, "%d");
+    CHECK(depq_cursor_next(&c) == depq_end(&pq), true, bool, "%d");
+    CHECK(depq_cursor_rbegin(&pq, &c) == depq_end(&pq), true, bool, "%d");
+    int const num_nodes = 100;
+    int const prime = 37;
+    struct val vals[num_nodes];
+    /* Rings of every length from lone tree nodes up to a dozen dups. */
+    for (int i = 0, shuffled = 0; i < num_nodes; ++i)
+    {
+        vals[i].val = shuffled % 13; // NOLINT
+        vals[i].id = i;
+        depq_push(&pq, &vals[i].elem);
+        shuffled = (shuffled + prime) % num_nodes;
+    }
+    CHECK(validate_tree(&pq.t), true, bool, "%d");
+    size_t visited = 0;
+    struct depq_elem *i = depq_begin(&pq);
+    for (struct depq_elem *e = depq_cursor_begin(&pq, &c); e != depq_end(&pq);
+         e = depq_cursor_next(&c), i = depq_next(&pq, i), ++visited)
+    {
+        CHECK(e == i, true, bool, "%d");
+    }
+    CHECK(i == depq_end(&pq), true, bool, "%d");
+    CHECK(visited, depq_size(&pq), size_t, "%zu");
+    visited = 0;
+    i = depq_rbegin(&pq);
+    for (struct depq_elem *e = depq_cursor_rbegin(&pq, &c); e != depq_end(&pq);
+         e = depq_cursor_next(&c), i = depq_rnext(&pq, i), ++visited)
+    {
+        CHECK(e == i, true, bool, "%d");
+    }
+    CHECK(i == depq_end(&pq), true, bool, "%d");
+    CHECK(visited, depq_size(&pq), size_t, "%zu");
+    CHECK(depq_cursor_next(&c) == depq_end(&pq), true, bool, "%d");
+    return PASS;
+}
+
+static enum test_result
+depq_test_for_each_matches_iter(void)
+{
+    struct depqueue pq = DEPQ_INIT(pq, val_cmp, NULL);
+    struct visits v = {.n = 0};
+    depq_for_each(&pq, record, &v);
+    CHECK(v.n, 0, size_t, "%zu");
+    int const num_nodes = 100;
+    int const prime = 37;
+    struct val vals[num_nodes];
+    for (int i = 0, shuffled = 0; i < num_nodes; ++i)
+    {
+        vals[i].val = shuffled % 13; // NOLINT
+        vals[i].id = i;
+        depq_push(&pq, &vals[i].elem);
+        shuffled = (shuffled + prime) % num_nodes;
+    }
+    depq_for_each(&pq, record, &v);
+    CHECK(v.n, depq_size(&pq), size_t, "%zu");
+    size_t j = 0;
+    for (struct depq_elem *i = depq_begin(&pq); i != depq_end(&pq);
+         i = depq_next(&pq, i), ++j)
+    {
+        CHECK(v.elems[j] == i, true, bool, "%d");
+    }
+    v.n = 0;
+    depq_rfor_each(&pq, record, &v);
+    CHECK(v.n, depq_size(&pq), size_t, "%zu");
+    j = 0;
+    for (struct depq_elem *i = depq_rbegin(&pq); i != depq_end(&pq);
+         i = depq_rnext(&pq, i), ++j)
+    {
+        CHECK(v.elems[j] == i, true, bool, "%d");
+    }
+    /* Ranges must visit the rings of every tree node they contain. */
+    struct val b = {.id = 0, .val = 10};
+    struct val e = {.id = 0, .val = 3};
+    struct depq_range const range = depq_equal_range(&pq, &b.elem, &e.elem);
+    v.n = 0;
+    depq_for_each_range(&pq, &range, record, &v);
+    j = 0;
+    for (struct depq_elem *i = depq_begin_range(&range);
+         i != depq_end_range(&range); i = depq_next(&pq, i), ++j)
+    {
+        CHECK(v.elems[j] == i, true, bool, "%d");
+    }
+    CHECK(v.n, j, size_t, "%zu");
+    struct depq_rrange const rrange = depq_equal_rrange(&pq, &e.elem, &b.elem);
+    v.n = 0;
+    depq_for_each_rrange(&pq, &rrange, record, &v);
+    j = 0;
+    for (struct depq_elem *i = depq_begin_rrange(&rrange);
+         i != depq_end_rrange(&rrange); i = depq_rnext(&pq, i), ++j)
+    {
+        CHECK(v.elems[j] == i, true, bool, "%d");
+    }
+    CHECK(v.n, j, size_t, "%zu");
+    CHECK(validate_tree(&pq.t), true, bool, "%d");
+    return PASS;
+}
+
 static enum test_result
 depq_test_insert_iterate_pop(void)
 {
@@ -438,6 +551,13 @@ val_cmp(struct depq_elem const *a, struct depq_elem const *b, void *aux)
     return (lhs->val > rhs->val) - (lhs->val < rhs->val);
 }
 
+static void
+record(struct depq_elem *e, void *aux)
+{
+    struct visits *v = aux;
+    v->elems[v->n++] = e;
+}
+
 static void
 val_update(struct depq_elem *a, void *aux)
 {
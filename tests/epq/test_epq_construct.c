@@ -0,0 +1,162 @@
+#include "ext_pqueue.h"
+#include "test.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+struct rec
+{
+    int key;
+    int id;
+};
+
+static enum test_result epq_test_bad_config(void);
+static enum test_result epq_test_empty(void);
+static enum test_result epq_test_in_memory(void);
+static enum test_result epq_test_profile(void);
+static enum ext_pq_threeway_cmp rec_cmp(void const *, void const *, void *);
+
+#define NUM_TESTS (size_t)4
+test_fn const all_tests[NUM_TESTS] = {
+    epq_test_bad_config,
+    epq_test_empty,
+    epq_test_in_memory,
+    epq_test_profile,
+};
+
+int
+main()
+{
+    enum test_result res = PASS;
+    for (size_t i = 0; i < NUM_TESTS; ++i)
+    {
+        bool const fail = all_tests[i]() == FAIL;
+        if (fail)
+        {
+            res = FAIL;
+        }
+    }
+    return res;
+}
+
+static enum test_result
+epq_test_bad_config(void)
+{
+    struct ext_pqueue epq;
+    struct epq_config config = {
+        .record_size = 0,
+        .memory_budget = 4096,
+        .block_size = 256,
+    };
+    CHECK(epq_init(&epq, &config, EPQLES, rec_cmp, NULL), false, bool, "%d");
+    /* A block must hold a record. */
+    config.record_size = sizeof(struct rec);
+    config.block_size = sizeof(struct rec) - 1;
+    CHECK(epq_init(&epq, &config, EPQLES, rec_cmp, NULL), false, bool, "%d");
+    /* Half the budget must hold at least two read buffers. */
+    config.block_size = 2048;
+    CHECK(epq_init(&epq, &config, EPQLES, rec_cmp, NULL), false, bool, "%d");
+    config.block_size = 1024;
+    CHECK(epq_init(&epq, &config, EPQLES, rec_cmp, NULL), true, bool, "%d");
+    epq_free(&epq);
+    return PASS;
+}
+
+static enum test_result
+epq_test_empty(void)
+{
+    struct ext_pqueue epq;
+    struct epq_config const config = {
+        .record_size = sizeof(struct rec),
+        .memory_budget = 4096,
+        .block_size = 256,
+    };
+    CHECK(epq_init(&epq, &config, EPQLES, rec_cmp, NULL), true, bool, "%d");
+    CHECK(epq_empty(&epq), true, bool, "%d");
+    CHECK(epq_front(&epq) == NULL, true, bool, "%d");
+    struct rec out = {0};
+    CHECK(epq_pop(&epq, &out), false, bool, "%d");
+    CHECK(epq_validate(&epq), true, bool, "%d");
+    epq_free(&epq);
+    return PASS;
+}
+
+/* A queue that stays within the memory half of the budget never spills. */
+static enum test_result
+epq_test_in_memory(void)
+{
+    struct ext_pqueue epq;
+    struct epq_config const config = {
+        .record_size = sizeof(struct rec),
+        .memory_budget = 1 << 16,
+        .block_size = 4096,
+    };
+    CHECK(epq_init(&epq, &config, EPQGRT, rec_cmp, NULL), true, bool, "%d");
+    int const size = 100;
+    for (int i = 0; i < size; ++i)
+    {
+        struct rec const r = {.key = (i * 37) % size, .id = i};
+        CHECK(epq_push(&epq, &r), true, bool, "%d");
+    }
+    CHECK(epq_num_runs(&epq), 0, size_t, "%zu");
+    CHECK(epq_validate(&epq), true, bool, "%d");
+    for (int i = size; i--;)
+    {
+        struct rec front;
+        memcpy(&front, epq_front(&epq), sizeof(front));
+        CHECK(front.key, i, int, "%d");
+        struct rec out;
+        CHECK(epq_pop(&epq, &out), true, bool, "%d");
+        CHECK(out.key, i, int, "%d");
+    }
+    CHECK(epq_empty(&epq), true, bool, "%d");
+    epq_free(&epq);
+    return PASS;
+}
+
+static enum test_result
+epq_test_profile(void)
+{
+    struct ext_pqueue epq;
+    struct epq_config const config = {
+        .record_size = sizeof(struct rec),
+        .memory_budget = 4096,
+        .block_size = 256,
+    };
+    CHECK(epq_init(&epq, &config, EPQLES, rec_cmp, NULL), true, bool, "%d");
+    int const size = 1000;
+    for (int i = 0; i < size; ++i)
+    {
+        struct rec const r = {.key = size - i, .id = i};
+        CHECK(epq_push(&epq, &r), true, bool, "%d");
+    }
+    while (!epq_empty(&epq))
+    {
+        CHECK(epq_pop(&epq, NULL), true, bool, "%d");
+    }
+    struct epq_counters const c = epq_profile(&epq);
+#ifdef CONTAINER_PROFILE
+    CHECK(c.spills > 0, true, bool, "%d");
+    /* Everything written is read back once the queue is drained. */
+    CHECK(c.bytes_read, c.bytes_written, size_t, "%zu");
+    epq_profile_reset(&epq);
+    CHECK(epq_profile(&epq).spills, 0, size_t, "%zu");
+#else
+    CHECK(c.spills, 0, size_t, "%zu");
+    CHECK(c.bytes_written, 0, size_t, "%zu");
+#endif
+    epq_free(&epq);
+    return PASS;
+}
+
+static enum ext_pq_threeway_cmp
+rec_cmp(void const *const a, void const *const b, void *const aux)
+{
+    (void)aux;
+    struct rec lhs;
+    struct rec rhs;
+    memcpy(&lhs, a, sizeof(lhs));
+    memcpy(&rhs, b, sizeof(rhs));
+    return (lhs.key > rhs.key) - (lhs.key < rhs.key);
+}
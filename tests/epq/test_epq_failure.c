@@ -0,0 +1,178 @@
+/* setrlimit to make spill writes fail and fstat and ftruncate to make the
+   unlinked run files unreadable. */
+#define _POSIX_C_SOURCE 200809L
+
+#include "ext_pqueue.h"
+#include "test.h"
+
+#include <signal.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+struct rec
+{
+    int key;
+    int id;
+};
+
+static enum test_result epq_test_merge_write_fails(void);
+static enum test_result epq_test_unreadable_runs(void);
+static void truncate_spill_files(void);
+static enum ext_pq_threeway_cmp rec_cmp(void const *, void const *, void *);
+
+/* 128 records fit in memory and there are 8 read buffers of 64 records. */
+static struct epq_config const small_budget = {
+    .record_size = sizeof(struct rec),
+    .memory_budget = 8192,
+    .block_size = 512,
+};
+
+/* Runs of 16384 records, far more than stdio reads ahead, so a run file
+   cut short is noticed when a block is read. */
+static struct epq_config const large_runs = {
+    .record_size = sizeof(struct rec),
+    .memory_budget = 1 << 20,
+    .block_size = 4096,
+};
+
+#define NUM_TESTS (size_t)2
+test_fn const all_tests[NUM_TESTS] = {
+    epq_test_merge_write_fails,
+    epq_test_unreadable_runs,
+};
+
+int
+main()
+{
+    enum test_result res = PASS;
+    for (size_t i = 0; i < NUM_TESTS; ++i)
+    {
+        bool const fail = all_tests[i]() == FAIL;
+        if (fail)
+        {
+            res = FAIL;
+        }
+    }
+    return res;
+}
+
+/* Eight full runs and a full memory heap make the next push merge the runs.
+   A file size limit of half the merged run makes that merge fail partway,
+   which must leave every record in the queue. Once the limit is lifted the
+   same push goes through and every record comes back once in order. */
+static enum test_result
+epq_test_merge_write_fails(void)
+{
+    struct ext_pqueue epq;
+    CHECK(epq_init(&epq, &small_budget, EPQLES, rec_cmp, NULL), true, bool,
+          "%d");
+    int const size = 9 * 128;
+    /* 1153 is prime so the keys are a permutation of 0 to size. */
+    for (int i = 0; i < size; ++i)
+    {
+        struct rec const r = {.key = (i * 7919) % (size + 1), .id = i};
+        CHECK(epq_push(&epq, &r), true, bool, "%d");
+    }
+    CHECK(epq_num_runs(&epq), 8, size_t, "%zu");
+    struct rlimit old;
+    CHECK(getrlimit(RLIMIT_FSIZE, &old), 0, int, "%d");
+    struct rlimit limit = old;
+    limit.rlim_cur = 4096;
+    (void)signal(SIGXFSZ, SIG_IGN);
+    CHECK(setrlimit(RLIMIT_FSIZE, &limit), 0, int, "%d");
+    struct rec const last = {.key = (size * 7919) % (size + 1), .id = size};
+    bool const pushed = epq_push(&epq, &last);
+    CHECK(setrlimit(RLIMIT_FSIZE, &old), 0, int, "%d");
+    CHECK(pushed, false, bool, "%d");
+    CHECK(epq_size(&epq), size, size_t, "%zu");
+    CHECK(epq_num_runs(&epq), 8, size_t, "%zu");
+    CHECK(epq_lost(&epq), 0, size_t, "%zu");
+    CHECK(epq_validate(&epq), true, bool, "%d");
+    CHECK(epq_push(&epq, &last), true, bool, "%d");
+    CHECK(epq_num_runs(&epq), 2, size_t, "%zu");
+    for (int i = 0; i <= size; ++i)
+    {
+        struct rec out;
+        CHECK(epq_pop(&epq, &out), true, bool, "%d");
+        CHECK(out.key, i, int, "%d");
+        if (i % 97 == 0)
+        {
+            CHECK(epq_validate(&epq), true, bool, "%d");
+        }
+    }
+    CHECK(epq_empty(&epq), true, bool, "%d");
+    epq_free(&epq);
+    return PASS;
+}
+
+/* With the run files cut to nothing after their first blocks are buffered,
+   each run gives up its buffered records and is then dropped when the next
+   block cannot be read. Every pop still returns its record, the size counts
+   the dropped records out, and the order holds. */
+static enum test_result
+epq_test_unreadable_runs(void)
+{
+    struct ext_pqueue epq;
+    CHECK(epq_init(&epq, &large_runs, EPQLES, rec_cmp, NULL), true, bool,
+          "%d");
+    int const size = (3 * 16384) + 100;
+    for (int i = 0; i < size; ++i)
+    {
+        struct rec const r = {.key = i, .id = i};
+        CHECK(epq_push(&epq, &r), true, bool, "%d");
+    }
+    CHECK(epq_num_runs(&epq), 3, size_t, "%zu");
+    truncate_spill_files();
+    size_t popped = 0;
+    int prev = -1;
+    while (!epq_empty(&epq))
+    {
+        struct rec out;
+        CHECK(epq_pop(&epq, &out), true, bool, "%d");
+        CHECK(out.key > prev, true, bool, "%d");
+        prev = out.key;
+        ++popped;
+        CHECK(epq_size(&epq) + popped + epq_lost(&epq), size, size_t, "%zu");
+        if (popped % 97 == 0)
+        {
+            CHECK(epq_validate(&epq), true, bool, "%d");
+        }
+    }
+    CHECK(epq_lost(&epq) > 0, true, bool, "%d");
+    CHECK(epq_num_runs(&epq), 0, size_t, "%zu");
+    CHECK(prev, size - 1, int, "%d");
+    struct rec out;
+    CHECK(epq_pop(&epq, &out), false, bool, "%d");
+    epq_free(&epq);
+    return PASS;
+}
+
+/* The spill files are the only open regular files with no name left. */
+static void
+truncate_spill_files(void)
+{
+    for (int fd = 3; fd < 256; ++fd)
+    {
+        struct stat st;
+        if (!fstat(fd, &st) && S_ISREG(st.st_mode) && !st.st_nlink)
+        {
+            (void)ftruncate(fd, 0);
+        }
+    }
+}
+
+static enum ext_pq_threeway_cmp
+rec_cmp(void const *const a, void const *const b, void *const aux)
+{
+    (void)aux;
+    struct rec lhs;
+    struct rec rhs;
+    memcpy(&lhs, a, sizeof(lhs));
+    memcpy(&rhs, b, sizeof(rhs));
+    return (lhs.key > rhs.key) - (lhs.key < rhs.key);
+}
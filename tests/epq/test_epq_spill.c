@@ -0,0 +1,167 @@
+#include "ext_pqueue.h"
+#include "test.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+struct rec
+{
+    int key;
+    int id;
+};
+
+static enum test_result epq_test_many_times_budget(void);
+static enum test_result epq_test_interleaved(void);
+static enum test_result epq_test_spill_dir(void);
+static enum ext_pq_threeway_cmp rec_cmp(void const *, void const *, void *);
+
+/* 128 records fit in memory and there are 8 read buffers of 64 records. */
+static struct epq_config const small_budget = {
+    .record_size = sizeof(struct rec),
+    .memory_budget = 8192,
+    .block_size = 512,
+};
+
+#define NUM_TESTS (size_t)3
+test_fn const all_tests[NUM_TESTS] = {
+    epq_test_many_times_budget,
+    epq_test_interleaved,
+    epq_test_spill_dir,
+};
+
+int
+main()
+{
+    enum test_result res = PASS;
+    for (size_t i = 0; i < NUM_TESTS; ++i)
+    {
+        bool const fail = all_tests[i]() == FAIL;
+        if (fail)
+        {
+            res = FAIL;
+        }
+    }
+    return res;
+}
+
+/* About 10 times the whole budget in records forces many spills and
+   several merges of the runs on disk. Every record must come back once
+   and in order. */
+static enum test_result
+epq_test_many_times_budget(void)
+{
+    struct ext_pqueue epq;
+    CHECK(epq_init(&epq, &small_budget, EPQLES, rec_cmp, NULL), true, bool,
+          "%d");
+    int const size = 10000;
+    /* Seed the test with any integer for reproducible randome test sequence
+       currently this will change every test. NOLINTNEXTLINE */
+    srand(time(NULL));
+    for (int i = 0; i < size; ++i)
+    {
+        struct rec const r = {.key = rand() % 2000, .id = i}; // NOLINT
+        CHECK(epq_push(&epq, &r), true, bool, "%d");
+        CHECK(epq_num_runs(&epq) <= 8, true, bool, "%d");
+        if (i % 97 == 0)
+        {
+            CHECK(epq_validate(&epq), true, bool, "%d");
+        }
+    }
+    CHECK(epq_size(&epq), size, size_t, "%zu");
+    CHECK(epq_num_runs(&epq) > 0, true, bool, "%d");
+    bool *const seen = calloc(size, sizeof(bool));
+    CHECK(seen != NULL, true, bool, "%d");
+    int prev = -1;
+    for (int i = 0; i < size; ++i)
+    {
+        struct rec out;
+        CHECK(epq_pop(&epq, &out), true, bool, "%d");
+        CHECK(out.key >= prev, true, bool, "%d");
+        CHECK(seen[out.id], false, bool, "%d");
+        seen[out.id] = true;
+        prev = out.key;
+        if (i % 97 == 0)
+        {
+            CHECK(epq_validate(&epq), true, bool, "%d");
+        }
+    }
+    CHECK(epq_empty(&epq), true, bool, "%d");
+    CHECK(epq_num_runs(&epq), 0, size_t, "%zu");
+    free(seen);
+    epq_free(&epq);
+    return PASS;
+}
+
+/* Pushes that beat records already on disk must be popped before them. */
+static enum test_result
+epq_test_interleaved(void)
+{
+    struct ext_pqueue epq;
+    CHECK(epq_init(&epq, &small_budget, EPQGRT, rec_cmp, NULL), true, bool,
+          "%d");
+    int next_id = 0;
+    for (int round = 0; round < 20; ++round)
+    {
+        for (int i = 0; i < 300; ++i)
+        {
+            struct rec const r = {.key = (round * 300) + i, .id = next_id++};
+            CHECK(epq_push(&epq, &r), true, bool, "%d");
+        }
+        /* The newest round always holds the max. */
+        for (int i = 0; i < 100; ++i)
+        {
+            struct rec out;
+            CHECK(epq_pop(&epq, &out), true, bool, "%d");
+            CHECK(out.key, (round * 300) + 299 - i, int, "%d");
+        }
+        CHECK(epq_validate(&epq), true, bool, "%d");
+    }
+    int prev = 20 * 300;
+    while (!epq_empty(&epq))
+    {
+        struct rec out;
+        CHECK(epq_pop(&epq, &out), true, bool, "%d");
+        CHECK(out.key < prev, true, bool, "%d");
+        prev = out.key;
+    }
+    epq_free(&epq);
+    return PASS;
+}
+
+static enum test_result
+epq_test_spill_dir(void)
+{
+    struct ext_pqueue epq;
+    struct epq_config config = small_budget;
+    config.dir = ".";
+    CHECK(epq_init(&epq, &config, EPQLES, rec_cmp, NULL), true, bool, "%d");
+    int const size = 3000;
+    for (int i = 0; i < size; ++i)
+    {
+        struct rec const r = {.key = size - i, .id = i};
+        CHECK(epq_push(&epq, &r), true, bool, "%d");
+    }
+    CHECK(epq_num_runs(&epq) > 0, true, bool, "%d");
+    for (int i = 1; i <= size; ++i)
+    {
+        struct rec out;
+        CHECK(epq_pop(&epq, &out), true, bool, "%d");
+        CHECK(out.key, i, int, "%d");
+    }
+    epq_free(&epq);
+    return PASS;
+}
+
+static enum ext_pq_threeway_cmp
+rec_cmp(void const *const a, void const *const b, void *const aux)
+{
+    (void)aux;
+    struct rec lhs;
+    struct rec rhs;
+    memcpy(&lhs, a, sizeof(lhs));
+    memcpy(&rhs, b, sizeof(rhs));
+    return (lhs.key > rhs.key) - (lhs.key < rhs.key);
+}
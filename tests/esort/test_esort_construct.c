@@ -0,0 +1,176 @@
+#include "ext_sort.h"
+#include "test.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+static enum test_result esort_test_bad_config(void);
+static enum test_result esort_test_empty_input(void);
+static enum test_result esort_test_partial_record(void);
+static enum test_result esort_test_single_chunk(void);
+static enum ext_sort_threeway_cmp int_cmp(void const *, void const *, void *);
+
+#define NUM_TESTS (size_t)4
+test_fn const all_tests[NUM_TESTS] = {
+    esort_test_bad_config,
+    esort_test_empty_input,
+    esort_test_partial_record,
+    esort_test_single_chunk,
+};
+
+int
+main()
+{
+    enum test_result res = PASS;
+    for (size_t i = 0; i < NUM_TESTS; ++i)
+    {
+        bool const fail = all_tests[i]() == FAIL;
+        if (fail)
+        {
+            res = FAIL;
+        }
+    }
+    return res;
+}
+
+static enum test_result
+esort_test_bad_config(void)
+{
+    FILE *const in = tmpfile();
+    FILE *const out = tmpfile();
+    CHECK(in && out, true, bool, "%d");
+    struct esort_config const no_record = {
+        .memory_budget = 1 << 16,
+        .block_size = 4096,
+    };
+    CHECK(esort_file(in, out, &no_record, ESORTLES, int_cmp, NULL, NULL),
+          false, bool, "%d");
+    struct esort_config const small_block = {
+        .record_size = 64,
+        .memory_budget = 1 << 16,
+        .block_size = 32,
+    };
+    CHECK(esort_file(in, out, &small_block, ESORTLES, int_cmp, NULL, NULL),
+          false, bool, "%d");
+    /* Five page sized blocks are the least a sort can work with. */
+    struct esort_config const small_budget = {
+        .record_size = sizeof(int),
+        .memory_budget = 4 * 4096,
+        .block_size = 4096,
+    };
+    CHECK(esort_file(in, out, &small_budget, ESORTLES, int_cmp, NULL, NULL),
+          false, bool, "%d");
+    struct esort_config const ok = {
+        .record_size = sizeof(int),
+        .memory_budget = 5 * 4096,
+        .block_size = 4096,
+    };
+    CHECK(esort_file(in, out, &ok, ESORTEQL, int_cmp, NULL, NULL), false,
+          bool, "%d");
+    CHECK(esort_file(in, out, &ok, ESORTLES, NULL, NULL, NULL), false, bool,
+          "%d");
+    CHECK(esort_file(in, out, &ok, ESORTLES, int_cmp, NULL, NULL), true, bool,
+          "%d");
+    (void)fclose(in);
+    (void)fclose(out);
+    return PASS;
+}
+
+static enum test_result
+esort_test_empty_input(void)
+{
+    FILE *const in = tmpfile();
+    FILE *const out = tmpfile();
+    CHECK(in && out, true, bool, "%d");
+    struct esort_config const config = {
+        .record_size = sizeof(int),
+        .memory_budget = 1 << 16,
+        .block_size = 4096,
+        .reader_thread = true,
+    };
+    struct esort_stats stats;
+    CHECK(esort_file(in, out, &config, ESORTLES, int_cmp, NULL, &stats), true,
+          bool, "%d");
+    CHECK(stats.records, 0, size_t, "%zu");
+    CHECK(stats.runs, 0, size_t, "%zu");
+    CHECK(stats.bytes_written, 0, size_t, "%zu");
+    CHECK(ftell(out), 0, long, "%ld");
+    (void)fclose(in);
+    (void)fclose(out);
+    return PASS;
+}
+
+static enum test_result
+esort_test_partial_record(void)
+{
+    FILE *const in = tmpfile();
+    FILE *const out = tmpfile();
+    CHECK(in && out, true, bool, "%d");
+    int const vals[3] = {3, 1, 2};
+    CHECK(fwrite(vals, sizeof(int), 3, in), 3, size_t, "%zu");
+    CHECK(fwrite(vals, 1, 1, in), 1, size_t, "%zu");
+    rewind(in);
+    struct esort_config const config = {
+        .record_size = sizeof(int),
+        .memory_budget = 1 << 16,
+        .block_size = 4096,
+    };
+    CHECK(esort_file(in, out, &config, ESORTLES, int_cmp, NULL, NULL), false,
+          bool, "%d");
+    (void)fclose(in);
+    (void)fclose(out);
+    return PASS;
+}
+
+/* Input that fits in one chunk is sorted in memory and written to the
+   output without a run or a merge. */
+static enum test_result
+esort_test_single_chunk(void)
+{
+    FILE *const in = tmpfile();
+    FILE *const out = tmpfile();
+    CHECK(in && out, true, bool, "%d");
+    int vals[100];
+    for (int i = 0; i < 100; ++i)
+    {
+        vals[i] = (i * 37) % 100;
+    }
+    CHECK(fwrite(vals, sizeof(int), 100, in), 100, size_t, "%zu");
+    rewind(in);
+    struct esort_config const config = {
+        .record_size = sizeof(int),
+        .memory_budget = 1 << 16,
+        .block_size = 4096,
+    };
+    struct esort_stats stats;
+    CHECK(esort_file(in, out, &config, ESORTLES, int_cmp, NULL, &stats), true,
+          bool, "%d");
+    CHECK(stats.records, 100, size_t, "%zu");
+    CHECK(stats.runs, 0, size_t, "%zu");
+    CHECK(stats.merge_passes, 0, size_t, "%zu");
+    CHECK(stats.bytes_read, sizeof(vals), size_t, "%zu");
+    CHECK(stats.bytes_written, sizeof(vals), size_t, "%zu");
+    rewind(out);
+    int sorted[100];
+    CHECK(fread(sorted, sizeof(int), 100, out), 100, size_t, "%zu");
+    for (int i = 0; i < 100; ++i)
+    {
+        CHECK(sorted[i], i, int, "%d");
+    }
+    (void)fclose(in);
+    (void)fclose(out);
+    return PASS;
+}
+
+static enum ext_sort_threeway_cmp
+int_cmp(void const *const a, void const *const b, void *const aux)
+{
+    (void)aux;
+    int x;
+    int y;
+    memcpy(&x, a, sizeof(int));
+    memcpy(&y, b, sizeof(int));
+    return (x > y) - (x < y);
+}
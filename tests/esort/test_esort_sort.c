@@ -0,0 +1,220 @@
+#include "ext_sort.h"
+#include "test.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+struct rec
+{
+    uint32_t key;
+    uint32_t seq;
+    uint64_t payload;
+};
+
+static enum test_result esort_test_multi_pass(void);
+static enum test_result esort_test_descending_dir(void);
+static enum test_result esort_test_exact_chunk(void);
+static enum test_result esort_test_large_records(void);
+static enum test_result sort_and_check(size_t n, uint32_t key_range,
+                                       struct esort_config const *,
+                                       enum ext_sort_threeway_cmp,
+                                       struct esort_stats *);
+static enum ext_sort_threeway_cmp rec_cmp(void const *, void const *, void *);
+
+/* 64KiB of memory and 4KiB blocks give chunks of 1920 records, or 1280 with
+   the reader thread, and merges of 7 runs at a time. */
+#define BUDGET ((size_t)1 << 16)
+#define BLOCK (size_t)4096
+
+/* Records are padded up to the record size of the test. */
+#define MAX_RECORD (size_t)64
+
+#define NUM_TESTS (size_t)4
+test_fn const all_tests[NUM_TESTS] = {
+    esort_test_multi_pass,
+    esort_test_descending_dir,
+    esort_test_exact_chunk,
+    esort_test_large_records,
+};
+
+int
+main()
+{
+    /* Seed the test with any integer for reproducible randome test sequence
+       currently this will change every test. NOLINTNEXTLINE */
+    srand(time(NULL));
+    enum test_result res = PASS;
+    for (size_t i = 0; i < NUM_TESTS; ++i)
+    {
+        bool const fail = all_tests[i]() == FAIL;
+        if (fail)
+        {
+            res = FAIL;
+        }
+    }
+    return res;
+}
+
+/* Enough runs that they take more than one merge pass, for both merge
+   engines with and without the reader thread. */
+static enum test_result
+esort_test_multi_pass(void)
+{
+    enum kwm_engine const engines[2] = {KWM_LOSER_TREE, KWM_HEAP};
+    for (size_t e = 0; e < 2; ++e)
+    {
+        for (int threaded = 0; threaded < 2; ++threaded)
+        {
+            struct esort_config const config = {
+                .record_size = sizeof(struct rec),
+                .memory_budget = BUDGET,
+                .block_size = BLOCK,
+                .engine = engines[e],
+                .reader_thread = threaded,
+            };
+            struct esort_stats stats;
+            CHECK(sort_and_check(60000, 500, &config, ESORTLES, &stats), PASS,
+                  enum test_result, "%d");
+            CHECK(stats.runs, threaded ? (size_t)47 : (size_t)32, size_t,
+                  "%zu");
+            CHECK(stats.merge_passes, 2, size_t, "%zu");
+            CHECK(stats.bytes_read, stats.bytes_written, size_t, "%zu");
+        }
+    }
+    return PASS;
+}
+
+static enum test_result
+esort_test_descending_dir(void)
+{
+    struct esort_config const config = {
+        .record_size = sizeof(struct rec),
+        .memory_budget = BUDGET,
+        .block_size = BLOCK,
+        .dir = "/tmp",
+        .reader_thread = true,
+    };
+    struct esort_stats stats;
+    CHECK(sort_and_check(8000, 100000, &config, ESORTGRT, &stats), PASS,
+          enum test_result, "%d");
+    CHECK(stats.merge_passes, 1, size_t, "%zu");
+    return PASS;
+}
+
+/* A full chunk followed by the end of the input is a run of its own. */
+static enum test_result
+esort_test_exact_chunk(void)
+{
+    struct esort_config const config = {
+        .record_size = sizeof(struct rec),
+        .memory_budget = BUDGET,
+        .block_size = BLOCK,
+    };
+    struct esort_stats stats;
+    CHECK(sort_and_check(1920, 50, &config, ESORTLES, &stats), PASS,
+          enum test_result, "%d");
+    CHECK(stats.runs, 1, size_t, "%zu");
+    CHECK(stats.merge_passes, 1, size_t, "%zu");
+    CHECK(sort_and_check(1919, 50, &config, ESORTLES, &stats), PASS,
+          enum test_result, "%d");
+    CHECK(stats.runs, 0, size_t, "%zu");
+    return PASS;
+}
+
+/* Records larger than two pointers are sorted through pointers rather than
+   by value. */
+static enum test_result
+esort_test_large_records(void)
+{
+    enum kwm_engine const engines[2] = {KWM_LOSER_TREE, KWM_HEAP};
+    for (size_t e = 0; e < 2; ++e)
+    {
+        for (int threaded = 0; threaded < 2; ++threaded)
+        {
+            struct esort_config const config = {
+                .record_size = 40,
+                .memory_budget = BUDGET,
+                .block_size = BLOCK,
+                .engine = engines[e],
+                .reader_thread = threaded,
+            };
+            struct esort_stats stats;
+            CHECK(sort_and_check(30000, 300, &config, ESORTLES, &stats), PASS,
+                  enum test_result, "%d");
+            CHECK(stats.merge_passes, 2, size_t, "%zu");
+        }
+    }
+    return PASS;
+}
+
+/* Writes n random records numbered in input order, sorts them, and checks
+   the output is ordered, equal keys keep input order, and every record
+   comes out once. */
+static enum test_result
+sort_and_check(size_t const n, uint32_t const key_range,
+               struct esort_config const *const config,
+               enum ext_sort_threeway_cmp const order,
+               struct esort_stats *const stats)
+{
+    FILE *const in = tmpfile();
+    FILE *const out = tmpfile();
+    bool *const seen = calloc(n, sizeof(bool));
+    CHECK(in && out && seen, true, bool, "%d");
+    size_t const rs = config->record_size;
+    unsigned char padded[MAX_RECORD] = {0};
+    for (size_t i = 0; i < n; ++i)
+    {
+        struct rec const r = {
+            .key = (uint32_t)rand() % key_range, // NOLINT
+            .seq = (uint32_t)i,
+            .payload = i * 3,
+        };
+        memcpy(padded, &r, sizeof(r));
+        CHECK(fwrite(padded, rs, 1, in), 1, size_t, "%zu");
+    }
+    rewind(in);
+    CHECK(esort_file(in, out, config, order, rec_cmp, NULL, stats), true,
+          bool, "%d");
+    CHECK(stats->records, n, size_t, "%zu");
+    rewind(out);
+    struct rec prev = {0};
+    for (size_t i = 0; i < n; ++i)
+    {
+        struct rec r;
+        CHECK(fread(padded, rs, 1, out), 1, size_t, "%zu");
+        memcpy(&r, padded, sizeof(r));
+        CHECK(r.seq < n && !seen[r.seq], true, bool, "%d");
+        CHECK(r.payload, (uint64_t)r.seq * 3, uint64_t, "%lu");
+        seen[r.seq] = true;
+        if (i)
+        {
+            CHECK(rec_cmp(&r, &prev, NULL) != order, true, bool, "%d");
+            if (r.key == prev.key)
+            {
+                CHECK(r.seq > prev.seq, true, bool, "%d");
+            }
+        }
+        prev = r;
+    }
+    CHECK(fgetc(out), EOF, int, "%d");
+    free(seen);
+    (void)fclose(in);
+    (void)fclose(out);
+    return PASS;
+}
+
+static enum ext_sort_threeway_cmp
+rec_cmp(void const *const a, void const *const b, void *const aux)
+{
+    (void)aux;
+    struct rec x;
+    struct rec y;
+    memcpy(&x, a, sizeof(x));
+    memcpy(&y, b, sizeof(y));
+    return (x.key > y.key) - (x.key < y.key);
+}
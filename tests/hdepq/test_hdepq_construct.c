@@ -0,0 +1,132 @@
+#include "heap_depqueue.h"
+#include "test.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+struct val
+{
+    int id;
+    int val;
+    struct hdepq_elem elem;
+};
+
+static enum test_result hdepq_test_empty(void);
+static enum test_result hdepq_test_min_max_small(void);
+static enum test_result hdepq_test_profile(void);
+static enum heap_depq_threeway_cmp val_cmp(struct hdepq_elem const *,
+                                           struct hdepq_elem const *, void *);
+static void no_destruct(struct hdepq_elem *);
+
+#define NUM_TESTS (size_t)3
+test_fn const all_tests[NUM_TESTS] = {
+    hdepq_test_empty,
+    hdepq_test_min_max_small,
+    hdepq_test_profile,
+};
+
+int
+main()
+{
+    enum test_result res = PASS;
+    for (size_t i = 0; i < NUM_TESTS; ++i)
+    {
+        bool const fail = all_tests[i]() == FAIL;
+        if (fail)
+        {
+            res = FAIL;
+        }
+    }
+    return res;
+}
+
+static enum test_result
+hdepq_test_empty(void)
+{
+    struct heap_depqueue hdq;
+    hdepq_init(&hdq, val_cmp, NULL);
+    CHECK(hdepq_empty(&hdq), true, bool, "%d");
+    CHECK(hdepq_min(&hdq) == NULL, true, bool, "%d");
+    CHECK(hdepq_max(&hdq) == NULL, true, bool, "%d");
+    CHECK(hdepq_pop_min(&hdq) == NULL, true, bool, "%d");
+    CHECK(hdepq_pop_max(&hdq) == NULL, true, bool, "%d");
+    hdepq_clear(&hdq, no_destruct);
+    return PASS;
+}
+
+/* The max moves between the root and its children as the heap grows past
+   one and two elements so check the peeks at every small size. */
+static enum test_result
+hdepq_test_min_max_small(void)
+{
+    struct heap_depqueue hdq;
+    hdepq_init(&hdq, val_cmp, NULL);
+    struct val vals[5] = {{.val = 3}, {.val = 1}, {.val = 4},
+                          {.val = 0}, {.val = 9}};
+    int const mins[5] = {3, 1, 1, 0, 0};
+    int const maxs[5] = {3, 3, 4, 4, 9};
+    for (size_t i = 0; i < 5; ++i)
+    {
+        hdepq_push(&hdq, &vals[i].elem);
+        CHECK(hdepq_validate(&hdq), true, bool, "%d");
+        CHECK(HDEPQ_ENTRY(hdepq_min(&hdq), struct val, elem)->val, mins[i],
+              int, "%d");
+        CHECK(HDEPQ_ENTRY(hdepq_max(&hdq), struct val, elem)->val, maxs[i],
+              int, "%d");
+    }
+    CHECK(HDEPQ_ENTRY(hdepq_pop_max(&hdq), struct val, elem)->val, 9, int,
+          "%d");
+    CHECK(HDEPQ_ENTRY(hdepq_pop_min(&hdq), struct val, elem)->val, 0, int,
+          "%d");
+    CHECK(HDEPQ_ENTRY(hdepq_pop_max(&hdq), struct val, elem)->val, 4, int,
+          "%d");
+    CHECK(HDEPQ_ENTRY(hdepq_pop_max(&hdq), struct val, elem)->val, 3, int,
+          "%d");
+    CHECK(HDEPQ_ENTRY(hdepq_max(&hdq), struct val, elem)->val, 1, int, "%d");
+    CHECK(HDEPQ_ENTRY(hdepq_pop_min(&hdq), struct val, elem)->val, 1, int,
+          "%d");
+    CHECK(hdepq_empty(&hdq), true, bool, "%d");
+    hdepq_clear(&hdq, no_destruct);
+    return PASS;
+}
+
+static enum test_result
+hdepq_test_profile(void)
+{
+    struct heap_depqueue hdq;
+    hdepq_init(&hdq, val_cmp, NULL);
+    struct val vals[10];
+    for (int i = 0; i < 10; ++i)
+    {
+        vals[i].val = 10 - i;
+        hdepq_push(&hdq, &vals[i].elem);
+    }
+    struct hdepq_counters const c = hdepq_profile(&hdq);
+#ifdef CONTAINER_PROFILE
+    /* Every push of a new minimum climbs the min levels to the root. */
+    CHECK(c.sift_steps > 0, true, bool, "%d");
+    CHECK(c.cmps >= c.sift_steps, true, bool, "%d");
+    hdepq_profile_reset(&hdq);
+    CHECK(hdepq_profile(&hdq).cmps, 0, size_t, "%zu");
+#else
+    CHECK(c.cmps, 0, size_t, "%zu");
+    CHECK(c.sift_steps, 0, size_t, "%zu");
+#endif
+    hdepq_clear(&hdq, no_destruct);
+    return PASS;
+}
+
+static enum heap_depq_threeway_cmp
+val_cmp(struct hdepq_elem const *a, struct hdepq_elem const *b, void *aux)
+{
+    (void)aux;
+    struct val *lhs = HDEPQ_ENTRY(a, struct val, elem);
+    struct val *rhs = HDEPQ_ENTRY(b, struct val, elem);
+    return (lhs->val > rhs->val) - (lhs->val < rhs->val);
+}
+
+static void
+no_destruct(struct hdepq_elem *e)
+{
+    (void)e;
+}
@@ -0,0 +1,198 @@
+#include "heap_depqueue.h"
+#include "test.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <time.h>
+
+struct val
+{
+    int id;
+    int val;
+    struct hdepq_elem elem;
+};
+
+static enum test_result hdepq_test_pop_alternating(void);
+static enum test_result hdepq_test_prime_shuffle_erase(void);
+static enum test_result hdepq_test_erase_twice(void);
+static enum test_result hdepq_test_weak_srand(void);
+static enum test_result insert_shuffled(struct heap_depqueue *, struct val[],
+                                        size_t, int);
+static enum heap_depq_threeway_cmp val_cmp(struct hdepq_elem const *,
+                                           struct hdepq_elem const *, void *);
+static void no_destruct(struct hdepq_elem *);
+
+#define NUM_TESTS (size_t)4
+test_fn const all_tests[NUM_TESTS] = {
+    hdepq_test_pop_alternating,
+    hdepq_test_prime_shuffle_erase,
+    hdepq_test_erase_twice,
+    hdepq_test_weak_srand,
+};
+
+int
+main()
+{
+    enum test_result res = PASS;
+    for (size_t i = 0; i < NUM_TESTS; ++i)
+    {
+        bool const fail = all_tests[i]() == FAIL;
+        if (fail)
+        {
+            res = FAIL;
+        }
+    }
+    return res;
+}
+
+/* Popping from alternating ends should close in on the middle from both
+   sides of the sorted order. */
+static enum test_result
+hdepq_test_pop_alternating(void)
+{
+    struct heap_depqueue hdq;
+    hdepq_init(&hdq, val_cmp, NULL);
+    size_t const size = 99;
+    int const prime = 101;
+    struct val vals[size];
+    CHECK(insert_shuffled(&hdq, vals, size, prime), PASS, enum test_result,
+          "%d");
+    int lo = 0;
+    int hi = (int)size - 1;
+    for (size_t i = 0; i < size; ++i)
+    {
+        if (i % 2)
+        {
+            struct val const *v
+                = HDEPQ_ENTRY(hdepq_pop_max(&hdq), struct val, elem);
+            CHECK(v->val, hi--, int, "%d");
+        }
+        else
+        {
+            struct val const *v
+                = HDEPQ_ENTRY(hdepq_pop_min(&hdq), struct val, elem);
+            CHECK(v->val, lo++, int, "%d");
+        }
+        CHECK(hdepq_validate(&hdq), true, bool, "%d");
+    }
+    CHECK(hdepq_empty(&hdq), true, bool, "%d");
+    hdepq_clear(&hdq, no_destruct);
+    return PASS;
+}
+
+static enum test_result
+hdepq_test_prime_shuffle_erase(void)
+{
+    struct heap_depqueue hdq;
+    hdepq_init(&hdq, val_cmp, NULL);
+    int const size = 99;
+    int const prime = 101;
+    /* Make the prime shuffle shorter than size for many duplicates. */
+    int const less = 77;
+    struct val vals[size];
+    int shuffled_index = prime % (size - less);
+    for (int i = 0; i < size; ++i)
+    {
+        vals[i].val = shuffled_index;
+        vals[i].id = i;
+        hdepq_push(&hdq, &vals[i].elem);
+        CHECK(hdepq_validate(&hdq), true, bool, "%d");
+        shuffled_index = (shuffled_index + prime) % (size - less);
+    }
+    shuffled_index = prime % (size - less);
+    size_t cur_size = size;
+    for (int i = 0; i < size; ++i)
+    {
+        CHECK(hdepq_erase(&hdq, &vals[shuffled_index].elem)
+                  == &vals[shuffled_index].elem,
+              true, bool, "%d");
+        CHECK(hdepq_validate(&hdq), true, bool, "%d");
+        --cur_size;
+        CHECK(hdepq_size(&hdq), cur_size, size_t, "%zu");
+        /* Shuffle normally here so we only remove each elem once. */
+        shuffled_index = (shuffled_index + prime) % size;
+    }
+    hdepq_clear(&hdq, no_destruct);
+    return PASS;
+}
+
+/* An element that has left the heap is refused even if its stale handle
+   is still in range. */
+static enum test_result
+hdepq_test_erase_twice(void)
+{
+    struct heap_depqueue hdq;
+    hdepq_init(&hdq, val_cmp, NULL);
+    size_t const size = 10;
+    struct val vals[size];
+    CHECK(insert_shuffled(&hdq, vals, size, 11), PASS, enum test_result,
+          "%d");
+    struct hdepq_elem *const min = hdepq_pop_min(&hdq);
+    CHECK(hdepq_erase(&hdq, min) == NULL, true, bool, "%d");
+    CHECK(hdepq_size(&hdq), size - 1, size_t, "%zu");
+    CHECK(hdepq_validate(&hdq), true, bool, "%d");
+    hdepq_clear(&hdq, no_destruct);
+    return PASS;
+}
+
+static enum test_result
+hdepq_test_weak_srand(void)
+{
+    struct heap_depqueue hdq;
+    hdepq_init(&hdq, val_cmp, NULL);
+    /* Seed the test with any integer for reproducible randome test sequence
+       currently this will change every test. NOLINTNEXTLINE */
+    srand(time(NULL));
+    int const num_heap_elems = 1000;
+    struct val vals[num_heap_elems];
+    for (int i = 0; i < num_heap_elems; ++i)
+    {
+        vals[i].val = rand() % (num_heap_elems / 4); // NOLINT
+        vals[i].id = i;
+        hdepq_push(&hdq, &vals[i].elem);
+        CHECK(hdepq_validate(&hdq), true, bool, "%d");
+    }
+    for (int i = 0; i < num_heap_elems; ++i)
+    {
+        CHECK(hdepq_erase(&hdq, &vals[i].elem) != NULL, true, bool, "%d");
+        CHECK(hdepq_validate(&hdq), true, bool, "%d");
+    }
+    CHECK(hdepq_empty(&hdq), true, bool, "%d");
+    hdepq_clear(&hdq, no_destruct);
+    return PASS;
+}
+
+static enum test_result
+insert_shuffled(struct heap_depqueue *hdq, struct val vals[],
+                size_t const size, int const larger_prime)
+{
+    /* Math magic ahead so that we iterate over every index
+       eventually but in a shuffled order. */
+    size_t shuffled_index = larger_prime % size;
+    for (size_t i = 0; i < size; ++i)
+    {
+        vals[shuffled_index].val = (int)shuffled_index;
+        hdepq_push(hdq, &vals[shuffled_index].elem);
+        CHECK(hdepq_size(hdq), i + 1, size_t, "%zu");
+        CHECK(hdepq_validate(hdq), true, bool, "%d");
+        shuffled_index = (shuffled_index + larger_prime) % size;
+    }
+    CHECK(hdepq_size(hdq), size, size_t, "%zu");
+    return PASS;
+}
+
+static enum heap_depq_threeway_cmp
+val_cmp(struct hdepq_elem const *a, struct hdepq_elem const *b, void *aux)
+{
+    (void)aux;
+    struct val *lhs = HDEPQ_ENTRY(a, struct val, elem);
+    struct val *rhs = HDEPQ_ENTRY(b, struct val, elem);
+    return (lhs->val > rhs->val) - (lhs->val < rhs->val);
+}
+
+static void
+no_destruct(struct hdepq_elem *e)
+{
+    (void)e;
+}
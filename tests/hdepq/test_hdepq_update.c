@@ -0,0 +1,131 @@
+#include "heap_depqueue.h"
+#include "test.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <time.h>
+
+struct val
+{
+    int id;
+    int val;
+    struct hdepq_elem elem;
+};
+
+static enum test_result hdepq_test_update_to_ends(void);
+static enum test_result hdepq_test_update_random(void);
+static enum heap_depq_threeway_cmp val_cmp(struct hdepq_elem const *,
+                                           struct hdepq_elem const *, void *);
+static void val_update(struct hdepq_elem *, void *);
+static void no_destruct(struct hdepq_elem *);
+
+#define NUM_TESTS (size_t)2
+test_fn const all_tests[NUM_TESTS] = {
+    hdepq_test_update_to_ends,
+    hdepq_test_update_random,
+};
+
+int
+main()
+{
+    enum test_result res = PASS;
+    for (size_t i = 0; i < NUM_TESTS; ++i)
+    {
+        bool const fail = all_tests[i]() == FAIL;
+        if (fail)
+        {
+            res = FAIL;
+        }
+    }
+    return res;
+}
+
+/* Elements deep in the heap updated past either end must become the new
+   min or max from whatever kind of level they started on. */
+static enum test_result
+hdepq_test_update_to_ends(void)
+{
+    struct heap_depqueue hdq;
+    hdepq_init(&hdq, val_cmp, NULL);
+    int const size = 100;
+    struct val vals[size];
+    for (int i = 0; i < size; ++i)
+    {
+        vals[i].val = i;
+        hdepq_push(&hdq, &vals[i].elem);
+    }
+    for (int i = 0; i < size; ++i)
+    {
+        int new_val = (i % 2) ? size + i : -i - 1;
+        CHECK(hdepq_update(&hdq, &vals[i].elem, val_update, &new_val), true,
+              bool, "%d");
+        CHECK(hdepq_validate(&hdq), true, bool, "%d");
+        struct val const *end
+            = (i % 2) ? HDEPQ_ENTRY(hdepq_max(&hdq), struct val, elem)
+                      : HDEPQ_ENTRY(hdepq_min(&hdq), struct val, elem);
+        CHECK(end, &vals[i], struct val const *, "%p");
+    }
+    struct hdepq_elem *const gone = hdepq_pop_min(&hdq);
+    int unused = 0;
+    CHECK(hdepq_update(&hdq, gone, val_update, &unused), false, bool, "%d");
+    hdepq_clear(&hdq, no_destruct);
+    return PASS;
+}
+
+static enum test_result
+hdepq_test_update_random(void)
+{
+    struct heap_depqueue hdq;
+    hdepq_init(&hdq, val_cmp, NULL);
+    /* Seed the test with any integer for reproducible randome test sequence
+       currently this will change every test. NOLINTNEXTLINE */
+    srand(time(NULL));
+    int const num_nodes = 1000;
+    struct val vals[num_nodes];
+    for (int i = 0; i < num_nodes; ++i)
+    {
+        vals[i].val = rand() % (num_nodes + 1); // NOLINT
+        vals[i].id = i;
+        hdepq_push(&hdq, &vals[i].elem);
+        CHECK(hdepq_validate(&hdq), true, bool, "%d");
+    }
+    for (int i = 0; i < num_nodes; ++i)
+    {
+        int new_val = rand() % (num_nodes + 1); // NOLINT
+        CHECK(hdepq_update(&hdq, &vals[i].elem, val_update, &new_val), true,
+              bool, "%d");
+        CHECK(hdepq_validate(&hdq), true, bool, "%d");
+    }
+    int prev = -1;
+    while (!hdepq_empty(&hdq))
+    {
+        struct val const *v
+            = HDEPQ_ENTRY(hdepq_pop_min(&hdq), struct val, elem);
+        CHECK(v->val >= prev, true, bool, "%d");
+        prev = v->val;
+    }
+    hdepq_clear(&hdq, no_destruct);
+    return PASS;
+}
+
+static enum heap_depq_threeway_cmp
+val_cmp(struct hdepq_elem const *a, struct hdepq_elem const *b, void *aux)
+{
+    (void)aux;
+    struct val *lhs = HDEPQ_ENTRY(a, struct val, elem);
+    struct val *rhs = HDEPQ_ENTRY(b, struct val, elem);
+    return (lhs->val > rhs->val) - (lhs->val < rhs->val);
+}
+
+static void
+val_update(struct hdepq_elem *e, void *aux)
+{
+    HDEPQ_ENTRY(e, struct val, elem)->val = *((int *)aux);
+}
+
+static void
+no_destruct(struct hdepq_elem *e)
+{
+    (void)e;
+}
@@ -12,11 +12,12 @@ struct val
 };
 
 static enum test_result pq_test_empty(void);
+static enum test_result pq_test_profile(void);
 static enum heap_pq_threeway_cmp val_cmp(struct hpq_elem const *,
                                          struct hpq_elem const *, void *);
 
-#define NUM_TESTS (size_t)1
-test_fn const all_tests[NUM_TESTS] = {pq_test_empty};
+#define NUM_TESTS (size_t)2
+test_fn const all_tests[NUM_TESTS] = {pq_test_empty, pq_test_profile};
 
 int
 main()
@@ -42,6 +43,31 @@ pq_test_empty(void)
     return PASS;
 }
 
+static enum test_result
+pq_test_profile(void)
+{
+    struct heap_pqueue pq;
+    hpq_init(&pq, HPQLES, val_cmp, NULL);
+    struct val vals[10];
+    for (int i = 0; i < 10; ++i)
+    {
+        vals[i].val = 10 - i;
+        hpq_push(&pq, &vals[i].elem);
+    }
+    struct hpq_counters const c = hpq_profile(&pq);
+#ifdef CONTAINER_PROFILE
+    /* Every push of a new minimum sifts all the way to the root. */
+    CHECK(c.sift_steps > 0, true, bool, "%d");
+    CHECK(c.cmps >= c.sift_steps, true, bool, "%d");
+    hpq_profile_reset(&pq);
+    CHECK(hpq_profile(&pq).cmps, 0, size_t, "%zu");
+#else
+    CHECK(c.cmps, 0, size_t, "%zu");
+    CHECK(c.sift_steps, 0, size_t, "%zu");
+#endif
+    return PASS;
+}
+
 static enum heap_pq_threeway_cmp
 val_cmp(struct hpq_elem const *a, struct hpq_elem const *b, void *aux)
 {
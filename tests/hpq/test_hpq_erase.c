@@ -21,13 +21,14 @@ static enum test_result hpq_test_pop_min(void);
 static enum test_result hpq_test_delete_prime_shuffle_duplicates(void);
 static enum test_result hpq_test_prime_shuffle(void);
 static enum test_result hpq_test_weak_srand(void);
+static enum test_result hpq_test_replace_front_pushpop(void);
 static enum test_result insert_shuffled(struct heap_pqueue *, struct val[],
                                         size_t, int);
 static size_t inorder_fill(int[], size_t, struct heap_pqueue *);
 static enum heap_pq_threeway_cmp val_cmp(struct hpq_elem const *,
                                          struct hpq_elem const *, void *);
 
-#define NUM_TESTS (size_t)7
+#define NUM_TESTS (size_t)8
 test_fn const all_tests[NUM_TESTS] = {
     hpq_test_insert_remove_four_dups,
     hpq_test_insert_erase_shuffled,
@@ -36,6 +37,7 @@ test_fn const all_tests[NUM_TESTS] = {
     hpq_test_delete_prime_shuffle_duplicates,
     hpq_test_prime_shuffle,
     hpq_test_weak_srand,
+    hpq_test_replace_front_pushpop,
 };
 
 int
@@ -258,6 +260,41 @@ hpq_test_weak_srand(void)
     return PASS;
 }
 
+static enum test_result
+hpq_test_replace_front_pushpop(void)
+{
+    struct heap_pqueue hpq;
+    hpq_init(&hpq, HPQLES, val_cmp, NULL);
+    size_t const size = 50;
+    int const prime = 53;
+    struct val vals[size];
+    CHECK(insert_shuffled(&hpq, vals, size, prime), PASS, enum test_result,
+          "%d");
+    /* Replace the min with a larger value each time. Fronts stay sorted. */
+    struct val replacements[size];
+    for (size_t i = 0; i < size; ++i)
+    {
+        replacements[i].val = (int)(size + i);
+        struct val const *front = HPQ_ENTRY(
+            hpq_replace_front(&hpq, &replacements[i].elem), struct val, elem);
+        CHECK(front->val, (int)i, int, "%d");
+        CHECK(hpq_validate(&hpq), true, bool, "%d");
+    }
+    CHECK(hpq_size(&hpq), size, size_t, "%zu");
+    /* A value that would be the front never enters the heap. */
+    struct val small = {.val = -1};
+    CHECK(hpq_pushpop(&hpq, &small.elem) == &small.elem, true, bool, "%d");
+    CHECK(hpq_size(&hpq), size, size_t, "%zu");
+    /* A larger value enters and the old front comes out. */
+    struct val big = {.val = (int)(size * 3)};
+    struct val const *out
+        = HPQ_ENTRY(hpq_pushpop(&hpq, &big.elem), struct val, elem);
+    CHECK(out->val, (int)size, int, "%d");
+    CHECK(hpq_validate(&hpq), true, bool, "%d");
+    CHECK(hpq_size(&hpq), size, size_t, "%zu");
+    return PASS;
+}
+
 static enum test_result
 insert_shuffled(struct heap_pqueue *hpq, struct val vals[], size_t const size,
                 int const larger_prime)
@@ -14,18 +14,34 @@ struct val
     struct hpq_elem elem;
 };
 
+/* Gives each updated element the next value and counts the calls that found
+   the heap out of order. The sift path restores the order after every
+   update while the rebuild path restores it only after the last, so the
+   count tells the two apart without profile counters. */
+struct batch_probe
+{
+    struct heap_pqueue const *pq;
+    int next_val;
+    size_t unordered_calls;
+};
+
 static enum test_result hpq_test_insert_iterate_pop(void);
 static enum test_result hpq_test_priority_update(void);
 static enum test_result hpq_test_priority_removal(void);
+static enum test_result hpq_test_priority_update_batch(void);
+static enum test_result hpq_test_update_batch_rejects(void);
 static void val_update(struct hpq_elem *, void *);
+static void val_update_probe(struct hpq_elem *, void *);
 static enum heap_pq_threeway_cmp val_cmp(struct hpq_elem const *,
                                          struct hpq_elem const *, void *);
 
-#define NUM_TESTS (size_t)3
+#define NUM_TESTS (size_t)5
 test_fn const all_tests[NUM_TESTS] = {
     hpq_test_insert_iterate_pop,
     hpq_test_priority_update,
     hpq_test_priority_removal,
+    hpq_test_priority_update_batch,
+    hpq_test_update_batch_rejects,
 };
 
 int
@@ -138,6 +154,112 @@ hpq_test_priority_update(void)
     return PASS;
 }
 
+static enum test_result
+hpq_test_priority_update_batch(void)
+{
+    struct heap_pqueue pq;
+    hpq_init(&pq, HPQLES, val_cmp, NULL);
+    /* Seed the test with any integer for reproducible random test sequence
+       currently this will change every test. NOLINTNEXTLINE */
+    srand(time(NULL));
+    /* The rebuild needs at least 2048 elements, see hpq_update_batch. */
+    size_t const num_nodes = 4096;
+    struct val vals[num_nodes];
+    struct hpq_elem *batch[num_nodes];
+    for (size_t i = 0; i < num_nodes; ++i)
+    {
+        /* Force duplicates. */
+        vals[i].val = rand() % (num_nodes + 1); // NOLINT
+        vals[i].id = (int)i;
+        hpq_push(&pq, &vals[i].elem);
+        batch[i] = &vals[i].elem;
+    }
+    /* A handful of updates should sift each element individually. */
+    struct batch_probe probe = {.pq = &pq, .next_val = -10};
+    hpq_profile_reset(&pq);
+    CHECK(hpq_update_batch(&pq, batch, 10, val_update_probe, &probe), true,
+          bool, "%d");
+    CHECK(hpq_validate(&pq), true, bool, "%d");
+    CHECK(probe.unordered_calls, 0, size_t, "%zu");
+    CHECK(hpq_profile(&pq).rebuilds, 0, size_t, "%zu");
+    struct val const *front = HPQ_ENTRY(hpq_front(&pq), struct val, elem);
+    CHECK(front->val, -10, int, "%d");
+    /* Changing every element should take the rebuild path. The front goes
+       first and becomes the largest value so every later update finds the
+       heap out of order until the rebuild. */
+    for (size_t i = 0; i < num_nodes; ++i)
+    {
+        if (batch[i] == hpq_front(&pq))
+        {
+            batch[i] = batch[0];
+            batch[0] = (struct hpq_elem *)hpq_front(&pq);
+            break;
+        }
+    }
+    probe = (struct batch_probe){.pq = &pq, .next_val = (int)num_nodes + 1};
+    CHECK(hpq_update_batch(&pq, batch, num_nodes, val_update_probe, &probe),
+          true, bool, "%d");
+    CHECK(hpq_validate(&pq), true, bool, "%d");
+    CHECK(probe.unordered_calls, num_nodes - 1, size_t, "%zu");
+#ifdef CONTAINER_PROFILE
+    CHECK(hpq_profile(&pq).rebuilds, 1, size_t, "%zu");
+#endif
+    CHECK(hpq_size(&pq), num_nodes, size_t, "%zu");
+    int prev = -1;
+    while (!hpq_empty(&pq))
+    {
+        struct val const *v = HPQ_ENTRY(hpq_pop(&pq), struct val, elem);
+        CHECK(v->val >= prev, true, bool, "%d");
+        prev = v->val;
+    }
+    return PASS;
+}
+
+/* A batch with a NULL or an element of another heap late in it must be
+   refused before fn touches any element, on both update paths. */
+static enum test_result
+hpq_test_update_batch_rejects(void)
+{
+    struct heap_pqueue pq;
+    hpq_init(&pq, HPQLES, val_cmp, NULL);
+    struct heap_pqueue other;
+    hpq_init(&other, HPQLES, val_cmp, NULL);
+    size_t const num_nodes = 4096;
+    struct val vals[num_nodes];
+    struct hpq_elem *batch[num_nodes];
+    for (size_t i = 0; i < num_nodes; ++i)
+    {
+        vals[i].val = (int)i;
+        vals[i].id = (int)i;
+        hpq_push(&pq, &vals[i].elem);
+        batch[i] = &vals[i].elem;
+    }
+    struct val stray = {.id = -1, .val = -1};
+    hpq_push(&other, &stray.elem);
+    int new_val = -5;
+    size_t const lens[2] = {10, num_nodes};
+    for (size_t l = 0; l < 2; ++l)
+    {
+        struct hpq_elem *const last = batch[lens[l] - 1];
+        batch[lens[l] - 1] = NULL;
+        CHECK(hpq_update_batch(&pq, batch, lens[l], val_update, &new_val),
+              false, bool, "%d");
+        batch[lens[l] - 1] = &stray.elem;
+        CHECK(hpq_update_batch(&pq, batch, lens[l], val_update, &new_val),
+              false, bool, "%d");
+        batch[lens[l] - 1] = last;
+        CHECK(hpq_update(&pq, &stray.elem, val_update, &new_val), false, bool,
+              "%d");
+    }
+    for (size_t i = 0; i < num_nodes; ++i)
+    {
+        CHECK(vals[i].val, (int)i, int, "%d");
+    }
+    CHECK(stray.val, -1, int, "%d");
+    CHECK(hpq_validate(&pq), true, bool, "%d");
+    return PASS;
+}
+
 static enum heap_pq_threeway_cmp
 val_cmp(struct hpq_elem const *a, struct hpq_elem const *b, void *aux)
 {
@@ -153,3 +275,14 @@ val_update(struct hpq_elem *a, void *aux)
     struct val *old = HPQ_ENTRY(a, struct val, elem);
     old->val = *(int *)aux;
 }
+
+static void
+val_update_probe(struct hpq_elem *a, void *aux)
+{
+    struct batch_probe *const probe = aux;
+    if (!hpq_validate(probe->pq))
+    {
+        ++probe->unordered_calls;
+    }
+    HPQ_ENTRY(a, struct val, elem)->val = probe->next_val++;
+}
@@ -0,0 +1,179 @@
+#include "depqueue.h"
+#include "inbox.h"
+#include "pqueue.h"
+#include "test.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <time.h>
+
+struct val
+{
+    int id;
+    int val;
+    struct pq_elem pq_elem;
+    struct depq_elem depq_elem;
+};
+
+static enum test_result inbox_test_empty(void);
+static enum test_result inbox_test_pq_order(void);
+static enum test_result inbox_test_depq_order(void);
+static enum test_result inbox_test_interleaved(void);
+static enum pq_threeway_cmp pq_val_cmp(struct pq_elem const *,
+                                       struct pq_elem const *, void *);
+static dpq_threeway_cmp depq_val_cmp(struct depq_elem const *,
+                                     struct depq_elem const *, void *);
+
+#define NUM_TESTS (size_t)4
+test_fn const all_tests[NUM_TESTS] = {
+    inbox_test_empty,
+    inbox_test_pq_order,
+    inbox_test_depq_order,
+    inbox_test_interleaved,
+};
+
+int
+main()
+{
+    /* Seed the test with any integer for reproducible randome test sequence
+       currently this will change every test. NOLINTNEXTLINE */
+    srand(time(NULL));
+    enum test_result res = PASS;
+    for (size_t i = 0; i < NUM_TESTS; ++i)
+    {
+        bool const fail = all_tests[i]() == FAIL;
+        if (fail)
+        {
+            res = FAIL;
+        }
+    }
+    return res;
+}
+
+static enum test_result
+inbox_test_empty(void)
+{
+    struct pqueue pq = PQ_INIT(PQLES, pq_val_cmp, NULL);
+    struct pq_inbox pin;
+    pq_inbox_init(&pin, &pq);
+    CHECK(pq_inbox_drain(&pin), 0, size_t, "%zu");
+    CHECK(pq_inbox_pop(&pin) == NULL, true, bool, "%d");
+    struct depqueue depq = DEPQ_INIT(depq, depq_val_cmp, NULL);
+    struct depq_inbox din;
+    depq_inbox_init(&din, &depq);
+    CHECK(depq_inbox_drain(&din), 0, size_t, "%zu");
+    CHECK(depq_inbox_pop_max(&din) == NULL, true, bool, "%d");
+    CHECK(depq_inbox_pop_min(&din) == NULL, true, bool, "%d");
+    return PASS;
+}
+
+/* Pushes wait in the inbox until a drain moves them all into the pqueue,
+   which then pops in order. */
+static enum test_result
+inbox_test_pq_order(void)
+{
+    struct pqueue pq = PQ_INIT(PQLES, pq_val_cmp, NULL);
+    struct pq_inbox in;
+    pq_inbox_init(&in, &pq);
+    struct val vals[500];
+    for (int i = 0; i < 500; ++i)
+    {
+        vals[i] = (struct val){.id = i, .val = rand() % 100}; // NOLINT
+        pq_inbox_push(&in, &vals[i].pq_elem);
+    }
+    CHECK(pq_empty(&pq), true, bool, "%d");
+    CHECK(pq_inbox_drain(&in), 500, size_t, "%zu");
+    CHECK(pq_size(&pq), 500, size_t, "%zu");
+    CHECK(pq_validate(&pq), true, bool, "%d");
+    CHECK(pq_inbox_drain(&in), 0, size_t, "%zu");
+    int prev = -1;
+    for (struct pq_elem *e = NULL; (e = pq_inbox_pop(&in));)
+    {
+        int const cur = PQ_ENTRY(e, struct val, pq_elem)->val;
+        CHECK(cur >= prev, true, bool, "%d");
+        prev = cur;
+    }
+    CHECK(pq_empty(&pq), true, bool, "%d");
+    return PASS;
+}
+
+static enum test_result
+inbox_test_depq_order(void)
+{
+    struct depqueue depq = DEPQ_INIT(depq, depq_val_cmp, NULL);
+    struct depq_inbox in;
+    depq_inbox_init(&in, &depq);
+    struct val vals[500];
+    for (int i = 0; i < 500; ++i)
+    {
+        vals[i] = (struct val){.id = i, .val = rand() % 100}; // NOLINT
+        depq_inbox_push(&in, &vals[i].depq_elem);
+    }
+    CHECK(depq_inbox_drain(&in), 500, size_t, "%zu");
+    CHECK(depq_size(&depq), 500, size_t, "%zu");
+    CHECK(validate_tree(&depq.t), true, bool, "%d");
+    int lo = -1;
+    int hi = 100;
+    for (int i = 0; i < 250; ++i)
+    {
+        int const min = DEPQ_ENTRY(depq_inbox_pop_min(&in), struct val,
+                                   depq_elem)
+                            ->val;
+        int const max = DEPQ_ENTRY(depq_inbox_pop_max(&in), struct val,
+                                   depq_elem)
+                            ->val;
+        CHECK(min >= lo && max <= hi && min <= max, true, bool, "%d");
+        lo = min;
+        hi = max;
+    }
+    CHECK(depq_empty(&depq), true, bool, "%d");
+    return PASS;
+}
+
+/* Elements pushed between pops join the queue at the next pop and a popped
+   element may be pushed again. */
+static enum test_result
+inbox_test_interleaved(void)
+{
+    struct pqueue pq = PQ_INIT(PQLES, pq_val_cmp, NULL);
+    struct pq_inbox in;
+    pq_inbox_init(&in, &pq);
+    struct val vals[3] = {{.id = 0, .val = 5}, {.id = 1, .val = 3}};
+    pq_inbox_push(&in, &vals[0].pq_elem);
+    pq_inbox_push(&in, &vals[1].pq_elem);
+    struct pq_elem *e = pq_inbox_pop(&in);
+    CHECK(PQ_ENTRY(e, struct val, pq_elem)->id, 1, int, "%d");
+    vals[2] = (struct val){.id = 2, .val = 1};
+    pq_inbox_push(&in, &vals[2].pq_elem);
+    PQ_ENTRY(e, struct val, pq_elem)->val = 9;
+    pq_inbox_push(&in, e);
+    e = pq_inbox_pop(&in);
+    CHECK(PQ_ENTRY(e, struct val, pq_elem)->id, 2, int, "%d");
+    e = pq_inbox_pop(&in);
+    CHECK(PQ_ENTRY(e, struct val, pq_elem)->id, 0, int, "%d");
+    e = pq_inbox_pop(&in);
+    CHECK(PQ_ENTRY(e, struct val, pq_elem)->id, 1, int, "%d");
+    CHECK(pq_inbox_pop(&in) == NULL, true, bool, "%d");
+    return PASS;
+}
+
+static enum pq_threeway_cmp
+pq_val_cmp(struct pq_elem const *const a, struct pq_elem const *const b,
+           void *const aux)
+{
+    (void)aux;
+    int const x = PQ_ENTRY(a, struct val, pq_elem)->val;
+    int const y = PQ_ENTRY(b, struct val, pq_elem)->val;
+    return (x > y) - (x < y);
+}
+
+static dpq_threeway_cmp
+depq_val_cmp(struct depq_elem const *const a, struct depq_elem const *const b,
+             void *const aux)
+{
+    (void)aux;
+    int const x = DEPQ_ENTRY(a, struct val, depq_elem)->val;
+    int const y = DEPQ_ENTRY(b, struct val, depq_elem)->val;
+    return (x > y) - (x < y);
+}
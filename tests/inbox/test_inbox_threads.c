@@ -0,0 +1,222 @@
+#include "depqueue.h"
+#include "inbox.h"
+#include "pqueue.h"
+#include "test.h"
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+struct val
+{
+    int id;
+    int val;
+    struct pq_elem pq_elem;
+    struct depq_elem depq_elem;
+};
+
+/* A producer thread and the slice of elements it pushes. */
+struct producer
+{
+    struct pq_inbox *pin;
+    struct depq_inbox *din;
+    struct val *vals;
+    size_t begin;
+    size_t end;
+};
+
+static enum test_result inbox_test_pq_producers(void);
+static enum test_result inbox_test_depq_producers(void);
+static void *produce_pq(void *);
+static void *produce_depq(void *);
+static enum pq_threeway_cmp pq_val_cmp(struct pq_elem const *,
+                                       struct pq_elem const *, void *);
+static dpq_threeway_cmp depq_val_cmp(struct depq_elem const *,
+                                     struct depq_elem const *, void *);
+
+#define THREADS (size_t)4
+#define PER_THREAD (size_t)10000
+
+#define NUM_TESTS (size_t)2
+test_fn const all_tests[NUM_TESTS] = {
+    inbox_test_pq_producers,
+    inbox_test_depq_producers,
+};
+
+int
+main()
+{
+    enum test_result res = PASS;
+    for (size_t i = 0; i < NUM_TESTS; ++i)
+    {
+        bool const fail = all_tests[i]() == FAIL;
+        if (fail)
+        {
+            res = FAIL;
+        }
+    }
+    return res;
+}
+
+/* The consumer pops while the producers push. Each element must come out
+   once and after the producers finish the rest comes out in order. */
+static enum test_result
+inbox_test_pq_producers(void)
+{
+    struct pqueue pq = PQ_INIT(PQLES, pq_val_cmp, NULL);
+    struct pq_inbox in;
+    pq_inbox_init(&in, &pq);
+    size_t const total = THREADS * PER_THREAD;
+    struct val *const vals = malloc(total * sizeof(struct val));
+    bool *const seen = calloc(total, sizeof(bool));
+    CHECK(vals && seen, true, bool, "%d");
+    for (size_t i = 0; i < total; ++i)
+    {
+        vals[i] = (struct val){.id = (int)i, .val = (int)((i * 31) % 997)};
+    }
+    pthread_t threads[THREADS];
+    struct producer producers[THREADS];
+    for (size_t i = 0; i < THREADS; ++i)
+    {
+        producers[i] = (struct producer){
+            .pin = &in,
+            .vals = vals,
+            .begin = i * PER_THREAD,
+            .end = (i + 1) * PER_THREAD,
+        };
+        CHECK(pthread_create(&threads[i], NULL, produce_pq, &producers[i]),
+              0, int, "%d");
+    }
+    size_t popped = 0;
+    while (popped < total / 2)
+    {
+        struct pq_elem *const e = pq_inbox_pop(&in);
+        if (e)
+        {
+            int const id = PQ_ENTRY(e, struct val, pq_elem)->id;
+            CHECK(seen[id], false, bool, "%d");
+            seen[id] = true;
+            ++popped;
+        }
+    }
+    for (size_t i = 0; i < THREADS; ++i)
+    {
+        CHECK(pthread_join(threads[i], NULL), 0, int, "%d");
+    }
+    int prev = -1;
+    for (struct pq_elem *e = NULL; (e = pq_inbox_pop(&in));)
+    {
+        struct val const *const v = PQ_ENTRY(e, struct val, pq_elem);
+        CHECK(seen[v->id], false, bool, "%d");
+        CHECK(v->val >= prev, true, bool, "%d");
+        seen[v->id] = true;
+        prev = v->val;
+        ++popped;
+    }
+    CHECK(popped, total, size_t, "%zu");
+    CHECK(pq_validate(&pq), true, bool, "%d");
+    free(seen);
+    free(vals);
+    return PASS;
+}
+
+static enum test_result
+inbox_test_depq_producers(void)
+{
+    struct depqueue depq = DEPQ_INIT(depq, depq_val_cmp, NULL);
+    struct depq_inbox in;
+    depq_inbox_init(&in, &depq);
+    size_t const total = THREADS * PER_THREAD;
+    struct val *const vals = malloc(total * sizeof(struct val));
+    bool *const seen = calloc(total, sizeof(bool));
+    CHECK(vals && seen, true, bool, "%d");
+    for (size_t i = 0; i < total; ++i)
+    {
+        vals[i] = (struct val){.id = (int)i, .val = (int)((i * 31) % 997)};
+    }
+    pthread_t threads[THREADS];
+    struct producer producers[THREADS];
+    for (size_t i = 0; i < THREADS; ++i)
+    {
+        producers[i] = (struct producer){
+            .din = &in,
+            .vals = vals,
+            .begin = i * PER_THREAD,
+            .end = (i + 1) * PER_THREAD,
+        };
+        CHECK(pthread_create(&threads[i], NULL, produce_depq, &producers[i]),
+              0, int, "%d");
+    }
+    size_t popped = 0;
+    while (popped < total / 2)
+    {
+        struct depq_elem *const e = popped % 2 ? depq_inbox_pop_max(&in)
+                                               : depq_inbox_pop_min(&in);
+        if (e)
+        {
+            int const id = DEPQ_ENTRY(e, struct val, depq_elem)->id;
+            CHECK(seen[id], false, bool, "%d");
+            seen[id] = true;
+            ++popped;
+        }
+    }
+    for (size_t i = 0; i < THREADS; ++i)
+    {
+        CHECK(pthread_join(threads[i], NULL), 0, int, "%d");
+    }
+    for (struct depq_elem *e = NULL; (e = depq_inbox_pop_max(&in));)
+    {
+        int const id = DEPQ_ENTRY(e, struct val, depq_elem)->id;
+        CHECK(seen[id], false, bool, "%d");
+        seen[id] = true;
+        ++popped;
+    }
+    CHECK(popped, total, size_t, "%zu");
+    CHECK(validate_tree(&depq.t), true, bool, "%d");
+    free(seen);
+    free(vals);
+    return PASS;
+}
+
+static void *
+produce_pq(void *const arg)
+{
+    struct producer *const p = arg;
+    for (size_t i = p->begin; i < p->end; ++i)
+    {
+        pq_inbox_push(p->pin, &p->vals[i].pq_elem);
+    }
+    return NULL;
+}
+
+static void *
+produce_depq(void *const arg)
+{
+    struct producer *const p = arg;
+    for (size_t i = p->begin; i < p->end; ++i)
+    {
+        depq_inbox_push(p->din, &p->vals[i].depq_elem);
+    }
+    return NULL;
+}
+
+static enum pq_threeway_cmp
+pq_val_cmp(struct pq_elem const *const a, struct pq_elem const *const b,
+           void *const aux)
+{
+    (void)aux;
+    int const x = PQ_ENTRY(a, struct val, pq_elem)->val;
+    int const y = PQ_ENTRY(b, struct val, pq_elem)->val;
+    return (x > y) - (x < y);
+}
+
+static dpq_threeway_cmp
+depq_val_cmp(struct depq_elem const *const a, struct depq_elem const *const b,
+             void *const aux)
+{
+    (void)aux;
+    int const x = DEPQ_ENTRY(a, struct val, depq_elem)->val;
+    int const y = DEPQ_ENTRY(b, struct val, depq_elem)->val;
+    return (x > y) - (x < y);
+}
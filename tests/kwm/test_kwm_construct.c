@@ -0,0 +1,131 @@
+#include "kway_merge.h"
+#include "test.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+static enum test_result kwm_test_no_inputs(void);
+static enum test_result kwm_test_empty_inputs(void);
+static enum test_result kwm_test_single_input(void);
+static enum test_result kwm_test_profile(void);
+static enum kway_threeway_cmp int_cmp(void const *, void const *, void *);
+
+#define NUM_TESTS (size_t)4
+test_fn const all_tests[NUM_TESTS] = {
+    kwm_test_no_inputs,
+    kwm_test_empty_inputs,
+    kwm_test_single_input,
+    kwm_test_profile,
+};
+
+int
+main()
+{
+    enum test_result res = PASS;
+    for (size_t i = 0; i < NUM_TESTS; ++i)
+    {
+        bool const fail = all_tests[i]() == FAIL;
+        if (fail)
+        {
+            res = FAIL;
+        }
+    }
+    return res;
+}
+
+static enum test_result
+kwm_test_no_inputs(void)
+{
+    enum kwm_engine const engines[2] = {KWM_LOSER_TREE, KWM_HEAP};
+    for (size_t e = 0; e < 2; ++e)
+    {
+        struct kway_merge km;
+        CHECK(kwm_init(&km, NULL, 0, KWMLES, int_cmp, NULL, engines[e]), true,
+              bool, "%d");
+        CHECK(kwm_done(&km), true, bool, "%d");
+        CHECK(kwm_next(&km) == NULL, true, bool, "%d");
+        kwm_free(&km);
+    }
+    return PASS;
+}
+
+static enum test_result
+kwm_test_empty_inputs(void)
+{
+    enum kwm_engine const engines[2] = {KWM_LOSER_TREE, KWM_HEAP};
+    for (size_t e = 0; e < 2; ++e)
+    {
+        struct kwm_input inputs[5] = {0};
+        struct kway_merge km;
+        CHECK(kwm_init(&km, inputs, 5, KWMLES, int_cmp, NULL, engines[e]),
+              true, bool, "%d");
+        CHECK(kwm_done(&km), true, bool, "%d");
+        void const *out[4];
+        CHECK(kwm_next_batch(&km, out, 4), 0, size_t, "%zu");
+        kwm_free(&km);
+    }
+    return PASS;
+}
+
+static enum test_result
+kwm_test_single_input(void)
+{
+    int const vals[4] = {1, 2, 2, 9};
+    void const *const items[4] = {&vals[0], &vals[1], &vals[2], &vals[3]};
+    struct kwm_input input = {.items = items, .len = 4};
+    struct kway_merge km;
+    CHECK(kwm_init(&km, &input, 1, KWMLES, int_cmp, NULL, KWM_LOSER_TREE),
+          true, bool, "%d");
+    for (size_t i = 0; i < 4; ++i)
+    {
+        CHECK(kwm_next(&km) == items[i], true, bool, "%d");
+    }
+    CHECK(kwm_done(&km), true, bool, "%d");
+    kwm_free(&km);
+    return PASS;
+}
+
+/* Every element after the first tournament costs at most one comparison
+   per level of the loser tree, ceil(lg8) = 3 here. */
+static enum test_result
+kwm_test_profile(void)
+{
+    size_t const k = 8;
+    size_t const per_input = 100;
+    int vals[8][100];
+    void const *items[8][100];
+    struct kwm_input inputs[8];
+    for (size_t i = 0; i < k; ++i)
+    {
+        for (size_t j = 0; j < per_input; ++j)
+        {
+            vals[i][j] = (int)((j * k) + i);
+            items[i][j] = &vals[i][j];
+        }
+        inputs[i] = (struct kwm_input){.items = items[i], .len = per_input};
+    }
+    struct kway_merge km;
+    CHECK(kwm_init(&km, inputs, k, KWMLES, int_cmp, NULL, KWM_LOSER_TREE),
+          true, bool, "%d");
+    kwm_profile_reset(&km);
+    while (kwm_next(&km))
+    {}
+    struct kwm_counters const c = kwm_profile(&km);
+#ifdef CONTAINER_PROFILE
+    CHECK(c.cmps > 0, true, bool, "%d");
+    CHECK(c.cmps <= k * per_input * 3, true, bool, "%d");
+#else
+    CHECK(c.cmps, 0, size_t, "%zu");
+#endif
+    kwm_free(&km);
+    return PASS;
+}
+
+static enum kway_threeway_cmp
+int_cmp(void const *const a, void const *const b, void *const aux)
+{
+    (void)aux;
+    int const x = *(int const *)a;
+    int const y = *(int const *)b;
+    return (x > y) - (x < y);
+}
@@ -0,0 +1,222 @@
+#include "kway_merge.h"
+#include "test.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <time.h>
+
+struct val
+{
+    int key;
+    size_t input;
+    size_t seq;
+};
+
+struct counter
+{
+    int cur;
+    int end;
+    int step;
+    struct val *vals;
+};
+
+static enum test_result kwm_test_random_runs(void);
+static enum test_result kwm_test_stable_ties(void);
+static enum test_result kwm_test_descending(void);
+static enum test_result kwm_test_callback_inputs(void);
+static enum test_result merge_and_check(size_t k, enum kway_threeway_cmp,
+                                        enum kwm_engine, int key_range);
+static enum kway_threeway_cmp val_cmp(void const *, void const *, void *);
+static int sort_asc(void const *, void const *);
+static void const *count_next(void *);
+
+#define NUM_TESTS (size_t)4
+test_fn const all_tests[NUM_TESTS] = {
+    kwm_test_random_runs,
+    kwm_test_stable_ties,
+    kwm_test_descending,
+    kwm_test_callback_inputs,
+};
+
+int
+main()
+{
+    enum test_result res = PASS;
+    for (size_t i = 0; i < NUM_TESTS; ++i)
+    {
+        bool const fail = all_tests[i]() == FAIL;
+        if (fail)
+        {
+            res = FAIL;
+        }
+    }
+    return res;
+}
+
+/* Sizes of K that are and are not powers of two give loser trees with
+   leaves on one or two levels. */
+static enum test_result
+kwm_test_random_runs(void)
+{
+    /* Seed the test with any integer for reproducible randome test sequence
+       currently this will change every test. NOLINTNEXTLINE */
+    srand(time(NULL));
+    size_t const ks[6] = {1, 2, 3, 7, 64, 100};
+    for (size_t i = 0; i < 6; ++i)
+    {
+        CHECK(merge_and_check(ks[i], KWMLES, KWM_LOSER_TREE, 1000), PASS,
+              enum test_result, "%d");
+        CHECK(merge_and_check(ks[i], KWMLES, KWM_HEAP, 1000), PASS,
+              enum test_result, "%d");
+    }
+    return PASS;
+}
+
+/* Few distinct keys across many inputs so nearly every match is a tie. */
+static enum test_result
+kwm_test_stable_ties(void)
+{
+    CHECK(merge_and_check(13, KWMLES, KWM_LOSER_TREE, 3), PASS,
+          enum test_result, "%d");
+    CHECK(merge_and_check(13, KWMLES, KWM_HEAP, 3), PASS, enum test_result,
+          "%d");
+    return PASS;
+}
+
+static enum test_result
+kwm_test_descending(void)
+{
+    CHECK(merge_and_check(9, KWMGRT, KWM_LOSER_TREE, 50), PASS,
+          enum test_result, "%d");
+    CHECK(merge_and_check(9, KWMGRT, KWM_HEAP, 50), PASS, enum test_result,
+          "%d");
+    return PASS;
+}
+
+/* Three counting generators with strides that interleave the integers. */
+static enum test_result
+kwm_test_callback_inputs(void)
+{
+    struct val vals[300];
+    struct counter counters[3];
+    struct kwm_input inputs[3];
+    for (int i = 0; i < 3; ++i)
+    {
+        counters[i] = (struct counter){
+            .cur = i,
+            .end = 300,
+            .step = 3,
+            .vals = vals,
+        };
+        inputs[i] = (struct kwm_input){.next = count_next, .ctx = &counters[i]};
+    }
+    struct kway_merge km;
+    CHECK(kwm_init(&km, inputs, 3, KWMLES, val_cmp, NULL, KWM_LOSER_TREE),
+          true, bool, "%d");
+    void const *batch[64];
+    int expect = 0;
+    for (size_t n = 0; (n = kwm_next_batch(&km, batch, 64));)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            CHECK(((struct val const *)batch[i])->key, expect, int, "%d");
+            ++expect;
+        }
+    }
+    CHECK(expect, 300, int, "%d");
+    kwm_free(&km);
+    return PASS;
+}
+
+/* Builds k sorted inputs of uneven lengths, some empty, merges them, and
+   checks the output is ordered, ties leave by input then by position, and
+   every element comes out. */
+static enum test_result
+merge_and_check(size_t const k, enum kway_threeway_cmp const order,
+                enum kwm_engine const engine, int const key_range)
+{
+    size_t const max_len = 200;
+    struct val *const vals = malloc(k * max_len * sizeof(struct val));
+    void const **const items = malloc(k * max_len * sizeof(void const *));
+    struct kwm_input *const inputs = malloc(k * sizeof(struct kwm_input));
+    CHECK(vals && items && inputs, true, bool, "%d");
+    size_t total = 0;
+    for (size_t i = 0; i < k; ++i)
+    {
+        size_t const len = (size_t)rand() % max_len; // NOLINT
+        struct val *const run = vals + (i * max_len);
+        for (size_t j = 0; j < len; ++j)
+        {
+            run[j].key = rand() % key_range; // NOLINT
+        }
+        qsort(run, len, sizeof(struct val), sort_asc);
+        for (size_t j = 0; j < len; ++j)
+        {
+            size_t const at = order == KWMLES ? j : len - 1 - j;
+            run[at].input = i;
+            run[at].seq = j;
+            items[(i * max_len) + j] = &run[at];
+        }
+        inputs[i] = (struct kwm_input){
+            .items = items + (i * max_len),
+            .len = len,
+        };
+        total += len;
+    }
+    struct kway_merge km;
+    CHECK(kwm_init(&km, inputs, k, order, val_cmp, NULL, engine), true, bool,
+          "%d");
+    size_t count = 0;
+    struct val const *prev = NULL;
+    for (struct val const *v = NULL; (v = kwm_next(&km)); prev = v, ++count)
+    {
+        if (!prev)
+        {
+            continue;
+        }
+        CHECK(val_cmp(v, prev, NULL) != order, true, bool, "%d");
+        if (v->key == prev->key)
+        {
+            CHECK(v->input > prev->input
+                      || (v->input == prev->input && v->seq == prev->seq + 1),
+                  true, bool, "%d");
+        }
+    }
+    CHECK(count, total, size_t, "%zu");
+    CHECK(kwm_done(&km), true, bool, "%d");
+    kwm_free(&km);
+    free(inputs);
+    free(items);
+    free(vals);
+    return PASS;
+}
+
+static enum kway_threeway_cmp
+val_cmp(void const *const a, void const *const b, void *const aux)
+{
+    (void)aux;
+    int const x = ((struct val const *)a)->key;
+    int const y = ((struct val const *)b)->key;
+    return (x > y) - (x < y);
+}
+
+static int
+sort_asc(void const *const a, void const *const b)
+{
+    return val_cmp(a, b, NULL);
+}
+
+static void const *
+count_next(void *const ctx)
+{
+    struct counter *const c = ctx;
+    if (c->cur >= c->end)
+    {
+        return NULL;
+    }
+    struct val *const v = &c->vals[c->cur];
+    v->key = c->cur;
+    c->cur += c->step;
+    return v;
+}
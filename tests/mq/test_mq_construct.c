@@ -0,0 +1,172 @@
+#include "multi_queue.h"
+#include "pqueue.h"
+#include "test.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <time.h>
+
+struct val
+{
+    int id;
+    int val;
+    struct pq_elem elem;
+};
+
+static enum test_result mq_test_empty(void);
+static enum test_result mq_test_all_out(void);
+static enum test_result mq_test_rank_error(void);
+static enum test_result mq_test_clear(void);
+static enum pq_threeway_cmp val_cmp(struct pq_elem const *,
+                                    struct pq_elem const *, void *);
+static void count_destruct(struct pq_elem *);
+
+static int destructed = 0;
+
+#define NUM_TESTS (size_t)4
+test_fn const all_tests[NUM_TESTS] = {
+    mq_test_empty,
+    mq_test_all_out,
+    mq_test_rank_error,
+    mq_test_clear,
+};
+
+int
+main()
+{
+    /* Seed the test with any integer for reproducible randome test sequence
+       currently this will change every test. NOLINTNEXTLINE */
+    srand(time(NULL));
+    enum test_result res = PASS;
+    for (size_t i = 0; i < NUM_TESTS; ++i)
+    {
+        bool const fail = all_tests[i]() == FAIL;
+        if (fail)
+        {
+            res = FAIL;
+        }
+    }
+    return res;
+}
+
+static enum test_result
+mq_test_empty(void)
+{
+    struct multi_queue mq;
+    CHECK(mq_init(&mq, 1, PQLES, val_cmp, NULL), false, bool, "%d");
+    CHECK(mq_init(&mq, 4, PQLES, val_cmp, NULL), true, bool, "%d");
+    CHECK(mq_num_heaps(&mq), 4, size_t, "%zu");
+    CHECK(mq_empty(&mq), true, bool, "%d");
+    CHECK(mq_pop(&mq) == NULL, true, bool, "%d");
+    CHECK(mq_validate(&mq), true, bool, "%d");
+    mq_clear(&mq, NULL);
+    return PASS;
+}
+
+/* Every element comes out once whatever the order. */
+static enum test_result
+mq_test_all_out(void)
+{
+    struct multi_queue mq;
+    CHECK(mq_init(&mq, 6, PQGRT, val_cmp, NULL), true, bool, "%d");
+    struct val vals[1000];
+    bool seen[1000] = {0};
+    for (int i = 0; i < 1000; ++i)
+    {
+        vals[i] = (struct val){.id = i, .val = rand() % 100}; // NOLINT
+        mq_push(&mq, &vals[i].elem);
+    }
+    CHECK(mq_size(&mq), 1000, size_t, "%zu");
+    CHECK(mq_validate(&mq), true, bool, "%d");
+    for (int i = 0; i < 1000; ++i)
+    {
+        struct pq_elem *const e = mq_pop(&mq);
+        CHECK(e != NULL, true, bool, "%d");
+        struct val const *const v = PQ_ENTRY(e, struct val, elem);
+        CHECK(seen[v->id], false, bool, "%d");
+        seen[v->id] = true;
+    }
+    CHECK(mq_pop(&mq) == NULL, true, bool, "%d");
+    CHECK(mq_empty(&mq), true, bool, "%d");
+    mq_clear(&mq, NULL);
+    return PASS;
+}
+
+/* The rank of a popped element is the number of elements still queued
+   that should have come out before it. With two choices over h heaps the
+   mean is a small multiple of h. The bound is loose so the test does not
+   fail by chance. */
+static enum test_result
+mq_test_rank_error(void)
+{
+    size_t const heaps = 8;
+    struct multi_queue mq;
+    CHECK(mq_init(&mq, heaps, PQLES, val_cmp, NULL), true, bool, "%d");
+    struct val vals[4000];
+    bool queued[4000] = {0};
+    for (int i = 0; i < 4000; ++i)
+    {
+        vals[i] = (struct val){.id = i, .val = i};
+    }
+    for (int i = 3999; i > 0; --i)
+    {
+        int const j = rand() % (i + 1); // NOLINT
+        int const swap = vals[i].val;
+        vals[i].val = vals[j].val;
+        vals[j].val = swap;
+    }
+    for (int i = 0; i < 4000; ++i)
+    {
+        mq_push(&mq, &vals[i].elem);
+        queued[vals[i].val] = true;
+    }
+    size_t total_rank = 0;
+    for (int i = 0; i < 4000; ++i)
+    {
+        int const popped = PQ_ENTRY(mq_pop(&mq), struct val, elem)->val;
+        for (int k = 0; k < popped; ++k)
+        {
+            total_rank += queued[k];
+        }
+        queued[popped] = false;
+    }
+    CHECK(total_rank / 4000 <= 4 * heaps, true, bool, "%d");
+    mq_clear(&mq, NULL);
+    return PASS;
+}
+
+static enum test_result
+mq_test_clear(void)
+{
+    struct multi_queue mq;
+    CHECK(mq_init(&mq, 3, PQLES, val_cmp, NULL), true, bool, "%d");
+    struct val vals[100];
+    for (int i = 0; i < 100; ++i)
+    {
+        vals[i] = (struct val){.id = i, .val = i};
+        mq_push(&mq, &vals[i].elem);
+    }
+    destructed = 0;
+    mq_clear(&mq, count_destruct);
+    CHECK(destructed, 100, int, "%d");
+    CHECK(mq_num_heaps(&mq), 0, size_t, "%zu");
+    return PASS;
+}
+
+static enum pq_threeway_cmp
+val_cmp(struct pq_elem const *const a, struct pq_elem const *const b,
+        void *const aux)
+{
+    (void)aux;
+    int const x = PQ_ENTRY(a, struct val, elem)->val;
+    int const y = PQ_ENTRY(b, struct val, elem)->val;
+    return (x > y) - (x < y);
+}
+
+static void
+count_destruct(struct pq_elem *const e)
+{
+    (void)e;
+    ++destructed;
+}
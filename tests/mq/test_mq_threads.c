@@ -0,0 +1,212 @@
+#include "multi_queue.h"
+#include "pqueue.h"
+#include "test.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+struct val
+{
+    int id;
+    int val;
+    struct pq_elem elem;
+};
+
+/* The shared state of the producers and consumers. */
+struct run
+{
+    struct multi_queue *mq;
+    struct val *vals;
+    atomic_int *seen;
+    atomic_size_t popped;
+    size_t total;
+};
+
+/* A thread of the run with the slice of elements it pushes. */
+struct worker
+{
+    struct run *run;
+    size_t begin;
+    size_t end;
+};
+
+static enum test_result mq_test_producers_consumers(void);
+static enum test_result mq_test_pop_push_pairs(void);
+static void *produce(void *);
+static void *consume(void *);
+static void *pop_push(void *);
+static enum pq_threeway_cmp val_cmp(struct pq_elem const *,
+                                    struct pq_elem const *, void *);
+
+#define THREADS (size_t)4
+#define PER_THREAD (size_t)5000
+
+#define NUM_TESTS (size_t)2
+test_fn const all_tests[NUM_TESTS] = {
+    mq_test_producers_consumers,
+    mq_test_pop_push_pairs,
+};
+
+int
+main()
+{
+    enum test_result res = PASS;
+    for (size_t i = 0; i < NUM_TESTS; ++i)
+    {
+        bool const fail = all_tests[i]() == FAIL;
+        if (fail)
+        {
+            res = FAIL;
+        }
+    }
+    return res;
+}
+
+/* Producers push disjoint slices while as many consumers pop until every
+   element is out. Each element must come out once. */
+static enum test_result
+mq_test_producers_consumers(void)
+{
+    struct multi_queue mq;
+    CHECK(mq_init(&mq, 2 * THREADS, PQLES, val_cmp, NULL), true, bool, "%d");
+    size_t const total = THREADS * PER_THREAD;
+    struct val *const vals = malloc(total * sizeof(struct val));
+    atomic_int *const seen = malloc(total * sizeof(atomic_int));
+    CHECK(vals && seen, true, bool, "%d");
+    for (size_t i = 0; i < total; ++i)
+    {
+        vals[i] = (struct val){.id = (int)i, .val = (int)((i * 31) % 997)};
+        atomic_init(&seen[i], 0);
+    }
+    struct run run = {.mq = &mq, .vals = vals, .seen = seen, .total = total};
+    atomic_init(&run.popped, 0);
+    pthread_t threads[2 * THREADS];
+    struct worker workers[2 * THREADS];
+    for (size_t i = 0; i < THREADS; ++i)
+    {
+        workers[i] = (struct worker){
+            .run = &run,
+            .begin = i * PER_THREAD,
+            .end = (i + 1) * PER_THREAD,
+        };
+        workers[THREADS + i] = (struct worker){.run = &run};
+    }
+    for (size_t i = 0; i < 2 * THREADS; ++i)
+    {
+        CHECK(pthread_create(&threads[i], NULL,
+                             i < THREADS ? produce : consume, &workers[i]),
+              0, int, "%d");
+    }
+    for (size_t i = 0; i < 2 * THREADS; ++i)
+    {
+        CHECK(pthread_join(threads[i], NULL), 0, int, "%d");
+    }
+    CHECK(atomic_load(&run.popped), total, size_t, "%zu");
+    for (size_t i = 0; i < total; ++i)
+    {
+        CHECK(atomic_load(&seen[i]), 1, int, "%d");
+    }
+    CHECK(mq_empty(&mq), true, bool, "%d");
+    CHECK(mq_validate(&mq), true, bool, "%d");
+    mq_clear(&mq, NULL);
+    free(seen);
+    free(vals);
+    return PASS;
+}
+
+/* Threads pop an element and push it back as a scheduler would with a
+   task that is not done. The size holds and no element is lost. */
+static enum test_result
+mq_test_pop_push_pairs(void)
+{
+    struct multi_queue mq;
+    CHECK(mq_init(&mq, 3 * THREADS, PQLES, val_cmp, NULL), true, bool, "%d");
+    struct val vals[200];
+    for (int i = 0; i < 200; ++i)
+    {
+        vals[i] = (struct val){.id = i, .val = i};
+        mq_push(&mq, &vals[i].elem);
+    }
+    struct run run = {.mq = &mq, .total = 20000};
+    pthread_t threads[THREADS];
+    struct worker workers[THREADS];
+    for (size_t i = 0; i < THREADS; ++i)
+    {
+        workers[i] = (struct worker){.run = &run};
+        CHECK(pthread_create(&threads[i], NULL, pop_push, &workers[i]), 0,
+              int, "%d");
+    }
+    for (size_t i = 0; i < THREADS; ++i)
+    {
+        CHECK(pthread_join(threads[i], NULL), 0, int, "%d");
+    }
+    CHECK(mq_size(&mq), 200, size_t, "%zu");
+    CHECK(mq_validate(&mq), true, bool, "%d");
+    bool seen[200] = {0};
+    for (struct pq_elem *e = NULL; (e = mq_pop(&mq));)
+    {
+        struct val const *const v = PQ_ENTRY(e, struct val, elem);
+        CHECK(seen[v->id], false, bool, "%d");
+        seen[v->id] = true;
+    }
+    mq_clear(&mq, NULL);
+    return PASS;
+}
+
+static void *
+produce(void *const arg)
+{
+    struct worker *const w = arg;
+    for (size_t i = w->begin; i < w->end; ++i)
+    {
+        mq_push(w->run->mq, &w->run->vals[i].elem);
+    }
+    return NULL;
+}
+
+static void *
+consume(void *const arg)
+{
+    struct worker *const w = arg;
+    struct run *const run = w->run;
+    while (atomic_load(&run->popped) < run->total)
+    {
+        struct pq_elem *const e = mq_pop(run->mq);
+        if (e)
+        {
+            (void)atomic_fetch_add(
+                &run->seen[PQ_ENTRY(e, struct val, elem)->id], 1);
+            (void)atomic_fetch_add(&run->popped, 1);
+        }
+    }
+    return NULL;
+}
+
+static void *
+pop_push(void *const arg)
+{
+    struct worker *const w = arg;
+    for (size_t i = 0; i < w->run->total; ++i)
+    {
+        struct pq_elem *const e = mq_pop(w->run->mq);
+        if (e)
+        {
+            PQ_ENTRY(e, struct val, elem)->val += 200;
+            mq_push(w->run->mq, e);
+        }
+    }
+    return NULL;
+}
+
+static enum pq_threeway_cmp
+val_cmp(struct pq_elem const *const a, struct pq_elem const *const b,
+        void *const aux)
+{
+    (void)aux;
+    int const x = PQ_ENTRY(a, struct val, elem)->val;
+    int const y = PQ_ENTRY(b, struct val, elem)->val;
+    return (x > y) - (x < y);
+}
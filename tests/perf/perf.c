@@ -1,25 +1,122 @@
+/* pthread_setaffinity_np to pin the two threads of the spsc test. */
+#define _GNU_SOURCE
+
+#include "bucket_pqueue.h"
 #include "cli.h"
+#include "concurrent_depq.h"
 #include "depqueue.h"
+#include "ext_sort.h"
+#include "heap_depqueue.h"
 #include "heap_pqueue.h"
+#include "inbox.h"
+#include "kway_merge.h"
+#include "multi_queue.h"
 #include "pqueue.h"
+#include "queue.h"
+#include "radix_pqueue.h"
 #include "random.h"
+#include "rank_pqueue.h"
+#include "sequence_pqueue.h"
+#include "set.h"
+#include "spsc_queue.h"
 #include "str_view/str_view.h"
+#include "topk.h"
 
+#include <limits.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
+#include <unistd.h>
 
 struct val
 {
     int val;
     struct depq_elem depq_elem;
+    struct hdepq_elem hdepq_elem;
+    struct hpq_elem hpq_elem;
+    struct pq_elem pq_elem;
+    struct rkpq_elem rkpq_elem;
+    struct rdpq_elem rdpq_elem;
+    struct bpq_elem bpq_elem;
+    struct set_elem set_elem;
+};
+
+/* One thread of the concurrency tests. It pops an element and pushes it
+   back with a new priority so the size stays constant. The rank error test
+   only pops and logs each key in the order tickets were taken. The inbox
+   test only pushes its slice of elements. */
+struct contender
+{
+    struct concurrent_depq *cdq;
+    struct depqueue *depq;
+    struct multi_queue *mq;
+    struct pq_inbox *inbox;
+    struct pqueue *pq;
+    struct val *vals;
+    pthread_mutex_t *lock;
+    size_t ops;
+    uint64_t rng;
+    atomic_size_t *ticket;
+    int *pop_log;
+};
+
+/* One side of the two thread pipeline tests. A batch of 0 passes items
+   through one queue.h queue behind a mutex instead of the ring. The
+   latency test sends each item on the ring and waits for it on echo. */
+struct stage
+{
+    struct spsc_queue *ring;
+    struct spsc_queue *echo;
+    struct queue *q;
+    pthread_mutex_t *lock;
+    size_t items;
+    size_t batch;
+    int cpu;
+};
+
+/* A lean element for the large queue test so more of memory holds elements
+   rather than the intrusive fields of every other container. */
+struct big_val
+{
+    int val;
     struct hpq_elem hpq_elem;
     struct pq_elem pq_elem;
+    struct spq_elem spq_elem;
 };
 
 size_t const step = 100000;
 size_t const end_size = 1100000;
 int const max_rand_range = RAND_MAX;
+/* The out degree and largest edge cost of the random graphs for Dijkstra. */
+size_t const graph_degree = 8;
+int const graph_max_cost = 1000;
+/* The cell costs of the maze sample which the bucket test mirrors. */
+int const maze_max_cost = 100;
+/* The large queue sizes. At about 60 bytes per element plus the queue 16M
+   fits a small machine. Raise the end toward 500M with the memory for it. */
+size_t const big_step = 1000000;
+size_t const big_end_size = 16000000;
+/* The external sort input and the memory it may use. Raise the file size
+   past the memory of the machine to sort a file that cannot be cached. */
+size_t const sort_file_bytes = (size_t)1 << 30;
+size_t const sort_budget = (size_t)64 << 20;
+/* The concurrency test runs 1 to max_threads threads on a queue of this
+   size with a few shards per thread. */
+size_t const max_threads = 64;
+size_t const contention_size = 100000;
+size_t const contention_ops = 1000000;
+size_t const shards_per_thread = 4;
+size_t const heaps_per_thread = 2;
+/* The spsc test moves this many items through a ring of this capacity and
+   times this many round trips for latency. */
+size_t const spsc_items = 20000000;
+size_t const spsc_capacity = 1024;
+size_t const spsc_round_trips = 100000;
 
 typedef void (*depq_perf_fn)(void);
 
@@ -29,28 +126,121 @@ static void test_push_pop(void);
 static void test_push_intermittent_pop(void);
 static void test_pop_intermittent_push(void);
 static void test_update(void);
+static void test_update_batch(void);
+static void test_top_k(void);
+static void test_pop_batch(void);
+static void test_latency(void);
+static void test_scan(void);
+static void test_burst_drain(void);
+static void test_pairing(void);
+static void test_rank_pairing(void);
+static void test_dijkstra(void);
+static void test_bucket(void);
+static void test_heap_depq(void);
+static void test_sequence(void);
+static void test_kway(void);
+static void test_ext_sort(void);
+static void test_concurrent(void);
+static void test_multi_queue(void);
+static void test_inbox(void);
+static void test_spsc(void);
 
 static void *valid_malloc(size_t bytes);
+static double elapsed_ns(struct timespec const *, struct timespec const *);
+static int double_cmp(void const *, void const *);
+static void print_latencies(char const *, double *, size_t);
 static struct val *create_rand_vals(size_t);
+static unsigned long long dijkstra_pq(struct val *, size_t, size_t const *,
+                                      int const *);
+static unsigned long long dijkstra_hpq(struct val *, size_t, size_t const *,
+                                       int const *);
+static unsigned long long dijkstra_rdpq(struct val *, size_t, size_t const *,
+                                        int const *);
 static dpq_threeway_cmp depq_val_cmp(struct depq_elem const *,
                                      struct depq_elem const *, void *);
+static enum heap_pq_threeway_cmp big_hpq_cmp(struct hpq_elem const *,
+                                             struct hpq_elem const *, void *);
+static enum pq_threeway_cmp big_pq_cmp(struct pq_elem const *,
+                                       struct pq_elem const *, void *);
+static enum sequence_pq_threeway_cmp big_spq_cmp(struct spq_elem const *,
+                                                 struct spq_elem const *,
+                                                 void *);
+static enum kway_threeway_cmp kwm_int_cmp(void const *, void const *, void *);
+static int int_sort_cmp(void const *, void const *);
+static double contention_rate(struct val *, size_t, enum cdepq_mode, bool);
+static void *contend_sharded(void *);
+static void *contend_locked(void *);
+static double multi_queue_rate(struct val *, size_t, bool);
+static void rank_error(struct val *, size_t, size_t, double *, size_t *);
+static void *contend_multi(void *);
+static void *contend_pq_locked(void *);
+static void *pop_logged(void *);
+static double inbox_rate(struct val *, size_t, bool, double *);
+static void *produce_inbox(void *);
+static void *produce_locked(void *);
+static double spsc_rate(size_t);
+static void spsc_latency(void);
+static void *spsc_produce(void *);
+static void *spsc_consume(void *);
+static void *spsc_ping(void *);
+static void *spsc_pong(void *);
+static void pin_thread(int);
+static void spin_wait(unsigned *);
+static int next_priority(struct contender *);
+static enum ext_sort_threeway_cmp u64_record_cmp(void const *, void const *,
+                                                 void *);
+static double kway_rate(struct kwm_input *, size_t, void const **, size_t,
+                        enum kwm_engine);
+static enum heap_depq_threeway_cmp hdepq_val_cmp(struct hdepq_elem const *,
+                                                 struct hdepq_elem const *,
+                                                 void *);
 static enum heap_pq_threeway_cmp hpq_val_cmp(struct hpq_elem const *,
                                              struct hpq_elem const *, void *);
+static set_threeway_cmp set_val_cmp(struct set_elem const *,
+                                    struct set_elem const *, void *);
+static enum rkpq_threeway_cmp rkpq_val_cmp(struct rkpq_elem const *,
+                                           struct rkpq_elem const *, void *);
 static enum pq_threeway_cmp pq_val_cmp(struct pq_elem const *,
                                        struct pq_elem const *, void *);
 static void depq_update_val(struct depq_elem *, void *);
+static void hdepq_update_val(struct hdepq_elem *, void *);
 static void hpq_update_val(struct hpq_elem *, void *);
+static void hpq_update_rand_val(struct hpq_elem *, void *);
 static void pq_update_val(struct pq_elem *, void *);
+static void rkpq_update_val(struct rkpq_elem *, void *);
+static void depq_sum_val(struct depq_elem *, void *);
+static void set_sum_val(struct set_elem *, void *);
+static void hdepq_destroy_val(struct hdepq_elem *);
 static void hpq_destroy_val(struct hpq_elem *);
 static void pq_destroy_val(struct pq_elem *);
+static void rkpq_destroy_val(struct rkpq_elem *);
+static void rdpq_destroy_val(struct rdpq_elem *);
 
-#define NUM_TESTS (size_t)6
+#define NUM_TESTS (size_t)24
 static depq_perf_fn const perf_tests[NUM_TESTS] = {test_push,
                                                    test_pop,
                                                    test_push_pop,
                                                    test_push_intermittent_pop,
                                                    test_pop_intermittent_push,
-                                                   test_update};
+                                                   test_update,
+                                                   test_update_batch,
+                                                   test_top_k,
+                                                   test_pop_batch,
+                                                   test_latency,
+                                                   test_scan,
+                                                   test_burst_drain,
+                                                   test_pairing,
+                                                   test_rank_pairing,
+                                                   test_dijkstra,
+                                                   test_bucket,
+                                                   test_heap_depq,
+                                                   test_sequence,
+                                                   test_kway,
+                                                   test_ext_sort,
+                                                   test_concurrent,
+                                                   test_multi_queue,
+                                                   test_inbox,
+                                                   test_spsc};
 
 int
 main(int argc, char **argv)
@@ -82,6 +272,78 @@ main(int argc, char **argv)
         {
             test_update();
         }
+        else if (sv_cmp(arg, SV("update-batch")) == SV_EQL)
+        {
+            test_update_batch();
+        }
+        else if (sv_cmp(arg, SV("top-k")) == SV_EQL)
+        {
+            test_top_k();
+        }
+        else if (sv_cmp(arg, SV("pop-batch")) == SV_EQL)
+        {
+            test_pop_batch();
+        }
+        else if (sv_cmp(arg, SV("latency")) == SV_EQL)
+        {
+            test_latency();
+        }
+        else if (sv_cmp(arg, SV("scan")) == SV_EQL)
+        {
+            test_scan();
+        }
+        else if (sv_cmp(arg, SV("burst-drain")) == SV_EQL)
+        {
+            test_burst_drain();
+        }
+        else if (sv_cmp(arg, SV("pairing")) == SV_EQL)
+        {
+            test_pairing();
+        }
+        else if (sv_cmp(arg, SV("rank-pairing")) == SV_EQL)
+        {
+            test_rank_pairing();
+        }
+        else if (sv_cmp(arg, SV("dijkstra")) == SV_EQL)
+        {
+            test_dijkstra();
+        }
+        else if (sv_cmp(arg, SV("bucket")) == SV_EQL)
+        {
+            test_bucket();
+        }
+        else if (sv_cmp(arg, SV("heap-depq")) == SV_EQL)
+        {
+            test_heap_depq();
+        }
+        else if (sv_cmp(arg, SV("sequence")) == SV_EQL)
+        {
+            test_sequence();
+        }
+        else if (sv_cmp(arg, SV("kway")) == SV_EQL)
+        {
+            test_kway();
+        }
+        else if (sv_cmp(arg, SV("ext-sort")) == SV_EQL)
+        {
+            test_ext_sort();
+        }
+        else if (sv_cmp(arg, SV("concurrent")) == SV_EQL)
+        {
+            test_concurrent();
+        }
+        else if (sv_cmp(arg, SV("multiqueue")) == SV_EQL)
+        {
+            test_multi_queue();
+        }
+        else if (sv_cmp(arg, SV("inbox")) == SV_EQL)
+        {
+            test_inbox();
+        }
+        else if (sv_cmp(arg, SV("spsc")) == SV_EQL)
+        {
+            test_spsc();
+        }
         else
         {
             quit("Unknown test request\n", 1);
@@ -423,87 +685,2061 @@ test_update(void)
     }
 }
 
-/*=======================  Static Helpers  =================================*/
-
-static struct val *
-create_rand_vals(size_t n)
+static void
+test_update_batch(void)
 {
-    struct val *vals = valid_malloc(n * sizeof(struct val));
-    while (n--)
+    printf("push N elements update K elements, heap priority queue one at a "
+           "time vs batch:\n");
+    for (size_t n = step; n < end_size; n += step)
     {
-        vals[n].val = rand_range(0, max_rand_range);
+        struct val *val_array = create_rand_vals(n);
+        struct hpq_elem **batch = valid_malloc(n * sizeof(struct hpq_elem *));
+        struct heap_pqueue hpq;
+        hpq_init(&hpq, HPQLES, hpq_val_cmp, NULL);
+        for (size_t i = 0; i < n; ++i)
+        {
+            hpq_push(&hpq, &val_array[i].hpq_elem);
+            batch[i] = &val_array[i].hpq_elem;
+        }
+        printf("N=%zu:", n);
+        for (size_t k = n / 64; k <= n; k *= 8)
+        {
+            clock_t begin = clock();
+            for (size_t i = 0; i < k; ++i)
+            {
+                (void)hpq_update(&hpq, batch[i], hpq_update_rand_val, NULL);
+            }
+            clock_t end = clock();
+            double const hpq_time = (double)(end - begin) / CLOCKS_PER_SEC;
+            begin = clock();
+            (void)hpq_update_batch(&hpq, batch, k, hpq_update_rand_val, NULL);
+            end = clock();
+            double const batch_time = (double)(end - begin) / CLOCKS_PER_SEC;
+            printf(" K=%zu: HPQ=%f, HPQ_BATCH=%f", k, hpq_time, batch_time);
+        }
+        printf("\n");
+        hpq_clear(&hpq, hpq_destroy_val);
+        free(batch);
+        free(val_array);
     }
-    return vals;
 }
 
-static void *
-valid_malloc(size_t bytes)
+static void
+test_top_k(void)
 {
-    void *mem = malloc(bytes);
-    if (!mem)
+    size_t const k = 1000;
+    printf("stream N trending up elements keep top %zu, pop then push vs "
+           "fused replace vs topk:\n",
+           k);
+    for (size_t n = step; n < end_size; n += step)
     {
-        (void)fprintf(stderr, "heap is exhausted in perf, exiting program.\n");
-        exit(1);
+        /* An upward trend with noise means most elements displace the min
+           of the window which is where the fused operations matter. */
+        struct val *val_array = valid_malloc(n * sizeof(struct val));
+        for (size_t i = 0; i < n; ++i)
+        {
+            val_array[i].val = (int)i + rand_range(0, (int)k);
+        }
+        struct depqueue depq = DEPQ_INIT(depq, depq_val_cmp, NULL);
+        struct heap_pqueue hpq;
+        hpq_init(&hpq, HPQLES, hpq_val_cmp, NULL);
+        struct pqueue pq = PQ_INIT(PQLES, pq_val_cmp, NULL);
+        clock_t begin = clock();
+        for (size_t i = 0; i < n; ++i)
+        {
+            if (depq_size(&depq) < k)
+            {
+                depq_push(&depq, &val_array[i].depq_elem);
+            }
+            else if (val_array[i].val
+                     > DEPQ_ENTRY(depq_min(&depq), struct val, depq_elem)->val)
+            {
+                (void)depq_pop_min(&depq);
+                depq_push(&depq, &val_array[i].depq_elem);
+            }
+        }
+        clock_t end = clock();
+        double const depq_time = (double)(end - begin) / CLOCKS_PER_SEC;
+        depq = (struct depqueue)DEPQ_INIT(depq, depq_val_cmp, NULL);
+        begin = clock();
+        for (size_t i = 0; i < n; ++i)
+        {
+            if (depq_size(&depq) < k)
+            {
+                depq_push(&depq, &val_array[i].depq_elem);
+            }
+            else if (val_array[i].val
+                     > DEPQ_ENTRY(depq_min(&depq), struct val, depq_elem)->val)
+            {
+                (void)depq_replace_min(&depq, &val_array[i].depq_elem);
+            }
+        }
+        end = clock();
+        double const depq_fused_time = (double)(end - begin) / CLOCKS_PER_SEC;
+        struct topk tk = TOPK_INIT(tk, k, depq_val_cmp, NULL);
+        begin = clock();
+        for (size_t i = 0; i < n; ++i)
+        {
+            (void)topk_push(&tk, &val_array[i].depq_elem);
+        }
+        end = clock();
+        double const topk_time = (double)(end - begin) / CLOCKS_PER_SEC;
+        begin = clock();
+        for (size_t i = 0; i < n; ++i)
+        {
+            if (hpq_size(&hpq) < k)
+            {
+                hpq_push(&hpq, &val_array[i].hpq_elem);
+            }
+            else if (val_array[i].val
+                     > HPQ_ENTRY(hpq_front(&hpq), struct val, hpq_elem)->val)
+            {
+                (void)hpq_pop(&hpq);
+                hpq_push(&hpq, &val_array[i].hpq_elem);
+            }
+        }
+        end = clock();
+        double const hpq_time = (double)(end - begin) / CLOCKS_PER_SEC;
+        hpq_clear(&hpq, hpq_destroy_val);
+        hpq_init(&hpq, HPQLES, hpq_val_cmp, NULL);
+        begin = clock();
+        for (size_t i = 0; i < n; ++i)
+        {
+            if (hpq_size(&hpq) < k)
+            {
+                hpq_push(&hpq, &val_array[i].hpq_elem);
+            }
+            else
+            {
+                (void)hpq_pushpop(&hpq, &val_array[i].hpq_elem);
+            }
+        }
+        end = clock();
+        double const hpq_fused_time = (double)(end - begin) / CLOCKS_PER_SEC;
+        begin = clock();
+        for (size_t i = 0; i < n; ++i)
+        {
+            if (pq_size(&pq) < k)
+            {
+                pq_push(&pq, &val_array[i].pq_elem);
+            }
+            else if (val_array[i].val
+                     > PQ_ENTRY(pq_front(&pq), struct val, pq_elem)->val)
+            {
+                (void)pq_pop(&pq);
+                pq_push(&pq, &val_array[i].pq_elem);
+            }
+        }
+        end = clock();
+        double const pq_time = (double)(end - begin) / CLOCKS_PER_SEC;
+        pq = (struct pqueue)PQ_INIT(PQLES, pq_val_cmp, NULL);
+        begin = clock();
+        for (size_t i = 0; i < n; ++i)
+        {
+            if (pq_size(&pq) < k)
+            {
+                pq_push(&pq, &val_array[i].pq_elem);
+            }
+            else
+            {
+                (void)pq_pushpop(&pq, &val_array[i].pq_elem);
+            }
+        }
+        end = clock();
+        double const pq_fused_time = (double)(end - begin) / CLOCKS_PER_SEC;
+        printf("N=%zu: DEPQ=%f, DEPQ_FUSED=%f, TOPK=%f, HPQ=%f, HPQ_FUSED=%f, "
+               "PQ=%f, PQ_FUSED=%f\n",
+               n, depq_time, depq_fused_time, topk_time, hpq_time,
+               hpq_fused_time, pq_time, pq_fused_time);
+        hpq_clear(&hpq, hpq_destroy_val);
+        free(val_array);
     }
-    return mem;
 }
 
-static dpq_threeway_cmp
-depq_val_cmp(struct depq_elem const *const a, struct depq_elem const *const b,
-             void *const aux)
+static void
+test_pop_batch(void)
 {
-    (void)aux;
-    struct val const *const x = DEPQ_ENTRY(a, struct val, depq_elem);
-    struct val const *const y = DEPQ_ENTRY(b, struct val, depq_elem);
-    if (x->val < y->val)
+    enum
     {
-        return DPQLES;
-    }
-    if (x->val > y->val)
+        batch = 64,
+    };
+    printf("drain N elements %d at a time, repeated pop vs batch pop:\n",
+           batch);
+    for (size_t n = step; n < end_size; n += step)
     {
-        return DPQGRT;
+        struct val *val_array = create_rand_vals(n);
+        struct depqueue depq = DEPQ_INIT(depq, depq_val_cmp, NULL);
+        struct depq_elem *out[batch];
+        for (size_t i = 0; i < n; ++i)
+        {
+            depq_push(&depq, &val_array[i].depq_elem);
+        }
+        clock_t begin = clock();
+        while (!depq_empty(&depq))
+        {
+            for (size_t i = 0; i < batch && !depq_empty(&depq); ++i)
+            {
+                out[i] = depq_pop_max(&depq);
+            }
+        }
+        clock_t end = clock();
+        double const depq_time = (double)(end - begin) / CLOCKS_PER_SEC;
+        for (size_t i = 0; i < n; ++i)
+        {
+            depq_push(&depq, &val_array[i].depq_elem);
+        }
+        begin = clock();
+        while (depq_pop_max_n(&depq, out, batch))
+        {}
+        end = clock();
+        double const depq_batch_time = (double)(end - begin) / CLOCKS_PER_SEC;
+        printf("N=%zu: DEPQ=%f, DEPQ_BATCH=%f\n", n, depq_time,
+               depq_batch_time);
+        free(val_array);
     }
-    return DPQEQL;
 }
 
-static enum heap_pq_threeway_cmp
-hpq_val_cmp(struct hpq_elem const *a, struct hpq_elem const *b, void *const aux)
+static void
+test_latency(void)
 {
-    (void)aux;
-    struct val const *const x = HPQ_ENTRY(a, struct val, hpq_elem);
-    struct val const *const y = HPQ_ENTRY(b, struct val, hpq_elem);
-    if (x->val < y->val)
-    {
-        return HPQLES;
-    }
-    if (x->val > y->val)
+    size_t const n = step;
+    printf("per operation latency of %zu sequential pushes followed by %zu "
+           "pop mins, plain splay vs one rebalance after the pushes (ns):\n",
+           n, n);
+    struct val *val_array = valid_malloc(n * sizeof(struct val));
+    double *latencies = valid_malloc(2 * n * sizeof(double));
+    for (int rebalanced = 0; rebalanced < 2; ++rebalanced)
     {
-        return HPQGRT;
+        struct depqueue depq = DEPQ_INIT(depq, depq_val_cmp, NULL);
+        struct timespec begin;
+        struct timespec end;
+        for (size_t i = 0; i < n; ++i)
+        {
+            val_array[i].val = (int)i;
+            (void)clock_gettime(CLOCK_MONOTONIC, &begin);
+            depq_push(&depq, &val_array[i].depq_elem);
+            (void)clock_gettime(CLOCK_MONOTONIC, &end);
+            latencies[i] = elapsed_ns(&begin, &end);
+        }
+        if (rebalanced)
+        {
+            (void)clock_gettime(CLOCK_MONOTONIC, &begin);
+            depq_rebalance(&depq);
+            (void)clock_gettime(CLOCK_MONOTONIC, &end);
+            printf("REBALANCE: %.0f\n", elapsed_ns(&begin, &end));
+        }
+        for (size_t i = 0; i < n; ++i)
+        {
+            (void)clock_gettime(CLOCK_MONOTONIC, &begin);
+            (void)depq_pop_min(&depq);
+            (void)clock_gettime(CLOCK_MONOTONIC, &end);
+            latencies[n + i] = elapsed_ns(&begin, &end);
+        }
+        print_latencies(rebalanced ? "REBALANCED" : "SPLAY", latencies, 2 * n);
     }
-    return HPQEQL;
+    free(latencies);
+    free(val_array);
 }
 
 static void
-depq_update_val(struct depq_elem *e, void *aux)
+test_scan(void)
 {
-    struct val *v = DEPQ_ENTRY(e, struct val, depq_elem);
-    v->val = *((int *)aux);
+    printf("sum every value of N elements in order, iterator vs cursor vs "
+           "for each:\n");
+    for (size_t n = step; n < end_size; n += step)
+    {
+        struct val *val_array = create_rand_vals(n);
+        struct depqueue depq = DEPQ_INIT(depq, depq_val_cmp, NULL);
+        struct set s = SET_INIT(s, set_val_cmp, NULL);
+        for (size_t i = 0; i < n; ++i)
+        {
+            depq_push(&depq, &val_array[i].depq_elem);
+            (void)set_insert(&s, &val_array[i].set_elem);
+        }
+        long long iter_sum = 0;
+        clock_t begin = clock();
+        for (struct depq_elem *e = depq_begin(&depq); e != depq_end(&depq);
+             e = depq_next(&depq, e))
+        {
+            iter_sum += DEPQ_ENTRY(e, struct val, depq_elem)->val;
+        }
+        clock_t end = clock();
+        double const depq_time = (double)(end - begin) / CLOCKS_PER_SEC;
+        long long cursor_sum = 0;
+        struct depq_cursor dc;
+        begin = clock();
+        for (struct depq_elem *e = depq_cursor_begin(&depq, &dc);
+             e != depq_end(&depq); e = depq_cursor_next(&dc))
+        {
+            cursor_sum += DEPQ_ENTRY(e, struct val, depq_elem)->val;
+        }
+        end = clock();
+        double const depq_cursor_time = (double)(end - begin) / CLOCKS_PER_SEC;
+        begin = clock();
+        for (struct set_elem *e = set_begin(&s); e != set_end(&s);
+             e = set_next(&s, e))
+        {
+            iter_sum += SET_ENTRY(e, struct val, set_elem)->val;
+        }
+        end = clock();
+        double const set_time = (double)(end - begin) / CLOCKS_PER_SEC;
+        struct set_cursor sc;
+        begin = clock();
+        for (struct set_elem *e = set_cursor_begin(&s, &sc); e != set_end(&s);
+             e = set_cursor_next(&sc))
+        {
+            cursor_sum += SET_ENTRY(e, struct val, set_elem)->val;
+        }
+        end = clock();
+        double const set_cursor_time = (double)(end - begin) / CLOCKS_PER_SEC;
+        long long for_each_sum = 0;
+        begin = clock();
+        depq_for_each(&depq, depq_sum_val, &for_each_sum);
+        end = clock();
+        double const depq_for_each_time
+            = (double)(end - begin) / CLOCKS_PER_SEC;
+        begin = clock();
+        set_for_each(&s, set_sum_val, &for_each_sum);
+        end = clock();
+        double const set_for_each_time = (double)(end - begin) / CLOCKS_PER_SEC;
+        if (iter_sum != cursor_sum || iter_sum != for_each_sum)
+        {
+            quit("cursor, iterator, and for each scans disagree\n", 1);
+        }
+        printf("N=%zu: DEPQ=%f, DEPQ_CURSOR=%f, DEPQ_FOR_EACH=%f, SET=%f, "
+               "SET_CURSOR=%f, SET_FOR_EACH=%f, for each elems/s=%.0f\n",
+               n, depq_time, depq_cursor_time, depq_for_each_time, set_time,
+               set_cursor_time, set_for_each_time,
+               depq_for_each_time > 0 ? (double)n / depq_for_each_time : 0.0);
+        free(val_array);
+    }
 }
 
 static void
-hpq_update_val(struct hpq_elem *e, void *aux)
+test_burst_drain(void)
 {
-    struct val *v = HPQ_ENTRY(e, struct val, hpq_elem);
-    v->val = *((int *)aux);
-}
-
-static void
+    size_t const n = end_size - step;
+    printf("per pop latency after a burst of %zu random pushes, plain vs "
+           "bounded pairing heap (ns):\n",
+           n);
+    struct val *val_array = create_rand_vals(n);
+    double *latencies = valid_malloc(n * sizeof(double));
+    for (int bounded = 0; bounded < 2; ++bounded)
+    {
+        struct pqueue pq = PQ_INIT(PQLES, pq_val_cmp, NULL);
+        struct pq_elem *pending[PQ_PENDING_SLOTS] = {0};
+        struct pqueue bpq = PQ_INIT_BOUNDED(PQLES, pq_val_cmp, NULL, pending);
+        struct pqueue *const q = bounded ? &bpq : &pq;
+        clock_t const begin = clock();
+        for (size_t i = 0; i < n; ++i)
+        {
+            pq_push(q, &val_array[i].pq_elem);
+        }
+        clock_t const end = clock();
+        struct timespec pop_begin;
+        struct timespec pop_end;
+        for (size_t i = 0; i < n; ++i)
+        {
+            (void)clock_gettime(CLOCK_MONOTONIC, &pop_begin);
+            (void)pq_pop(q);
+            (void)clock_gettime(CLOCK_MONOTONIC, &pop_end);
+            latencies[i] = elapsed_ns(&pop_begin, &pop_end);
+        }
+        printf("%s: first pop=%.0f, push total=%f\n",
+               bounded ? "PQ_BOUNDED" : "PQ", latencies[0],
+               (double)(end - begin) / CLOCKS_PER_SEC);
+        print_latencies(bounded ? "PQ_BOUNDED" : "PQ", latencies, n);
+    }
+    free(latencies);
+    free(val_array);
+}
+
+static void
+test_pairing(void)
+{
+    enum pq_pairing const strategies[4] = {
+        PQ_FRONT_TO_BACK,
+        PQ_TWO_PASS,
+        PQ_MULTIPASS,
+        PQ_AUXILIARY_TWO_PASS,
+    };
+    char const *const names[4] = {
+        "FRONT_TO_BACK",
+        "TWO_PASS",
+        "MULTIPASS",
+        "AUXILIARY_TWO_PASS",
+    };
+    printf("pairing strategies across a push heavy mix with one pop per 8 "
+           "pushes, a pop heavy drain, and a decrease key heavy drain with 4 "
+           "decreases per pop:\n");
+    for (size_t n = step; n < end_size; n *= 3)
+    {
+        for (size_t s = 0; s < sizeof(strategies) / sizeof(strategies[0]); ++s)
+        {
+            struct val *val_array = create_rand_vals(n);
+            struct pqueue pq
+                = PQ_INIT_PAIRING(PQLES, pq_val_cmp, NULL, strategies[s]);
+            clock_t begin = clock();
+            for (size_t i = 0; i < n; ++i)
+            {
+                pq_push(&pq, &val_array[i].pq_elem);
+                if (i % 8 == 7)
+                {
+                    (void)pq_pop(&pq);
+                }
+            }
+            clock_t end = clock();
+            double const push_heavy = (double)(end - begin) / CLOCKS_PER_SEC;
+            while (!pq_empty(&pq))
+            {
+                (void)pq_pop(&pq);
+            }
+            for (size_t i = 0; i < n; ++i)
+            {
+                pq_push(&pq, &val_array[i].pq_elem);
+            }
+            begin = clock();
+            while (!pq_empty(&pq))
+            {
+                (void)pq_pop(&pq);
+            }
+            end = clock();
+            double const pop_heavy = (double)(end - begin) / CLOCKS_PER_SEC;
+            for (size_t i = 0; i < n; ++i)
+            {
+                pq_push(&pq, &val_array[i].pq_elem);
+            }
+            begin = clock();
+            while (!pq_empty(&pq))
+            {
+                for (int d = 0; d < 4; ++d)
+                {
+                    struct val *const v
+                        = &val_array[rand_range(0, (int)n - 1)];
+                    int new_val = rand_range(0, v->val - (v->val != 0));
+                    (void)pq_decrease(&pq, &v->pq_elem, pq_update_val,
+                                      &new_val);
+                }
+                (void)pq_pop(&pq);
+            }
+            end = clock();
+            double const decrease_heavy
+                = (double)(end - begin) / CLOCKS_PER_SEC;
+            printf("N=%zu: %s push-heavy=%f, pop-heavy=%f, "
+                   "decrease-heavy=%f\n",
+                   n, names[s], push_heavy, pop_heavy, decrease_heavy);
+            free(val_array);
+        }
+    }
+}
+
+static void
+test_rank_pairing(void)
+{
+    printf("pairing heap vs rank pairing heap across a push heavy mix with "
+           "one pop per 8 pushes, a pop heavy drain, and a decrease key heavy "
+           "drain with 4 decreases per pop:\n");
+    for (size_t n = step; n < end_size; n *= 3)
+    {
+        struct val *val_array = create_rand_vals(n);
+        struct pqueue pq = PQ_INIT(PQLES, pq_val_cmp, NULL);
+        struct rkpqueue rpq = RKPQ_INIT(RKPQLES, rkpq_val_cmp, NULL);
+        double pq_times[3];
+        double rkpq_times[3];
+        int *const orig = valid_malloc(n * sizeof(int));
+        for (size_t i = 0; i < n; ++i)
+        {
+            orig[i] = val_array[i].val;
+        }
+        /* Both heaps see the same random decrease sequence. */
+        unsigned const seed = (unsigned)time(NULL);
+        srand(seed);
+        clock_t begin = clock();
+        for (size_t i = 0; i < n; ++i)
+        {
+            pq_push(&pq, &val_array[i].pq_elem);
+            if (i % 8 == 7)
+            {
+                (void)pq_pop(&pq);
+            }
+        }
+        clock_t end = clock();
+        pq_times[0] = (double)(end - begin) / CLOCKS_PER_SEC;
+        pq_clear(&pq, pq_destroy_val);
+        for (size_t i = 0; i < n; ++i)
+        {
+            pq_push(&pq, &val_array[i].pq_elem);
+        }
+        begin = clock();
+        while (!pq_empty(&pq))
+        {
+            (void)pq_pop(&pq);
+        }
+        end = clock();
+        pq_times[1] = (double)(end - begin) / CLOCKS_PER_SEC;
+        for (size_t i = 0; i < n; ++i)
+        {
+            pq_push(&pq, &val_array[i].pq_elem);
+        }
+        begin = clock();
+        while (!pq_empty(&pq))
+        {
+            for (int d = 0; d < 4; ++d)
+            {
+                struct val *const v = &val_array[rand_range(0, (int)n - 1)];
+                int new_val = rand_range(0, v->val - (v->val != 0));
+                (void)pq_decrease(&pq, &v->pq_elem, pq_update_val, &new_val);
+            }
+            (void)pq_pop(&pq);
+        }
+        end = clock();
+        pq_times[2] = (double)(end - begin) / CLOCKS_PER_SEC;
+        for (size_t i = 0; i < n; ++i)
+        {
+            val_array[i].val = orig[i];
+        }
+        srand(seed);
+        begin = clock();
+        for (size_t i = 0; i < n; ++i)
+        {
+            rkpq_push(&rpq, &val_array[i].rkpq_elem);
+            if (i % 8 == 7)
+            {
+                (void)rkpq_pop(&rpq);
+            }
+        }
+        end = clock();
+        rkpq_times[0] = (double)(end - begin) / CLOCKS_PER_SEC;
+        rkpq_clear(&rpq, rkpq_destroy_val);
+        for (size_t i = 0; i < n; ++i)
+        {
+            rkpq_push(&rpq, &val_array[i].rkpq_elem);
+        }
+        begin = clock();
+        while (!rkpq_empty(&rpq))
+        {
+            (void)rkpq_pop(&rpq);
+        }
+        end = clock();
+        rkpq_times[1] = (double)(end - begin) / CLOCKS_PER_SEC;
+        for (size_t i = 0; i < n; ++i)
+        {
+            rkpq_push(&rpq, &val_array[i].rkpq_elem);
+        }
+        begin = clock();
+        while (!rkpq_empty(&rpq))
+        {
+            for (int d = 0; d < 4; ++d)
+            {
+                struct val *const v = &val_array[rand_range(0, (int)n - 1)];
+                int new_val = rand_range(0, v->val - (v->val != 0));
+                (void)rkpq_decrease(&rpq, &v->rkpq_elem, rkpq_update_val,
+                                    &new_val);
+            }
+            (void)rkpq_pop(&rpq);
+        }
+        end = clock();
+        rkpq_times[2] = (double)(end - begin) / CLOCKS_PER_SEC;
+        printf("N=%zu: PQ push-heavy=%f, pop-heavy=%f, decrease-heavy=%f\n",
+               n, pq_times[0], pq_times[1], pq_times[2]);
+        printf("N=%zu: RKPQ push-heavy=%f, pop-heavy=%f, "
+               "decrease-heavy=%f\n",
+               n, rkpq_times[0], rkpq_times[1], rkpq_times[2]);
+        free(orig);
+        free(val_array);
+    }
+}
+
+static void
+test_dijkstra(void)
+{
+    printf("dijkstra shortest paths from vertex 0 on random directed graphs "
+           "with %zu edges per vertex and costs in [1, %d]:\n",
+           graph_degree, graph_max_cost);
+    for (size_t n = step; n < end_size; n *= 3)
+    {
+        size_t *const to = valid_malloc(n * graph_degree * sizeof(size_t));
+        int *const cost = valid_malloc(n * graph_degree * sizeof(int));
+        for (size_t i = 0; i < n * graph_degree; ++i)
+        {
+            to[i] = (size_t)rand_range(0, (int)n - 1);
+            cost[i] = rand_range(1, graph_max_cost);
+        }
+        struct val *const vertices = valid_malloc(n * sizeof(struct val));
+        clock_t begin = clock();
+        unsigned long long const pq_sum = dijkstra_pq(vertices, n, to, cost);
+        clock_t end = clock();
+        double const pq_time = (double)(end - begin) / CLOCKS_PER_SEC;
+        begin = clock();
+        unsigned long long const hpq_sum
+            = dijkstra_hpq(vertices, n, to, cost);
+        end = clock();
+        double const hpq_time = (double)(end - begin) / CLOCKS_PER_SEC;
+        begin = clock();
+        unsigned long long const rdpq_sum
+            = dijkstra_rdpq(vertices, n, to, cost);
+        end = clock();
+        double const rdpq_time = (double)(end - begin) / CLOCKS_PER_SEC;
+        if (pq_sum != hpq_sum || pq_sum != rdpq_sum)
+        {
+            quit("dijkstra distances differ between priority queues.\n", 1);
+        }
+        printf("N=%zu: PQ=%f, HPQ=%f, RDPQ=%f\n", n, pq_time, hpq_time,
+               rdpq_time);
+        free(vertices);
+        free(cost);
+        free(to);
+    }
+}
+
+/* The maze sample builds with Prim's algorithm. It peeks at the max cost
+   cell, usually pushes a neighbor, and otherwise pops the cell. This runs
+   the same pattern without drawing, 2 pushes for every pop until n cells
+   have been pushed, then drains. The costs of the cells are reused from
+   the val array so both queues see the same sequence. */
+static void
+test_bucket(void)
+{
+    printf("DEPQ vs bucket queue with costs in [0, %d] across a push then "
+           "pop_max drain and the maze sample frontier pattern:\n",
+           maze_max_cost);
+    for (size_t n = step; n < end_size; n *= 3)
+    {
+        struct val *val_array = valid_malloc(n * sizeof(struct val));
+        for (size_t i = 0; i < n; ++i)
+        {
+            val_array[i].val = rand_range(0, maze_max_cost);
+        }
+        struct depqueue depq = DEPQ_INIT(depq, depq_val_cmp, NULL);
+        clock_t begin = clock();
+        for (size_t i = 0; i < n; ++i)
+        {
+            depq_push(&depq, &val_array[i].depq_elem);
+        }
+        while (!depq_empty(&depq))
+        {
+            (void)depq_pop_max(&depq);
+        }
+        clock_t end = clock();
+        double const depq_drain = (double)(end - begin) / CLOCKS_PER_SEC;
+        size_t pushed = 0;
+        begin = clock();
+        depq_push(&depq, &val_array[pushed++].depq_elem);
+        for (size_t turn = 0; !depq_empty(&depq); ++turn)
+        {
+            (void)depq_max(&depq);
+            if (pushed < n && turn % 3 != 2)
+            {
+                depq_push(&depq, &val_array[pushed++].depq_elem);
+            }
+            else
+            {
+                (void)depq_pop_max(&depq);
+            }
+        }
+        end = clock();
+        double const depq_frontier = (double)(end - begin) / CLOCKS_PER_SEC;
+        struct bpq_elem **const buckets
+            = calloc((size_t)maze_max_cost + 1, sizeof(struct bpq_elem *));
+        if (!buckets)
+        {
+            quit("bucket allocation failed.\n", 1);
+        }
+        struct bucket_pqueue bq = BPQ_INIT(buckets, maze_max_cost + 1);
+        begin = clock();
+        for (size_t i = 0; i < n; ++i)
+        {
+            (void)bpq_push(&bq, &val_array[i].bpq_elem,
+                           (size_t)val_array[i].val);
+        }
+        while (!bpq_empty(&bq))
+        {
+            (void)bpq_pop_max(&bq);
+        }
+        end = clock();
+        double const bpq_drain = (double)(end - begin) / CLOCKS_PER_SEC;
+        pushed = 0;
+        begin = clock();
+        (void)bpq_push(&bq, &val_array[pushed].bpq_elem,
+                       (size_t)val_array[pushed].val);
+        ++pushed;
+        for (size_t turn = 0; !bpq_empty(&bq); ++turn)
+        {
+            (void)bpq_max(&bq);
+            if (pushed < n && turn % 3 != 2)
+            {
+                (void)bpq_push(&bq, &val_array[pushed].bpq_elem,
+                               (size_t)val_array[pushed].val);
+                ++pushed;
+            }
+            else
+            {
+                (void)bpq_pop_max(&bq);
+            }
+        }
+        end = clock();
+        double const bpq_frontier = (double)(end - begin) / CLOCKS_PER_SEC;
+        printf("N=%zu: DEPQ drain=%f, frontier=%f\n", n, depq_drain,
+               depq_frontier);
+        printf("N=%zu: BPQ drain=%f, frontier=%f\n", n, bpq_drain,
+               bpq_frontier);
+        free(buckets);
+        free(val_array);
+    }
+}
+
+/* The same double ended workload on the splay tree and the min-max heap.
+   The drain alternates ends so neither side is favored. */
+static void
+test_heap_depq(void)
+{
+    printf("splay tree DEPQ vs min-max heap DEPQ across a push, an update "
+           "of every element, and a drain alternating pop_min and "
+           "pop_max:\n");
+    for (size_t n = step; n < end_size; n *= 3)
+    {
+        struct val *val_array = create_rand_vals(n);
+        int *const new_vals = valid_malloc(n * sizeof(int));
+        for (size_t i = 0; i < n; ++i)
+        {
+            new_vals[i] = rand_range(0, max_rand_range);
+        }
+        int *const old_vals = valid_malloc(n * sizeof(int));
+        for (size_t i = 0; i < n; ++i)
+        {
+            old_vals[i] = val_array[i].val;
+        }
+        struct depqueue depq = DEPQ_INIT(depq, depq_val_cmp, NULL);
+        clock_t begin = clock();
+        for (size_t i = 0; i < n; ++i)
+        {
+            depq_push(&depq, &val_array[i].depq_elem);
+        }
+        clock_t end = clock();
+        double const depq_push_time = (double)(end - begin) / CLOCKS_PER_SEC;
+        begin = clock();
+        for (size_t i = 0; i < n; ++i)
+        {
+            (void)depq_update(&depq, &val_array[i].depq_elem, depq_update_val,
+                              &new_vals[i]);
+        }
+        end = clock();
+        double const depq_update_time
+            = (double)(end - begin) / CLOCKS_PER_SEC;
+        begin = clock();
+        for (size_t i = 0; !depq_empty(&depq); ++i)
+        {
+            (void)(i % 2 ? depq_pop_max(&depq) : depq_pop_min(&depq));
+        }
+        end = clock();
+        double const depq_drain_time = (double)(end - begin) / CLOCKS_PER_SEC;
+        for (size_t i = 0; i < n; ++i)
+        {
+            val_array[i].val = old_vals[i];
+        }
+        struct heap_depqueue hdq;
+        hdepq_init(&hdq, hdepq_val_cmp, NULL);
+        begin = clock();
+        for (size_t i = 0; i < n; ++i)
+        {
+            hdepq_push(&hdq, &val_array[i].hdepq_elem);
+        }
+        end = clock();
+        double const hdepq_push_time = (double)(end - begin) / CLOCKS_PER_SEC;
+        begin = clock();
+        for (size_t i = 0; i < n; ++i)
+        {
+            (void)hdepq_update(&hdq, &val_array[i].hdepq_elem,
+                               hdepq_update_val, &new_vals[i]);
+        }
+        end = clock();
+        double const hdepq_update_time
+            = (double)(end - begin) / CLOCKS_PER_SEC;
+        begin = clock();
+        for (size_t i = 0; !hdepq_empty(&hdq); ++i)
+        {
+            (void)(i % 2 ? hdepq_pop_max(&hdq) : hdepq_pop_min(&hdq));
+        }
+        end = clock();
+        double const hdepq_drain_time
+            = (double)(end - begin) / CLOCKS_PER_SEC;
+        printf("N=%zu: DEPQ push=%f, update=%f, drain=%f\n", n,
+               depq_push_time, depq_update_time, depq_drain_time);
+        printf("N=%zu: HDEPQ push=%f, update=%f, drain=%f\n", n,
+               hdepq_push_time, hdepq_update_time, hdepq_drain_time);
+        hdepq_clear(&hdq, hdepq_destroy_val);
+        free(old_vals);
+        free(new_vals);
+        free(val_array);
+    }
+}
+
+/* Throughput in millions of operations per second for a push of every
+   element followed by a pop of every element, at sizes where the binary
+   heap and pairing heap working sets are far beyond the cache. */
+static void
+test_sequence(void)
+{
+    printf("heap priority queue vs pairing heap vs sequence heap push then "
+           "pop throughput in Mops/s:\n");
+    for (size_t n = big_step; n <= big_end_size; n *= 4)
+    {
+        struct big_val *vals = valid_malloc(n * sizeof(struct big_val));
+        for (size_t i = 0; i < n; ++i)
+        {
+            vals[i].val = rand_range(0, max_rand_range);
+        }
+        double const mops = (double)n / 1e6;
+        struct heap_pqueue hpq;
+        hpq_init(&hpq, HPQLES, big_hpq_cmp, NULL);
+        clock_t begin = clock();
+        for (size_t i = 0; i < n; ++i)
+        {
+            hpq_push(&hpq, &vals[i].hpq_elem);
+        }
+        clock_t end = clock();
+        double const hpq_push_rate
+            = mops / ((double)(end - begin) / CLOCKS_PER_SEC);
+        begin = clock();
+        while (!hpq_empty(&hpq))
+        {
+            (void)hpq_pop(&hpq);
+        }
+        end = clock();
+        double const hpq_pop_rate
+            = mops / ((double)(end - begin) / CLOCKS_PER_SEC);
+        hpq_clear(&hpq, hpq_destroy_val);
+        struct pqueue pq = PQ_INIT(PQLES, big_pq_cmp, NULL);
+        begin = clock();
+        for (size_t i = 0; i < n; ++i)
+        {
+            pq_push(&pq, &vals[i].pq_elem);
+        }
+        end = clock();
+        double const pq_push_rate
+            = mops / ((double)(end - begin) / CLOCKS_PER_SEC);
+        begin = clock();
+        while (!pq_empty(&pq))
+        {
+            (void)pq_pop(&pq);
+        }
+        end = clock();
+        double const pq_pop_rate
+            = mops / ((double)(end - begin) / CLOCKS_PER_SEC);
+        struct sequence_pqueue spq;
+        spq_init(&spq, SPQLES, big_spq_cmp, NULL);
+        begin = clock();
+        for (size_t i = 0; i < n; ++i)
+        {
+            if (!spq_push(&spq, &vals[i].spq_elem))
+            {
+                quit("sequence heap push failed.\n", 1);
+            }
+        }
+        end = clock();
+        double const spq_push_rate
+            = mops / ((double)(end - begin) / CLOCKS_PER_SEC);
+        begin = clock();
+        while (!spq_empty(&spq))
+        {
+            (void)spq_pop(&spq);
+        }
+        end = clock();
+        double const spq_pop_rate
+            = mops / ((double)(end - begin) / CLOCKS_PER_SEC);
+        spq_clear(&spq, NULL);
+        printf("N=%zu: HPQ push=%.2f, pop=%.2f\n", n, hpq_push_rate,
+               hpq_pop_rate);
+        printf("N=%zu: PQ push=%.2f, pop=%.2f\n", n, pq_push_rate,
+               pq_pop_rate);
+        printf("N=%zu: SPQ push=%.2f, pop=%.2f\n", n, spq_push_rate,
+               spq_pop_rate);
+        free(vals);
+    }
+}
+
+/* The same n random integers are split into k sorted runs of equal length
+   and merged in batches by each engine. Only the merge is timed. */
+static void
+test_kway(void)
+{
+    printf("loser tree vs binary heap k-way merge throughput in Mops/s:\n");
+    size_t const n = 4000000;
+    size_t const batch = 4096;
+    int *const ints = valid_malloc(n * sizeof(int));
+    void const **const items = valid_malloc(n * sizeof(void const *));
+    void const **const out = valid_malloc(batch * sizeof(void const *));
+    for (size_t k = 8; k <= 4096; k *= 8)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            ints[i] = rand_range(0, max_rand_range);
+        }
+        struct kwm_input *const inputs
+            = valid_malloc(k * sizeof(struct kwm_input));
+        size_t const run_len = n / k;
+        for (size_t i = 0; i < k; ++i)
+        {
+            size_t const len = i == k - 1 ? n - (run_len * i) : run_len;
+            int *const run = ints + (run_len * i);
+            qsort(run, len, sizeof(int), int_sort_cmp);
+            for (size_t j = 0; j < len; ++j)
+            {
+                items[(run_len * i) + j] = &run[j];
+            }
+            inputs[i] = (struct kwm_input){
+                .items = items + (run_len * i),
+                .len = len,
+            };
+        }
+        double const tree_rate
+            = kway_rate(inputs, k, out, batch, KWM_LOSER_TREE);
+        double const heap_rate = kway_rate(inputs, k, out, batch, KWM_HEAP);
+        printf("N=%zu, K=%zu: loser tree=%.2f, heap=%.2f\n", n, k, tree_rate,
+               heap_rate);
+        free(inputs);
+    }
+    free(out);
+    free(items);
+    free(ints);
+}
+
+/* Sorts a file of random 16 byte records, a key and a payload, with each
+   merge engine and with and without the reader thread. The time includes
+   reading the input and writing the output but not creating the input. */
+static void
+test_ext_sort(void)
+{
+    printf("external sort of %zu MiB with %zu MiB of memory in MB/s:\n",
+           sort_file_bytes >> 20, sort_budget >> 20);
+    size_t const n = sort_file_bytes / (2 * sizeof(uint64_t));
+    FILE *const in = tmpfile();
+    if (!in)
+    {
+        quit("could not create the sort input.\n", 1);
+    }
+    uint64_t block[2 * 1024];
+    for (size_t i = 0; i < n; i += 1024)
+    {
+        size_t const len = n - i < 1024 ? n - i : 1024;
+        for (size_t j = 0; j < len; ++j)
+        {
+            block[2 * j] = ((uint64_t)rand_range(0, max_rand_range) << 31)
+                           | (uint64_t)rand_range(0, max_rand_range);
+            block[(2 * j) + 1] = i + j;
+        }
+        if (fwrite(block, 2 * sizeof(uint64_t), len, in) != len)
+        {
+            quit("could not write the sort input.\n", 1);
+        }
+    }
+    enum kwm_engine const engines[2] = {KWM_LOSER_TREE, KWM_HEAP};
+    char const *const engine_names[2] = {"loser tree", "heap"};
+    for (size_t e = 0; e < 2; ++e)
+    {
+        for (int threaded = 0; threaded < 2; ++threaded)
+        {
+            FILE *const out = tmpfile();
+            if (!out)
+            {
+                quit("could not create the sort output.\n", 1);
+            }
+            rewind(in);
+            struct esort_config const config = {
+                .record_size = 2 * sizeof(uint64_t),
+                .memory_budget = sort_budget,
+                .block_size = (size_t)1 << 20,
+                .engine = engines[e],
+                .reader_thread = threaded,
+            };
+            struct esort_stats stats;
+            struct timespec begin;
+            struct timespec end;
+            (void)clock_gettime(CLOCK_MONOTONIC, &begin);
+            if (!esort_file(in, out, &config, ESORTLES, u64_record_cmp, NULL,
+                            &stats))
+            {
+                quit("external sort failed.\n", 1);
+            }
+            (void)clock_gettime(CLOCK_MONOTONIC, &end);
+            double const secs = elapsed_ns(&begin, &end) / 1e9;
+            printf("%s, reader thread %s: %.2f MB/s, runs=%zu, passes=%zu\n",
+                   engine_names[e], threaded ? "on" : "off",
+                   ((double)sort_file_bytes / 1e6) / secs, stats.runs,
+                   stats.merge_passes);
+            (void)fclose(out);
+        }
+    }
+    (void)fclose(in);
+}
+
+/* Splits a fixed number of pop and push pairs across 1 to max_threads
+   threads. The baseline is one depqueue behind one mutex against the
+   sharded queue with relaxed and with exact pops. */
+static void
+test_concurrent(void)
+{
+    printf("global lock depq vs sharded depq pop and push pairs in Mops/s "
+           "with %zu shards per thread:\n",
+           shards_per_thread);
+    struct val *const vals = create_rand_vals(contention_size);
+    for (size_t threads = 1; threads <= max_threads; threads *= 2)
+    {
+        double const locked = contention_rate(vals, threads, CDEPQ_EXACT, true);
+        double const relaxed
+            = contention_rate(vals, threads, CDEPQ_RELAXED, false);
+        double const exact = contention_rate(vals, threads, CDEPQ_EXACT, false);
+        printf("threads=%zu: global lock=%.2f, relaxed=%.2f, exact=%.2f\n",
+               threads, locked, relaxed, exact);
+    }
+    free(vals);
+}
+
+/* The throughput of pop and push pairs on one pairing heap behind one
+   mutex against a MultiQueue, with the rank error of the MultiQueue. The
+   rank error is measured once with one thread draining the same number of
+   heaps, which is the error the sampling alone causes, and once with all
+   the threads, which adds the error of threads that hold locks or have
+   popped but not yet logged when they are preempted. */
+static void
+test_multi_queue(void)
+{
+    printf("global lock pairing heap vs multiqueue with %zu heaps per "
+           "thread, pop and push pairs in Mops/s and rank error:\n",
+           heaps_per_thread);
+    struct val *const vals = create_rand_vals(contention_size);
+    for (size_t threads = 1; threads <= max_threads; threads *= 2)
+    {
+        double const locked = multi_queue_rate(vals, threads, true);
+        double const relaxed = multi_queue_rate(vals, threads, false);
+        size_t const heaps = threads * heaps_per_thread;
+        double one_mean = 0;
+        size_t one_max = 0;
+        rank_error(vals, 1, heaps, &one_mean, &one_max);
+        double all_mean = 0;
+        size_t all_max = 0;
+        rank_error(vals, threads, heaps, &all_mean, &all_max);
+        printf("threads=%zu: global lock=%.2f, multiqueue=%.2f, rank error "
+               "one drainer mean=%.2f max=%zu, all drainers mean=%.2f "
+               "max=%zu\n",
+               threads, locked, relaxed, one_mean, one_max, all_mean,
+               all_max);
+    }
+    free(vals);
+}
+
+/* Producers push a fixed number of elements that one consumer pops as they
+   arrive. The baseline guards one pairing heap with one mutex that every
+   push and pop takes. With an inbox the producers never touch the heap and
+   the consumer moves whole batches into it before it pops. */
+static void
+test_inbox(void)
+{
+    printf("global lock pairing heap vs inbox, %zu elements pushed by "
+           "producers and popped by one consumer, the rate until the last "
+           "push and until the last pop in Mops/s:\n",
+           contention_ops);
+    struct val *const vals = create_rand_vals(contention_ops);
+    for (size_t producers = 1; producers <= max_threads; producers *= 2)
+    {
+        double locked_push = 0;
+        double const locked = inbox_rate(vals, producers, true, &locked_push);
+        double inbox_push = 0;
+        double const inbox = inbox_rate(vals, producers, false, &inbox_push);
+        printf("producers=%zu: global lock push=%.2f all=%.2f, inbox "
+               "push=%.2f all=%.2f\n",
+               producers, locked_push, locked, inbox_push, inbox);
+    }
+    free(vals);
+}
+
+/* Items pass from a producer pinned to one cpu to a consumer pinned to
+   another, first through queue.h behind a mutex as the pipeline stages did
+   and then through the ring one item and a batch at a time. The latency is
+   half of a round trip over a pair of rings. */
+static void
+test_spsc(void)
+{
+    size_t const batches[4] = {0, 1, 8, 64};
+    printf("queue behind a mutex vs spsc ring of %zu, %zu items between two "
+           "pinned threads in Mops/s:\n",
+           spsc_capacity, spsc_items);
+    for (size_t i = 0; i < sizeof(batches) / sizeof(batches[0]); ++i)
+    {
+        double const rate = spsc_rate(batches[i]);
+        if (!batches[i])
+        {
+            printf("locked queue=%.2f\n", rate);
+        }
+        else
+        {
+            printf("ring batch=%zu: %.2f\n", batches[i], rate);
+        }
+    }
+    spsc_latency();
+}
+
+/*=======================  Static Helpers  =================================*/
+
+static struct val *
+create_rand_vals(size_t n)
+{
+    struct val *vals = valid_malloc(n * sizeof(struct val));
+    while (n--)
+    {
+        vals[n].val = rand_range(0, max_rand_range);
+    }
+    return vals;
+}
+
+static double
+kway_rate(struct kwm_input *const inputs, size_t const k,
+          void const **const out, size_t const batch,
+          enum kwm_engine const engine)
+{
+    struct kway_merge km;
+    if (!kwm_init(&km, inputs, k, KWMLES, kwm_int_cmp, NULL, engine))
+    {
+        quit("k-way merge init failed.\n", 1);
+    }
+    size_t total = 0;
+    int prev = INT_MIN;
+    clock_t const begin = clock();
+    for (size_t got = 0; (got = kwm_next_batch(&km, out, batch));)
+    {
+        total += got;
+        /* Touch the batch as a consumer would and check the order. */
+        for (size_t i = 0; i < got; ++i)
+        {
+            int const cur = *(int const *)out[i];
+            if (cur < prev)
+            {
+                quit("k-way merge out of order.\n", 1);
+            }
+            prev = cur;
+        }
+    }
+    clock_t const end = clock();
+    kwm_free(&km);
+    return ((double)total / 1e6) / ((double)(end - begin) / CLOCKS_PER_SEC);
+}
+
+static enum kway_threeway_cmp
+kwm_int_cmp(void const *const a, void const *const b, void *const aux)
+{
+    (void)aux;
+    int const x = *(int const *)a;
+    int const y = *(int const *)b;
+    return (x > y) - (x < y);
+}
+
+static int
+int_sort_cmp(void const *const a, void const *const b)
+{
+    return kwm_int_cmp(a, b, NULL);
+}
+
+static double
+contention_rate(struct val *const vals, size_t const threads,
+                enum cdepq_mode const mode, bool const global_lock)
+{
+    struct concurrent_depq cdq;
+    struct depqueue depq = DEPQ_INIT(depq, depq_val_cmp, NULL);
+    pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+    if (!cdepq_init(&cdq, threads * shards_per_thread, mode, depq_val_cmp,
+                    NULL))
+    {
+        quit("could not create the sharded depq.\n", 1);
+    }
+    for (size_t i = 0; i < contention_size; ++i)
+    {
+        if (global_lock)
+        {
+            depq_push(&depq, &vals[i].depq_elem);
+        }
+        else
+        {
+            cdepq_push(&cdq, &vals[i].depq_elem);
+        }
+    }
+    pthread_t *const ids = valid_malloc(threads * sizeof(pthread_t));
+    struct contender *const cs
+        = valid_malloc(threads * sizeof(struct contender));
+    struct timespec begin;
+    struct timespec end;
+    (void)clock_gettime(CLOCK_MONOTONIC, &begin);
+    for (size_t i = 0; i < threads; ++i)
+    {
+        cs[i] = (struct contender){
+            .cdq = &cdq,
+            .depq = &depq,
+            .lock = &lock,
+            .ops = contention_ops / threads,
+            .rng = (i + 1) * 0x9E3779B97F4A7C15ULL,
+        };
+        if (pthread_create(&ids[i], NULL,
+                           global_lock ? contend_locked : contend_sharded,
+                           &cs[i]))
+        {
+            quit("could not create a thread.\n", 1);
+        }
+    }
+    for (size_t i = 0; i < threads; ++i)
+    {
+        (void)pthread_join(ids[i], NULL);
+    }
+    (void)clock_gettime(CLOCK_MONOTONIC, &end);
+    double const secs = elapsed_ns(&begin, &end) / 1e9;
+    cdepq_clear(&cdq, NULL);
+    free(cs);
+    free(ids);
+    return ((double)(contention_ops / threads * threads) / 1e6) / secs;
+}
+
+static void *
+contend_sharded(void *const arg)
+{
+    struct contender *const c = arg;
+    for (size_t i = 0; i < c->ops; ++i)
+    {
+        struct depq_elem *const e
+            = i % 2 ? cdepq_pop_max(c->cdq) : cdepq_pop_min(c->cdq);
+        DEPQ_ENTRY(e, struct val, depq_elem)->val = next_priority(c);
+        cdepq_push(c->cdq, e);
+    }
+    return NULL;
+}
+
+static void *
+contend_locked(void *const arg)
+{
+    struct contender *const c = arg;
+    for (size_t i = 0; i < c->ops; ++i)
+    {
+        int const priority = next_priority(c);
+        (void)pthread_mutex_lock(c->lock);
+        struct depq_elem *const e
+            = i % 2 ? depq_pop_max(c->depq) : depq_pop_min(c->depq);
+        DEPQ_ENTRY(e, struct val, depq_elem)->val = priority;
+        depq_push(c->depq, e);
+        (void)pthread_mutex_unlock(c->lock);
+    }
+    return NULL;
+}
+
+static double
+multi_queue_rate(struct val *const vals, size_t const threads,
+                 bool const global_lock)
+{
+    struct multi_queue mq;
+    struct pqueue pq = PQ_INIT(PQLES, pq_val_cmp, NULL);
+    pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+    if (!mq_init(&mq, threads * heaps_per_thread, PQLES, pq_val_cmp, NULL))
+    {
+        quit("could not create the multiqueue.\n", 1);
+    }
+    for (size_t i = 0; i < contention_size; ++i)
+    {
+        if (global_lock)
+        {
+            pq_push(&pq, &vals[i].pq_elem);
+        }
+        else
+        {
+            mq_push(&mq, &vals[i].pq_elem);
+        }
+    }
+    pthread_t *const ids = valid_malloc(threads * sizeof(pthread_t));
+    struct contender *const cs
+        = valid_malloc(threads * sizeof(struct contender));
+    struct timespec begin;
+    struct timespec end;
+    (void)clock_gettime(CLOCK_MONOTONIC, &begin);
+    for (size_t i = 0; i < threads; ++i)
+    {
+        cs[i] = (struct contender){
+            .mq = &mq,
+            .pq = &pq,
+            .lock = &lock,
+            .ops = contention_ops / threads,
+            .rng = (i + 1) * 0x9E3779B97F4A7C15ULL,
+        };
+        if (pthread_create(&ids[i], NULL,
+                           global_lock ? contend_pq_locked : contend_multi,
+                           &cs[i]))
+        {
+            quit("could not create a thread.\n", 1);
+        }
+    }
+    for (size_t i = 0; i < threads; ++i)
+    {
+        (void)pthread_join(ids[i], NULL);
+    }
+    (void)clock_gettime(CLOCK_MONOTONIC, &end);
+    double const secs = elapsed_ns(&begin, &end) / 1e9;
+    mq_clear(&mq, NULL);
+    free(cs);
+    free(ids);
+    return ((double)(contention_ops / threads * threads) / 1e6) / secs;
+}
+
+/* Drains a MultiQueue of the given heaps holding the distinct keys 0 to
+   N - 1 with the given threads. Each pop takes a ticket and the log is
+   replayed in ticket order over a Fenwick tree of the keys still queued,
+   so the rank error of a pop is the number of smaller keys still queued
+   when it was taken. */
+static void
+rank_error(struct val *const vals, size_t const threads, size_t const heaps,
+           double *const mean, size_t *const max)
+{
+    size_t const n = contention_size;
+    for (size_t i = 0; i < n; ++i)
+    {
+        vals[i].val = (int)i;
+    }
+    for (size_t i = n - 1; i > 0; --i)
+    {
+        size_t const j = (size_t)rand_range(0, (int)i);
+        int const swap = vals[i].val;
+        vals[i].val = vals[j].val;
+        vals[j].val = swap;
+    }
+    struct multi_queue mq;
+    if (!mq_init(&mq, heaps, PQLES, pq_val_cmp, NULL))
+    {
+        quit("could not create the multiqueue.\n", 1);
+    }
+    for (size_t i = 0; i < n; ++i)
+    {
+        mq_push(&mq, &vals[i].pq_elem);
+    }
+    int *const pop_log = valid_malloc(n * sizeof(int));
+    atomic_size_t ticket;
+    atomic_init(&ticket, 0);
+    pthread_t *const ids = valid_malloc(threads * sizeof(pthread_t));
+    struct contender *const cs
+        = valid_malloc(threads * sizeof(struct contender));
+    for (size_t i = 0; i < threads; ++i)
+    {
+        cs[i] = (struct contender){
+            .mq = &mq,
+            .ticket = &ticket,
+            .pop_log = pop_log,
+        };
+        if (pthread_create(&ids[i], NULL, pop_logged, &cs[i]))
+        {
+            quit("could not create a thread.\n", 1);
+        }
+    }
+    for (size_t i = 0; i < threads; ++i)
+    {
+        (void)pthread_join(ids[i], NULL);
+    }
+    size_t *const fenwick = valid_malloc((n + 1) * sizeof(size_t));
+    for (size_t i = 1; i <= n; ++i)
+    {
+        fenwick[i] = i & -i;
+    }
+    size_t total = 0;
+    *max = 0;
+    for (size_t t = 0; t < n; ++t)
+    {
+        size_t const key = (size_t)pop_log[t];
+        size_t rank = 0;
+        for (size_t i = key; i; i -= i & -i)
+        {
+            rank += fenwick[i];
+        }
+        for (size_t i = key + 1; i <= n; i += i & -i)
+        {
+            --fenwick[i];
+        }
+        total += rank;
+        *max = rank > *max ? rank : *max;
+    }
+    *mean = (double)total / (double)n;
+    mq_clear(&mq, NULL);
+    free(fenwick);
+    free(cs);
+    free(ids);
+    free(pop_log);
+}
+
+static void *
+contend_multi(void *const arg)
+{
+    struct contender *const c = arg;
+    for (size_t i = 0; i < c->ops; ++i)
+    {
+        struct pq_elem *const e = mq_pop(c->mq);
+        PQ_ENTRY(e, struct val, pq_elem)->val = next_priority(c);
+        mq_push(c->mq, e);
+    }
+    return NULL;
+}
+
+static void *
+contend_pq_locked(void *const arg)
+{
+    struct contender *const c = arg;
+    for (size_t i = 0; i < c->ops; ++i)
+    {
+        int const priority = next_priority(c);
+        (void)pthread_mutex_lock(c->lock);
+        struct pq_elem *const e = pq_pop(c->pq);
+        PQ_ENTRY(e, struct val, pq_elem)->val = priority;
+        pq_push(c->pq, e);
+        (void)pthread_mutex_unlock(c->lock);
+    }
+    return NULL;
+}
+
+static void *
+pop_logged(void *const arg)
+{
+    struct contender *const c = arg;
+    for (struct pq_elem *e = NULL; (e = mq_pop(c->mq));)
+    {
+        c->pop_log[atomic_fetch_add(c->ticket, 1)]
+            = PQ_ENTRY(e, struct val, pq_elem)->val;
+    }
+    return NULL;
+}
+
+/* The calling thread is the consumer and pops until every element pushed
+   by the producers is out. It notes when the last producer finishes to
+   give the rate of the pushes alone. */
+static double
+inbox_rate(struct val *const vals, size_t const producers,
+           bool const global_lock, double *const push_rate)
+{
+    struct pqueue pq = PQ_INIT(PQLES, pq_val_cmp, NULL);
+    struct pq_inbox inbox;
+    pq_inbox_init(&inbox, &pq);
+    pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+    atomic_size_t finished;
+    atomic_init(&finished, 0);
+    size_t const slice = contention_ops / producers;
+    size_t const total = slice * producers;
+    pthread_t *const ids = valid_malloc(producers * sizeof(pthread_t));
+    struct contender *const cs
+        = valid_malloc(producers * sizeof(struct contender));
+    struct timespec begin;
+    struct timespec pushed = {0};
+    struct timespec end;
+    (void)clock_gettime(CLOCK_MONOTONIC, &begin);
+    for (size_t i = 0; i < producers; ++i)
+    {
+        cs[i] = (struct contender){
+            .inbox = &inbox,
+            .ticket = &finished,
+            .pq = &pq,
+            .lock = &lock,
+            .vals = vals + i * slice,
+            .ops = slice,
+        };
+        if (pthread_create(&ids[i], NULL,
+                           global_lock ? produce_locked : produce_inbox,
+                           &cs[i]))
+        {
+            quit("could not create a thread.\n", 1);
+        }
+    }
+    for (size_t popped = 0; popped < total;)
+    {
+        struct pq_elem *e = NULL;
+        if (global_lock)
+        {
+            (void)pthread_mutex_lock(&lock);
+            e = pq_empty(&pq) ? NULL : pq_pop(&pq);
+            (void)pthread_mutex_unlock(&lock);
+        }
+        else
+        {
+            e = pq_inbox_pop(&inbox);
+        }
+        popped += e != NULL;
+        if (!pushed.tv_sec && !pushed.tv_nsec
+            && atomic_load_explicit(&finished, memory_order_relaxed)
+                   == producers)
+        {
+            (void)clock_gettime(CLOCK_MONOTONIC, &pushed);
+        }
+    }
+    (void)clock_gettime(CLOCK_MONOTONIC, &end);
+    for (size_t i = 0; i < producers; ++i)
+    {
+        (void)pthread_join(ids[i], NULL);
+    }
+    if (!pushed.tv_sec && !pushed.tv_nsec)
+    {
+        pushed = end;
+    }
+    *push_rate
+        = ((double)total / 1e6) / (elapsed_ns(&begin, &pushed) / 1e9);
+    double const secs = elapsed_ns(&begin, &end) / 1e9;
+    free(cs);
+    free(ids);
+    return ((double)total / 1e6) / secs;
+}
+
+static void *
+produce_inbox(void *const arg)
+{
+    struct contender *const c = arg;
+    for (size_t i = 0; i < c->ops; ++i)
+    {
+        pq_inbox_push(c->inbox, &c->vals[i].pq_elem);
+    }
+    (void)atomic_fetch_add(c->ticket, 1);
+    return NULL;
+}
+
+static void *
+produce_locked(void *const arg)
+{
+    struct contender *const c = arg;
+    for (size_t i = 0; i < c->ops; ++i)
+    {
+        (void)pthread_mutex_lock(c->lock);
+        pq_push(c->pq, &c->vals[i].pq_elem);
+        (void)pthread_mutex_unlock(c->lock);
+    }
+    (void)atomic_fetch_add(c->ticket, 1);
+    return NULL;
+}
+
+static double
+spsc_rate(size_t const batch)
+{
+    struct spsc_queue ring;
+    if (!spscq_init(&ring, sizeof(uint64_t), spsc_capacity))
+    {
+        quit("could not create the spsc ring.\n", 1);
+    }
+    struct queue q;
+    q_init(sizeof(uint64_t), &q, spsc_capacity);
+    pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+    struct stage producer = {
+        .ring = &ring,
+        .q = &q,
+        .lock = &lock,
+        .items = spsc_items,
+        .batch = batch,
+        .cpu = 0,
+    };
+    struct stage consumer = producer;
+    consumer.cpu = 1;
+    pthread_t ids[2];
+    struct timespec begin;
+    struct timespec end;
+    (void)clock_gettime(CLOCK_MONOTONIC, &begin);
+    if (pthread_create(&ids[0], NULL, spsc_produce, &producer)
+        || pthread_create(&ids[1], NULL, spsc_consume, &consumer))
+    {
+        quit("could not create a thread.\n", 1);
+    }
+    (void)pthread_join(ids[0], NULL);
+    (void)pthread_join(ids[1], NULL);
+    (void)clock_gettime(CLOCK_MONOTONIC, &end);
+    q_free(&q);
+    spscq_free(&ring);
+    return ((double)spsc_items / 1e6) / (elapsed_ns(&begin, &end) / 1e9);
+}
+
+static void
+spsc_latency(void)
+{
+    struct spsc_queue ring;
+    struct spsc_queue echo;
+    if (!spscq_init(&ring, sizeof(uint64_t), spsc_capacity)
+        || !spscq_init(&echo, sizeof(uint64_t), spsc_capacity))
+    {
+        quit("could not create the spsc rings.\n", 1);
+    }
+    struct stage ping = {
+        .ring = &ring,
+        .echo = &echo,
+        .items = spsc_round_trips,
+        .cpu = 0,
+    };
+    struct stage pong = ping;
+    pong.cpu = 1;
+    pthread_t ids[2];
+    if (pthread_create(&ids[0], NULL, spsc_ping, &ping)
+        || pthread_create(&ids[1], NULL, spsc_pong, &pong))
+    {
+        quit("could not create a thread.\n", 1);
+    }
+    double *one_way = NULL;
+    (void)pthread_join(ids[0], (void **)&one_way);
+    (void)pthread_join(ids[1], NULL);
+    print_latencies("spsc one way (ns)", one_way, spsc_round_trips);
+    free(one_way);
+    spscq_free(&echo);
+    spscq_free(&ring);
+}
+
+static void *
+spsc_produce(void *const arg)
+{
+    struct stage *const s = arg;
+    pin_thread(s->cpu);
+    uint64_t buf[64];
+    unsigned fails = 0;
+    for (size_t sent = 0; sent < s->items;)
+    {
+        if (!s->batch)
+        {
+            uint64_t item = sent;
+            (void)pthread_mutex_lock(s->lock);
+            q_push(s->q, &item);
+            (void)pthread_mutex_unlock(s->lock);
+            ++sent;
+            continue;
+        }
+        size_t n = s->items - sent < s->batch ? s->items - sent : s->batch;
+        for (size_t i = 0; i < n; ++i)
+        {
+            buf[i] = sent + i;
+        }
+        n = n == 1 ? spscq_push(s->ring, buf) : spscq_push_n(s->ring, buf, n);
+        if (!n)
+        {
+            spin_wait(&fails);
+        }
+        sent += n;
+    }
+    return NULL;
+}
+
+/* Checks every item arrives once and in order. */
+static void *
+spsc_consume(void *const arg)
+{
+    struct stage *const s = arg;
+    pin_thread(s->cpu);
+    uint64_t buf[64];
+    unsigned fails = 0;
+    for (size_t got = 0; got < s->items;)
+    {
+        size_t n = 0;
+        if (!s->batch)
+        {
+            (void)pthread_mutex_lock(s->lock);
+            if (!q_empty(s->q))
+            {
+                buf[0] = *(uint64_t *)q_front(s->q);
+                q_pop(s->q);
+                n = 1;
+            }
+            (void)pthread_mutex_unlock(s->lock);
+        }
+        else if (s->batch == 1)
+        {
+            n = spscq_pop(s->ring, buf);
+        }
+        else
+        {
+            n = spscq_pop_n(s->ring, buf, s->batch);
+        }
+        if (!n)
+        {
+            spin_wait(&fails);
+        }
+        for (size_t i = 0; i < n; ++i)
+        {
+            if (buf[i] != got + i)
+            {
+                quit("spsc item out of order.\n", 1);
+            }
+        }
+        got += n;
+    }
+    return NULL;
+}
+
+/* Returns the one way latencies which the caller frees. */
+static void *
+spsc_ping(void *const arg)
+{
+    struct stage *const s = arg;
+    pin_thread(s->cpu);
+    double *const one_way = valid_malloc(s->items * sizeof(double));
+    unsigned fails = 0;
+    for (size_t i = 0; i < s->items; ++i)
+    {
+        uint64_t item = i;
+        struct timespec begin;
+        struct timespec end;
+        (void)clock_gettime(CLOCK_MONOTONIC, &begin);
+        while (!spscq_push(s->ring, &item))
+        {
+            spin_wait(&fails);
+        }
+        while (!spscq_pop(s->echo, &item))
+        {
+            spin_wait(&fails);
+        }
+        (void)clock_gettime(CLOCK_MONOTONIC, &end);
+        if (item != i)
+        {
+            quit("spsc echo out of order.\n", 1);
+        }
+        one_way[i] = elapsed_ns(&begin, &end) / 2;
+    }
+    return one_way;
+}
+
+static void *
+spsc_pong(void *const arg)
+{
+    struct stage *const s = arg;
+    pin_thread(s->cpu);
+    unsigned fails = 0;
+    for (size_t i = 0; i < s->items; ++i)
+    {
+        uint64_t item = 0;
+        while (!spscq_pop(s->ring, &item))
+        {
+            spin_wait(&fails);
+        }
+        while (!spscq_push(s->echo, &item))
+        {
+            spin_wait(&fails);
+        }
+    }
+    return NULL;
+}
+
+/* Pins the calling thread to the cpu, wrapping on a machine with fewer. A
+   failure to pin is not fatal because the numbers are still valid, only
+   noisier. */
+static void
+pin_thread(int const cpu)
+{
+    long const cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpus > 0 ? cpu % (int)cpus : 0, &set);
+    (void)pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
+
+/* Spins while the other side is on another cpu but yields now and then in
+   case both threads share one. */
+static void
+spin_wait(unsigned *const fails)
+{
+    if (++*fails % 64 == 0)
+    {
+        (void)sched_yield();
+    }
+}
+
+/* A xorshift per thread because rand() takes a lock of its own. */
+static int
+next_priority(struct contender *const c)
+{
+    c->rng ^= c->rng << 13;
+    c->rng ^= c->rng >> 7;
+    c->rng ^= c->rng << 17;
+    return (int)(c->rng % (uint64_t)max_rand_range);
+}
+
+static enum ext_sort_threeway_cmp
+u64_record_cmp(void const *const a, void const *const b, void *const aux)
+{
+    (void)aux;
+    uint64_t x;
+    uint64_t y;
+    memcpy(&x, a, sizeof(x));
+    memcpy(&y, b, sizeof(y));
+    return (x > y) - (x < y);
+}
+
+/* Each Dijkstra queues every vertex up front with an infinite distance,
+   like the graph sample, so a relaxed vertex is always in the queue. The
+   sum of the reachable distances is returned to check the queues agree. */
+static unsigned long long
+dijkstra_pq(struct val *const vertices, size_t const n, size_t const *to,
+            int const *cost)
+{
+    struct pqueue pq = PQ_INIT(PQLES, pq_val_cmp, NULL);
+    for (size_t i = 0; i < n; ++i)
+    {
+        vertices[i].val = i ? INT_MAX : 0;
+        pq_push(&pq, &vertices[i].pq_elem);
+    }
+    unsigned long long sum = 0;
+    while (!pq_empty(&pq))
+    {
+        struct val const *const cur
+            = PQ_ENTRY(pq_pop(&pq), struct val, pq_elem);
+        if (cur->val == INT_MAX)
+        {
+            break;
+        }
+        sum += (unsigned long long)cur->val;
+        size_t const u = (size_t)(cur - vertices);
+        for (size_t e = u * graph_degree; e < (u + 1) * graph_degree; ++e)
+        {
+            int alt = cur->val + cost[e];
+            if (alt < vertices[to[e]].val)
+            {
+                (void)pq_decrease(&pq, &vertices[to[e]].pq_elem,
+                                  pq_update_val, &alt);
+            }
+        }
+    }
+    pq_clear(&pq, pq_destroy_val);
+    return sum;
+}
+
+static unsigned long long
+dijkstra_hpq(struct val *const vertices, size_t const n, size_t const *to,
+             int const *cost)
+{
+    struct heap_pqueue hpq;
+    hpq_init(&hpq, HPQLES, hpq_val_cmp, NULL);
+    for (size_t i = 0; i < n; ++i)
+    {
+        vertices[i].val = i ? INT_MAX : 0;
+        hpq_push(&hpq, &vertices[i].hpq_elem);
+    }
+    unsigned long long sum = 0;
+    while (!hpq_empty(&hpq))
+    {
+        struct val const *const cur
+            = HPQ_ENTRY(hpq_pop(&hpq), struct val, hpq_elem);
+        if (cur->val == INT_MAX)
+        {
+            break;
+        }
+        sum += (unsigned long long)cur->val;
+        size_t const u = (size_t)(cur - vertices);
+        for (size_t e = u * graph_degree; e < (u + 1) * graph_degree; ++e)
+        {
+            int alt = cur->val + cost[e];
+            if (alt < vertices[to[e]].val)
+            {
+                (void)hpq_update(&hpq, &vertices[to[e]].hpq_elem,
+                                 hpq_update_val, &alt);
+            }
+        }
+    }
+    hpq_clear(&hpq, hpq_destroy_val);
+    return sum;
+}
+
+static unsigned long long
+dijkstra_rdpq(struct val *const vertices, size_t const n, size_t const *to,
+              int const *cost)
+{
+    struct rdpqueue rdq = RDPQ_INIT();
+    for (size_t i = 0; i < n; ++i)
+    {
+        vertices[i].val = i ? INT_MAX : 0;
+        (void)rdpq_push(&rdq, &vertices[i].rdpq_elem,
+                        (uint64_t)vertices[i].val);
+    }
+    unsigned long long sum = 0;
+    while (!rdpq_empty(&rdq))
+    {
+        struct val const *const cur
+            = RDPQ_ENTRY(rdpq_pop(&rdq), struct val, rdpq_elem);
+        if (cur->val == INT_MAX)
+        {
+            break;
+        }
+        sum += (unsigned long long)cur->val;
+        size_t const u = (size_t)(cur - vertices);
+        for (size_t e = u * graph_degree; e < (u + 1) * graph_degree; ++e)
+        {
+            int const alt = cur->val + cost[e];
+            if (alt < vertices[to[e]].val)
+            {
+                vertices[to[e]].val = alt;
+                (void)rdpq_decrease(&rdq, &vertices[to[e]].rdpq_elem,
+                                    (uint64_t)alt);
+            }
+        }
+    }
+    rdpq_clear(&rdq, rdpq_destroy_val);
+    return sum;
+}
+
+static void *
+valid_malloc(size_t bytes)
+{
+    void *mem = malloc(bytes);
+    if (!mem)
+    {
+        (void)fprintf(stderr, "heap is exhausted in perf, exiting program.\n");
+        exit(1);
+    }
+    return mem;
+}
+
+static dpq_threeway_cmp
+depq_val_cmp(struct depq_elem const *const a, struct depq_elem const *const b,
+             void *const aux)
+{
+    (void)aux;
+    struct val const *const x = DEPQ_ENTRY(a, struct val, depq_elem);
+    struct val const *const y = DEPQ_ENTRY(b, struct val, depq_elem);
+    if (x->val < y->val)
+    {
+        return DPQLES;
+    }
+    if (x->val > y->val)
+    {
+        return DPQGRT;
+    }
+    return DPQEQL;
+}
+
+static set_threeway_cmp
+set_val_cmp(struct set_elem const *const a, struct set_elem const *const b,
+            void *const aux)
+{
+    (void)aux;
+    struct val const *const x = SET_ENTRY(a, struct val, set_elem);
+    struct val const *const y = SET_ENTRY(b, struct val, set_elem);
+    if (x->val < y->val)
+    {
+        return SETLES;
+    }
+    if (x->val > y->val)
+    {
+        return SETGRT;
+    }
+    return SETEQL;
+}
+
+static enum heap_pq_threeway_cmp
+big_hpq_cmp(struct hpq_elem const *a, struct hpq_elem const *b, void *const aux)
+{
+    (void)aux;
+    int const x = HPQ_ENTRY(a, struct big_val, hpq_elem)->val;
+    int const y = HPQ_ENTRY(b, struct big_val, hpq_elem)->val;
+    return (x > y) - (x < y);
+}
+
+static enum pq_threeway_cmp
+big_pq_cmp(struct pq_elem const *a, struct pq_elem const *b, void *const aux)
+{
+    (void)aux;
+    int const x = PQ_ENTRY(a, struct big_val, pq_elem)->val;
+    int const y = PQ_ENTRY(b, struct big_val, pq_elem)->val;
+    return (x > y) - (x < y);
+}
+
+static enum sequence_pq_threeway_cmp
+big_spq_cmp(struct spq_elem const *a, struct spq_elem const *b,
+            void *const aux)
+{
+    (void)aux;
+    int const x = SPQ_ENTRY(a, struct big_val, spq_elem)->val;
+    int const y = SPQ_ENTRY(b, struct big_val, spq_elem)->val;
+    return (x > y) - (x < y);
+}
+
+static enum heap_depq_threeway_cmp
+hdepq_val_cmp(struct hdepq_elem const *a, struct hdepq_elem const *b,
+              void *const aux)
+{
+    (void)aux;
+    struct val const *const x = HDEPQ_ENTRY(a, struct val, hdepq_elem);
+    struct val const *const y = HDEPQ_ENTRY(b, struct val, hdepq_elem);
+    if (x->val < y->val)
+    {
+        return HDEPQLES;
+    }
+    if (x->val > y->val)
+    {
+        return HDEPQGRT;
+    }
+    return HDEPQEQL;
+}
+
+static enum heap_pq_threeway_cmp
+hpq_val_cmp(struct hpq_elem const *a, struct hpq_elem const *b, void *const aux)
+{
+    (void)aux;
+    struct val const *const x = HPQ_ENTRY(a, struct val, hpq_elem);
+    struct val const *const y = HPQ_ENTRY(b, struct val, hpq_elem);
+    if (x->val < y->val)
+    {
+        return HPQLES;
+    }
+    if (x->val > y->val)
+    {
+        return HPQGRT;
+    }
+    return HPQEQL;
+}
+
+static void
+depq_update_val(struct depq_elem *e, void *aux)
+{
+    struct val *v = DEPQ_ENTRY(e, struct val, depq_elem);
+    v->val = *((int *)aux);
+}
+
+static void
+hdepq_update_val(struct hdepq_elem *e, void *aux)
+{
+    struct val *v = HDEPQ_ENTRY(e, struct val, hdepq_elem);
+    v->val = *((int *)aux);
+}
+
+static void
+hpq_update_val(struct hpq_elem *e, void *aux)
+{
+    struct val *v = HPQ_ENTRY(e, struct val, hpq_elem);
+    v->val = *((int *)aux);
+}
+
+static void
+hpq_update_rand_val(struct hpq_elem *e, void *aux)
+{
+    (void)aux;
+    struct val *v = HPQ_ENTRY(e, struct val, hpq_elem);
+    v->val = rand_range(0, max_rand_range);
+}
+
+static void
 pq_update_val(struct pq_elem *e, void *aux)
 {
     struct val *v = PQ_ENTRY(e, struct val, pq_elem);
     v->val = *((int *)aux);
 }
 
+static void
+rkpq_update_val(struct rkpq_elem *e, void *aux)
+{
+    struct val *v = RKPQ_ENTRY(e, struct val, rkpq_elem);
+    v->val = *((int *)aux);
+}
+
+static void
+depq_sum_val(struct depq_elem *e, void *aux)
+{
+    *(long long *)aux += DEPQ_ENTRY(e, struct val, depq_elem)->val;
+}
+
+static void
+set_sum_val(struct set_elem *e, void *aux)
+{
+    *(long long *)aux += SET_ENTRY(e, struct val, set_elem)->val;
+}
+
+static void
+hdepq_destroy_val(struct hdepq_elem *e)
+{
+    (void)e;
+}
+
 static void
 hpq_destroy_val(struct hpq_elem *e)
 {
@@ -516,6 +2752,18 @@ pq_destroy_val(struct pq_elem *e)
     (void)e;
 }
 
+static void
+rkpq_destroy_val(struct rkpq_elem *e)
+{
+    (void)e;
+}
+
+static void
+rdpq_destroy_val(struct rdpq_elem *e)
+{
+    (void)e;
+}
+
 static enum pq_threeway_cmp
 pq_val_cmp(struct pq_elem const *a, struct pq_elem const *const b,
            void *const aux)
@@ -533,3 +2781,53 @@ pq_val_cmp(struct pq_elem const *a, struct pq_elem const *const b,
     }
     return PQEQL;
 }
+
+static enum rkpq_threeway_cmp
+rkpq_val_cmp(struct rkpq_elem const *a, struct rkpq_elem const *const b,
+             void *const aux)
+{
+    (void)aux;
+    struct val const *const x = RKPQ_ENTRY(a, struct val, rkpq_elem);
+    struct val const *const y = RKPQ_ENTRY(b, struct val, rkpq_elem);
+    if (x->val < y->val)
+    {
+        return RKPQLES;
+    }
+    if (x->val > y->val)
+    {
+        return RKPQGRT;
+    }
+    return RKPQEQL;
+}
+
+static double
+elapsed_ns(struct timespec const *begin, struct timespec const *end)
+{
+    return ((double)(end->tv_sec - begin->tv_sec) * 1e9)
+           + (double)(end->tv_nsec - begin->tv_nsec);
+}
+
+static int
+double_cmp(void const *a, void const *b)
+{
+    double const lhs = *(double const *)a;
+    double const rhs = *(double const *)b;
+    return (lhs > rhs) - (lhs < rhs);
+}
+
+static void
+print_latencies(char const *label, double *latencies, size_t n)
+{
+    qsort(latencies, n, sizeof(double), double_cmp);
+    double total = 0.0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        total += latencies[i];
+    }
+    printf("%s: p50=%.0f, p99=%.0f, p99.9=%.0f, p99.99=%.0f, max=%.0f, "
+           "total=%f\n",
+           label, latencies[n / 2], latencies[(size_t)((double)n * 0.99)],
+           latencies[(size_t)((double)n * 0.999)],
+           latencies[(size_t)((double)n * 0.9999)], latencies[n - 1],
+           total / 1e9);
+}
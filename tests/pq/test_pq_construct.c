@@ -12,11 +12,12 @@ struct val
 };
 
 static enum test_result pq_test_empty(void);
+static enum test_result pq_test_profile(void);
 static enum pq_threeway_cmp val_cmp(struct pq_elem const *,
                                     struct pq_elem const *, void *);
 
-#define NUM_TESTS (size_t)1
-test_fn const all_tests[NUM_TESTS] = {pq_test_empty};
+#define NUM_TESTS (size_t)2
+test_fn const all_tests[NUM_TESTS] = {pq_test_empty, pq_test_profile};
 
 int
 main()
@@ -41,6 +42,37 @@ pq_test_empty(void)
     return PASS;
 }
 
+static enum test_result
+pq_test_profile(void)
+{
+    struct pqueue pq = PQ_INIT(PQLES, val_cmp, NULL);
+    struct val vals[10];
+    for (int i = 0; i < 10; ++i)
+    {
+        vals[i].val = 10 - i;
+        pq_push(&pq, &vals[i].elem);
+    }
+    for (int i = 0; i < 10; ++i)
+    {
+        (void)pq_pop(&pq);
+    }
+    struct pq_counters const c = pq_profile(&pq);
+#ifdef CONTAINER_PROFILE
+    CHECK(c.merges > 0, true, bool, "%d");
+    CHECK(c.cmps >= c.merges, true, bool, "%d");
+    CHECK(c.delete_mins, 10, size_t, "%zu");
+    pq_profile_reset(&pq);
+    CHECK(pq_profile(&pq).cmps, 0, size_t, "%zu");
+    /* A pushpop into an empty queue returns the element uncompared. */
+    CHECK(pq_pushpop(&pq, &vals[0].elem) == &vals[0].elem, true, bool, "%d");
+    CHECK(pq_profile(&pq).cmps, 0, size_t, "%zu");
+#else
+    CHECK(c.cmps, 0, size_t, "%zu");
+    CHECK(c.merges, 0, size_t, "%zu");
+#endif
+    return PASS;
+}
+
 static enum pq_threeway_cmp
 val_cmp(struct pq_elem const *a, struct pq_elem const *b, void *aux)
 {
@@ -21,6 +21,8 @@ static enum test_result pq_test_pop_min(void);
 static enum test_result pq_test_delete_prime_shuffle_duplicates(void);
 static enum test_result pq_test_prime_shuffle(void);
 static enum test_result pq_test_weak_srand(void);
+static enum test_result pq_test_replace_front_pushpop(void);
+static enum test_result pq_test_bounded_burst_drain(void);
 static enum test_result insert_shuffled(struct pqueue *, struct val[], size_t,
                                         int);
 static size_t inorder_fill(int[], size_t, struct pqueue *);
@@ -36,6 +38,8 @@ test_fn const all_tests[NUM_TESTS] = {
     pq_test_delete_prime_shuffle_duplicates,
     pq_test_prime_shuffle,
     pq_test_weak_srand,
+    pq_test_replace_front_pushpop,
+    pq_test_bounded_burst_drain,
 };
 
 int
@@ -251,6 +255,91 @@ pq_test_weak_srand(void)
     return PASS;
 }
 
+static enum test_result
+pq_test_replace_front_pushpop(void)
+{
+    struct pqueue ppq = PQ_INIT(PQLES, val_cmp, NULL);
+    size_t const size = 50;
+    int const prime = 53;
+    struct val vals[size];
+    CHECK(insert_shuffled(&ppq, vals, size, prime), PASS, enum test_result,
+          "%d");
+    /* Replace the min with a larger value each time. Fronts stay sorted. */
+    struct val replacements[size];
+    for (size_t i = 0; i < size; ++i)
+    {
+        replacements[i].val = (int)(size + i);
+        struct val const *front = PQ_ENTRY(
+            pq_replace_front(&ppq, &replacements[i].elem), struct val, elem);
+        CHECK(front->val, (int)i, int, "%d");
+        CHECK(pq_validate(&ppq), true, bool, "%d");
+    }
+    CHECK(pq_size(&ppq), size, size_t, "%zu");
+    /* A value that would be the front never enters the priority queue. */
+    struct val small = {.val = -1};
+    CHECK(pq_pushpop(&ppq, &small.elem) == &small.elem, true, bool, "%d");
+    CHECK(pq_size(&ppq), size, size_t, "%zu");
+    /* A larger value enters and the old front comes out. */
+    struct val big = {.val = (int)(size * 3)};
+    struct val const *out
+        = PQ_ENTRY(pq_pushpop(&ppq, &big.elem), struct val, elem);
+    CHECK(out->val, (int)size, int, "%d");
+    CHECK(pq_validate(&ppq), true, bool, "%d");
+    CHECK(pq_size(&ppq), size, size_t, "%zu");
+    /* Replacing the front of an empty queue is a push. */
+    struct pqueue empty = PQ_INIT(PQLES, val_cmp, NULL);
+    CHECK(pq_replace_front(&empty, &small.elem) == NULL, true, bool, "%d");
+    CHECK(pq_size(&empty), 1, size_t, "%zu");
+    return PASS;
+}
+
+static enum test_result
+pq_test_bounded_burst_drain(void)
+{
+    struct pq_elem *pending[PQ_PENDING_SLOTS] = {0};
+    struct pqueue ppq = PQ_INIT_BOUNDED(PQLES, val_cmp, NULL, pending);
+    size_t const size = 1000;
+    int const prime = 1009;
+    struct val vals[size];
+    size_t shuffled_index = prime % size;
+    for (size_t i = 0; i < size; ++i)
+    {
+        vals[shuffled_index].val = (int)(shuffled_index % 250);
+        pq_push(&ppq, &vals[shuffled_index].elem);
+        CHECK(pq_validate(&ppq), true, bool, "%d");
+        shuffled_index = (shuffled_index + prime) % size;
+    }
+    CHECK(pq_size(&ppq), size, size_t, "%zu");
+    CHECK(PQ_ENTRY(pq_front(&ppq), struct val, elem)->val, 0, int, "%d");
+    /* Erasing from the pending trees must leave the rest intact. */
+    for (size_t i = 3; i < size; i += 10)
+    {
+        CHECK(pq_erase(&ppq, &vals[i].elem) != NULL, true, bool, "%d");
+        CHECK(pq_validate(&ppq), true, bool, "%d");
+    }
+    size_t const remaining = pq_size(&ppq);
+    /* Interleave pops and pushes so pending trees keep forming. */
+    int prev = -1;
+    size_t popped = 0;
+    size_t repushed = 0;
+    while (!pq_empty(&ppq))
+    {
+        struct val *v = PQ_ENTRY(pq_pop(&ppq), struct val, elem);
+        CHECK(v->val >= prev, true, bool, "%d");
+        prev = v->val;
+        ++popped;
+        if (popped % 3 == 0 && v->val < 249)
+        {
+            v->val = 249;
+            pq_push(&ppq, &v->elem);
+            ++repushed;
+        }
+        CHECK(pq_validate(&ppq), true, bool, "%d");
+    }
+    CHECK(popped, remaining + repushed, size_t, "%zu");
+    return PASS;
+}
+
 static enum test_result
 insert_shuffled(struct pqueue *ppq, struct val vals[], size_t const size,
                 int const larger_prime)
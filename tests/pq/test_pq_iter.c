@@ -0,0 +1,187 @@
+#include "pqueue.h"
+#include "test.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+struct val
+{
+    int id;
+    int val;
+    bool seen;
+    struct pq_elem elem;
+};
+
+struct scan
+{
+    size_t visits;
+    size_t repeats;
+    int threshold;
+};
+
+static enum test_result pq_test_for_each_empty(void);
+static enum test_result pq_test_for_each_visits_all(void);
+static enum test_result pq_test_find_if_early_exit(void);
+static enum test_result pq_test_for_each_bounded(void);
+static void mark_seen(struct pq_elem *, void *);
+static bool val_above(struct pq_elem const *, void *);
+static enum pq_threeway_cmp val_cmp(struct pq_elem const *,
+                                    struct pq_elem const *, void *);
+
+#define NUM_TESTS (size_t)4
+test_fn const all_tests[NUM_TESTS] = {
+    pq_test_for_each_empty,
+    pq_test_for_each_visits_all,
+    pq_test_find_if_early_exit,
+    pq_test_for_each_bounded,
+};
+
+int
+main()
+{
+    enum test_result res = PASS;
+    for (size_t i = 0; i < NUM_TESTS; ++i)
+    {
+        bool const fail = all_tests[i]() == FAIL;
+        if (fail)
+        {
+            res = FAIL;
+        }
+    }
+    return res;
+}
+
+static enum test_result
+pq_test_for_each_empty(void)
+{
+    struct pqueue ppq = PQ_INIT(PQLES, val_cmp, NULL);
+    struct scan sc = {.visits = 0, .repeats = 0, .threshold = 0};
+    pq_for_each(&ppq, mark_seen, &sc);
+    CHECK(sc.visits, 0, size_t, "%zu");
+    CHECK(pq_find_if(&ppq, val_above, &sc) == NULL, true, bool, "%d");
+    return PASS;
+}
+
+static enum test_result
+pq_test_for_each_visits_all(void)
+{
+    struct pqueue ppq = PQ_INIT(PQLES, val_cmp, NULL);
+    int const num_nodes = 1000;
+    int const prime = 1009;
+    struct val vals[num_nodes];
+    for (int i = 0, shuffled = 0; i < num_nodes; ++i)
+    {
+        vals[i].id = i;
+        vals[i].val = shuffled % 100;
+        vals[i].seen = false;
+        pq_push(&ppq, &vals[i].elem);
+        shuffled = (shuffled + prime) % num_nodes;
+    }
+    /* Pops and erases give the heap deep child rings to walk. The pops
+       take every value below 10 so erase only what remains. */
+    for (int i = 0; i < num_nodes / 10; ++i)
+    {
+        (void)pq_pop(&ppq);
+    }
+    for (int i = 1; i < num_nodes; i += 7)
+    {
+        if (vals[i].val >= 10)
+        {
+            (void)pq_erase(&ppq, &vals[i].elem);
+        }
+    }
+    CHECK(pq_validate(&ppq), true, bool, "%d");
+    struct scan sc = {.visits = 0, .repeats = 0, .threshold = 0};
+    pq_for_each(&ppq, mark_seen, &sc);
+    CHECK(sc.visits, pq_size(&ppq), size_t, "%zu");
+    CHECK(sc.repeats, 0, size_t, "%zu");
+    size_t seen = 0;
+    for (int i = 0; i < num_nodes; ++i)
+    {
+        seen += vals[i].seen;
+    }
+    CHECK(seen, pq_size(&ppq), size_t, "%zu");
+    CHECK(pq_validate(&ppq), true, bool, "%d");
+    return PASS;
+}
+
+static enum test_result
+pq_test_find_if_early_exit(void)
+{
+    struct pqueue ppq = PQ_INIT(PQLES, val_cmp, NULL);
+    int const num_nodes = 100;
+    struct val vals[num_nodes];
+    for (int i = 0; i < num_nodes; ++i)
+    {
+        vals[i].id = i;
+        vals[i].val = i;
+        pq_push(&ppq, &vals[i].elem);
+    }
+    /* The root of a min heap satisfies the predicate so we stop there. */
+    struct scan sc = {.visits = 0, .repeats = 0, .threshold = -1};
+    struct pq_elem *found = pq_find_if(&ppq, val_above, &sc);
+    CHECK(found == pq_front(&ppq), true, bool, "%d");
+    CHECK(sc.visits, 1, size_t, "%zu");
+    sc = (struct scan){.visits = 0, .repeats = 0, .threshold = num_nodes - 2};
+    found = pq_find_if(&ppq, val_above, &sc);
+    CHECK(found != NULL, true, bool, "%d");
+    CHECK(PQ_ENTRY(found, struct val, elem)->val, num_nodes - 1, int, "%d");
+    sc = (struct scan){.visits = 0, .repeats = 0, .threshold = num_nodes};
+    CHECK(pq_find_if(&ppq, val_above, &sc) == NULL, true, bool, "%d");
+    CHECK(sc.visits, pq_size(&ppq), size_t, "%zu");
+    CHECK(pq_validate(&ppq), true, bool, "%d");
+    return PASS;
+}
+
+static enum test_result
+pq_test_for_each_bounded(void)
+{
+    struct pq_elem *pending[PQ_PENDING_SLOTS] = {0};
+    struct pqueue ppq = PQ_INIT_BOUNDED(PQGRT, val_cmp, NULL, pending);
+    int const num_nodes = 77;
+    struct val vals[num_nodes];
+    for (int i = 0; i < num_nodes; ++i)
+    {
+        vals[i].id = i;
+        vals[i].val = i % 10;
+        vals[i].seen = false;
+        pq_push(&ppq, &vals[i].elem);
+    }
+    /* Most elements wait in pending trees and must still be visited. */
+    CHECK(pq_validate(&ppq), true, bool, "%d");
+    struct scan sc = {.visits = 0, .repeats = 0, .threshold = 0};
+    pq_for_each(&ppq, mark_seen, &sc);
+    CHECK(sc.visits, pq_size(&ppq), size_t, "%zu");
+    CHECK(sc.repeats, 0, size_t, "%zu");
+    sc = (struct scan){.visits = 0, .repeats = 0, .threshold = 100};
+    CHECK(pq_find_if(&ppq, val_above, &sc) == NULL, true, bool, "%d");
+    CHECK(sc.visits, pq_size(&ppq), size_t, "%zu");
+    return PASS;
+}
+
+static void
+mark_seen(struct pq_elem *e, void *aux)
+{
+    struct val *v = PQ_ENTRY(e, struct val, elem);
+    struct scan *sc = aux;
+    ++sc->visits;
+    sc->repeats += v->seen;
+    v->seen = true;
+}
+
+static bool
+val_above(struct pq_elem const *e, void *aux)
+{
+    struct scan *sc = aux;
+    ++sc->visits;
+    return PQ_ENTRY(e, struct val, elem)->val > sc->threshold;
+}
+
+static enum pq_threeway_cmp
+val_cmp(struct pq_elem const *a, struct pq_elem const *b, void *aux)
+{
+    (void)aux;
+    struct val *lhs = PQ_ENTRY(a, struct val, elem);
+    struct val *rhs = PQ_ENTRY(b, struct val, elem);
+    return (lhs->val > rhs->val) - (lhs->val < rhs->val);
+}
@@ -19,15 +19,16 @@ static enum test_result pq_test_priority_update(void);
 static enum test_result pq_test_priority_increase(void);
 static enum test_result pq_test_priority_decrease(void);
 static enum test_result pq_test_priority_removal(void);
+static enum test_result pq_test_pairing_strategies(void);
 static void val_update(struct pq_elem *, void *);
 static enum pq_threeway_cmp val_cmp(struct pq_elem const *,
                                     struct pq_elem const *, void *);
 
-#define NUM_TESTS (size_t)5
+#define NUM_TESTS (size_t)6
 test_fn const all_tests[NUM_TESTS] = {
     pq_test_insert_iterate_pop, pq_test_priority_update,
     pq_test_priority_removal,   pq_test_priority_increase,
-    pq_test_priority_decrease,
+    pq_test_priority_decrease,  pq_test_pairing_strategies,
 };
 
 int
@@ -215,6 +216,72 @@ pq_test_priority_decrease(void)
     return PASS;
 }
 
+static enum test_result
+pq_test_pairing_strategies(void)
+{
+    enum pq_pairing const strategies[4] = {
+        PQ_FRONT_TO_BACK,
+        PQ_TWO_PASS,
+        PQ_MULTIPASS,
+        PQ_AUXILIARY_TWO_PASS,
+    };
+    size_t const num_nodes = 500;
+    int const prime = 503;
+    struct val vals[num_nodes];
+    for (size_t s = 0; s < sizeof(strategies) / sizeof(strategies[0]); ++s)
+    {
+        struct pqueue pq = PQ_INIT_PAIRING(PQLES, val_cmp, NULL, strategies[s]);
+        CHECK(pq_pairing(&pq), strategies[s], enum pq_pairing, "%d");
+        size_t shuffled = prime % num_nodes;
+        for (size_t i = 0; i < num_nodes; ++i)
+        {
+            vals[shuffled].val = (int)(shuffled % 100) + 1000;
+            vals[shuffled].id = (int)shuffled;
+            pq_push(&pq, &vals[shuffled].elem);
+            shuffled = (shuffled + prime) % num_nodes;
+        }
+        CHECK(pq_validate(&pq), true, bool, "%d");
+        /* Pop a few so the auxiliary roots are consumed at least once. */
+        int prev = -1;
+        for (size_t i = 0; i < 10; ++i)
+        {
+            struct val *v = PQ_ENTRY(pq_pop(&pq), struct val, elem);
+            CHECK(v->val >= prev, true, bool, "%d");
+            prev = v->val;
+            CHECK(pq_validate(&pq), true, bool, "%d");
+        }
+        /* Decrease keys across the heap, some below the front, and erase
+           a few so cuts come from the children and the auxiliary roots. */
+        for (size_t i = 0; i < num_nodes; i += 3)
+        {
+            if (vals[i].val < prev)
+            {
+                continue;
+            }
+            int dec = vals[i].val - (int)(i % 1100);
+            (void)pq_decrease(&pq, &vals[i].elem, val_update, &dec);
+            CHECK(pq_validate(&pq), true, bool, "%d");
+            if (i % 7 == 0)
+            {
+                CHECK(pq_erase(&pq, &vals[i].elem) != NULL, true, bool, "%d");
+                CHECK(pq_validate(&pq), true, bool, "%d");
+            }
+        }
+        prev = -1000;
+        size_t popped = 0;
+        while (!pq_empty(&pq))
+        {
+            struct val *v = PQ_ENTRY(pq_pop(&pq), struct val, elem);
+            CHECK(v->val >= prev, true, bool, "%d");
+            prev = v->val;
+            ++popped;
+            CHECK(pq_validate(&pq), true, bool, "%d");
+        }
+        CHECK(popped > 0, true, bool, "%d");
+    }
+    return PASS;
+}
+
 static enum pq_threeway_cmp
 val_cmp(struct pq_elem const *a, struct pq_elem const *b, void *aux)
 {
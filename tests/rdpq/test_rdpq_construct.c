@@ -0,0 +1,106 @@
+#include "radix_pqueue.h"
+#include "test.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <inttypes.h>
+#include <stdint.h>
+
+struct val
+{
+    int id;
+    struct rdpq_elem elem;
+};
+
+static enum test_result rdpq_test_empty(void);
+static enum test_result rdpq_test_monotone_push(void);
+static enum test_result rdpq_test_profile(void);
+
+#define NUM_TESTS (size_t)3
+test_fn const all_tests[NUM_TESTS] = {
+    rdpq_test_empty,
+    rdpq_test_monotone_push,
+    rdpq_test_profile,
+};
+
+int
+main()
+{
+    enum test_result res = PASS;
+    for (size_t i = 0; i < NUM_TESTS; ++i)
+    {
+        bool const fail = all_tests[i]() == FAIL;
+        if (fail)
+        {
+            res = FAIL;
+        }
+    }
+    return res;
+}
+
+static enum test_result
+rdpq_test_empty(void)
+{
+    struct rdpqueue rdq = RDPQ_INIT();
+    CHECK(rdpq_empty(&rdq), true, bool, "%d");
+    CHECK(rdpq_front(&rdq) == NULL, true, bool, "%d");
+    CHECK(rdpq_pop(&rdq) == NULL, true, bool, "%d");
+    CHECK(rdpq_validate(&rdq), true, bool, "%d");
+    return PASS;
+}
+
+static enum test_result
+rdpq_test_monotone_push(void)
+{
+    struct rdpqueue rdq = RDPQ_INIT();
+    struct val vals[3];
+    CHECK(rdpq_push(&rdq, &vals[0].elem, 10), true, bool, "%d");
+    CHECK(rdpq_push(&rdq, &vals[1].elem, 20), true, bool, "%d");
+    CHECK(rdpq_pop(&rdq) == &vals[0].elem, true, bool, "%d");
+    CHECK(rdpq_last(&rdq), 10, uint64_t, "%" PRIu64);
+    /* A key below the last popped key breaks the promise. */
+    CHECK(rdpq_push(&rdq, &vals[2].elem, 9), false, bool, "%d");
+    CHECK(rdpq_size(&rdq), 1, size_t, "%zu");
+    CHECK(rdpq_push(&rdq, &vals[2].elem, 10), true, bool, "%d");
+    CHECK(rdpq_front(&rdq) == &vals[2].elem, true, bool, "%d");
+    CHECK(rdpq_validate(&rdq), true, bool, "%d");
+    CHECK(rdpq_decrease(&rdq, &vals[1].elem, 9), false, bool, "%d");
+    CHECK(rdpq_decrease(&rdq, &vals[1].elem, 21), false, bool, "%d");
+    CHECK(rdpq_decrease(&rdq, &vals[1].elem, 10), true, bool, "%d");
+    CHECK(rdpq_validate(&rdq), true, bool, "%d");
+    /* The largest key lands in the last bucket. */
+    CHECK(rdpq_push(&rdq, &vals[0].elem, UINT64_MAX), true, bool, "%d");
+    CHECK(rdpq_validate(&rdq), true, bool, "%d");
+    CHECK(rdpq_pop(&rdq) != NULL, true, bool, "%d");
+    CHECK(rdpq_pop(&rdq) != NULL, true, bool, "%d");
+    CHECK(rdpq_pop(&rdq) == &vals[0].elem, true, bool, "%d");
+    CHECK(rdpq_last(&rdq), UINT64_MAX, uint64_t, "%" PRIu64);
+    CHECK(rdpq_empty(&rdq), true, bool, "%d");
+    return PASS;
+}
+
+static enum test_result
+rdpq_test_profile(void)
+{
+    struct rdpqueue rdq = RDPQ_INIT();
+    struct val vals[10];
+    for (int i = 0; i < 10; ++i)
+    {
+        (void)rdpq_push(&rdq, &vals[i].elem, (uint64_t)(10 - i));
+    }
+    for (int i = 0; i < 10; ++i)
+    {
+        (void)rdpq_pop(&rdq);
+    }
+    struct rdpq_counters const c = rdpq_profile(&rdq);
+#ifdef CONTAINER_PROFILE
+    CHECK(c.redistributions > 0, true, bool, "%d");
+    CHECK(c.moves >= c.redistributions, true, bool, "%d");
+    rdpq_profile_reset(&rdq);
+    CHECK(rdpq_profile(&rdq).moves, 0, size_t, "%zu");
+#else
+    CHECK(c.redistributions, 0, size_t, "%zu");
+    CHECK(c.moves, 0, size_t, "%zu");
+#endif
+    return PASS;
+}
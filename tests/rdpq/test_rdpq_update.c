@@ -0,0 +1,169 @@
+#include "radix_pqueue.h"
+#include "test.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+struct val
+{
+    int id;
+    bool queued;
+    struct rdpq_elem elem;
+};
+
+static enum test_result rdpq_test_pop_sorted_dups(void);
+static enum test_result rdpq_test_erase_shuffled(void);
+static enum test_result rdpq_test_monotone_decrease(void);
+
+#define NUM_TESTS (size_t)3
+test_fn const all_tests[NUM_TESTS] = {
+    rdpq_test_pop_sorted_dups,
+    rdpq_test_erase_shuffled,
+    rdpq_test_monotone_decrease,
+};
+
+int
+main()
+{
+    enum test_result res = PASS;
+    for (size_t i = 0; i < NUM_TESTS; ++i)
+    {
+        bool const fail = all_tests[i]() == FAIL;
+        if (fail)
+        {
+            res = FAIL;
+        }
+    }
+    return res;
+}
+
+static enum test_result
+rdpq_test_pop_sorted_dups(void)
+{
+    struct rdpqueue rdq = RDPQ_INIT();
+    /* Seed the test with any integer for reproducible random test sequence
+       currently this will change every test. NOLINTNEXTLINE */
+    srand(time(NULL));
+    size_t const num_nodes = 1000;
+    struct val vals[num_nodes];
+    for (size_t i = 0; i < num_nodes; ++i)
+    {
+        /* Force duplicates. */
+        uint64_t const key = (uint64_t)(rand() % (num_nodes + 1)); // NOLINT
+        vals[i].id = (int)i;
+        CHECK(rdpq_push(&rdq, &vals[i].elem, key), true, bool, "%d");
+        CHECK(rdpq_validate(&rdq), true, bool, "%d");
+    }
+    uint64_t prev = 0;
+    size_t pop_count = 0;
+    while (!rdpq_empty(&rdq))
+    {
+        struct rdpq_elem const *const front = rdpq_front(&rdq);
+        struct rdpq_elem *const e = rdpq_pop(&rdq);
+        CHECK(front == e, true, bool, "%d");
+        CHECK(rdpq_key(e) >= prev, true, bool, "%d");
+        prev = rdpq_key(e);
+        ++pop_count;
+        CHECK(rdpq_validate(&rdq), true, bool, "%d");
+    }
+    CHECK(pop_count, num_nodes, size_t, "%zu");
+    return PASS;
+}
+
+static enum test_result
+rdpq_test_erase_shuffled(void)
+{
+    struct rdpqueue rdq = RDPQ_INIT();
+    size_t const size = 99;
+    size_t const prime = 101;
+    struct val vals[size];
+    size_t shuffled_index = prime % size;
+    for (size_t i = 0; i < size; ++i)
+    {
+        vals[shuffled_index].id = (int)shuffled_index;
+        CHECK(rdpq_push(&rdq, &vals[shuffled_index].elem,
+                        (uint64_t)(shuffled_index % 40) << 20),
+              true, bool, "%d");
+        CHECK(rdpq_validate(&rdq), true, bool, "%d");
+        shuffled_index = (shuffled_index + prime) % size;
+    }
+    /* Pop a few so the last key moves and the buckets are rebuilt. */
+    for (size_t i = 0; i < 5; ++i)
+    {
+        CHECK(rdpq_pop(&rdq) != NULL, true, bool, "%d");
+        CHECK(rdpq_validate(&rdq), true, bool, "%d");
+    }
+    size_t cur_size = rdpq_size(&rdq);
+    for (size_t i = 0; i < size; ++i)
+    {
+        if (rdpq_erase(&rdq, &vals[i].elem))
+        {
+            --cur_size;
+        }
+        CHECK(rdpq_validate(&rdq), true, bool, "%d");
+        CHECK(rdpq_size(&rdq), cur_size, size_t, "%zu");
+    }
+    CHECK(rdpq_empty(&rdq), true, bool, "%d");
+    CHECK(rdpq_erase(&rdq, &vals[0].elem) == NULL, true, bool, "%d");
+    return PASS;
+}
+
+/* The access pattern of Dijkstra's algorithm. Popped elements come back
+   with larger keys and keys in the heap are lowered but never below the
+   last popped key. */
+static enum test_result
+rdpq_test_monotone_decrease(void)
+{
+    struct rdpqueue rdq = RDPQ_INIT();
+    /* Seed the test with any integer for reproducible random test sequence
+       currently this will change every test. NOLINTNEXTLINE */
+    srand(time(NULL));
+    size_t const num_nodes = 1000;
+    struct val vals[num_nodes];
+    for (size_t i = 0; i < num_nodes; ++i)
+    {
+        vals[i].id = (int)i;
+        vals[i].queued = true;
+        CHECK(rdpq_push(&rdq, &vals[i].elem,
+                        (uint64_t)rand() % 100000), // NOLINT
+              true, bool, "%d");
+    }
+    CHECK(rdpq_validate(&rdq), true, bool, "%d");
+    uint64_t prev = 0;
+    for (size_t round = 0; round < 5000 && !rdpq_empty(&rdq); ++round)
+    {
+        struct rdpq_elem *const e = rdpq_pop(&rdq);
+        CHECK(rdpq_key(e) >= prev, true, bool, "%d");
+        prev = rdpq_key(e);
+        RDPQ_ENTRY(e, struct val, elem)->queued = false;
+        for (int d = 0; d < 4; ++d)
+        {
+            struct val *const v = &vals[(size_t)rand() % num_nodes]; // NOLINT
+            if (v->queued && rdpq_key(&v->elem) > prev)
+            {
+                uint64_t const span = rdpq_key(&v->elem) - prev;
+                uint64_t const key = prev + ((uint64_t)rand() % span); // NOLINT
+                CHECK(rdpq_decrease(&rdq, &v->elem, key), true, bool, "%d");
+            }
+        }
+        if (round % 2 == 0)
+        {
+            uint64_t const key = prev + ((uint64_t)rand() % 5000); // NOLINT
+            CHECK(rdpq_push(&rdq, e, key), true, bool, "%d");
+            RDPQ_ENTRY(e, struct val, elem)->queued = true;
+        }
+        CHECK(rdpq_validate(&rdq), true, bool, "%d");
+    }
+    while (!rdpq_empty(&rdq))
+    {
+        struct rdpq_elem *const e = rdpq_pop(&rdq);
+        CHECK(rdpq_key(e) >= prev, true, bool, "%d");
+        prev = rdpq_key(e);
+    }
+    CHECK(rdpq_validate(&rdq), true, bool, "%d");
+    return PASS;
+}
@@ -0,0 +1,80 @@
+#include "rank_pqueue.h"
+#include "test.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+struct val
+{
+    int id;
+    int val;
+    struct rkpq_elem elem;
+};
+
+static enum test_result rkpq_test_empty(void);
+static enum test_result rkpq_test_profile(void);
+static enum rkpq_threeway_cmp val_cmp(struct rkpq_elem const *,
+                                      struct rkpq_elem const *, void *);
+
+#define NUM_TESTS (size_t)2
+test_fn const all_tests[NUM_TESTS] = {rkpq_test_empty, rkpq_test_profile};
+
+int
+main()
+{
+    enum test_result res = PASS;
+    for (size_t i = 0; i < NUM_TESTS; ++i)
+    {
+        bool const fail = all_tests[i]() == FAIL;
+        if (fail)
+        {
+            res = FAIL;
+        }
+    }
+    return res;
+}
+
+static enum test_result
+rkpq_test_empty(void)
+{
+    struct rkpqueue pq = RKPQ_INIT(RKPQLES, val_cmp, NULL);
+    CHECK(rkpq_empty(&pq), true, bool, "%d");
+    return PASS;
+}
+
+static enum test_result
+rkpq_test_profile(void)
+{
+    struct rkpqueue pq = RKPQ_INIT(RKPQLES, val_cmp, NULL);
+    struct val vals[10];
+    for (int i = 0; i < 10; ++i)
+    {
+        vals[i].val = 10 - i;
+        rkpq_push(&pq, &vals[i].elem);
+    }
+    for (int i = 0; i < 10; ++i)
+    {
+        (void)rkpq_pop(&pq);
+    }
+    struct rkpq_counters const c = rkpq_profile(&pq);
+#ifdef CONTAINER_PROFILE
+    CHECK(c.links > 0, true, bool, "%d");
+    CHECK(c.cmps >= c.links, true, bool, "%d");
+    CHECK(c.cuts, 0, size_t, "%zu");
+    rkpq_profile_reset(&pq);
+    CHECK(rkpq_profile(&pq).cmps, 0, size_t, "%zu");
+#else
+    CHECK(c.cmps, 0, size_t, "%zu");
+    CHECK(c.links, 0, size_t, "%zu");
+#endif
+    return PASS;
+}
+
+static enum rkpq_threeway_cmp
+val_cmp(struct rkpq_elem const *a, struct rkpq_elem const *b, void *aux)
+{
+    (void)aux;
+    struct val *lhs = RKPQ_ENTRY(a, struct val, elem);
+    struct val *rhs = RKPQ_ENTRY(b, struct val, elem);
+    return (lhs->val > rhs->val) - (lhs->val < rhs->val);
+}
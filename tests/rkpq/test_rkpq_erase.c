@@ -0,0 +1,310 @@
+#include "rank_pqueue.h"
+#include "test.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+struct val
+{
+    int id;
+    int val;
+    struct rkpq_elem elem;
+};
+
+static enum test_result rkpq_test_insert_remove_four_dups(void);
+static enum test_result rkpq_test_insert_erase_shuffled(void);
+static enum test_result rkpq_test_pop_max(void);
+static enum test_result rkpq_test_pop_min(void);
+static enum test_result rkpq_test_delete_prime_shuffle_duplicates(void);
+static enum test_result rkpq_test_prime_shuffle(void);
+static enum test_result rkpq_test_weak_srand(void);
+static enum test_result insert_shuffled(struct rkpqueue *, struct val[], size_t,
+                                        int);
+static size_t inorder_fill(int[], size_t, struct rkpqueue *);
+static enum rkpq_threeway_cmp val_cmp(struct rkpq_elem const *,
+                                      struct rkpq_elem const *, void *);
+
+#define NUM_TESTS (size_t)7
+test_fn const all_tests[NUM_TESTS] = {
+    rkpq_test_insert_remove_four_dups,
+    rkpq_test_insert_erase_shuffled,
+    rkpq_test_pop_max,
+    rkpq_test_pop_min,
+    rkpq_test_delete_prime_shuffle_duplicates,
+    rkpq_test_prime_shuffle,
+    rkpq_test_weak_srand,
+};
+
+int
+main()
+{
+    enum test_result res = PASS;
+    for (size_t i = 0; i < NUM_TESTS; ++i)
+    {
+        bool const fail = all_tests[i]() == FAIL;
+        if (fail)
+        {
+            res = FAIL;
+        }
+    }
+    return res;
+}
+
+static enum test_result
+rkpq_test_insert_remove_four_dups(void)
+{
+    struct rkpqueue rpq = RKPQ_INIT(RKPQLES, val_cmp, NULL);
+    struct val three_vals[4];
+    for (int i = 0; i < 4; ++i)
+    {
+        three_vals[i].val = 0;
+        rkpq_push(&rpq, &three_vals[i].elem);
+        CHECK(rkpq_validate(&rpq), true, bool, "%d");
+        size_t const size = i + 1;
+        CHECK(rkpq_size(&rpq), size, size_t, "%zu");
+    }
+    CHECK(rkpq_size(&rpq), 4, size_t, "%zu");
+    for (int i = 0; i < 4; ++i)
+    {
+        three_vals[i].val = 0;
+        rkpq_pop(&rpq);
+        CHECK(rkpq_validate(&rpq), true, bool, "%d");
+    }
+    CHECK(rkpq_size(&rpq), 0ULL, size_t, "%zu");
+    return PASS;
+}
+
+static enum test_result
+rkpq_test_insert_erase_shuffled(void)
+{
+    struct rkpqueue rpq = RKPQ_INIT(RKPQLES, val_cmp, NULL);
+    size_t const size = 50;
+    int const prime = 53;
+    struct val vals[size];
+    CHECK(insert_shuffled(&rpq, vals, size, prime), PASS, enum test_result,
+          "%d");
+    struct val const *min = RKPQ_ENTRY(rkpq_front(&rpq), struct val, elem);
+    CHECK(min->val, 0, int, "%d");
+    int sorted_check[size];
+    CHECK(inorder_fill(sorted_check, size, &rpq), size, size_t, "%zu");
+    for (size_t i = 0; i < size; ++i)
+    {
+        CHECK(vals[i].val, sorted_check[i], int, "%d");
+    }
+    /* Now let's delete everything with no errors. */
+    for (size_t i = 0; i < size; ++i)
+    {
+        (void)rkpq_erase(&rpq, &vals[i].elem);
+        CHECK(rkpq_validate(&rpq), true, bool, "%d");
+    }
+    CHECK(rkpq_size(&rpq), 0ULL, size_t, "%zu");
+    return PASS;
+}
+
+static enum test_result
+rkpq_test_pop_max(void)
+{
+    struct rkpqueue rpq = RKPQ_INIT(RKPQLES, val_cmp, NULL);
+    size_t const size = 50;
+    int const prime = 53;
+    struct val vals[size];
+    CHECK(insert_shuffled(&rpq, vals, size, prime), PASS, enum test_result,
+          "%d");
+    struct val const *min = RKPQ_ENTRY(rkpq_front(&rpq), struct val, elem);
+    CHECK(min->val, 0, int, "%d");
+    int sorted_check[size];
+    CHECK(inorder_fill(sorted_check, size, &rpq), size, size_t, "%zu");
+    for (size_t i = 0; i < size; ++i)
+    {
+        CHECK(vals[i].val, sorted_check[i], int, "%d");
+    }
+    /* Now let's pop from the front of the queue until empty. */
+    for (size_t i = 0; i < size; ++i)
+    {
+        struct val const *front = RKPQ_ENTRY(rkpq_pop(&rpq), struct val, elem);
+        CHECK(front->val, vals[i].val, int, "%d");
+    }
+    CHECK(rkpq_empty(&rpq), true, bool, "%d");
+    return PASS;
+}
+
+static enum test_result
+rkpq_test_pop_min(void)
+{
+    struct rkpqueue rpq = RKPQ_INIT(RKPQLES, val_cmp, NULL);
+    size_t const size = 50;
+    int const prime = 53;
+    struct val vals[size];
+    CHECK(insert_shuffled(&rpq, vals, size, prime), PASS, enum test_result,
+          "%d");
+    struct val const *min = RKPQ_ENTRY(rkpq_front(&rpq), struct val, elem);
+    CHECK(min->val, 0, int, "%d");
+    int sorted_check[size];
+    CHECK(inorder_fill(sorted_check, size, &rpq), size, size_t, "%zu");
+    for (size_t i = 0; i < size; ++i)
+    {
+        CHECK(vals[i].val, sorted_check[i], int, "%d");
+    }
+    /* Now let's pop from the front of the queue until empty. */
+    for (size_t i = 0; i < size; ++i)
+    {
+        struct val const *front = RKPQ_ENTRY(rkpq_pop(&rpq), struct val, elem);
+        CHECK(front->val, vals[i].val, int, "%d");
+    }
+    CHECK(rkpq_empty(&rpq), true, bool, "%d");
+    return PASS;
+}
+
+static enum test_result
+rkpq_test_delete_prime_shuffle_duplicates(void)
+{
+    struct rkpqueue rpq = RKPQ_INIT(RKPQLES, val_cmp, NULL);
+    int const size = 99;
+    int const prime = 101;
+    /* Make the prime shuffle shorter than size for many duplicates. */
+    int const less = 77;
+    struct val vals[size];
+    int shuffled_index = prime % (size - less);
+    for (int i = 0; i < size; ++i)
+    {
+        vals[i].val = shuffled_index;
+        vals[i].id = i;
+        rkpq_push(&rpq, &vals[i].elem);
+        CHECK(rkpq_validate(&rpq), true, bool, "%d");
+        size_t const s = i + 1;
+        CHECK(rkpq_size(&rpq), s, size_t, "%zu");
+        /* Shuffle like this only on insertions to create more dups. */
+        shuffled_index = (shuffled_index + prime) % (size - less);
+    }
+
+    shuffled_index = prime % (size - less);
+    size_t cur_size = size;
+    for (int i = 0; i < size; ++i)
+    {
+        (void)rkpq_erase(&rpq, &vals[shuffled_index].elem);
+        CHECK(rkpq_validate(&rpq), true, bool, "%d");
+        --cur_size;
+        CHECK(rkpq_size(&rpq), cur_size, size_t, "%zu");
+        /* Shuffle normally here so we only remove each elem once. */
+        shuffled_index = (shuffled_index + prime) % size;
+    }
+    return PASS;
+}
+
+static enum test_result
+rkpq_test_prime_shuffle(void)
+{
+    struct rkpqueue rpq = RKPQ_INIT(RKPQLES, val_cmp, NULL);
+    int const size = 50;
+    int const prime = 53;
+    int const less = 10;
+    /* We want the tree to have a smattering of duplicates so
+       reduce the shuffle range so it will repeat some values. */
+    int shuffled_index = prime % (size - less);
+    struct val vals[size];
+    for (int i = 0; i < size; ++i)
+    {
+        vals[i].val = shuffled_index;
+        vals[i].id = shuffled_index;
+        rkpq_push(&rpq, &vals[i].elem);
+        CHECK(rkpq_validate(&rpq), true, bool, "%d");
+        shuffled_index = (shuffled_index + prime) % (size - less);
+    }
+    /* Now we go through and free all the elements in order but
+       their positions in the tree will be somewhat random */
+    size_t cur_size = size;
+    for (int i = 0; i < size; ++i)
+    {
+        CHECK(rkpq_erase(&rpq, &vals[i].elem) != NULL, true, bool, "%d");
+        CHECK(rkpq_validate(&rpq), true, bool, "%d");
+        --cur_size;
+        CHECK(rkpq_size(&rpq), cur_size, size_t, "%zu");
+    }
+    return PASS;
+}
+
+static enum test_result
+rkpq_test_weak_srand(void)
+{
+    struct rkpqueue rpq = RKPQ_INIT(RKPQLES, val_cmp, NULL);
+    /* Seed the test with any integer for reproducible randome test sequence
+       currently this will change every test. NOLINTNEXTLINE */
+    srand(time(NULL));
+    int const num_heap_elems = 1000;
+    struct val vals[num_heap_elems];
+    for (int i = 0; i < num_heap_elems; ++i)
+    {
+        vals[i].val = rand(); // NOLINT
+        vals[i].id = i;
+        rkpq_push(&rpq, &vals[i].elem);
+        CHECK(rkpq_validate(&rpq), true, bool, "%d");
+    }
+    for (int i = 0; i < num_heap_elems; ++i)
+    {
+        CHECK(rkpq_erase(&rpq, &vals[i].elem) != NULL, true, bool, "%d");
+        CHECK(rkpq_validate(&rpq), true, bool, "%d");
+    }
+    CHECK(rkpq_empty(&rpq), true, bool, "%d");
+    return PASS;
+}
+
+static enum test_result
+insert_shuffled(struct rkpqueue *rpq, struct val vals[], size_t const size,
+                int const larger_prime)
+{
+    /* Math magic ahead so that we iterate over every index
+       eventually but in a shuffled order. Not necessarily
+       randome but a repeatable sequence that makes it
+       easier to debug if something goes wrong. Think
+       of the prime number as a random seed, kind of. */
+    size_t shuffled_index = larger_prime % size;
+    for (size_t i = 0; i < size; ++i)
+    {
+        vals[shuffled_index].val = (int)shuffled_index;
+        rkpq_push(rpq, &vals[shuffled_index].elem);
+        CHECK(rkpq_size(rpq), i + 1, size_t, "%zu");
+        CHECK(rkpq_validate(rpq), true, bool, "%d");
+        shuffled_index = (shuffled_index + larger_prime) % size;
+    }
+    CHECK(rkpq_size(rpq), size, size_t, "%zu");
+    return PASS;
+}
+
+/* Iterative inorder traversal to check the heap is sorted. */
+static size_t
+inorder_fill(int vals[], size_t size, struct rkpqueue *rpq)
+{
+    if (rkpq_size(rpq) != size)
+    {
+        return 0;
+    }
+    size_t i = 0;
+    struct rkpqueue copy = RKPQ_INIT(rkpq_order(rpq), val_cmp, NULL);
+    while (!rkpq_empty(rpq))
+    {
+        struct rkpq_elem *const front = rkpq_pop(rpq);
+        CHECK(rkpq_validate(rpq), true, bool, "%d");
+        CHECK(rkpq_validate(&copy), true, bool, "%d");
+        vals[i++] = RKPQ_ENTRY(front, struct val, elem)->val;
+        rkpq_push(&copy, front);
+    }
+    while (!rkpq_empty(&copy))
+    {
+        rkpq_push(rpq, rkpq_pop(&copy));
+        CHECK(rkpq_validate(rpq), true, bool, "%d");
+        CHECK(rkpq_validate(&copy), true, bool, "%d");
+    }
+    return i;
+}
+
+static enum rkpq_threeway_cmp
+val_cmp(struct rkpq_elem const *a, struct rkpq_elem const *b, void *aux)
+{
+    (void)aux;
+    struct val *lhs = RKPQ_ENTRY(a, struct val, elem);
+    struct val *rhs = RKPQ_ENTRY(b, struct val, elem);
+    return (lhs->val > rhs->val) - (lhs->val < rhs->val);
+}
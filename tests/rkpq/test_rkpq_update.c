@@ -0,0 +1,293 @@
+#include "rank_pqueue.h"
+#include "test.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+struct val
+{
+    int id;
+    int val;
+    struct rkpq_elem elem;
+};
+
+static enum test_result rkpq_test_insert_iterate_pop(void);
+static enum test_result rkpq_test_priority_update(void);
+static enum test_result rkpq_test_priority_increase(void);
+static enum test_result rkpq_test_priority_decrease(void);
+static enum test_result rkpq_test_priority_removal(void);
+static enum test_result rkpq_test_decrease_heavy(void);
+static void val_update(struct rkpq_elem *, void *);
+static enum rkpq_threeway_cmp val_cmp(struct rkpq_elem const *,
+                                      struct rkpq_elem const *, void *);
+
+#define NUM_TESTS (size_t)6
+test_fn const all_tests[NUM_TESTS] = {
+    rkpq_test_insert_iterate_pop, rkpq_test_priority_update,
+    rkpq_test_priority_removal,   rkpq_test_priority_increase,
+    rkpq_test_priority_decrease,  rkpq_test_decrease_heavy,
+};
+
+int
+main()
+{
+    enum test_result res = PASS;
+    for (size_t i = 0; i < NUM_TESTS; ++i)
+    {
+        bool const fail = all_tests[i]() == FAIL;
+        if (fail)
+        {
+            res = FAIL;
+        }
+    }
+    return res;
+}
+
+static enum test_result
+rkpq_test_insert_iterate_pop(void)
+{
+    struct rkpqueue pq = RKPQ_INIT(RKPQLES, val_cmp, NULL);
+    /* Seed the test with any integer for reproducible random test sequence
+       currently this will change every test. NOLINTNEXTLINE */
+    srand(time(NULL));
+    size_t const num_nodes = 1000;
+    struct val vals[num_nodes];
+    for (size_t i = 0; i < num_nodes; ++i)
+    {
+        /* Force duplicates. */
+        vals[i].val = rand() % (num_nodes + 1); // NOLINT
+        vals[i].id = (int)i;
+        rkpq_push(&pq, &vals[i].elem);
+        CHECK(rkpq_validate(&pq), true, bool, "%d");
+    }
+    size_t pop_count = 0;
+    while (!rkpq_empty(&pq))
+    {
+        rkpq_pop(&pq);
+        ++pop_count;
+        CHECK(rkpq_validate(&pq), true, bool, "%d");
+    }
+    CHECK(pop_count, num_nodes, size_t, "%zu");
+    return PASS;
+}
+
+static enum test_result
+rkpq_test_priority_removal(void)
+{
+    struct rkpqueue pq = RKPQ_INIT(RKPQLES, val_cmp, NULL);
+    /* Seed the test with any integer for reproducible random test sequence
+       currently this will change every test. NOLINTNEXTLINE */
+    srand(time(NULL));
+    size_t const num_nodes = 1000;
+    struct val vals[num_nodes];
+    for (size_t i = 0; i < num_nodes; ++i)
+    {
+        /* Force duplicates. */
+        vals[i].val = rand() % (num_nodes + 1); // NOLINT
+        vals[i].id = (int)i;
+        rkpq_push(&pq, &vals[i].elem);
+        CHECK(rkpq_validate(&pq), true, bool, "%d");
+    }
+    int const limit = 400;
+    for (size_t val = 0; val < num_nodes; ++val)
+    {
+        struct rkpq_elem *i = &vals[val].elem;
+        struct val *cur = RKPQ_ENTRY(i, struct val, elem);
+        if (cur->val > limit)
+        {
+            (void)rkpq_erase(&pq, i);
+            CHECK(rkpq_validate(&pq), true, bool, "%d");
+        }
+    }
+    return PASS;
+}
+
+static enum test_result
+rkpq_test_priority_update(void)
+{
+    struct rkpqueue pq = RKPQ_INIT(RKPQLES, val_cmp, NULL);
+    /* Seed the test with any integer for reproducible random test sequence
+       currently this will change every test. NOLINTNEXTLINE */
+    srand(time(NULL));
+    size_t const num_nodes = 1000;
+    struct val vals[num_nodes];
+    for (size_t i = 0; i < num_nodes; ++i)
+    {
+        /* Force duplicates. */
+        vals[i].val = rand() % (num_nodes + 1); // NOLINT
+        vals[i].id = (int)i;
+        rkpq_push(&pq, &vals[i].elem);
+        CHECK(rkpq_validate(&pq), true, bool, "%d");
+    }
+    int const limit = 400;
+    for (size_t val = 0; val < num_nodes; ++val)
+    {
+        struct rkpq_elem *i = &vals[val].elem;
+        struct val *cur = RKPQ_ENTRY(i, struct val, elem);
+        int backoff = cur->val / 2;
+        if (cur->val > limit)
+        {
+            CHECK(rkpq_update(&pq, i, val_update, &backoff), true, bool, "%d");
+            CHECK(rkpq_validate(&pq), true, bool, "%d");
+        }
+    }
+    CHECK(rkpq_size(&pq), num_nodes, size_t, "%zu");
+    return PASS;
+}
+
+static enum test_result
+rkpq_test_priority_increase(void)
+{
+    struct rkpqueue pq = RKPQ_INIT(RKPQLES, val_cmp, NULL);
+    /* Seed the test with any integer for reproducible random test sequence
+       currently this will change every test. NOLINTNEXTLINE */
+    srand(time(NULL));
+    size_t const num_nodes = 1000;
+    struct val vals[num_nodes];
+    for (size_t i = 0; i < num_nodes; ++i)
+    {
+        /* Force duplicates. */
+        vals[i].val = rand() % (num_nodes + 1); // NOLINT
+        vals[i].id = (int)i;
+        rkpq_push(&pq, &vals[i].elem);
+        CHECK(rkpq_validate(&pq), true, bool, "%d");
+    }
+    int const limit = 400;
+    for (size_t val = 0; val < num_nodes; ++val)
+    {
+        struct rkpq_elem *i = &vals[val].elem;
+        struct val *cur = RKPQ_ENTRY(i, struct val, elem);
+        int inc = limit * 2;
+        int dec = cur->val / 2;
+        if (cur->val > limit)
+        {
+            CHECK(rkpq_decrease(&pq, i, val_update, &dec), true, bool, "%d");
+            CHECK(rkpq_validate(&pq), true, bool, "%d");
+        }
+        else
+        {
+            CHECK(rkpq_increase(&pq, i, val_update, &inc), true, bool, "%d");
+            CHECK(rkpq_validate(&pq), true, bool, "%d");
+        }
+    }
+    CHECK(rkpq_size(&pq), num_nodes, size_t, "%zu");
+    return PASS;
+}
+
+static enum test_result
+rkpq_test_priority_decrease(void)
+{
+    struct rkpqueue pq = RKPQ_INIT(RKPQGRT, val_cmp, NULL);
+    /* Seed the test with any integer for reproducible random test sequence
+       currently this will change every test. NOLINTNEXTLINE */
+    srand(time(NULL));
+    size_t const num_nodes = 1000;
+    struct val vals[num_nodes];
+    for (size_t i = 0; i < num_nodes; ++i)
+    {
+        /* Force duplicates. */
+        vals[i].val = rand() % (num_nodes + 1); // NOLINT
+        vals[i].id = (int)i;
+        rkpq_push(&pq, &vals[i].elem);
+        CHECK(rkpq_validate(&pq), true, bool, "%d");
+    }
+    int const limit = 400;
+    for (size_t val = 0; val < num_nodes; ++val)
+    {
+        struct rkpq_elem *i = &vals[val].elem;
+        struct val *cur = RKPQ_ENTRY(i, struct val, elem);
+        int inc = limit * 2;
+        int dec = cur->val / 2;
+        if (cur->val < limit)
+        {
+            CHECK(rkpq_increase(&pq, i, val_update, &inc), true, bool, "%d");
+            CHECK(rkpq_validate(&pq), true, bool, "%d");
+        }
+        else
+        {
+            CHECK(rkpq_decrease(&pq, i, val_update, &dec), true, bool, "%d");
+            CHECK(rkpq_validate(&pq), true, bool, "%d");
+        }
+    }
+    CHECK(rkpq_size(&pq), num_nodes, size_t, "%zu");
+    return PASS;
+}
+
+static enum test_result
+rkpq_test_decrease_heavy(void)
+{
+    struct rkpqueue pq = RKPQ_INIT(RKPQLES, val_cmp, NULL);
+    size_t const num_nodes = 500;
+    int const prime = 503;
+    struct val vals[num_nodes];
+    size_t shuffled = prime % num_nodes;
+    for (size_t i = 0; i < num_nodes; ++i)
+    {
+        vals[shuffled].val = (int)(shuffled % 100) + 1000;
+        vals[shuffled].id = (int)shuffled;
+        rkpq_push(&pq, &vals[shuffled].elem);
+        shuffled = (shuffled + prime) % num_nodes;
+    }
+    CHECK(rkpq_validate(&pq), true, bool, "%d");
+    /* Pop a few so the roots are linked into taller half trees. */
+    int prev = -1;
+    for (size_t i = 0; i < 10; ++i)
+    {
+        struct val *v = RKPQ_ENTRY(rkpq_pop(&pq), struct val, elem);
+        CHECK(v->val >= prev, true, bool, "%d");
+        prev = v->val;
+        CHECK(rkpq_validate(&pq), true, bool, "%d");
+    }
+    /* Decrease keys across the heap, some below the front, and erase a
+       few so the ranks are repaired after cuts from every depth. */
+    for (size_t i = 0; i < num_nodes; i += 3)
+    {
+        if (vals[i].val < prev)
+        {
+            continue;
+        }
+        int dec = vals[i].val - (int)(i % 1100);
+        (void)rkpq_decrease(&pq, &vals[i].elem, val_update, &dec);
+        CHECK(rkpq_validate(&pq), true, bool, "%d");
+        if (i % 7 == 0)
+        {
+            CHECK(rkpq_erase(&pq, &vals[i].elem) != NULL, true, bool, "%d");
+            CHECK(rkpq_validate(&pq), true, bool, "%d");
+        }
+    }
+    prev = -1000;
+    size_t popped = 0;
+    while (!rkpq_empty(&pq))
+    {
+        struct val *v = RKPQ_ENTRY(rkpq_pop(&pq), struct val, elem);
+        CHECK(v->val >= prev, true, bool, "%d");
+        prev = v->val;
+        ++popped;
+        CHECK(rkpq_validate(&pq), true, bool, "%d");
+    }
+    CHECK(popped > 0, true, bool, "%d");
+    /* An element outside of the heap is rejected. */
+    CHECK(rkpq_erase(&pq, &vals[0].elem) == NULL, true, bool, "%d");
+    CHECK(rkpq_decrease(&pq, &vals[0].elem, val_update, &prev), false, bool,
+          "%d");
+    return PASS;
+}
+
+static enum rkpq_threeway_cmp
+val_cmp(struct rkpq_elem const *a, struct rkpq_elem const *b, void *aux)
+{
+    (void)aux;
+    struct val *lhs = RKPQ_ENTRY(a, struct val, elem);
+    struct val *rhs = RKPQ_ENTRY(b, struct val, elem);
+    return (lhs->val > rhs->val) - (lhs->val < rhs->val);
+}
+
+static void
+val_update(struct rkpq_elem *a, void *aux)
+{
+    struct val *old = RKPQ_ENTRY(a, struct val, elem);
+    old->val = *(int *)aux;
+}
@@ -17,18 +17,20 @@ static enum test_result set_test_insert_one(void);
 static enum test_result set_test_insert_three(void);
 static enum test_result set_test_struct_getter(void);
 static enum test_result set_test_insert_shuffle(void);
+static enum test_result set_test_rebalance_sequential(void);
 static enum test_result insert_shuffled(struct set *, struct val[], size_t,
                                         int);
 static size_t inorder_fill(int vals[], size_t, struct set *);
 static set_threeway_cmp val_cmp(struct set_elem const *,
                                 struct set_elem const *, void *);
 
-#define NUM_TESTS ((size_t)4)
+#define NUM_TESTS ((size_t)5)
 test_fn const all_tests[NUM_TESTS] = {
     set_test_insert_one,
     set_test_insert_three,
     set_test_struct_getter,
     set_test_insert_shuffle,
+    set_test_rebalance_sequential,
 };
 
 int
@@ -118,6 +120,52 @@ set_test_insert_shuffle(void)
     return PASS;
 }
 
+static enum test_result
+set_test_rebalance_sequential(void)
+{
+    /* Sizes around powers of two exercise the partial bottom level. */
+    size_t const sizes[8] = {1, 2, 3, 7, 8, 100, 127, 128};
+    struct val vals[128];
+    for (size_t t = 0; t < 8; ++t)
+    {
+        size_t const n = sizes[t];
+        struct set s = SET_INIT(s, val_cmp, NULL);
+        set_rebalance(&s);
+        CHECK(set_stats(&s).nodes, 0, size_t, "%zu");
+        for (size_t i = 0; i < n; ++i)
+        {
+            vals[i].val = (int)i;
+            CHECK(set_insert(&s, &vals[i].elem), true, bool, "%d");
+        }
+        /* Sequential insertion is the anti-pattern leaving a spine. */
+        struct tree_stats st = set_stats(&s);
+        CHECK(st.nodes, n, size_t, "%zu");
+        CHECK(st.height, n, size_t, "%zu");
+        set_rebalance(&s);
+        CHECK(validate_tree(&s.t), true, bool, "%d");
+        st = set_stats(&s);
+        size_t min_height = 0;
+        for (size_t full = n; full; full >>= 1)
+        {
+            ++min_height;
+        }
+        CHECK(st.nodes, n, size_t, "%zu");
+        CHECK(st.height, min_height, size_t, "%zu");
+        CHECK(st.avg_depth <= (double)min_height, true, bool, "%d");
+        CHECK(st.dups, 0, size_t, "%zu");
+        int sorted_check[128];
+        CHECK(inorder_fill(sorted_check, n, &s), n, size_t, "%zu");
+        for (size_t i = 0; i < n; ++i)
+        {
+            CHECK(sorted_check[i], (int)i, int, "%d");
+        }
+        struct val key = {.val = (int)n / 2};
+        CHECK(set_contains(&s, &key.elem), true, bool, "%d");
+        CHECK(validate_tree(&s.t), true, bool, "%d");
+    }
+    return PASS;
+}
+
 static enum test_result
 insert_shuffled(struct set *s, struct val vals[], size_t const size,
                 int const larger_prime)
@@ -14,22 +14,32 @@ struct val
     struct set_elem elem;
 };
 
+struct visits
+{
+    struct set_elem *elems[100];
+    size_t n;
+};
+
 static enum test_result set_test_forward_iter(void);
 static enum test_result set_test_iterate_removal(void);
 static enum test_result set_test_iterate_remove_reinsert(void);
 static enum test_result set_test_valid_range(void);
 static enum test_result set_test_invalid_range(void);
 static enum test_result set_test_empty_range(void);
+static enum test_result set_test_cursor_matches_iter(void);
+static enum test_result set_test_for_each_matches_iter(void);
 static size_t inorder_fill(int[], size_t, struct set *);
 static enum test_result iterator_check(struct set *);
+static void record(struct set_elem *, void *);
 static set_threeway_cmp val_cmp(struct set_elem const *,
                                 struct set_elem const *, void *);
 
-#define NUM_TESTS ((size_t)6)
+#define NUM_TESTS ((size_t)8)
 test_fn const all_tests[NUM_TESTS] = {
     set_test_forward_iter, set_test_iterate_removal,
     set_test_valid_range,  set_test_invalid_range,
     set_test_empty_range,  set_test_iterate_remove_reinsert,
+    set_test_cursor_matches_iter, set_test_for_each_matches_iter,
 };
 
 int
@@ -82,6 +92,105 @@ set_test_forward_iter(void)
     return PASS;
 }
 
+static enum test_result
+set_test_cursor_matches_iter(void)
+{
+    struct set s = SET_INIT(s, val_cmp, NULL);
+    struct set_cursor c;
+    CHECK(set_cursor_begin(&s, &c) == set_end(&s), true, bool, "%d");
+    CHECK(set_cursor_next(&c) == set_end(&s), true, bool, "%d");
+    CHECK(set_cursor_rbegin(&s, &c) == set_end(&s), true, bool, "%d");
+    int const num_nodes = 100;
+    int const prime = 37;
+    struct val vals[num_nodes];
+    for (int i = 0, shuffled = 0; i < num_nodes; ++i)
+    {
+        vals[i].val = shuffled;
+        vals[i].id = i;
+        set_insert(&s, &vals[i].elem);
+        shuffled = (shuffled + prime) % num_nodes;
+    }
+    CHECK(validate_tree(&s.t), true, bool, "%d");
+    size_t visited = 0;
+    struct set_elem *i = set_begin(&s);
+    for (struct set_elem *e = set_cursor_begin(&s, &c); e != set_end(&s);
+         e = set_cursor_next(&c), i = set_next(&s, i), ++visited)
+    {
+        CHECK(e == i, true, bool, "%d");
+    }
+    CHECK(i == set_end(&s), true, bool, "%d");
+    CHECK(visited, set_size(&s), size_t, "%zu");
+    visited = 0;
+    i = set_rbegin(&s);
+    for (struct set_elem *e = set_cursor_rbegin(&s, &c); e != set_end(&s);
+         e = set_cursor_next(&c), i = set_rnext(&s, i), ++visited)
+    {
+        CHECK(e == i, true, bool, "%d");
+    }
+    CHECK(i == set_end(&s), true, bool, "%d");
+    CHECK(visited, set_size(&s), size_t, "%zu");
+    return PASS;
+}
+
+static enum test_result
+set_test_for_each_matches_iter(void)
+{
+    struct set s = SET_INIT(s, val_cmp, NULL);
+    struct visits v = {.n = 0};
+    set_for_each(&s, record, &v);
+    CHECK(v.n, 0, size_t, "%zu");
+    int const num_nodes = 100;
+    int const prime = 37;
+    struct val vals[num_nodes];
+    for (int i = 0, shuffled = 0; i < num_nodes; ++i)
+    {
+        vals[i].val = shuffled;
+        vals[i].id = i;
+        set_insert(&s, &vals[i].elem);
+        shuffled = (shuffled + prime) % num_nodes;
+    }
+    set_for_each(&s, record, &v);
+    CHECK(v.n, set_size(&s), size_t, "%zu");
+    size_t j = 0;
+    for (struct set_elem *i = set_begin(&s); i != set_end(&s);
+         i = set_next(&s, i), ++j)
+    {
+        CHECK(v.elems[j] == i, true, bool, "%d");
+    }
+    v.n = 0;
+    set_rfor_each(&s, record, &v);
+    CHECK(v.n, set_size(&s), size_t, "%zu");
+    j = 0;
+    for (struct set_elem *i = set_rbegin(&s); i != set_end(&s);
+         i = set_rnext(&s, i), ++j)
+    {
+        CHECK(v.elems[j] == i, true, bool, "%d");
+    }
+    struct val b = {.id = 0, .val = 20};
+    struct val e = {.id = 0, .val = 60};
+    struct set_range const range = set_equal_range(&s, &b.elem, &e.elem);
+    v.n = 0;
+    set_for_each_range(&s, &range, record, &v);
+    CHECK(v.n, 40, size_t, "%zu");
+    j = 0;
+    for (struct set_elem *i = set_begin_range(&range);
+         i != set_end_range(&range); i = set_next(&s, i), ++j)
+    {
+        CHECK(v.elems[j] == i, true, bool, "%d");
+    }
+    struct set_rrange const rrange = set_equal_rrange(&s, &e.elem, &b.elem);
+    v.n = 0;
+    set_for_each_rrange(&s, &rrange, record, &v);
+    CHECK(v.n, 40, size_t, "%zu");
+    j = 0;
+    for (struct set_elem *i = set_begin_rrange(&rrange);
+         i != set_end_rrange(&rrange); i = set_rnext(&s, i), ++j)
+    {
+        CHECK(v.elems[j] == i, true, bool, "%d");
+    }
+    return PASS;
+}
+
 static enum test_result
 set_test_iterate_removal(void)
 {
@@ -358,3 +467,10 @@ val_cmp(struct set_elem const *a, struct set_elem const *b, void *aux)
     struct val *rhs = SET_ENTRY(b, struct val, elem);
     return (lhs->val > rhs->val) - (lhs->val < rhs->val);
 }
+
+static void
+record(struct set_elem *e, void *aux)
+{
+    struct visits *v = aux;
+    v->elems[v->n++] = e;
+}
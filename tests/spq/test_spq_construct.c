@@ -0,0 +1,122 @@
+#include "sequence_pqueue.h"
+#include "test.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+struct val
+{
+    int id;
+    int val;
+    struct spq_elem elem;
+};
+
+static enum test_result spq_test_empty(void);
+static enum test_result spq_test_max_order(void);
+static enum test_result spq_test_profile(void);
+static enum sequence_pq_threeway_cmp val_cmp(struct spq_elem const *,
+                                             struct spq_elem const *, void *);
+
+#define NUM_TESTS (size_t)3
+test_fn const all_tests[NUM_TESTS] = {
+    spq_test_empty,
+    spq_test_max_order,
+    spq_test_profile,
+};
+
+int
+main()
+{
+    enum test_result res = PASS;
+    for (size_t i = 0; i < NUM_TESTS; ++i)
+    {
+        bool const fail = all_tests[i]() == FAIL;
+        if (fail)
+        {
+            res = FAIL;
+        }
+    }
+    return res;
+}
+
+static enum test_result
+spq_test_empty(void)
+{
+    struct sequence_pqueue spq;
+    spq_init(&spq, SPQLES, val_cmp, NULL);
+    CHECK(spq_empty(&spq), true, bool, "%d");
+    CHECK(spq_front(&spq) == NULL, true, bool, "%d");
+    CHECK(spq_pop(&spq) == NULL, true, bool, "%d");
+    CHECK(spq_validate(&spq), true, bool, "%d");
+    spq_clear(&spq, NULL);
+    return PASS;
+}
+
+/* Enough elements to spill the insertion heap into runs many times so the
+   max order is checked through flushes and refills, not just the heap. */
+static enum test_result
+spq_test_max_order(void)
+{
+    struct sequence_pqueue spq;
+    spq_init(&spq, SPQGRT, val_cmp, NULL);
+    size_t const size = (SPQ_INSERT_CAP * 5) + 3;
+    struct val vals[size];
+    size_t const prime = 10007;
+    size_t shuffled_index = prime % size;
+    for (size_t i = 0; i < size; ++i)
+    {
+        vals[shuffled_index].val = (int)shuffled_index;
+        CHECK(spq_push(&spq, &vals[shuffled_index].elem), true, bool, "%d");
+        shuffled_index = (shuffled_index + prime) % size;
+    }
+    CHECK(spq_validate(&spq), true, bool, "%d");
+    CHECK(spq_size(&spq), size, size_t, "%zu");
+    for (size_t i = size; i--;)
+    {
+        struct val const *const front
+            = SPQ_ENTRY(spq_pop(&spq), struct val, elem);
+        CHECK(front->val, (int)i, int, "%d");
+    }
+    CHECK(spq_empty(&spq), true, bool, "%d");
+    spq_clear(&spq, NULL);
+    return PASS;
+}
+
+static enum test_result
+spq_test_profile(void)
+{
+    struct sequence_pqueue spq;
+    spq_init(&spq, SPQLES, val_cmp, NULL);
+    size_t const size = SPQ_INSERT_CAP + 1;
+    struct val vals[size];
+    for (size_t i = 0; i < size; ++i)
+    {
+        vals[i].val = (int)(size - i);
+        CHECK(spq_push(&spq, &vals[i].elem), true, bool, "%d");
+    }
+    struct spq_counters const c = spq_profile(&spq);
+#ifdef CONTAINER_PROFILE
+    /* The last push finds the insertion heap full and sorts it into a run. */
+    CHECK(c.flushes, 1, size_t, "%zu");
+    CHECK(c.cmps > 0, true, bool, "%d");
+    CHECK(c.merge_moves, 0, size_t, "%zu");
+    (void)spq_pop(&spq);
+    CHECK(spq_profile(&spq).merge_moves, SPQ_DELETE_CAP, size_t, "%zu");
+    spq_profile_reset(&spq);
+    CHECK(spq_profile(&spq).cmps, 0, size_t, "%zu");
+#else
+    CHECK(c.cmps, 0, size_t, "%zu");
+    CHECK(c.flushes, 0, size_t, "%zu");
+#endif
+    spq_clear(&spq, NULL);
+    return PASS;
+}
+
+static enum sequence_pq_threeway_cmp
+val_cmp(struct spq_elem const *a, struct spq_elem const *b, void *aux)
+{
+    (void)aux;
+    struct val *lhs = SPQ_ENTRY(a, struct val, elem);
+    struct val *rhs = SPQ_ENTRY(b, struct val, elem);
+    return (lhs->val > rhs->val) - (lhs->val < rhs->val);
+}
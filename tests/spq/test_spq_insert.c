@@ -0,0 +1,172 @@
+#include "sequence_pqueue.h"
+#include "test.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <time.h>
+
+struct val
+{
+    int id;
+    int val;
+    struct spq_elem elem;
+};
+
+static enum test_result spq_test_level_merges(void);
+static enum test_result spq_test_push_pop_interleaved(void);
+static enum test_result spq_test_clear_destroys_all(void);
+static enum sequence_pq_threeway_cmp val_cmp(struct spq_elem const *,
+                                             struct spq_elem const *, void *);
+static void count_destroyed(struct spq_elem *);
+
+static size_t destroyed;
+
+#define NUM_TESTS (size_t)3
+test_fn const all_tests[NUM_TESTS] = {
+    spq_test_level_merges,
+    spq_test_push_pop_interleaved,
+    spq_test_clear_destroys_all,
+};
+
+int
+main()
+{
+    enum test_result res = PASS;
+    for (size_t i = 0; i < NUM_TESTS; ++i)
+    {
+        bool const fail = all_tests[i]() == FAIL;
+        if (fail)
+        {
+            res = FAIL;
+        }
+    }
+    return res;
+}
+
+/* Pushing past SPQ_INSERT_CAP * SPQ_WAYS elements fills level 0 and forces
+   merges onto level 1. Random values with many duplicates must still come
+   out in order. */
+static enum test_result
+spq_test_level_merges(void)
+{
+    struct sequence_pqueue spq;
+    spq_init(&spq, SPQLES, val_cmp, NULL);
+    size_t const size = (SPQ_INSERT_CAP * SPQ_WAYS * 3) + 17;
+    struct val *const vals = malloc(size * sizeof(struct val));
+    CHECK(vals != NULL, true, bool, "%d");
+    /* Seed the test with any integer for reproducible randome test sequence
+       currently this will change every test. NOLINTNEXTLINE */
+    srand(time(NULL));
+    for (size_t i = 0; i < size; ++i)
+    {
+        vals[i].val = rand() % 1000; // NOLINT
+        vals[i].id = (int)i;
+        CHECK(spq_push(&spq, &vals[i].elem), true, bool, "%d");
+        if (i % SPQ_INSERT_CAP == 0)
+        {
+            CHECK(spq_validate(&spq), true, bool, "%d");
+        }
+    }
+    CHECK(spq_validate(&spq), true, bool, "%d");
+    int prev = -1;
+    for (size_t i = 0; i < size; ++i)
+    {
+        struct val const *const front
+            = SPQ_ENTRY(spq_pop(&spq), struct val, elem);
+        CHECK(front->val >= prev, true, bool, "%d");
+        prev = front->val;
+        if (i % SPQ_INSERT_CAP == 0)
+        {
+            CHECK(spq_validate(&spq), true, bool, "%d");
+        }
+    }
+    CHECK(spq_empty(&spq), true, bool, "%d");
+    spq_clear(&spq, NULL);
+    free(vals);
+    return PASS;
+}
+
+/* New elements that beat everything in the deletion buffer must surface
+   first even after a flush merges the buffer back into a run. */
+static enum test_result
+spq_test_push_pop_interleaved(void)
+{
+    struct sequence_pqueue spq;
+    spq_init(&spq, SPQLES, val_cmp, NULL);
+    size_t const size = SPQ_INSERT_CAP * 8;
+    struct val *const vals = malloc(size * sizeof(struct val));
+    CHECK(vals != NULL, true, bool, "%d");
+    size_t pushed = 0;
+    for (; pushed < size / 2; ++pushed)
+    {
+        vals[pushed].val = (int)(size + pushed);
+        CHECK(spq_push(&spq, &vals[pushed].elem), true, bool, "%d");
+    }
+    /* Pull a few so the deletion buffer is partly consumed. */
+    for (size_t i = 0; i < 3; ++i)
+    {
+        struct val const *const front
+            = SPQ_ENTRY(spq_pop(&spq), struct val, elem);
+        CHECK(front->val, (int)(size + i), int, "%d");
+    }
+    /* Now push smaller values until the insertion heap flushes twice. */
+    int next_small = (int)size;
+    for (; pushed < size; ++pushed)
+    {
+        vals[pushed].val = --next_small;
+        CHECK(spq_push(&spq, &vals[pushed].elem), true, bool, "%d");
+        CHECK(SPQ_ENTRY(spq_front(&spq), struct val, elem)->val, next_small,
+              int, "%d");
+    }
+    CHECK(spq_validate(&spq), true, bool, "%d");
+    int prev = next_small - 1;
+    while (!spq_empty(&spq))
+    {
+        struct val const *const front
+            = SPQ_ENTRY(spq_pop(&spq), struct val, elem);
+        CHECK(front->val > prev, true, bool, "%d");
+        prev = front->val;
+    }
+    spq_clear(&spq, NULL);
+    free(vals);
+    return PASS;
+}
+
+static enum test_result
+spq_test_clear_destroys_all(void)
+{
+    struct sequence_pqueue spq;
+    spq_init(&spq, SPQLES, val_cmp, NULL);
+    size_t const size = (SPQ_INSERT_CAP * 3) + 5;
+    struct val *const vals = malloc(size * sizeof(struct val));
+    CHECK(vals != NULL, true, bool, "%d");
+    for (size_t i = 0; i < size; ++i)
+    {
+        vals[i].val = (int)(i % 7);
+        CHECK(spq_push(&spq, &vals[i].elem), true, bool, "%d");
+    }
+    (void)spq_pop(&spq);
+    destroyed = 0;
+    spq_clear(&spq, count_destroyed);
+    CHECK(destroyed, size - 1, size_t, "%zu");
+    CHECK(spq_empty(&spq), true, bool, "%d");
+    free(vals);
+    return PASS;
+}
+
+static enum sequence_pq_threeway_cmp
+val_cmp(struct spq_elem const *a, struct spq_elem const *b, void *aux)
+{
+    (void)aux;
+    struct val *lhs = SPQ_ENTRY(a, struct val, elem);
+    struct val *rhs = SPQ_ENTRY(b, struct val, elem);
+    return (lhs->val > rhs->val) - (lhs->val < rhs->val);
+}
+
+static void
+count_destroyed(struct spq_elem *e)
+{
+    (void)e;
+    ++destroyed;
+}
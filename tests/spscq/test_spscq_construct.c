@@ -0,0 +1,139 @@
+#include "spsc_queue.h"
+#include "test.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+static enum test_result spscq_test_init(void);
+static enum test_result spscq_test_full_empty(void);
+static enum test_result spscq_test_batch_wrap(void);
+static enum test_result spscq_test_front(void);
+
+#define NUM_TESTS (size_t)4
+test_fn const all_tests[NUM_TESTS] = {
+    spscq_test_init,
+    spscq_test_full_empty,
+    spscq_test_batch_wrap,
+    spscq_test_front,
+};
+
+int
+main()
+{
+    enum test_result res = PASS;
+    for (size_t i = 0; i < NUM_TESTS; ++i)
+    {
+        bool const fail = all_tests[i]() == FAIL;
+        if (fail)
+        {
+            res = FAIL;
+        }
+    }
+    return res;
+}
+
+static enum test_result
+spscq_test_init(void)
+{
+    struct spsc_queue q;
+    CHECK(spscq_init(&q, 0, 8), false, bool, "%d");
+    CHECK(spscq_init(&q, sizeof(int), 0), false, bool, "%d");
+    CHECK(spscq_init(&q, sizeof(int), SIZE_MAX), false, bool, "%d");
+    CHECK(spscq_init(&q, sizeof(int), 100), true, bool, "%d");
+    CHECK(spscq_capacity(&q), 128, size_t, "%zu");
+    CHECK(spscq_empty(&q), true, bool, "%d");
+    int out = 0;
+    CHECK(spscq_pop(&q, &out), false, bool, "%d");
+    spscq_free(&q);
+    CHECK(spscq_init(&q, sizeof(int), 64), true, bool, "%d");
+    CHECK(spscq_capacity(&q), 64, size_t, "%zu");
+    spscq_free(&q);
+    return PASS;
+}
+
+/* A push to a full ring fails and leaves it as it was. */
+static enum test_result
+spscq_test_full_empty(void)
+{
+    struct spsc_queue q;
+    CHECK(spscq_init(&q, sizeof(int), 16), true, bool, "%d");
+    for (int i = 0; i < 16; ++i)
+    {
+        CHECK(spscq_push(&q, &i), true, bool, "%d");
+    }
+    int const extra = 99;
+    CHECK(spscq_push(&q, &extra), false, bool, "%d");
+    CHECK(spscq_size(&q), 16, size_t, "%zu");
+    for (int i = 0; i < 16; ++i)
+    {
+        int out = -1;
+        CHECK(spscq_pop(&q, &out), true, bool, "%d");
+        CHECK(out, i, int, "%d");
+    }
+    int out = -1;
+    CHECK(spscq_pop(&q, &out), false, bool, "%d");
+    CHECK(spscq_empty(&q), true, bool, "%d");
+    spscq_free(&q);
+    return PASS;
+}
+
+/* Batches of a size that does not divide the capacity wrap around the end
+   of the ring and are cut short when the ring fills or runs out. */
+static enum test_result
+spscq_test_batch_wrap(void)
+{
+    struct spsc_queue q;
+    CHECK(spscq_init(&q, sizeof(size_t), 32), true, bool, "%d");
+    size_t in[7];
+    size_t out[7];
+    size_t next_in = 0;
+    size_t next_out = 0;
+    for (int round = 0; round < 100; ++round)
+    {
+        for (size_t i = 0; i < 7; ++i)
+        {
+            in[i] = next_in + i;
+        }
+        next_in += spscq_push_n(&q, in, 7);
+        size_t const got = spscq_pop_n(&q, out, round % 2 ? 7 : 3);
+        for (size_t i = 0; i < got; ++i)
+        {
+            CHECK(out[i], next_out + i, size_t, "%zu");
+        }
+        next_out += got;
+        CHECK(spscq_size(&q), next_in - next_out, size_t, "%zu");
+    }
+    for (size_t got = 0; (got = spscq_pop_n(&q, out, 7));)
+    {
+        for (size_t i = 0; i < got; ++i)
+        {
+            CHECK(out[i], next_out + i, size_t, "%zu");
+        }
+        next_out += got;
+    }
+    CHECK(next_out, next_in, size_t, "%zu");
+    CHECK(spscq_empty(&q), true, bool, "%d");
+    spscq_free(&q);
+    return PASS;
+}
+
+static enum test_result
+spscq_test_front(void)
+{
+    struct spsc_queue q;
+    CHECK(spscq_init(&q, sizeof(int), 4), true, bool, "%d");
+    CHECK(spscq_front(&q) == NULL, true, bool, "%d");
+    int const a = 7;
+    int const b = 8;
+    CHECK(spscq_push(&q, &a), true, bool, "%d");
+    CHECK(spscq_push(&q, &b), true, bool, "%d");
+    CHECK(*(int *)spscq_front(&q), 7, int, "%d");
+    int out = 0;
+    CHECK(spscq_pop(&q, &out), true, bool, "%d");
+    CHECK(*(int *)spscq_front(&q), 8, int, "%d");
+    CHECK(spscq_pop(&q, &out), true, bool, "%d");
+    CHECK(spscq_front(&q) == NULL, true, bool, "%d");
+    spscq_free(&q);
+    return PASS;
+}
@@ -0,0 +1,129 @@
+/* sched_yield so a spinning side lets the other run on a single core. */
+#define _POSIX_C_SOURCE 200809L
+
+#include "spsc_queue.h"
+#include "test.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* The producer side of a run. A batch of 1 uses the single element calls. */
+struct producer
+{
+    struct spsc_queue *q;
+    size_t total;
+    size_t batch;
+};
+
+static enum test_result spscq_test_single(void);
+static enum test_result spscq_test_batches(void);
+static enum test_result run_pair(size_t, size_t, size_t);
+static void *produce(void *);
+
+#define TOTAL (size_t)200000
+
+#define NUM_TESTS (size_t)2
+test_fn const all_tests[NUM_TESTS] = {
+    spscq_test_single,
+    spscq_test_batches,
+};
+
+int
+main()
+{
+    enum test_result res = PASS;
+    for (size_t i = 0; i < NUM_TESTS; ++i)
+    {
+        bool const fail = all_tests[i]() == FAIL;
+        if (fail)
+        {
+            res = FAIL;
+        }
+    }
+    return res;
+}
+
+/* A small ring so the producer often finds it full. */
+static enum test_result
+spscq_test_single(void)
+{
+    return run_pair(8, 1, 1);
+}
+
+/* Batch sizes that do not divide the capacity so runs wrap. */
+static enum test_result
+spscq_test_batches(void)
+{
+    return run_pair(64, 13, 9);
+}
+
+/* The producer sends 0 to TOTAL - 1 and the consumer on this thread must
+   see every number once and in order. */
+static enum test_result
+run_pair(size_t const capacity, size_t const push_batch,
+         size_t const pop_batch)
+{
+    struct spsc_queue q;
+    CHECK(spscq_init(&q, sizeof(size_t), capacity), true, bool, "%d");
+    struct producer p = {.q = &q, .total = TOTAL, .batch = push_batch};
+    pthread_t thread;
+    CHECK(pthread_create(&thread, NULL, produce, &p), 0, int, "%d");
+    size_t buf[16];
+    size_t next = 0;
+    while (next < TOTAL)
+    {
+        size_t got = 0;
+        if (pop_batch == 1)
+        {
+            got = spscq_pop(&q, buf);
+        }
+        else
+        {
+            got = spscq_pop_n(&q, buf, pop_batch);
+        }
+        if (!got)
+        {
+            (void)sched_yield();
+        }
+        for (size_t i = 0; i < got; ++i)
+        {
+            CHECK(buf[i], next, size_t, "%zu");
+            ++next;
+        }
+    }
+    CHECK(pthread_join(thread, NULL), 0, int, "%d");
+    CHECK(spscq_empty(&q), true, bool, "%d");
+    spscq_free(&q);
+    return PASS;
+}
+
+static void *
+produce(void *const arg)
+{
+    struct producer *const p = arg;
+    size_t buf[16];
+    for (size_t sent = 0; sent < p->total;)
+    {
+        size_t n = p->total - sent < p->batch ? p->total - sent : p->batch;
+        for (size_t i = 0; i < n; ++i)
+        {
+            buf[i] = sent + i;
+        }
+        if (p->batch == 1)
+        {
+            n = spscq_push(p->q, buf);
+        }
+        else
+        {
+            n = spscq_push_n(p->q, buf, n);
+        }
+        if (!n)
+        {
+            (void)sched_yield();
+        }
+        sent += n;
+    }
+    return NULL;
+}
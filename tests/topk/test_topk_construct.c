@@ -0,0 +1,72 @@
+#include "test.h"
+#include "topk.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+struct val
+{
+    int id;
+    int val;
+    struct depq_elem elem;
+};
+
+static enum test_result topk_test_empty(void);
+static enum test_result topk_test_zero_capacity(void);
+static dpq_threeway_cmp val_cmp(struct depq_elem const *,
+                                struct depq_elem const *, void *);
+
+#define NUM_TESTS ((size_t)2)
+test_fn const all_tests[NUM_TESTS] = {
+    topk_test_empty,
+    topk_test_zero_capacity,
+};
+
+int
+main()
+{
+    enum test_result res = PASS;
+    for (size_t i = 0; i < NUM_TESTS; ++i)
+    {
+        bool const fail = all_tests[i]() == FAIL;
+        if (fail)
+        {
+            res = FAIL;
+        }
+    }
+    return res;
+}
+
+static enum test_result
+topk_test_empty(void)
+{
+    struct topk tk = TOPK_INIT(tk, 10, val_cmp, NULL);
+    CHECK(topk_empty(&tk), true, bool, "%d");
+    CHECK(topk_full(&tk), false, bool, "%d");
+    CHECK(topk_size(&tk), 0, size_t, "%zu");
+    CHECK(topk_capacity(&tk), 10, size_t, "%zu");
+    CHECK(topk_min(&tk) == NULL, true, bool, "%d");
+    CHECK(topk_begin(&tk) == topk_end(&tk), true, bool, "%d");
+    CHECK(topk_validate(&tk), true, bool, "%d");
+    return PASS;
+}
+
+static enum test_result
+topk_test_zero_capacity(void)
+{
+    struct topk tk = TOPK_INIT(tk, 0, val_cmp, NULL);
+    struct val single = {.id = 0, .val = 0};
+    CHECK(topk_push(&tk, &single.elem) == &single.elem, true, bool, "%d");
+    CHECK(topk_empty(&tk), true, bool, "%d");
+    CHECK(topk_validate(&tk), true, bool, "%d");
+    return PASS;
+}
+
+static dpq_threeway_cmp
+val_cmp(struct depq_elem const *a, struct depq_elem const *b, void *aux)
+{
+    (void)aux;
+    struct val *lhs = DEPQ_ENTRY(a, struct val, elem);
+    struct val *rhs = DEPQ_ENTRY(b, struct val, elem);
+    return (lhs->val > rhs->val) - (lhs->val < rhs->val);
+}
@@ -0,0 +1,230 @@
+#include "test.h"
+#include "topk.h"
+#include "tree.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <time.h>
+
+struct val
+{
+    int id;
+    int val;
+    struct depq_elem elem;
+};
+
+static enum test_result topk_test_fill_then_reject(void);
+static enum test_result topk_test_evict_min(void);
+static enum test_result topk_test_evict_round_robin(void);
+static enum test_result topk_test_capacity_one(void);
+static enum test_result topk_test_stream_reuse(void);
+static dpq_threeway_cmp val_cmp(struct depq_elem const *,
+                                struct depq_elem const *, void *);
+
+#define NUM_TESTS ((size_t)5)
+test_fn const all_tests[NUM_TESTS] = {
+    topk_test_fill_then_reject, topk_test_evict_min,
+    topk_test_evict_round_robin, topk_test_capacity_one,
+    topk_test_stream_reuse,
+};
+
+int
+main()
+{
+    enum test_result res = PASS;
+    for (size_t i = 0; i < NUM_TESTS; ++i)
+    {
+        bool const fail = all_tests[i]() == FAIL;
+        if (fail)
+        {
+            res = FAIL;
+        }
+    }
+    return res;
+}
+
+static enum test_result
+topk_test_fill_then_reject(void)
+{
+    struct topk tk = TOPK_INIT(tk, 5, val_cmp, NULL);
+    struct val vals[5];
+    for (int i = 0; i < 5; ++i)
+    {
+        vals[i].id = i;
+        vals[i].val = 10 + i;
+        CHECK(topk_push(&tk, &vals[i].elem) == NULL, true, bool, "%d");
+        CHECK(topk_validate(&tk), true, bool, "%d");
+    }
+    CHECK(topk_full(&tk), true, bool, "%d");
+    CHECK(DEPQ_ENTRY(topk_min(&tk), struct val, elem)->val, 10, int, "%d");
+    /* Smaller elements and ties with the threshold are handed back. */
+    struct val smaller = {.id = 5, .val = 3};
+    struct val tie = {.id = 6, .val = 10};
+    CHECK(topk_push(&tk, &smaller.elem) == &smaller.elem, true, bool, "%d");
+    CHECK(topk_push(&tk, &tie.elem) == &tie.elem, true, bool, "%d");
+    CHECK(topk_size(&tk), 5, size_t, "%zu");
+    CHECK(topk_validate(&tk), true, bool, "%d");
+    int j = 14;
+    for (struct depq_elem *e = topk_begin(&tk); e != topk_end(&tk);
+         e = topk_next(&tk, e), --j)
+    {
+        CHECK(DEPQ_ENTRY(e, struct val, elem)->val, j, int, "%d");
+    }
+    CHECK(j, 9, int, "%d");
+    return PASS;
+}
+
+static enum test_result
+topk_test_evict_min(void)
+{
+    struct topk tk = TOPK_INIT(tk, 4, val_cmp, NULL);
+    struct val vals[4] = {
+        {.id = 0, .val = 50},
+        {.id = 1, .val = 20},
+        {.id = 2, .val = 40},
+        {.id = 3, .val = 30},
+    };
+    for (int i = 0; i < 4; ++i)
+    {
+        CHECK(topk_push(&tk, &vals[i].elem) == NULL, true, bool, "%d");
+    }
+    /* A new element below the remaining minimum becomes the threshold. */
+    struct val mid = {.id = 4, .val = 25};
+    struct depq_elem *out = topk_push(&tk, &mid.elem);
+    CHECK(DEPQ_ENTRY(out, struct val, elem)->id, 1, int, "%d");
+    CHECK(DEPQ_ENTRY(topk_min(&tk), struct val, elem)->id, 4, int, "%d");
+    CHECK(topk_validate(&tk), true, bool, "%d");
+    struct val big = {.id = 5, .val = 99};
+    out = topk_push(&tk, &big.elem);
+    CHECK(DEPQ_ENTRY(out, struct val, elem)->id, 4, int, "%d");
+    CHECK(DEPQ_ENTRY(topk_min(&tk), struct val, elem)->id, 3, int, "%d");
+    CHECK(topk_validate(&tk), true, bool, "%d");
+    int const ascending[4] = {30, 40, 50, 99};
+    int j = 0;
+    for (struct depq_elem *e = topk_rbegin(&tk); e != topk_end(&tk);
+         e = topk_rnext(&tk, e), ++j)
+    {
+        CHECK(DEPQ_ENTRY(e, struct val, elem)->val, ascending[j], int, "%d");
+    }
+    CHECK(j, 4, int, "%d");
+    return PASS;
+}
+
+static enum test_result
+topk_test_evict_round_robin(void)
+{
+    struct topk tk = TOPK_INIT(tk, 5, val_cmp, NULL);
+    struct val vals[5] = {
+        {.id = 0, .val = 1}, {.id = 1, .val = 7}, {.id = 2, .val = 1},
+        {.id = 3, .val = 1}, {.id = 4, .val = 9},
+    };
+    for (int i = 0; i < 5; ++i)
+    {
+        CHECK(topk_push(&tk, &vals[i].elem) == NULL, true, bool, "%d");
+    }
+    /* The threshold is the first of the tied elements to arrive and the
+       tied elements leave in the order they arrived. */
+    CHECK(DEPQ_ENTRY(topk_min(&tk), struct val, elem)->id, 0, int, "%d");
+    struct val more[3] = {
+        {.id = 5, .val = 5},
+        {.id = 6, .val = 5},
+        {.id = 7, .val = 5},
+    };
+    int const expected_out[3] = {0, 2, 3};
+    for (int i = 0; i < 3; ++i)
+    {
+        struct depq_elem *out = topk_push(&tk, &more[i].elem);
+        CHECK(DEPQ_ENTRY(out, struct val, elem)->id, expected_out[i], int,
+              "%d");
+        CHECK(topk_validate(&tk), true, bool, "%d");
+    }
+    CHECK(DEPQ_ENTRY(topk_min(&tk), struct val, elem)->id, 5, int, "%d");
+    struct val last = {.id = 8, .val = 6};
+    CHECK(DEPQ_ENTRY(topk_push(&tk, &last.elem), struct val, elem)->id, 5,
+          int, "%d");
+    CHECK(DEPQ_ENTRY(topk_min(&tk), struct val, elem)->id, 6, int, "%d");
+    CHECK(topk_validate(&tk), true, bool, "%d");
+    return PASS;
+}
+
+static enum test_result
+topk_test_capacity_one(void)
+{
+    struct topk tk = TOPK_INIT(tk, 1, val_cmp, NULL);
+    struct val vals[4] = {
+        {.id = 0, .val = 3},
+        {.id = 1, .val = 2},
+        {.id = 2, .val = 8},
+        {.id = 3, .val = 8},
+    };
+    CHECK(topk_push(&tk, &vals[0].elem) == NULL, true, bool, "%d");
+    CHECK(topk_push(&tk, &vals[1].elem) == &vals[1].elem, true, bool, "%d");
+    CHECK(topk_push(&tk, &vals[2].elem) == &vals[0].elem, true, bool, "%d");
+    CHECK(topk_validate(&tk), true, bool, "%d");
+    CHECK(topk_push(&tk, &vals[3].elem) == &vals[3].elem, true, bool, "%d");
+    CHECK(topk_min(&tk) == &vals[2].elem, true, bool, "%d");
+    CHECK(topk_size(&tk), 1, size_t, "%zu");
+    return PASS;
+}
+
+static enum test_result
+topk_test_stream_reuse(void)
+{
+    /* Only capacity + 1 elements are ever used for the whole stream. Every
+       rejected or evicted element carries the next value of the stream. */
+    srand(time(NULL)); /* NOLINT */
+    enum
+    {
+        k = 100,
+        stream_len = 10000,
+        max_val = 500,
+    };
+    struct topk tk = TOPK_INIT(tk, k, val_cmp, NULL);
+    struct val pool[k + 1];
+    int counts[max_val] = {0};
+    struct val *spare = &pool[0];
+    int next_free = 1;
+    for (int i = 0; i < stream_len; ++i)
+    {
+        spare->id = i;
+        spare->val = rand() % max_val; /* NOLINT */
+        ++counts[spare->val];
+        struct depq_elem *const out = topk_push(&tk, &spare->elem);
+        if (!out)
+        {
+            CHECK(next_free <= k, true, bool, "%d");
+            spare = &pool[next_free++];
+        }
+        else
+        {
+            spare = DEPQ_ENTRY(out, struct val, elem);
+        }
+        CHECK(topk_validate(&tk), true, bool, "%d");
+    }
+    CHECK(topk_size(&tk), k, size_t, "%zu");
+    /* The kept values must be the k largest values of the stream. */
+    int remaining = k;
+    int expected = max_val - 1;
+    for (struct depq_elem *e = topk_begin(&tk); e != topk_end(&tk);
+         e = topk_next(&tk, e), --remaining)
+    {
+        while (!counts[expected])
+        {
+            --expected;
+        }
+        CHECK(DEPQ_ENTRY(e, struct val, elem)->val, expected, int, "%d");
+        --counts[expected];
+    }
+    CHECK(remaining, 0, int, "%d");
+    return PASS;
+}
+
+static dpq_threeway_cmp
+val_cmp(struct depq_elem const *a, struct depq_elem const *b, void *aux)
+{
+    (void)aux;
+    struct val *lhs = DEPQ_ENTRY(a, struct val, elem);
+    struct val *rhs = DEPQ_ENTRY(b, struct val, elem);
+    return (lhs->val > rhs->val) - (lhs->val < rhs->val);
+}
@@ -0,0 +1,119 @@
+#include "test.h"
+#include "typed_queue.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+struct point
+{
+    int r;
+    int c;
+};
+
+TYPED_QUEUE(point_queue, struct point)
+TYPED_QUEUE(int_queue, int)
+
+static enum test_result tq_test_empty(void);
+static enum test_result tq_test_fifo(void);
+static enum test_result tq_test_grow_wrapped(void);
+
+#define NUM_TESTS (size_t)3
+test_fn const all_tests[NUM_TESTS] = {
+    tq_test_empty,
+    tq_test_fifo,
+    tq_test_grow_wrapped,
+};
+
+int
+main()
+{
+    enum test_result res = PASS;
+    for (size_t i = 0; i < NUM_TESTS; ++i)
+    {
+        bool const fail = all_tests[i]() == FAIL;
+        if (fail)
+        {
+            res = FAIL;
+        }
+    }
+    return res;
+}
+
+static enum test_result
+tq_test_empty(void)
+{
+    struct point_queue q;
+    CHECK(point_queue_init(&q, 5), true, bool, "%d");
+    CHECK(point_queue_capacity(&q), 8, size_t, "%zu");
+    CHECK(point_queue_empty(&q), true, bool, "%d");
+    CHECK(point_queue_front(&q) == NULL, true, bool, "%d");
+    struct point p = {0};
+    CHECK(point_queue_pop(&q, &p), false, bool, "%d");
+    point_queue_free(&q);
+    CHECK(point_queue_capacity(&q), 0, size_t, "%zu");
+    CHECK(point_queue_init(&q, 0), true, bool, "%d");
+    CHECK(point_queue_capacity(&q), 1, size_t, "%zu");
+    point_queue_free(&q);
+    return PASS;
+}
+
+/* Elements come out in the order they went in and the ring grows from a
+   capacity of one. */
+static enum test_result
+tq_test_fifo(void)
+{
+    struct point_queue q;
+    CHECK(point_queue_init(&q, 1), true, bool, "%d");
+    for (int i = 0; i < 100; ++i)
+    {
+        CHECK(point_queue_push(&q, (struct point){i, -i}), true, bool, "%d");
+    }
+    CHECK(point_queue_size(&q), 100, size_t, "%zu");
+    CHECK(point_queue_capacity(&q), 128, size_t, "%zu");
+    CHECK(point_queue_front(&q)->r, 0, int, "%d");
+    for (int i = 0; i < 100; ++i)
+    {
+        struct point p = {0};
+        CHECK(point_queue_pop(&q, &p), true, bool, "%d");
+        CHECK(p.r, i, int, "%d");
+        CHECK(p.c, -i, int, "%d");
+    }
+    CHECK(point_queue_empty(&q), true, bool, "%d");
+    point_queue_free(&q);
+    return PASS;
+}
+
+/* A full ring whose elements wrap around the end keeps their order when it
+   doubles. */
+static enum test_result
+tq_test_grow_wrapped(void)
+{
+    struct int_queue q;
+    CHECK(int_queue_init(&q, 8), true, bool, "%d");
+    int next_in = 0;
+    int next_out = 0;
+    for (; next_in < 5; ++next_in)
+    {
+        CHECK(int_queue_push(&q, next_in), true, bool, "%d");
+    }
+    for (; next_out < 3; ++next_out)
+    {
+        int out = -1;
+        CHECK(int_queue_pop(&q, &out), true, bool, "%d");
+        CHECK(out, next_out, int, "%d");
+    }
+    for (; next_in < 11; ++next_in)
+    {
+        CHECK(int_queue_push(&q, next_in), true, bool, "%d");
+    }
+    CHECK(int_queue_capacity(&q), 8, size_t, "%zu");
+    CHECK(int_queue_push(&q, next_in++), true, bool, "%d");
+    CHECK(int_queue_capacity(&q), 16, size_t, "%zu");
+    for (int out = -1; int_queue_pop(&q, &out); ++next_out)
+    {
+        CHECK(out, next_out, int, "%d");
+    }
+    CHECK(next_out, next_in, int, "%d");
+    int_queue_free(&q);
+    return PASS;
+}
@@ -0,0 +1,195 @@
+#include "test.h"
+#include "typed_queue.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+TYPED_QUEUE(int_queue, int)
+
+static enum test_result tq_test_reserve_commit(void);
+static enum test_result tq_test_reserve_wraps(void);
+static enum test_result tq_test_reserve_grows(void);
+static enum test_result tq_test_pop_n(void);
+static enum test_result tq_test_commit_bounds(void);
+
+#define NUM_TESTS (size_t)5
+test_fn const all_tests[NUM_TESTS] = {
+    tq_test_reserve_commit,
+    tq_test_reserve_wraps,
+    tq_test_reserve_grows,
+    tq_test_pop_n,
+    tq_test_commit_bounds,
+};
+
+int
+main()
+{
+    enum test_result res = PASS;
+    for (size_t i = 0; i < NUM_TESTS; ++i)
+    {
+        bool const fail = all_tests[i]() == FAIL;
+        if (fail)
+        {
+            res = FAIL;
+        }
+    }
+    return res;
+}
+
+/* Only the committed slots join the queue. */
+static enum test_result
+tq_test_reserve_commit(void)
+{
+    struct int_queue q;
+    CHECK(int_queue_init(&q, 8), true, bool, "%d");
+    struct int_queue_spans s = int_queue_reserve(&q, 4);
+    CHECK(s.first_len, 4, size_t, "%zu");
+    CHECK(s.second_len, 0, size_t, "%zu");
+    CHECK(int_queue_empty(&q), true, bool, "%d");
+    *int_queue_span_at(&s, 0) = 10;
+    *int_queue_span_at(&s, 1) = 11;
+    CHECK(int_queue_commit(&q, 2), 2, size_t, "%zu");
+    CHECK(int_queue_size(&q), 2, size_t, "%zu");
+    s = int_queue_reserve(&q, 1);
+    *int_queue_span_at(&s, 0) = 12;
+    CHECK(int_queue_commit(&q, 1), 1, size_t, "%zu");
+    for (int i = 10; i < 13; ++i)
+    {
+        int out = -1;
+        CHECK(int_queue_pop(&q, &out), true, bool, "%d");
+        CHECK(out, i, int, "%d");
+    }
+    CHECK(int_queue_empty(&q), true, bool, "%d");
+    int_queue_free(&q);
+    return PASS;
+}
+
+/* Reserved slots past the end of the ring continue at its start. */
+static enum test_result
+tq_test_reserve_wraps(void)
+{
+    struct int_queue q;
+    CHECK(int_queue_init(&q, 8), true, bool, "%d");
+    for (int i = 0; i < 6; ++i)
+    {
+        CHECK(int_queue_push(&q, i), true, bool, "%d");
+    }
+    int out = -1;
+    for (int i = 0; i < 5; ++i)
+    {
+        CHECK(int_queue_pop(&q, &out), true, bool, "%d");
+    }
+    struct int_queue_spans const s = int_queue_reserve(&q, 5);
+    CHECK(s.first_len, 2, size_t, "%zu");
+    CHECK(s.second_len, 3, size_t, "%zu");
+    CHECK(int_queue_capacity(&q), 8, size_t, "%zu");
+    for (size_t i = 0; i < 5; ++i)
+    {
+        *int_queue_span_at(&s, i) = 6 + (int)i;
+    }
+    CHECK(int_queue_commit(&q, 5), 5, size_t, "%zu");
+    for (int i = 5; i < 11; ++i)
+    {
+        CHECK(int_queue_pop(&q, &out), true, bool, "%d");
+        CHECK(out, i, int, "%d");
+    }
+    int_queue_free(&q);
+    return PASS;
+}
+
+/* A reserve larger than the free room doubles the ring first. */
+static enum test_result
+tq_test_reserve_grows(void)
+{
+    struct int_queue q;
+    CHECK(int_queue_init(&q, 4), true, bool, "%d");
+    CHECK(int_queue_push(&q, 0), true, bool, "%d");
+    CHECK(int_queue_push(&q, 1), true, bool, "%d");
+    struct int_queue_spans const s = int_queue_reserve(&q, 13);
+    CHECK(int_queue_capacity(&q), 16, size_t, "%zu");
+    CHECK(s.first_len + s.second_len, 13, size_t, "%zu");
+    for (size_t i = 0; i < 13; ++i)
+    {
+        *int_queue_span_at(&s, i) = 2 + (int)i;
+    }
+    CHECK(int_queue_commit(&q, 13), 13, size_t, "%zu");
+    int out = -1;
+    for (int i = 0; i < 15; ++i)
+    {
+        CHECK(int_queue_pop(&q, &out), true, bool, "%d");
+        CHECK(out, i, int, "%d");
+    }
+    int_queue_free(&q);
+    return PASS;
+}
+
+/* A batch pop returns the front elements in place, split where they wrap,
+   and stops at the size of the queue. */
+static enum test_result
+tq_test_pop_n(void)
+{
+    struct int_queue q;
+    CHECK(int_queue_init(&q, 8), true, bool, "%d");
+    for (int i = 0; i < 6; ++i)
+    {
+        CHECK(int_queue_push(&q, i), true, bool, "%d");
+    }
+    struct int_queue_spans s = int_queue_pop_n(&q, 4);
+    CHECK(s.first_len, 4, size_t, "%zu");
+    CHECK(s.second_len, 0, size_t, "%zu");
+    CHECK(s.first[3], 3, int, "%d");
+    for (int i = 6; i < 10; ++i)
+    {
+        CHECK(int_queue_push(&q, i), true, bool, "%d");
+    }
+    s = int_queue_pop_n(&q, 100);
+    CHECK(s.first_len, 4, size_t, "%zu");
+    CHECK(s.second_len, 2, size_t, "%zu");
+    for (size_t i = 0; i < 6; ++i)
+    {
+        CHECK(*int_queue_span_at(&s, i), 4 + (int)i, int, "%d");
+    }
+    CHECK(int_queue_empty(&q), true, bool, "%d");
+    s = int_queue_pop_n(&q, 3);
+    CHECK(s.first_len + s.second_len, 0, size_t, "%zu");
+    int_queue_free(&q);
+    return PASS;
+}
+
+/* A commit adds no more than the last reserve and ends it, so committing
+   again, committing past the reserve, or committing after a push cannot
+   make unwritten slots part of the queue. */
+static enum test_result
+tq_test_commit_bounds(void)
+{
+    struct int_queue q;
+    CHECK(int_queue_init(&q, 4), true, bool, "%d");
+    CHECK(int_queue_commit(&q, 3), 0, size_t, "%zu");
+    struct int_queue_spans s = int_queue_reserve(&q, 3);
+    *int_queue_span_at(&s, 0) = 20;
+    *int_queue_span_at(&s, 1) = 21;
+    CHECK(int_queue_commit(&q, 2), 2, size_t, "%zu");
+    CHECK(int_queue_commit(&q, 1), 0, size_t, "%zu");
+    CHECK(int_queue_size(&q), 2, size_t, "%zu");
+    s = int_queue_reserve(&q, 2);
+    *int_queue_span_at(&s, 0) = 22;
+    *int_queue_span_at(&s, 1) = 23;
+    CHECK(int_queue_commit(&q, 9), 2, size_t, "%zu");
+    CHECK(int_queue_size(&q), int_queue_capacity(&q), size_t, "%zu");
+    int dropped = -1;
+    CHECK(int_queue_pop(&q, &dropped), true, bool, "%d");
+    CHECK(dropped, 20, int, "%d");
+    (void)int_queue_reserve(&q, 1);
+    CHECK(int_queue_push(&q, 24), true, bool, "%d");
+    CHECK(int_queue_commit(&q, 1), 0, size_t, "%zu");
+    CHECK(int_queue_size(&q), 4, size_t, "%zu");
+    for (int i = 21; i < 25; ++i)
+    {
+        int out = -1;
+        CHECK(int_queue_pop(&q, &out), true, bool, "%d");
+        CHECK(out, i, int, "%d");
+    }
+    CHECK(int_queue_empty(&q), true, bool, "%d");
+    int_queue_free(&q);
+    return PASS;
+}